@@ -25,6 +25,7 @@
 #include "ad_interface.h"
 #include "ad_object.h"
 #include "ad_security.h"
+#include "ad_trace.h"
 #include "ad_utils.h"
 #include "ad_display.h"
 
@@ -33,7 +34,9 @@
 #include <QCoreApplication>
 #include <QDebug>
 #include <QLocale>
+#include <QSet>
 #include <algorithm>
+#include <functional>
 
 #define ATTRIBUTE_ATTRIBUTE_DISPLAY_NAMES "attributeDisplayNames"
 #define ATTRIBUTE_EXTRA_COLUMNS "extraColumns"
@@ -63,9 +66,21 @@
 
 #define FLAG_ATTR_IS_CONSTRUCTED 0x00000004
 
+AttributeType attribute_get_type(const AdObject &schema);
+LargeIntegerSubtype attribute_get_large_integer_subtype(const Attribute &attribute);
+AttributeMetadata attribute_metadata_from_schema(const Attribute &attribute, const AdObject &schema);
+
 AdConfigPrivate::AdConfigPrivate() {
 }
 
+AttributeMetadata::AttributeMetadata() {
+    type = AttributeType_StringCase;
+    large_integer_subtype = LargeIntegerSubtype_Integer;
+    flags = 0;
+    range_upper = 0;
+    link_id = 0;
+}
+
 AdConfig::AdConfig() {
     d = new AdConfigPrivate();
 }
@@ -75,6 +90,12 @@ AdConfig::~AdConfig() {
 }
 
 void AdConfig::load(AdInterface &ad, const QLocale &locale) {
+    TRACE_SCOPE("adconfig", "AdConfig::load");
+
+    // NOTE: config is reloaded when connecting to a
+    // different domain, where cached tokens are not valid
+    ad_security_clear_token_cache();
+
     d->domain = ad.get_domain();
 
     d->filter_containers.clear();
@@ -110,6 +131,8 @@ void AdConfig::load(AdInterface &ad, const QLocale &locale) {
 
     // Attribute schemas
     {
+        TRACE_SCOPE("adconfig", "attribute_schemas");
+
         const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_ATTRIBUTE_SCHEMA);
 
         const QList<QString> attributes = {
@@ -137,6 +160,8 @@ void AdConfig::load(AdInterface &ad, const QLocale &locale) {
 
     // Class schemas
     {
+        TRACE_SCOPE("adconfig", "class_schemas");
+
         const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_CLASS_SCHEMA);
 
         const QList<QString> attributes = {
@@ -167,9 +192,13 @@ void AdConfig::load(AdInterface &ad, const QLocale &locale) {
         }
     }
 
+    d->load_schema_tables();
+
     // Class display specifiers
     // NOTE: can't just store objects for these because the values require a decent amount of preprocessing which is best done once here, not everytime value is requested
     {
+        TRACE_SCOPE("adconfig", "display_specifiers");
+
         const QString filter = QString();
 
         const QList<QString> search_attributes = {
@@ -185,7 +214,7 @@ void AdConfig::load(AdInterface &ad, const QLocale &locale) {
             // Display specifier DN is "CN=object-class-Display,CN=..."
             // Get "object-class" from that
             const QString object_class = [dn]() {
-                const QString rdn = dn.split(",")[0];
+                const QString rdn = dn_get_rdn(dn);
                 QString out = rdn;
                 out.remove("CN=", Qt::CaseInsensitive);
                 out.remove("-Display");
@@ -226,6 +255,8 @@ void AdConfig::load(AdInterface &ad, const QLocale &locale) {
 
     // Columns
     {
+        TRACE_SCOPE("adconfig", "columns");
+
         const QList<QString> columns_values = [&] {
             const QString dn = QString("CN=default-Display,%1").arg(locale_dir);
             const AdObject object = ad.search_object(dn, {ATTRIBUTE_EXTRA_COLUMNS});
@@ -305,6 +336,8 @@ void AdConfig::load(AdInterface &ad, const QLocale &locale) {
 
     // Extended rights
     {
+        TRACE_SCOPE("adconfig", "extended_rights");
+
         const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_CONTROL_ACCESS_RIGHT);
 
         const QList<QString> attributes = {
@@ -317,6 +350,10 @@ void AdConfig::load(AdInterface &ad, const QLocale &locale) {
 
         const QString search_base = extended_rights_dn();
 
+        // NOTE: clear list so that rights are not
+        // duplicated if config is reloaded
+        d->extended_rights_list.clear();
+
         const QHash<QString, AdObject> search_results = ad.search(search_base, SearchScope_Children, filter, attributes);
 
         for (const AdObject &object : search_results.values()) {
@@ -347,6 +384,32 @@ void AdConfig::load(AdInterface &ad, const QLocale &locale) {
             d->extended_rights_list.append(cn);
             d->rights_valid_accesses_map[cn] = valid_accesses;
         }
+
+        d->class_to_rights_map.clear();
+        d->rights_index_map.clear();
+
+        for (int i = 0; i < d->extended_rights_list.size(); i++) {
+            const QString &rights = d->extended_rights_list[i];
+            const QByteArray rights_guid = d->rights_name_to_guid_map[rights];
+            const QList<QString> applies_to_list = d->rights_applies_to_map[rights_guid];
+
+            d->rights_index_map[rights] = i;
+
+            for (const QString &object_class : applies_to_list) {
+                QList<int> &class_rights = d->class_to_rights_map[object_class];
+
+                if (class_rights.isEmpty() || class_rights.last() != i) {
+                    class_rights.append(i);
+                }
+            }
+        }
+
+        {
+            QMutexLocker locker(&d->closure_cache_mutex);
+            d->extended_rights_list_cache.clear();
+        }
+
+        ad_security_clear_right_list_cache();
     }
 }
 
@@ -443,17 +506,7 @@ QList<QString> AdConfig::get_filter_containers() const {
 }
 
 QList<QString> AdConfig::get_possible_superiors(const QList<ObjectClass> &object_classes) const {
-    QList<QString> out;
-
-    for (const QString &object_class : object_classes) {
-        const AdObject schema = d->class_schemas[object_class];
-        out += schema.get_strings(ATTRIBUTE_POSSIBLE_SUPERIORS);
-        out += schema.get_strings(ATTRIBUTE_SYSTEM_POSSIBLE_SUPERIORS);
-    }
-
-    out.removeDuplicates();
-
-    return out;
+    return d->get_closure_list(object_classes, d->superior_closure, d->class_table, &d->possible_superiors_cache);
 }
 
 ObjectClass AdConfig::get_parent_class(const ObjectClass &object_class) const {
@@ -463,6 +516,14 @@ ObjectClass AdConfig::get_parent_class(const ObjectClass &object_class) const {
 }
 
 QList<ObjectClass> AdConfig::get_inherit_chain(const ObjectClass &object_class) const {
+    if (d->class_index_map.contains(object_class)) {
+        const int class_index = d->class_index_map[object_class];
+
+        return d->inherit_chain_table[class_index];
+    }
+
+    // NOTE: class is not in schema, so just follow
+    // parents the slow way
     QList<QString> out;
 
     ObjectClass current_class = object_class;
@@ -485,35 +546,11 @@ QList<ObjectClass> AdConfig::get_inherit_chain(const ObjectClass &object_class)
 }
 
 QList<QString> AdConfig::get_optional_attributes(const QList<QString> &object_classes) const {
-    const QList<QString> all_classes = d->add_auxiliary_classes(object_classes);
-
-    QList<QString> attributes;
-
-    for (const auto &object_class : all_classes) {
-        const AdObject schema = d->class_schemas[object_class];
-        attributes += schema.get_strings(ATTRIBUTE_MAY_CONTAIN);
-        attributes += schema.get_strings(ATTRIBUTE_SYSTEM_MAY_CONTAIN);
-    }
-
-    attributes.removeDuplicates();
-
-    return attributes;
+    return d->get_closure_list(object_classes, d->may_closure, d->attribute_table, &d->optional_attributes_cache);
 }
 
 QList<QString> AdConfig::get_mandatory_attributes(const QList<QString> &object_classes) const {
-    const QList<QString> all_classes = d->add_auxiliary_classes(object_classes);
-
-    QList<QString> attributes;
-
-    for (const auto &object_class : all_classes) {
-        const AdObject schema = d->class_schemas[object_class];
-        attributes += schema.get_strings(ATTRIBUTE_MUST_CONTAIN);
-        attributes += schema.get_strings(ATTRIBUTE_SYSTEM_MUST_CONTAIN);
-    }
-
-    attributes.removeDuplicates();
-
-    return attributes;
+    return d->get_closure_list(object_classes, d->must_closure, d->attribute_table, &d->mandatory_attributes_cache);
 }
 
 QList<QString> AdConfig::get_find_attributes(const QString &object_class) const {
@@ -521,122 +558,41 @@ QList<QString> AdConfig::get_find_attributes(const QString &object_class) const
 }
 
 AttributeType AdConfig::get_attribute_type(const QString &attribute) const {
-    // NOTE: replica of: https://docs.microsoft.com/en-us/openspecs/windows_protocols/ms-adts/7cda533e-d7a4-4aec-a517-91d02ff4a1aa
-    // syntax -> om syntax list -> type
-    static QHash<QString, QHash<QString, AttributeType>> type_map = {
-        {"2.5.5.8", {{"1", AttributeType_Boolean}}},
-        {"2.5.5.9",
-            {
-                {"10", AttributeType_Enumeration},
-                {"2", AttributeType_Integer},
-            }},
-        {"2.5.5.16", {{"65", AttributeType_LargeInteger}}},
-        {"2.5.5.3", {{"27", AttributeType_StringCase}}},
-        {"2.5.5.5", {{"22", AttributeType_IA5}}},
-        {"2.5.5.15", {{"66", AttributeType_NTSecDesc}}},
-        {"2.5.5.6", {{"18", AttributeType_Numeric}}},
-        {"2.5.5.2", {{"6", AttributeType_ObjectIdentifier}}},
-        {"2.5.5.10",
-            {
-                {"4", AttributeType_Octet},
-                {"127", AttributeType_ReplicaLink},
-            }},
-        {"2.5.5.5", {{"19", AttributeType_Printable}}},
-        {"2.5.5.17", {{"4", AttributeType_Sid}}},
-        {"2.5.5.4", {{"20", AttributeType_Teletex}}},
-        {"2.5.5.12", {{"64", AttributeType_Unicode}}},
-        {"2.5.5.11",
-            {
-                {"23", AttributeType_UTCTime},
-                {"24", AttributeType_GeneralizedTime},
-            }},
-        {"2.5.5.14", {{"127", AttributeType_DNString}}},
-        {"2.5.5.7", {{"127", AttributeType_DNBinary}}},
-        {"2.5.5.1", {{"127", AttributeType_DSDN}}},
-    };
-
-    const AdObject schema = d->attribute_schemas[attribute];
-
-    const QString attribute_syntax = schema.get_string(ATTRIBUTE_ATTRIBUTE_SYNTAX);
-    const QString om_syntax = schema.get_string(ATTRIBUTE_OM_SYNTAX);
-
-    if (type_map.contains(attribute_syntax) && type_map[attribute_syntax].contains(om_syntax)) {
-        return type_map[attribute_syntax][om_syntax];
-    } else {
-        return AttributeType_StringCase;
-    }
+    return d->get_attribute_metadata(attribute).type;
 }
 
 LargeIntegerSubtype AdConfig::get_attribute_large_integer_subtype(const QString &attribute) const {
-    // Manually remap large integer types to subtypes
-    static const QList<QString> datetimes = {
-        ATTRIBUTE_ACCOUNT_EXPIRES,
-        ATTRIBUTE_LAST_LOGON,
-        ATTRIBUTE_LAST_LOGON_TIMESTAMP,
-        ATTRIBUTE_PWD_LAST_SET,
-        ATTRIBUTE_LOCKOUT_TIME,
-        ATTRIBUTE_BAD_PWD_TIME,
-        ATTRIBUTE_CREATION_TIME,
-    };
-    static const QList<QString> timespans = {
-        ATTRIBUTE_MAX_PWD_AGE,
-        ATTRIBUTE_MIN_PWD_AGE,
-        ATTRIBUTE_LOCKOUT_DURATION,
-        ATTRIBUTE_LOCKOUT_OBSERVATION_WINDOW,
-        ATTRIBUTE_FORCE_LOGOFF,
-        ATTRIBUTE_MS_DS_LOCKOUT_DURATION,
-        ATTRIBUTE_MS_DS_LOCKOUT_OBSERVATION_WINDOW,
-        ATTRIBUTE_MS_DS_MAX_PASSWORD_AGE,
-        ATTRIBUTE_MS_DS_MIN_PASSWORD_AGE
-    };
-
-    if (datetimes.contains(attribute)) {
-        return LargeIntegerSubtype_Datetime;
-    } else if (timespans.contains(attribute)) {
-        return LargeIntegerSubtype_Timespan;
+    // NOTE: subtype doesn't depend on schema, so it's
+    // defined for attributes missing from schema as well
+    if (d->attribute_index_map.contains(attribute)) {
+        return d->get_attribute_metadata(attribute).large_integer_subtype;
     } else {
-        return LargeIntegerSubtype_Integer;
+        return attribute_get_large_integer_subtype(attribute);
     }
 }
 
 bool AdConfig::get_attribute_is_number(const QString &attribute) const {
-    static const QList<AttributeType> number_types = {
-        AttributeType_Integer,
-        AttributeType_LargeInteger,
-        AttributeType_Enumeration,
-        AttributeType_Numeric,
-    };
-    const AttributeType type = get_attribute_type(attribute);
-
-    return number_types.contains(type);
+    return bitmask_is_set(d->get_attribute_metadata(attribute).flags, AttributeFlag_Number);
 }
 
 bool AdConfig::get_attribute_is_single_valued(const QString &attribute) const {
-    return d->attribute_schemas[attribute].get_bool(ATTRIBUTE_IS_SINGLE_VALUED);
+    return bitmask_is_set(d->get_attribute_metadata(attribute).flags, AttributeFlag_SingleValued);
 }
 
 bool AdConfig::get_attribute_is_system_only(const QString &attribute) const {
-    return d->attribute_schemas[attribute].get_bool(ATTRIBUTE_SYSTEM_ONLY);
+    return bitmask_is_set(d->get_attribute_metadata(attribute).flags, AttributeFlag_SystemOnly);
 }
 
 int AdConfig::get_attribute_range_upper(const QString &attribute) const {
-    return d->attribute_schemas[attribute].get_int(ATTRIBUTE_RANGE_UPPER);
+    return d->get_attribute_metadata(attribute).range_upper;
 }
 
 bool AdConfig::get_attribute_is_backlink(const QString &attribute) const {
-    if (d->attribute_schemas[attribute].contains(ATTRIBUTE_LINK_ID)) {
-        const int link_id = d->attribute_schemas[attribute].get_int(ATTRIBUTE_LINK_ID);
-        const bool link_id_is_odd = (link_id % 2 != 0);
-
-        return link_id_is_odd;
-    } else {
-        return false;
-    }
+    return bitmask_is_set(d->get_attribute_metadata(attribute).flags, AttributeFlag_Backlink);
 }
 
 bool AdConfig::get_attribute_is_constructed(const QString &attribute) const {
-    const int system_flags = d->attribute_schemas[attribute].get_int(ATTRIBUTE_SYSTEM_FLAGS);
-    return bitmask_is_set(system_flags, FLAG_ATTR_IS_CONSTRUCTED);
+    return bitmask_is_set(d->get_attribute_metadata(attribute).flags, AttributeFlag_Constructed);
 }
 
 QByteArray AdConfig::get_right_guid(const QString &right_cn) const {
@@ -747,15 +703,32 @@ QString AdConfig::get_right_name(const QByteArray &right_guid, const QLocale::La
 }
 
 QList<QString> AdConfig::get_extended_rights_list(const QList<QString> &class_list) const {
-    QList<QString> out;
+    const QString cache_key = class_list.join(',');
 
-    for (const QString &rights : d->extended_rights_list) {
-        const bool applies_to = rights_applies_to_class(rights, class_list);
-        if (applies_to) {
-            out.append(rights);
-        }
+    QMutexLocker locker(&d->closure_cache_mutex);
+
+    if (d->extended_rights_list_cache.contains(cache_key)) {
+        return d->extended_rights_list_cache[cache_key];
+    }
+
+    // NOTE: merge indexes of all classes and sort them so
+    // that rights are in the same order as in
+    // extended_rights_list
+    QList<int> index_list;
+    for (const QString &object_class : class_list) {
+        index_list += d->class_to_rights_map.value(object_class);
     }
 
+    std::sort(index_list.begin(), index_list.end());
+    index_list.erase(std::unique(index_list.begin(), index_list.end()), index_list.end());
+
+    QList<QString> out;
+    for (const int i : index_list) {
+        out.append(d->extended_rights_list[i]);
+    }
+
+    d->extended_rights_list_cache.insert(cache_key, out);
+
     return out;
 }
 
@@ -796,30 +769,341 @@ QList<QString> AdConfig::get_noncontainer_classes() {
 }
 
 bool AdConfig::rights_applies_to_class(const QString &rights_cn, const QList<QString> &class_list) const {
-    const QByteArray rights_guid = d->rights_name_to_guid_map[rights_cn];
+    const int rights_index = d->rights_index_map.value(rights_cn, -1);
 
-    const QList<QString> applies_to_list = d->rights_applies_to_map[rights_guid];
-    const QSet<QString> applies_to_set = QSet<QString>(applies_to_list.begin(), applies_to_list.end());
+    if (rights_index == -1) {
+        return false;
+    }
 
-    const QSet<QString> class_set = QSet<QString>(class_list.begin(), class_list.end());
+    for (const QString &object_class : class_list) {
+        const QList<int> class_rights = d->class_to_rights_map.value(object_class);
 
-    const bool applies = applies_to_set.intersects(class_set);
+        if (std::binary_search(class_rights.begin(), class_rights.end(), rights_index)) {
+            return true;
+        }
+    }
 
-    return applies;
+    return false;
 }
 
-QList<QString> AdConfigPrivate::add_auxiliary_classes(const QList<QString> &object_classes) const {
-    QList<QString> out;
+AttributeType attribute_get_type(const AdObject &schema) {
+    // NOTE: replica of: https://docs.microsoft.com/en-us/openspecs/windows_protocols/ms-adts/7cda533e-d7a4-4aec-a517-91d02ff4a1aa
+    // syntax -> om syntax list -> type
+    static QHash<QString, QHash<QString, AttributeType>> type_map = {
+        {"2.5.5.8", {{"1", AttributeType_Boolean}}},
+        {"2.5.5.9",
+            {
+                {"10", AttributeType_Enumeration},
+                {"2", AttributeType_Integer},
+            }},
+        {"2.5.5.16", {{"65", AttributeType_LargeInteger}}},
+        {"2.5.5.3", {{"27", AttributeType_StringCase}}},
+        {"2.5.5.5", {{"22", AttributeType_IA5}}},
+        {"2.5.5.15", {{"66", AttributeType_NTSecDesc}}},
+        {"2.5.5.6", {{"18", AttributeType_Numeric}}},
+        {"2.5.5.2", {{"6", AttributeType_ObjectIdentifier}}},
+        {"2.5.5.10",
+            {
+                {"4", AttributeType_Octet},
+                {"127", AttributeType_ReplicaLink},
+            }},
+        {"2.5.5.5", {{"19", AttributeType_Printable}}},
+        {"2.5.5.17", {{"4", AttributeType_Sid}}},
+        {"2.5.5.4", {{"20", AttributeType_Teletex}}},
+        {"2.5.5.12", {{"64", AttributeType_Unicode}}},
+        {"2.5.5.11",
+            {
+                {"23", AttributeType_UTCTime},
+                {"24", AttributeType_GeneralizedTime},
+            }},
+        {"2.5.5.14", {{"127", AttributeType_DNString}}},
+        {"2.5.5.7", {{"127", AttributeType_DNBinary}}},
+        {"2.5.5.1", {{"127", AttributeType_DSDN}}},
+    };
+
+    const QString attribute_syntax = schema.get_string(ATTRIBUTE_ATTRIBUTE_SYNTAX);
+    const QString om_syntax = schema.get_string(ATTRIBUTE_OM_SYNTAX);
+
+    if (type_map.contains(attribute_syntax) && type_map[attribute_syntax].contains(om_syntax)) {
+        return type_map[attribute_syntax][om_syntax];
+    } else {
+        return AttributeType_StringCase;
+    }
+}
+
+LargeIntegerSubtype attribute_get_large_integer_subtype(const Attribute &attribute) {
+    // Manually remap large integer types to subtypes
+    static const QList<QString> datetimes = {
+        ATTRIBUTE_ACCOUNT_EXPIRES,
+        ATTRIBUTE_LAST_LOGON,
+        ATTRIBUTE_LAST_LOGON_TIMESTAMP,
+        ATTRIBUTE_PWD_LAST_SET,
+        ATTRIBUTE_LOCKOUT_TIME,
+        ATTRIBUTE_BAD_PWD_TIME,
+        ATTRIBUTE_CREATION_TIME,
+    };
+    static const QList<QString> timespans = {
+        ATTRIBUTE_MAX_PWD_AGE,
+        ATTRIBUTE_MIN_PWD_AGE,
+        ATTRIBUTE_LOCKOUT_DURATION,
+        ATTRIBUTE_LOCKOUT_OBSERVATION_WINDOW,
+        ATTRIBUTE_FORCE_LOGOFF,
+        ATTRIBUTE_MS_DS_LOCKOUT_DURATION,
+        ATTRIBUTE_MS_DS_LOCKOUT_OBSERVATION_WINDOW,
+        ATTRIBUTE_MS_DS_MAX_PASSWORD_AGE,
+        ATTRIBUTE_MS_DS_MIN_PASSWORD_AGE
+    };
+
+    if (datetimes.contains(attribute)) {
+        return LargeIntegerSubtype_Datetime;
+    } else if (timespans.contains(attribute)) {
+        return LargeIntegerSubtype_Timespan;
+    } else {
+        return LargeIntegerSubtype_Integer;
+    }
+}
+
+AttributeMetadata attribute_metadata_from_schema(const Attribute &attribute, const AdObject &schema) {
+    static const QList<AttributeType> number_types = {
+        AttributeType_Integer,
+        AttributeType_LargeInteger,
+        AttributeType_Enumeration,
+        AttributeType_Numeric,
+    };
+
+    AttributeMetadata out;
+
+    out.type = attribute_get_type(schema);
+    out.large_integer_subtype = attribute_get_large_integer_subtype(attribute);
+    out.range_upper = schema.get_int(ATTRIBUTE_RANGE_UPPER);
+    out.link_id = schema.get_int(ATTRIBUTE_LINK_ID);
+
+    const bool is_backlink = [&]() {
+        if (schema.contains(ATTRIBUTE_LINK_ID)) {
+            const bool link_id_is_odd = (out.link_id % 2 != 0);
+
+            return link_id_is_odd;
+        } else {
+            return false;
+        }
+    }();
+
+    const int system_flags = schema.get_int(ATTRIBUTE_SYSTEM_FLAGS);
+
+    const QHash<int, bool> flag_map = {
+        {AttributeFlag_SingleValued, schema.get_bool(ATTRIBUTE_IS_SINGLE_VALUED)},
+        {AttributeFlag_SystemOnly, schema.get_bool(ATTRIBUTE_SYSTEM_ONLY)},
+        {AttributeFlag_Backlink, is_backlink},
+        {AttributeFlag_Constructed, bitmask_is_set(system_flags, FLAG_ATTR_IS_CONSTRUCTED)},
+        {AttributeFlag_Number, number_types.contains(out.type)},
+    };
 
-    out += object_classes;
+    out.flags = 0;
+    for (const int flag : flag_map.keys()) {
+        out.flags = bitmask_set(out.flags, flag, flag_map[flag]);
+    }
+
+    return out;
+}
+
+void AdConfigPrivate::load_schema_tables() {
+    class_table.clear();
+    class_index_map.clear();
+    attribute_table.clear();
+    attribute_index_map.clear();
+    attribute_metadata_table.clear();
+    may_closure.clear();
+    must_closure.clear();
+    superior_closure.clear();
+    inherit_chain_table.clear();
+
+    {
+        QMutexLocker locker(&closure_cache_mutex);
+        optional_attributes_cache.clear();
+        mandatory_attributes_cache.clear();
+        possible_superiors_cache.clear();
+    }
+
+    // NOTE: read schema values once here, because
+    // get_strings() decodes values every time
+    class ClassData {
+    public:
+        QList<QString> may_list;
+        QList<QString> must_list;
+        QList<QString> superior_list;
+        QList<QString> auxiliary_list;
+    };
+
+    QHash<ObjectClass, ClassData> class_data_map;
+    QSet<ObjectClass> class_set;
+    QSet<Attribute> attribute_set;
+
+    for (const Attribute &attribute : attribute_schemas.keys()) {
+        attribute_set.insert(attribute);
+    }
+
+    for (const ObjectClass &object_class : class_schemas.keys()) {
+        const AdObject &schema = class_schemas[object_class];
+
+        ClassData data;
+        data.may_list = schema.get_strings(ATTRIBUTE_MAY_CONTAIN) + schema.get_strings(ATTRIBUTE_SYSTEM_MAY_CONTAIN);
+        data.must_list = schema.get_strings(ATTRIBUTE_MUST_CONTAIN) + schema.get_strings(ATTRIBUTE_SYSTEM_MUST_CONTAIN);
+        data.superior_list = schema.get_strings(ATTRIBUTE_POSSIBLE_SUPERIORS) + schema.get_strings(ATTRIBUTE_SYSTEM_POSSIBLE_SUPERIORS);
+        data.auxiliary_list = schema.get_strings(ATTRIBUTE_AUXILIARY_CLASS) + schema.get_strings(ATTRIBUTE_SYSTEM_AUXILIARY_CLASS);
+
+        class_set.insert(object_class);
+
+        for (const QString &attribute : data.may_list + data.must_list) {
+            attribute_set.insert(attribute);
+        }
+
+        // NOTE: superiors may reference classes that are
+        // not in schema, add them to table anyway so that
+        // they are not lost
+        for (const QString &superior : data.superior_list) {
+            class_set.insert(superior);
+        }
+
+        class_data_map[object_class] = data;
+    }
+
+    class_table = class_set.values();
+    std::sort(class_table.begin(), class_table.end());
+    for (int i = 0; i < class_table.size(); i++) {
+        class_index_map[class_table[i]] = i;
+    }
+
+    attribute_table = attribute_set.values();
+    std::sort(attribute_table.begin(), attribute_table.end());
+    for (int i = 0; i < attribute_table.size(); i++) {
+        attribute_index_map[attribute_table[i]] = i;
+    }
+
+    const int class_count = class_table.size();
+    const int attribute_count = attribute_table.size();
+
+    attribute_metadata_table = QVector<AttributeMetadata>(attribute_count);
+    for (int i = 0; i < attribute_count; i++) {
+        const Attribute attribute = attribute_table[i];
+        const AdObject schema = attribute_schemas.value(attribute);
+
+        attribute_metadata_table[i] = attribute_metadata_from_schema(attribute, schema);
+    }
+
+    may_closure = QVector<QBitArray>(class_count, QBitArray(attribute_count));
+    must_closure = QVector<QBitArray>(class_count, QBitArray(attribute_count));
+    superior_closure = QVector<QBitArray>(class_count, QBitArray(class_count));
+    inherit_chain_table = QVector<QList<ObjectClass>>(class_count);
+
+    // Compute closures in dependency order, so that
+    // closures of parent and auxiliary classes are ready
+    // before they are merged into a class. State prevents
+    // infinite loops on malformed schemas.
+    enum VisitState {
+        VisitState_None,
+        VisitState_Visiting,
+        VisitState_Done,
+    };
+
+    QVector<int> state_list(class_count, VisitState_None);
+
+    std::function<void(int)> visit = [&](const int class_i) {
+        if (state_list[class_i] != VisitState_None) {
+            return;
+        }
+
+        state_list[class_i] = VisitState_Visiting;
+
+        const ObjectClass object_class = class_table[class_i];
+        const ClassData data = class_data_map.value(object_class);
+
+        for (const Attribute &attribute : data.may_list) {
+            may_closure[class_i].setBit(attribute_index_map[attribute]);
+        }
+
+        for (const Attribute &attribute : data.must_list) {
+            must_closure[class_i].setBit(attribute_index_map[attribute]);
+        }
+
+        for (const ObjectClass &superior : data.superior_list) {
+            superior_closure[class_i].setBit(class_index_map[superior]);
+        }
+
+        const ObjectClass parent_class = sub_class_of_map.value(object_class);
+        const bool has_parent = (!parent_class.isEmpty() && parent_class != object_class && class_index_map.contains(parent_class));
+
+        inherit_chain_table[class_i] = {object_class};
+
+        if (has_parent) {
+            const int parent_i = class_index_map[parent_class];
+            visit(parent_i);
+
+            may_closure[class_i] |= may_closure[parent_i];
+            must_closure[class_i] |= must_closure[parent_i];
+            superior_closure[class_i] |= superior_closure[parent_i];
+            inherit_chain_table[class_i] += inherit_chain_table[parent_i];
+        }
+
+        for (const ObjectClass &auxiliary_class : data.auxiliary_list) {
+            if (!class_index_map.contains(auxiliary_class)) {
+                continue;
+            }
+
+            const int auxiliary_i = class_index_map[auxiliary_class];
+            visit(auxiliary_i);
+
+            may_closure[class_i] |= may_closure[auxiliary_i];
+            must_closure[class_i] |= must_closure[auxiliary_i];
+        }
+
+        state_list[class_i] = VisitState_Done;
+    };
+
+    for (int i = 0; i < class_count; i++) {
+        visit(i);
+    }
+}
+
+const AttributeMetadata &AdConfigPrivate::get_attribute_metadata(const Attribute &attribute) const {
+    static const AttributeMetadata default_metadata;
+
+    const int index = attribute_index_map.value(attribute, -1);
+
+    if (index != -1) {
+        return attribute_metadata_table[index];
+    } else {
+        return default_metadata;
+    }
+}
+
+QList<QString> AdConfigPrivate::get_closure_list(const QList<ObjectClass> &object_classes, const QVector<QBitArray> &closure, const QList<QString> &table, QHash<QString, QList<QString>> *cache) const {
+    const QString cache_key = object_classes.join(',');
+
+    QMutexLocker locker(&closure_cache_mutex);
 
-    for (const auto &object_class : object_classes) {
-        const AdObject schema = class_schemas[object_class];
-        out += schema.get_strings(ATTRIBUTE_AUXILIARY_CLASS);
-        out += schema.get_strings(ATTRIBUTE_SYSTEM_AUXILIARY_CLASS);
+    if (cache->contains(cache_key)) {
+        return cache->value(cache_key);
+    }
+
+    QBitArray bits(table.size());
+
+    for (const ObjectClass &object_class : object_classes) {
+        if (!class_index_map.contains(object_class)) {
+            continue;
+        }
+
+        const int class_i = class_index_map[object_class];
+        bits |= closure[class_i];
+    }
+
+    QList<QString> out;
+    for (int i = 0; i < bits.size(); i++) {
+        if (bits.testBit(i)) {
+            out.append(table[i]);
+        }
     }
 
-    out.removeDuplicates();
+    cache->insert(cache_key, out);
 
     return out;
 }
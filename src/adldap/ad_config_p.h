@@ -21,17 +21,43 @@
 #ifndef AD_CONFIG_P_H
 #define AD_CONFIG_P_H
 
+#include "ad_defines.h"
 #include "ad_object.h"
 
+#include <QBitArray>
 #include <QByteArray>
 #include <QHash>
 #include <QList>
+#include <QMutex>
 #include <QString>
+#include <QVector>
 
 // NOTE: name strings to reduce confusion
 typedef QString ObjectClass;
 typedef QString Attribute;
 
+enum AttributeFlag {
+    AttributeFlag_SingleValued = 0x01,
+    AttributeFlag_SystemOnly = 0x02,
+    AttributeFlag_Backlink = 0x04,
+    AttributeFlag_Constructed = 0x08,
+    AttributeFlag_Number = 0x10,
+};
+
+// Schema data of an attribute in a form that is fast to
+// access. Built once at load time so that getters don't
+// have to decode schema object values on every call.
+class AttributeMetadata {
+public:
+    AttributeMetadata();
+
+    AttributeType type;
+    LargeIntegerSubtype large_integer_subtype;
+    int flags;
+    int range_upper;
+    int link_id;
+};
+
 class AdConfigPrivate {
 
 public:
@@ -55,7 +81,35 @@ public:
     QHash<Attribute, AdObject> attribute_schemas;
     QHash<ObjectClass, AdObject> class_schemas;
 
-    QList<ObjectClass> add_auxiliary_classes(const QList<QString> &object_classes) const;
+    // Dense schema tables, built once at load time.
+    // Classes and attributes are identified by their index
+    // in class_table and attribute_table. Closures are
+    // transitive: a class gets attributes of all of it's
+    // superclasses and auxiliary classes, and possible
+    // superiors of all of it's superclasses.
+    QList<ObjectClass> class_table;
+    QHash<ObjectClass, int> class_index_map;
+    QList<Attribute> attribute_table;
+    QHash<Attribute, int> attribute_index_map;
+    QVector<QBitArray> may_closure;
+    QVector<QBitArray> must_closure;
+    QVector<QBitArray> superior_closure;
+    QVector<QList<ObjectClass>> inherit_chain_table;
+
+    // Results for class lists are memoized, so that
+    // repeated queries return the same shared list. Mutex
+    // guards all of the memoized results.
+    mutable QMutex closure_cache_mutex;
+    mutable QHash<QString, QList<Attribute>> optional_attributes_cache;
+    mutable QHash<QString, QList<Attribute>> mandatory_attributes_cache;
+    mutable QHash<QString, QList<ObjectClass>> possible_superiors_cache;
+
+    // Indexed same as attribute_table
+    QVector<AttributeMetadata> attribute_metadata_table;
+
+    void load_schema_tables();
+    const AttributeMetadata &get_attribute_metadata(const Attribute &attribute) const;
+    QList<QString> get_closure_list(const QList<ObjectClass> &object_classes, const QVector<QBitArray> &closure, const QList<QString> &table, QHash<QString, QList<QString>> *cache) const;
 
     QHash<QString, QByteArray> right_to_guid_map;
     QHash<QByteArray, QString> right_guid_to_cn_map;
@@ -65,6 +119,13 @@ public:
     QList<QString> extended_rights_list;
     QHash<QString, int> rights_valid_accesses_map;
 
+    // Index of extended rights by class. Values are
+    // indexes into extended_rights_list, in ascending
+    // order.
+    QHash<ObjectClass, QList<int>> class_to_rights_map;
+    QHash<QString, int> rights_index_map;
+    mutable QHash<QString, QList<QString>> extended_rights_list_cache;
+
     QHash<QByteArray, QString> guid_to_attribute_map;
     QHash<QByteArray, QString> guid_to_class_map;
 
@@ -125,6 +125,8 @@ enum SystemFlagsBit {
 #define ATTRIBUTE_WHEN_CHANGED "whenChanged"
 #define ATTRIBUTE_USN_CHANGED "uSNChanged"
 #define ATTRIBUTE_USN_CREATED "uSNCreated"
+#define ATTRIBUTE_IS_DELETED "isDeleted"
+#define ATTRIBUTE_LAST_KNOWN_PARENT "lastKnownParent"
 #define ATTRIBUTE_OBJECT_CATEGORY "objectCategory"
 #define ATTRIBUTE_MEMBER "member"
 #define ATTRIBUTE_MEMBER_OF "memberOf"
@@ -145,6 +147,7 @@ enum SystemFlagsBit {
 #define ATTRIBUTE_PWD_LAST_SET "pwdLastSet"
 #define ATTRIBUTE_BAD_PWD_TIME "badPasswordTime"
 #define ATTRIBUTE_OBJECT_SID "objectSid"
+#define ATTRIBUTE_TOKEN_GROUPS "tokenGroups"
 #define ATTRIBUTE_SYSTEM_FLAGS "systemFlags"
 #define ATTRIBUTE_MAX_PWD_AGE "maxPwdAge"
 #define ATTRIBUTE_MIN_PWD_AGE "minPwdAge"
@@ -300,6 +303,7 @@ const long long MILLIS_TO_100_NANOS = 10000LL;
 #define MATCHING_RULE_IN_CHAIN_OID "1.2.840.113556.1.4.1941"
 
 #define LDAP_SERVER_SD_FLAGS_OID "1.2.840.113556.1.4.801"
+#define LDAP_SERVER_SHOW_DELETED_OID "1.2.840.113556.1.4.417"
 #define OWNER_SECURITY_INFORMATION 0x01
 #define GROUP_SECURITY_INFORMATION 0x02
 #define SACL_SECURITY_INFORMATION 0x08
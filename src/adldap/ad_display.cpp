@@ -23,14 +23,12 @@
 #include "ad_config.h"
 #include "ad_defines.h"
 #include "ad_utils.h"
-#include "samba/dom_sid.h"
 
 #include <QByteArray>
 #include <QCoreApplication>
 #include <QDateTime>
 #include <QList>
 #include <QString>
-#include <algorithm>
 
 const qint64 SECONDS_TO_MILLIS = 1000LL;
 const qint64 MINUTES_TO_SECONDS = 60LL;
@@ -41,7 +39,6 @@ QString large_integer_datetime_display_value(const QString &attribute, const QBy
 QString datetime_display_value(const QString &attribute, const QByteArray &bytes, const AdConfig *adconfig);
 QString timespan_display_value(const QByteArray &bytes);
 QString octet_display_value(const QByteArray &bytes);
-QString guid_to_display_value(const QByteArray &bytes);
 QString uac_to_display_value(const QByteArray &bytes);
 QString samaccounttype_to_display_value(const QByteArray &bytes);
 QString primarygrouptype_to_display_value(const QByteArray &bytes);
@@ -125,14 +122,13 @@ QString attribute_display_values(const QString &attribute, const QList<QByteArra
 }
 
 QString object_sid_display_value(const QByteArray &sid_bytes) {
-    dom_sid *sid = (dom_sid *) sid_bytes.data();
-
-    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
-
-    const char *sid_cstr = dom_sid_string(tmp_ctx, sid);
-    const QString out = QString(sid_cstr);
+    char buffer[SID_STRING_BUFFER_SIZE];
+    const int length = sid_to_string_buffer(sid_bytes.constData(), sid_bytes.size(), buffer);
+    if (length == -1) {
+        return QString();
+    }
 
-    talloc_free(tmp_ctx);
+    const QString out = QString::fromLatin1(buffer, length);
 
     return out;
 }
@@ -221,41 +217,19 @@ QString timespan_display_value(const QByteArray &bytes) {
     return display;
 }
 
+// NOTE: Windows displays GUID's as 5 segments separated by
+// '-': "00112233-4455-6677-8899-aabbccddeeff", with byte
+// order of first 3 segments reversed.
 QString guid_to_display_value(const QByteArray &bytes) {
-    // NOTE: have to do some weird pre-processing to match
-    // how Windows displays GUID's. The GUID is broken down
-    // into 5 segments, each separated by '-':
-    // "0000-11-22-33-444444". Byte order for first 3
-    // segments is also reversed (why?), so reverse it again
-    // for display.
-    const int segments_count = 5;
-    QByteArray segments[segments_count];
-    segments[0] = bytes.mid(0, 4);
-    segments[1] = bytes.mid(4, 2);
-    segments[2] = bytes.mid(6, 2);
-    segments[3] = bytes.mid(8, 2);
-    segments[4] = bytes.mid(10, 6);
-    std::reverse(segments[0].begin(), segments[0].end());
-    std::reverse(segments[1].begin(), segments[1].end());
-    std::reverse(segments[2].begin(), segments[2].end());
-
-    const QString guid_display_string = [&]() {
-        QString out;
-
-        for (int i = 0; i < segments_count; i++) {
-            const QByteArray segment = segments[i];
-
-            if (i > 0) {
-                out += '-';
-            }
+    char buffer[GUID_STRING_BUFFER_SIZE];
+    const int length = guid_to_string_buffer(bytes.constData(), bytes.size(), buffer);
+    if (length == -1) {
+        return QString();
+    }
 
-            out += segment.toHex();
-        }
+    const QString out = QString::fromLatin1(buffer, length);
 
-        return out;
-    }();
-
-    return guid_display_string;
+    return out;
 }
 
 QString octet_display_value(const QByteArray &bytes) {
@@ -0,0 +1,392 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ad_dn.h"
+
+#include <QByteArray>
+
+bool dn_char_is_hex(const QChar c);
+int dn_hex_value(const QChar c);
+QString dn_value_escape_canonical(const QString &value);
+
+DnView::DnView() {
+    m_is_valid = false;
+    has_name = false;
+    has_canonical = false;
+    has_parent_canonical = false;
+}
+
+DnView::DnView(const QString &dn)
+: DnView() {
+    m_dn = dn;
+
+    parse();
+}
+
+QString DnView::dn() const {
+    return m_dn;
+}
+
+bool DnView::is_valid() const {
+    return m_is_valid;
+}
+
+int DnView::rdn_count() const {
+    return rdn_list.size();
+}
+
+QStringRef DnView::rdn() const {
+    if (rdn_list.isEmpty()) {
+        return QStringRef();
+    }
+
+    const DnRdnRange &range = rdn_list[0];
+    const QStringRef out = m_dn.midRef(range.start, range.end - range.start);
+
+    return out;
+}
+
+QStringRef DnView::rdn_type() const {
+    if (rdn_list.isEmpty()) {
+        return QStringRef();
+    }
+
+    const DnRdnRange &range = rdn_list[0];
+    const QStringRef out = m_dn.midRef(range.start, range.equals - range.start).trimmed();
+
+    return out;
+}
+
+QString DnView::name() const {
+    if (!has_name) {
+        if (rdn_list.isEmpty()) {
+            m_name = QString();
+        } else {
+            m_name = dn_value_unescape(rdn_value(0));
+        }
+
+        has_name = true;
+    }
+
+    return m_name;
+}
+
+QStringRef DnView::parent() const {
+    if (rdn_list.size() < 2) {
+        return QStringRef();
+    }
+
+    const QStringRef out = m_dn.midRef(rdn_list[1].start);
+
+    return out;
+}
+
+QString DnView::canonical() const {
+    if (!has_canonical) {
+        m_canonical = canonical_from(0);
+        has_canonical = true;
+    }
+
+    return m_canonical;
+}
+
+QString DnView::parent_canonical() const {
+    if (!has_parent_canonical) {
+        m_parent_canonical = canonical_from(1);
+        has_parent_canonical = true;
+    }
+
+    return m_parent_canonical;
+}
+
+// NOTE: single pass over the string which records where
+// each RDN starts, where it's type ends and where it
+// ends. Escaped chars and quoted values are skipped so
+// that separators inside them are not treated as
+// separators. Both ',' and ';' are accepted as
+// separators, same as RFC 2253 parsers do.
+void DnView::parse() {
+    rdn_list.clear();
+    m_is_valid = false;
+
+    const int size = m_dn.size();
+    const QChar *data = m_dn.constData();
+
+    // NOTE: empty DN is the DN of root DSE, it's valid
+    // and has no RDN's
+    if (size == 0) {
+        m_is_valid = true;
+
+        return;
+    }
+
+    auto skip_spaces = [&](int i) {
+        while (i < size && data[i] == ' ') {
+            i++;
+        }
+
+        return i;
+    };
+
+    int rdn_start = skip_spaces(0);
+    int equals = -1;
+    bool in_quotes = false;
+
+    for (int i = rdn_start; i < size; i++) {
+        const QChar c = data[i];
+
+        if (c == '\\') {
+            // NOTE: skip escaped char. For hex pairs this
+            // skips first digit, second one is not
+            // special so it's skipped by the loop.
+            const bool escape_is_complete = (i + 1 < size);
+            if (!escape_is_complete) {
+                rdn_list.clear();
+
+                return;
+            }
+
+            i++;
+        } else if (c == '"') {
+            in_quotes = !in_quotes;
+        } else if (in_quotes) {
+            continue;
+        } else if (c == '=' && equals == -1) {
+            equals = i;
+        } else if (c == ',' || c == ';') {
+            if (equals == -1) {
+                rdn_list.clear();
+
+                return;
+            }
+
+            rdn_list.append({rdn_start, equals, i});
+
+            rdn_start = skip_spaces(i + 1);
+            equals = -1;
+            i = rdn_start - 1;
+        }
+    }
+
+    if (in_quotes || equals == -1) {
+        rdn_list.clear();
+
+        return;
+    }
+
+    rdn_list.append({rdn_start, equals, size});
+
+    m_is_valid = true;
+}
+
+// NOTE: follows ldap_dn2ad_canonical() from libldap.
+// Trailing DC components form the domain, other RDN
+// values follow in reverse order separated by '/'. DN's
+// which are only a domain end with a '/'. DN's without a
+// domain are just values in reverse order.
+QString DnView::canonical_from(const int first_rdn) const {
+    const int count = rdn_list.size();
+
+    if (!m_is_valid || first_rdn >= count) {
+        return QString();
+    }
+
+    int domain_start = count;
+    while (domain_start > first_rdn && rdn_is_dc(domain_start - 1)) {
+        domain_start--;
+    }
+
+    const bool has_domain = (count - first_rdn > 1 && domain_start < count);
+
+    QString out;
+    bool trailing_slash = true;
+
+    if (has_domain) {
+        for (int i = domain_start; i < count; i++) {
+            if (i > domain_start) {
+                out += '.';
+            }
+
+            out += dn_value_unescape(rdn_value(i));
+        }
+
+        for (int i = domain_start - 1; i >= first_rdn; i--) {
+            trailing_slash = false;
+
+            out += '/';
+            out += dn_value_escape_canonical(dn_value_unescape(rdn_value(i)));
+        }
+    } else {
+        trailing_slash = false;
+
+        for (int i = count - 1; i >= first_rdn; i--) {
+            if (i < count - 1) {
+                out += '/';
+            }
+
+            out += dn_value_escape_canonical(dn_value_unescape(rdn_value(i)));
+        }
+    }
+
+    if (trailing_slash) {
+        out += '/';
+    }
+
+    return out;
+}
+
+QStringRef DnView::rdn_value(const int i) const {
+    const DnRdnRange &range = rdn_list[i];
+    const QStringRef out = m_dn.midRef(range.equals + 1, range.end - range.equals - 1);
+
+    return out;
+}
+
+bool DnView::rdn_is_dc(const int i) const {
+    const DnRdnRange &range = rdn_list[i];
+    const QStringRef type = m_dn.midRef(range.start, range.equals - range.start).trimmed();
+
+    const bool out = (type.compare(QLatin1String("DC"), Qt::CaseInsensitive) == 0);
+
+    return out;
+}
+
+QString dn_value_unescape(const QStringRef &value_arg) {
+    const QStringRef value = [&]() {
+        const QStringRef trimmed = value_arg.trimmed();
+
+        // NOTE: quoted values are allowed by RFC 2253
+        const bool is_quoted = (trimmed.size() >= 2 && trimmed.startsWith('"') && trimmed.endsWith('"'));
+        if (is_quoted) {
+            return trimmed.mid(1, trimmed.size() - 2);
+        } else {
+            return value_arg;
+        }
+    }();
+
+    // NOTE: most values don't have escapes
+    if (!value.contains('\\')) {
+        return value.toString();
+    }
+
+    QString out;
+    out.reserve(value.size());
+
+    // NOTE: hex escapes encode utf8 bytes, so collect
+    // them until a non-hex char and then decode
+    QByteArray pending_bytes;
+
+    const int size = value.size();
+
+    for (int i = 0; i < size; i++) {
+        const QChar c = value.at(i);
+
+        const bool is_hex_escape = (c == '\\' && i + 2 < size && dn_char_is_hex(value.at(i + 1)) && dn_char_is_hex(value.at(i + 2)));
+
+        if (is_hex_escape) {
+            const char byte = (char) (dn_hex_value(value.at(i + 1)) * 16 + dn_hex_value(value.at(i + 2)));
+            pending_bytes.append(byte);
+
+            i += 2;
+
+            continue;
+        }
+
+        if (!pending_bytes.isEmpty()) {
+            out += QString::fromUtf8(pending_bytes);
+            pending_bytes.clear();
+        }
+
+        if (c == '\\' && i + 1 < size) {
+            out += value.at(i + 1);
+            i++;
+        } else {
+            out += c;
+        }
+    }
+
+    if (!pending_bytes.isEmpty()) {
+        out += QString::fromUtf8(pending_bytes);
+    }
+
+    return out;
+}
+
+QString dn_value_escape(const QString &value) {
+    QString out;
+    out.reserve(value.size());
+
+    const int size = value.size();
+
+    for (int i = 0; i < size; i++) {
+        const QChar c = value[i];
+
+        const bool is_special = (c == ',' || c == '+' || c == '"' || c == '\\' || c == '<' || c == '>' || c == ';' || c == '=');
+        const bool is_leading_special = (i == 0 && (c == ' ' || c == '#'));
+        const bool is_trailing_space = (i == size - 1 && c == ' ');
+
+        if (is_special || is_leading_special || is_trailing_space) {
+            out += '\\';
+        }
+
+        out += c;
+    }
+
+    return out;
+}
+
+// NOTE: canonical names separate RDN's with '/', so '/'
+// and escape char itself are escaped within values
+QString dn_value_escape_canonical(const QString &value) {
+    if (!value.contains('/') && !value.contains('\\')) {
+        return value;
+    }
+
+    QString out;
+    out.reserve(value.size() + 4);
+
+    for (const QChar c : value) {
+        if (c == '/' || c == '\\') {
+            out += '\\';
+        }
+
+        out += c;
+    }
+
+    return out;
+}
+
+bool dn_char_is_hex(const QChar c) {
+    return (dn_hex_value(c) != -1);
+}
+
+int dn_hex_value(const QChar c) {
+    const ushort u = c.unicode();
+
+    if (u >= '0' && u <= '9') {
+        return u - '0';
+    } else if (u >= 'a' && u <= 'f') {
+        return u - 'a' + 10;
+    } else if (u >= 'A' && u <= 'F') {
+        return u - 'A' + 10;
+    } else {
+        return -1;
+    }
+}
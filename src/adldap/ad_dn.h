@@ -0,0 +1,111 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AD_DN_H
+#define AD_DN_H
+
+/**
+ * Read-only view of a DN, parsed according to RFC 4514.
+ * DN is parsed once, on construction, which only records
+ * positions of RDN's in the string, so rdn() and parent()
+ * are views into the DN and don't copy. Forms that need
+ * to be built, like name and canonical, are computed on
+ * first use and cached.
+ *
+ * NOTE: caching is done in const f-ns, so don't use the
+ * same instance from multiple threads at the same time.
+ * Copies can be used freely.
+ */
+
+#include <QString>
+#include <QVarLengthArray>
+
+class DnRdnRange {
+public:
+    int start;
+    int equals;
+    int end;
+};
+
+class DnView {
+
+public:
+    DnView();
+    DnView(const QString &dn);
+
+    QString dn() const;
+    bool is_valid() const;
+    int rdn_count() const;
+
+    // "CN=foo,CN=bar,DC=domain,DC=com"
+    // =>
+    // "CN=foo"
+    QStringRef rdn() const;
+
+    // "CN=foo,CN=bar,DC=domain,DC=com"
+    // =>
+    // "CN"
+    QStringRef rdn_type() const;
+
+    // "CN=foo\,baz,CN=bar,DC=domain,DC=com"
+    // =>
+    // "foo,baz"
+    QString name() const;
+
+    // "CN=foo,CN=bar,DC=domain,DC=com"
+    // =>
+    // "CN=bar,DC=domain,DC=com"
+    QStringRef parent() const;
+
+    // "CN=foo,CN=bar,DC=domain,DC=com"
+    // =>
+    // "domain.com/bar/foo"
+    QString canonical() const;
+
+    // "CN=foo,CN=bar,DC=domain,DC=com"
+    // =>
+    // "domain.com/bar"
+    QString parent_canonical() const;
+
+private:
+    QString m_dn;
+    bool m_is_valid;
+    QVarLengthArray<DnRdnRange, 8> rdn_list;
+
+    mutable bool has_name;
+    mutable bool has_canonical;
+    mutable bool has_parent_canonical;
+    mutable QString m_name;
+    mutable QString m_canonical;
+    mutable QString m_parent_canonical;
+
+    void parse();
+    QString canonical_from(const int first_rdn) const;
+    QStringRef rdn_value(const int i) const;
+    bool rdn_is_dc(const int i) const;
+};
+
+// Unescapes an RDN value: "\," => ",", "\2C" => ","
+QString dn_value_unescape(const QStringRef &value);
+
+// Escapes a value for use in an RDN
+QString dn_value_escape(const QString &value);
+
+#endif /* AD_DN_H */
@@ -23,8 +23,10 @@
 
 #include "ad_config.h"
 #include "ad_display.h"
+#include "ad_metrics.h"
 #include "ad_object.h"
 #include "ad_security.h"
+#include "ad_trace.h"
 #include "ad_utils.h"
 #include "gplink.h"
 #include "samba/dom_sid.h"
@@ -84,17 +86,24 @@ QList<QString> query_server_for_hosts(const char *dname);
 int sasl_interact_gssapi(LDAP *ld, unsigned flags, void *indefaults, void *in);
 QString get_gpt_sd_string(const AdObject &gpc_object, const AceMaskFormat format);
 int create_sd_control(bool get_sacl, int is_critical, LDAPControl **ctrlp, bool set_dacl = false);
+const char *ad_operation_trace_name(const AdOperation operation);
+void clear_token_cache_if_membership(const QString &attribute);
 
 AdConfig *AdInterfacePrivate::adconfig = nullptr;
 bool AdInterfacePrivate::s_log_searches = false;
 QString AdInterfacePrivate::s_dc = QString();
 bool AdInterfacePrivate::s_domain_is_default = true;
 QString AdInterfacePrivate::s_custom_domain = QString();
+QString AdInterfacePrivate::s_test_server = QString();
 void *AdInterfacePrivate::s_sasl_nocanon = LDAP_OPT_ON;
 int AdInterfacePrivate::s_port = 0;
 CertStrategy AdInterfacePrivate::s_cert_strat = CertStrategy_Never;
 SMBCCTX *AdInterfacePrivate::smbc = NULL;
 QMutex AdInterfacePrivate::mutex;
+QHash<QString, GptCacheEntry> AdInterfacePrivate::s_gpt_cache;
+QMutex AdInterfacePrivate::gpt_cache_mutex;
+
+QString gpt_cache_key(const QString &gpc_dn);
 
 void get_auth_data_fn(const char *pServer, const char *pShare, char *pWorkgroup, int maxLenWorkgroup, char *pUsername, int maxLenUsername, char *pPassword, int maxLenPassword) {
     UNUSED_ARG(pServer);
@@ -108,12 +117,17 @@ void get_auth_data_fn(const char *pServer, const char *pShare, char *pWorkgroup,
 }
 
 AdInterface::AdInterface() {
+    TRACE_SCOPE("ldap", "AdInterface::AdInterface");
+
     d = new AdInterfacePrivate(this);
 
     d->is_connected = false;
 
     d->ld = NULL;
 
+    d->cancel_flag = nullptr;
+    d->show_deleted = false;
+
     const QString connect_error_context = tr("Failed to connect.");
 
     if (AdInterfacePrivate::s_domain_is_default)
@@ -131,6 +145,10 @@ AdInterface::AdInterface() {
     //
 
     d->dc = [&]() {
+        if (!AdInterfacePrivate::s_test_server.isEmpty()) {
+            return AdInterfacePrivate::s_test_server;
+        }
+
         const QList<QString> dc_list = get_domain_hosts(d->domain, QString());
         if (dc_list.isEmpty()) {
             d->error_message_plain(tr("Failed to find domain controllers. Make sure your computer is in the domain and that domain controllers are operational."));
@@ -193,6 +211,12 @@ void AdInterface::set_log_searches(const bool enabled) {
 
 void AdInterface::set_dc(const QString &dc) {
     AdInterfacePrivate::s_dc = dc;
+
+    // NOTE: sysvol contents may differ between DC's if
+    // replication is not complete. Same for group
+    // memberships.
+    AdInterfacePrivate::gpt_cache_clear();
+    ad_security_clear_token_cache();
 }
 
 void AdInterface::set_sasl_nocanon(const bool is_on) {
@@ -222,6 +246,10 @@ void AdInterface::set_custom_domain(const QString &domain)
     AdInterfacePrivate::s_custom_domain = domain;
 }
 
+void AdInterface::set_test_server(const QString &host) {
+    AdInterfacePrivate::s_test_server = host;
+}
+
 AdInterfacePrivate::AdInterfacePrivate(AdInterface *q_arg) {
     mutex.lock();
     q = q_arg;
@@ -232,6 +260,14 @@ bool AdInterface::is_connected() const {
     return d->is_connected;
 }
 
+void AdInterface::set_cancel_flag(const QAtomicInt *flag) {
+    d->cancel_flag = flag;
+}
+
+void AdInterface::set_show_deleted(const bool enabled) {
+    d->show_deleted = enabled;
+}
+
 QList<AdMessage> AdInterface::messages() const {
     return d->messages;
 }
@@ -268,6 +304,7 @@ bool AdInterfacePrivate::search_paged_internal(const char *base, const int scope
     LDAPMessage *res = NULL;
     LDAPControl *page_control = NULL;
     LDAPControl *sd_control = NULL;
+    LDAPControl *show_deleted_control = NULL;
     LDAPControl **returned_controls = NULL;
     struct berval *prev_cookie = cookie->cookie;
     struct berval *new_cookie = NULL;
@@ -276,6 +313,7 @@ bool AdInterfacePrivate::search_paged_internal(const char *base, const int scope
         ldap_msgfree(res);
         ldap_control_free(page_control);
         ldap_control_free(sd_control);
+        ldap_control_free(show_deleted_control);
         ldap_controls_free(returned_controls);
         ber_bvfree(prev_cookie);
         ber_bvfree(new_cookie);
@@ -300,11 +338,85 @@ bool AdInterfacePrivate::search_paged_internal(const char *base, const int scope
         cleanup();
         return false;
     }
-    LDAPControl *server_controls[3] = {page_control, sd_control, NULL};
+
+    if (show_deleted) {
+        result = ldap_control_create(LDAP_SERVER_SHOW_DELETED_OID, is_critical, NULL, 0, &show_deleted_control);
+        if (result != LDAP_SUCCESS) {
+            qDebug() << "Failed to create show deleted control: " << ldap_err2string(result);
+
+            cleanup();
+            return false;
+        }
+    }
+
+    LDAPControl *server_controls[4] = {page_control, sd_control, show_deleted_control, NULL};
+
+    // NOTE: measure time from sending request until all
+    // results arrive, this is the part of search spent on
+    // the network and the server
+    QElapsedTimer server_timer;
+    server_timer.start();
+    TraceSpan server_span("ldap", "server_wait");
 
     // Perform search
     const int attrsonly = 0;
-    result = ldap_search_ext_s(ld, base, scope, filter, attributes, attrsonly, server_controls, NULL, NULL, LDAP_NO_LIMIT, &res);
+    int msgid;
+    result = ldap_search_ext(ld, base, scope, filter, attributes, attrsonly, server_controls, NULL, NULL, LDAP_NO_LIMIT, &msgid);
+    if (result != LDAP_SUCCESS) {
+        qDebug() << "Error in paged ldap_search_ext: " << ldap_err2string(result);
+
+        cleanup();
+        return false;
+    }
+
+    // NOTE: if search can be cancelled, wait for results
+    // in short intervals to check cancel flag in between.
+    // Otherwise block until results arrive.
+    while (true) {
+        if (is_cancelled()) {
+            ldap_abandon_ext(ld, msgid, NULL, NULL);
+
+            cleanup();
+            return false;
+        }
+
+        struct timeval timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = 100 * 1000;
+        struct timeval *timeout_ptr = (cancel_flag != nullptr) ? &timeout : NULL;
+
+        const int result_type = ldap_result(ld, msgid, LDAP_MSG_ALL, timeout_ptr, &res);
+
+        if (result_type == -1) {
+            qDebug() << "Error in paged ldap_result: " << ldap_err2string(get_ldap_result());
+
+            cleanup();
+            return false;
+        }
+
+        const bool timed_out = (result_type == 0);
+        if (!timed_out) {
+            break;
+        }
+    }
+
+    cookie->metrics_server_usec += server_timer.nsecsElapsed() / 1000;
+    server_span.end();
+
+    // Parse the results to retrieve result code and
+    // returned controls
+    int errcodep;
+    result = ldap_parse_result(ld, res, &errcodep, NULL, NULL, NULL, &returned_controls, false);
+    if (result != LDAP_SUCCESS) {
+        qDebug() << "Failed to parse result: " << ldap_err2string(result);
+
+        cleanup();
+        return false;
+    }
+
+    result = errcodep;
+
+    cookie->metrics_pages++;
 
     if ((result != LDAP_SUCCESS) && (result != LDAP_PARTIAL_RESULTS)) {
         // NOTE: it's not really an error for an object to
@@ -312,7 +424,7 @@ bool AdInterfacePrivate::search_paged_internal(const char *base, const int scope
         // check whether an object exists. Not sure how to
         // distinguish this error type from others
         if (result != LDAP_NO_SUCH_OBJECT) {
-            qDebug() << "Error in paged ldap_search_ext_s: " << ldap_err2string(result);
+            qDebug() << "Error in paged search: " << ldap_err2string(result);
         }
 
         cleanup();
@@ -320,9 +432,12 @@ bool AdInterfacePrivate::search_paged_internal(const char *base, const int scope
     }
 
     // Collect results for this search
+    TraceSpan decode_span("ldap", "decode_entries");
+    const int entries_before = results->size();
     for (LDAPMessage *entry = ldap_first_entry(ld, res); entry != NULL; entry = ldap_next_entry(ld, entry)) {
         char *dn_cstr = ldap_get_dn(ld, entry);
         const QString dn(dn_cstr);
+        cookie->metrics_bytes += strlen(dn_cstr);
         ldap_memfree(dn_cstr);
 
         QHash<QString, QList<QByteArray>> object_attributes;
@@ -339,6 +454,7 @@ bool AdInterfacePrivate::search_paged_internal(const char *base, const int scope
                     for (int i = 0; i < values_count; i++) {
                         struct berval value_berval = *values_ldap[i];
                         const QByteArray value_bytes(value_berval.bv_val, value_berval.bv_len);
+                        cookie->metrics_bytes += value_berval.bv_len;
 
                         out.append(value_bytes);
                     }
@@ -348,6 +464,7 @@ bool AdInterfacePrivate::search_paged_internal(const char *base, const int scope
             }();
 
             const QString attribute(attr);
+            cookie->metrics_bytes += strlen(attr);
 
             object_attributes[attribute] = values_bytes;
 
@@ -360,17 +477,10 @@ bool AdInterfacePrivate::search_paged_internal(const char *base, const int scope
         object.load(dn, object_attributes);
 
         results->insert(dn, object);
+        cookie->metrics_entries++;
     }
-
-    // Parse the results to retrieve returned controls
-    int errcodep;
-    result = ldap_parse_result(ld, res, &errcodep, NULL, NULL, NULL, &returned_controls, false);
-    if (result != LDAP_SUCCESS) {
-        qDebug() << "Failed to parse result: " << ldap_err2string(result);
-
-        cleanup();
-        return false;
-    }
+    decode_span.add_arg("entries", results->size() - entries_before);
+    decode_span.end();
 
     // Get page response control
     //
@@ -408,6 +518,17 @@ bool AdInterfacePrivate::search_paged_internal(const char *base, const int scope
     return true;
 }
 
+void AdInterfacePrivate::record_search(AdCookie *cookie, const bool success) {
+    const AdSearchRecord record = cookie->record_search(success, true);
+
+    if (s_log_searches) {
+        const QString usec_string = QString::number(record.usec / 1000.0, 'f', 1);
+        const QString server_usec_string = QString::number(record.server_usec / 1000.0, 'f', 1);
+
+        success_message(QString(tr("Search finished in %1 ms (%2 ms on server): %3 entries, %4 pages, %5 bytes.")).arg(usec_string, server_usec_string, QString::number(record.entries), QString::number(record.pages), QString::number(record.bytes)));
+    }
+}
+
 QHash<QString, AdObject> AdInterface::search(const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, const bool get_sacl) {
     AdCookie cookie;
     QHash<QString, AdObject> results;
@@ -434,22 +555,12 @@ bool AdInterface::search_paged(const QString &base, const SearchScope scope, con
     const bool need_to_log = (AdInterfacePrivate::s_log_searches && is_first_page);
     if (need_to_log) {
         const QString attributes_string = "{" + attributes.join(",") + "}";
-
-        const QString scope_string = [&scope]() -> QString {
-            switch (scope) {
-                case SearchScope_Object: return "object";
-                case SearchScope_Children: return "children";
-                case SearchScope_Descendants: return "descendants";
-                case SearchScope_All: return "all";
-                default: break;
-            }
-            return QString();
-        }();
+        const QString scope_string = search_scope_string(scope);
 
         d->success_message(QString(tr("Search:\n\tfilter = \"%1\"\n\tattributes = %2\n\tscope = \"%3\"\n\tbase = \"%4\"")).arg(filter, attributes_string, scope_string, base));
     }
 
-    const char *base_cstr = cstr(base);
+    const CString base_cstr(base);
 
     const int scope_int = [&]() {
         switch (scope) {
@@ -461,47 +572,64 @@ bool AdInterface::search_paged(const QString &base, const SearchScope scope, con
         return 0;
     }();
 
+    const CString filter_cstring(filter);
     const char *filter_cstr = [&]() {
         if (filter.isEmpty()) {
             // NOTE: need to pass NULL instead of empty
             // string to denote "no filter"
             return (const char *) NULL;
         } else {
-            return cstr(filter);
+            return filter_cstring.get();
         }
     }();
 
     // Convert attributes list to NULL-terminated array
-    char **attributes_array;
-    QList<QByteArray> attr_bytearray_list;
-    if (attributes.isEmpty()) {
-        // Pass NULL so LDAP gets all attributes
-        attributes_array = NULL;
-    } else {
-        attributes_array = (char **) malloc((attributes.size() + 1) * sizeof(char *));
-        if (attributes_array != NULL) {
-            for (int i = 0; i < attributes.size(); i++) {
-                attr_bytearray_list.append(attributes[i].toUtf8());
-                attributes_array[i] = strdup(attr_bytearray_list.last().constData());
-            }
-            attributes_array[attributes.size()] = NULL;
+    CStringList attributes_cstring_list(attributes);
+    char **attributes_array = [&]() {
+        if (attributes.isEmpty()) {
+            // Pass NULL so LDAP gets all attributes
+            return (char **) NULL;
+        } else {
+            return attributes_cstring_list.get();
         }
+    }();
+
+    TraceSpan span("ldap", "AdInterface::search_paged");
+    if (trace_is_enabled()) {
+        span.add_arg("base", base);
+        span.add_arg("scope", search_scope_string(scope));
+        span.add_arg("filter", filter);
+        span.add_arg("page", cookie->metrics_pages);
+    }
+
+    if (!cookie->metrics_pending) {
+        cookie->metrics_pending = true;
+        cookie->metrics_dc = d->dc;
+        cookie->metrics_base = base;
+        cookie->metrics_scope = scope;
+        cookie->metrics_filter = filter;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool search_success = d->search_paged_internal(base_cstr.get(), scope_int, filter_cstr, attributes_array, results, cookie, get_sacl);
+
+    cookie->metrics_usec += timer.nsecsElapsed() / 1000;
+    span.add_arg("success", search_success);
+
+    // NOTE: record search once, after last page
+    const bool search_finished = (!search_success || !cookie->more_pages());
+    if (search_finished) {
+        d->record_search(cookie, search_success);
     }
 
-    const bool search_success = d->search_paged_internal(base_cstr, scope_int, filter_cstr, attributes_array, results, cookie, get_sacl);
     if (!search_success) {
         results->clear();
 
         return false;
     }
 
-    if (attributes_array != NULL) {
-        for (int i = 0; attributes_array[i] != NULL; i++) {
-            free(attributes_array[i]);
-        }
-        free(attributes_array);
-    }
-
     return true;
 }
 
@@ -534,9 +662,11 @@ bool AdInterface::attribute_replace_values(const QString &dn, const QString &att
     struct berval bvalues_storage[values.size()];
     struct berval *bvalues[values.size() + 1];
     bvalues[values.size()] = NULL;
+    qint64 values_bytes = 0;
     for (int i = 0; i < values.size(); i++) {
         const QByteArray value = values[i];
         struct berval *bvalue = &(bvalues_storage[i]);
+        values_bytes += value.size();
 
         bvalue->bv_val = (char *) value.constData();
         bvalue->bv_len = (size_t) value.size();
@@ -544,9 +674,10 @@ bool AdInterface::attribute_replace_values(const QString &dn, const QString &att
         bvalues[i] = bvalue;
     }
 
+    const CString attribute_cstr(attribute);
     LDAPMod attr;
     attr.mod_op = (LDAP_MOD_REPLACE | LDAP_MOD_BVALUES);
-    attr.mod_type = (char *) cstr(attribute);
+    attr.mod_type = (char *) attribute_cstr.get();
     attr.mod_bvalues = bvalues;
 
     LDAPMod *attrs[] = {&attr, NULL};
@@ -569,9 +700,13 @@ bool AdInterface::attribute_replace_values(const QString &dn, const QString &att
         server_controls[0] = sd_control;
     }
 
-    result = ldap_modify_ext_s(d->ld, cstr(dn), attrs, server_controls, NULL);
+    AdOperationTimer timer(d, AdOperation_Modify);
+    result = ldap_modify_ext_s(d->ld, CString(dn).get(), attrs, server_controls, NULL);
+    timer.finish(result == LDAP_SUCCESS, values_bytes);
 
     if (result == LDAP_SUCCESS) {
+        clear_token_cache_if_membership(attribute);
+
         d->success_message(QString(tr("Attribute %1 of object %2 was changed from \"%3\" to \"%4\".")).arg(attribute, name, old_values_display, values_display), do_msg);
 
         return true;
@@ -596,6 +731,90 @@ bool AdInterface::attribute_replace_value(const QString &dn, const QString &attr
     return attribute_replace_values(dn, attribute, values, do_msg, set_dacl);
 }
 
+bool AdInterface::attribute_replace_value_batch(const QHash<QString, QByteArray> &value_map, const QString &attribute, const DoStatusMsg do_msg, const bool set_dacl, QHash<QString, QString> *error_map_out) {
+    if (value_map.isEmpty()) {
+        return true;
+    }
+
+    int result;
+
+    // NOTE: controls are encoded into each request when
+    // it's sent, so one control can be shared by all
+    // requests
+    LDAPControl *server_controls[2] = {NULL, NULL};
+    if (set_dacl) {
+        LDAPControl *sd_control = NULL;
+        const int is_critical = 1;
+
+        result = create_sd_control(false, is_critical, &sd_control, set_dacl);
+        if (result != LDAP_SUCCESS) {
+            qDebug() << "Failed to create sd control: " << ldap_err2string(result);
+
+            ldap_control_free(sd_control);
+            return false;
+        }
+
+        server_controls[0] = sd_control;
+    }
+
+    const QByteArray attribute_bytes = attribute.toUtf8();
+    const QList<QString> dn_list = value_map.keys();
+
+    bool total_success = true;
+
+    auto send_request = [&](const int index, int *msgid) {
+        const QString &dn = dn_list[index];
+        const QByteArray value = value_map[dn];
+
+        struct berval bvalue;
+        bvalue.bv_val = (char *) value.constData();
+        bvalue.bv_len = (size_t) value.size();
+
+        struct berval *bvalues[2] = {&bvalue, NULL};
+        if (value.isEmpty()) {
+            bvalues[0] = NULL;
+        }
+
+        LDAPMod attr;
+        attr.mod_op = (LDAP_MOD_REPLACE | LDAP_MOD_BVALUES);
+        attr.mod_type = (char *) attribute_bytes.constData();
+        attr.mod_bvalues = bvalues;
+
+        LDAPMod *attrs[] = {&attr, NULL};
+
+        return ldap_modify_ext(d->ld, CString(dn).get(), attrs, server_controls, NULL, msgid);
+    };
+
+    auto handle_result = [&](const int index, const int request_result, const qint64 usec) {
+        const QString &dn = dn_list[index];
+        const QString name = dn_get_name(dn);
+
+        const bool success = (request_result == LDAP_SUCCESS);
+        d->record_operation(AdOperation_Modify, usec, success, value_map[dn].size());
+
+        if (success) {
+            d->success_message(QString(tr("Attribute %1 of object %2 was changed.")).arg(attribute, name), do_msg);
+        } else {
+            const QString context = QString(tr("Failed to change attribute %1 of object %2.")).arg(attribute, name);
+
+            d->error_message(context, ldap_err2string(request_result), do_msg);
+            total_success = false;
+
+            if (error_map_out != nullptr) {
+                error_map_out->insert(dn, ldap_err2string(request_result));
+            }
+        }
+    };
+
+    d->send_pipelined(dn_list.size(), send_request, handle_result);
+
+    if (server_controls[0] != NULL) {
+        ldap_control_free(server_controls[0]);
+    }
+
+    return total_success;
+}
+
 bool AdInterface::attribute_add_value(const QString &dn, const QString &attribute, const QByteArray &value, const DoStatusMsg do_msg) {
     char *data_copy = (char *) malloc(value.size());
     if (data_copy == NULL) {
@@ -609,20 +828,25 @@ bool AdInterface::attribute_add_value(const QString &dn, const QString &attribut
 
     struct berval *values[] = {&ber_data, NULL};
 
+    const CString attribute_cstr(attribute);
     LDAPMod attr;
     attr.mod_op = LDAP_MOD_ADD | LDAP_MOD_BVALUES;
-    attr.mod_type = (char *) cstr(attribute);
+    attr.mod_type = (char *) attribute_cstr.get();
     attr.mod_bvalues = values;
 
     LDAPMod *attrs[] = {&attr, NULL};
 
-    const int result = ldap_modify_ext_s(d->ld, cstr(dn), attrs, NULL, NULL);
+    AdOperationTimer timer(d, AdOperation_Modify);
+    const int result = ldap_modify_ext_s(d->ld, CString(dn).get(), attrs, NULL, NULL);
+    timer.finish(result == LDAP_SUCCESS, value.size());
     free(data_copy);
 
     const QString name = dn_get_name(dn);
     const QString new_display_value = attribute_display_value(attribute, value, d->adconfig);
 
     if (result == LDAP_SUCCESS) {
+        clear_token_cache_if_membership(attribute);
+
         const QString context = QString(tr("Value \"%1\" was added for attribute %2 of object %3.")).arg(new_display_value, attribute, name);
 
         d->success_message(context, do_msg);
@@ -651,18 +875,23 @@ bool AdInterface::attribute_delete_value(const QString &dn, const QString &attri
     ber_data.bv_val = data_copy;
     ber_data.bv_len = value.size();
 
+    const CString attribute_cstr(attribute);
     LDAPMod attr;
     struct berval *values[] = {&ber_data, NULL};
     attr.mod_op = LDAP_MOD_DELETE | LDAP_MOD_BVALUES;
-    attr.mod_type = (char *) cstr(attribute);
+    attr.mod_type = (char *) attribute_cstr.get();
     attr.mod_bvalues = values;
 
     LDAPMod *attrs[] = {&attr, NULL};
 
-    const int result = ldap_modify_ext_s(d->ld, cstr(dn), attrs, NULL, NULL);
+    AdOperationTimer timer(d, AdOperation_Modify);
+    const int result = ldap_modify_ext_s(d->ld, CString(dn).get(), attrs, NULL, NULL);
+    timer.finish(result == LDAP_SUCCESS, value.size());
     free(data_copy);
 
     if (result == LDAP_SUCCESS) {
+        clear_token_cache_if_membership(attribute);
+
         const QString context = QString(tr("Value \"%1\" for attribute %2 of object %3 was deleted.")).arg(value_display, attribute, name);
 
         d->success_message(context, do_msg);
@@ -711,11 +940,11 @@ bool AdInterface::object_add(const QString &dn, const QHash<QString, QList<QStri
             char **value_array = (char **) malloc((value_list.size() + 1) * sizeof(char *));
             for (int j = 0; j < value_list.size(); j++) {
                 const QString value = value_list[j];
-                value_array[j] = (char *) strdup(cstr(value));
+                value_array[j] = (char *) strdup(CString(value).get());
             }
             value_array[value_list.size()] = NULL;
 
-            attr->mod_type = (char *) strdup(cstr(attr_name));
+            attr->mod_type = (char *) strdup(CString(attr_name).get());
             attr->mod_op = LDAP_MOD_ADD;
             attr->mod_values = value_array;
 
@@ -727,7 +956,21 @@ bool AdInterface::object_add(const QString &dn, const QHash<QString, QList<QStri
         return out;
     }();
 
-    const int result = ldap_add_ext_s(d->ld, cstr(dn), attrs, NULL, NULL);
+    const qint64 values_bytes = [&attrs_map]() {
+        qint64 out = 0;
+
+        for (const QList<QString> &value_list : attrs_map.values()) {
+            for (const QString &value : value_list) {
+                out += value.toUtf8().size();
+            }
+        }
+
+        return out;
+    }();
+
+    AdOperationTimer timer(d, AdOperation_Add);
+    const int result = ldap_add_ext_s(d->ld, CString(dn).get(), attrs, NULL, NULL);
+    timer.finish(result == LDAP_SUCCESS, values_bytes);
 
     ldap_mods_free(attrs, 1);
 
@@ -802,11 +1045,17 @@ bool AdInterface::object_delete(const QString &dn, const DoStatusMsg do_msg) {
         server_controls[0] = tree_delete_control;
     }
 
-    result = ldap_delete_ext_s(d->ld, cstr(dn), server_controls, NULL);
+    AdOperationTimer timer(d, AdOperation_Delete);
+    result = ldap_delete_ext_s(d->ld, CString(dn).get(), server_controls, NULL);
+    timer.finish(result == LDAP_SUCCESS);
 
     cleanup();
 
     if (result == LDAP_SUCCESS) {
+        // NOTE: deleting a group removes it from tokens of
+        // it's members
+        ad_security_clear_token_cache();
+
         d->success_message(QString(tr("Object %1 was deleted.")).arg(name), do_msg);
 
         return true;
@@ -818,12 +1067,14 @@ bool AdInterface::object_delete(const QString &dn, const DoStatusMsg do_msg) {
 }
 
 bool AdInterface::object_move(const QString &dn, const QString &new_container) {
-    const QString rdn = dn.split(',')[0];
+    const QString rdn = dn_get_rdn(dn);
     const QString new_dn = rdn + "," + new_container;
     const QString object_name = dn_get_name(dn);
     const QString container_name = dn_get_name(new_container);
 
-    const int result = ldap_rename_s(d->ld, cstr(dn), cstr(rdn), cstr(new_container), 1, NULL, NULL);
+    AdOperationTimer timer(d, AdOperation_Rename);
+    const int result = ldap_rename_s(d->ld, CString(dn).get(), CString(rdn).get(), CString(new_container).get(), 1, NULL, NULL);
+    timer.finish(result == LDAP_SUCCESS);
 
     if (result == LDAP_SUCCESS) {
         d->success_message(QString(tr("Object %1 was moved to %2.")).arg(object_name, container_name));
@@ -840,10 +1091,12 @@ bool AdInterface::object_move(const QString &dn, const QString &new_container) {
 
 bool AdInterface::object_rename(const QString &dn, const QString &new_name) {
     const QString new_dn = dn_rename(dn, new_name);
-    const QString new_rdn = new_dn.split(",")[0];
+    const QString new_rdn = dn_get_rdn(new_dn);
     const QString old_name = dn_get_name(dn);
 
-    const int result = ldap_rename_s(d->ld, cstr(dn), cstr(new_rdn), NULL, 1, NULL, NULL);
+    AdOperationTimer timer(d, AdOperation_Rename);
+    const int result = ldap_rename_s(d->ld, CString(dn).get(), CString(new_rdn).get(), NULL, 1, NULL, NULL);
+    timer.finish(result == LDAP_SUCCESS);
 
     if (result == LDAP_SUCCESS) {
         d->success_message(QString(tr("Object %1 was renamed to %2.")).arg(old_name, new_name));
@@ -1216,7 +1469,7 @@ bool AdInterface::gpo_add(const QString &display_name, QString &dn_out) {
         }
 
         struct stat filestat;
-        const int stat_result = smbc_stat(cstr(gpt_path), &filestat);
+        const int stat_result = smbc_stat(CString(gpt_path).get(), &filestat);
         const bool gpt_exists = (stat_result == 0);
         if (gpt_exists) {
             d->delete_gpt(gpt_path);
@@ -1227,9 +1480,11 @@ bool AdInterface::gpo_add(const QString &display_name, QString &dn_out) {
     // Create GPT
     //
 
+    AdOperationTimer smb_timer(d, AdOperation_Smb);
+
     // Create root dir
     // "smb://domain.alt/sysvol/domain.alt/Policies/{FF7E0880-F3AD-4540-8F1D-4472CB4A7044}"
-    const int result_mkdir_gpt = smbc_mkdir(cstr(gpt_path), 0755);
+    const int result_mkdir_gpt = smbc_mkdir(CString(gpt_path).get(), 0755);
     if (result_mkdir_gpt != 0) {
         error_message(tr("Failed to create GPT root dir."));
 
@@ -1239,7 +1494,7 @@ bool AdInterface::gpo_add(const QString &display_name, QString &dn_out) {
     }
 
     const QString gpt_machine_path = gpt_path + "/Machine";
-    const int result_mkdir_machine = smbc_mkdir(cstr(gpt_machine_path), 0755);
+    const int result_mkdir_machine = smbc_mkdir(CString(gpt_machine_path).get(), 0755);
     if (result_mkdir_machine != 0) {
         error_message(tr("Failed to create GPT machine dir."));
 
@@ -1249,7 +1504,7 @@ bool AdInterface::gpo_add(const QString &display_name, QString &dn_out) {
     }
 
     const QString gpt_user_path = gpt_path + "/User";
-    const int result_mkdir_user = smbc_mkdir(cstr(gpt_user_path), 0755);
+    const int result_mkdir_user = smbc_mkdir(CString(gpt_user_path).get(), 0755);
     if (result_mkdir_user != 0) {
         error_message(tr("Failed to create GPT user dir."));
 
@@ -1259,7 +1514,7 @@ bool AdInterface::gpo_add(const QString &display_name, QString &dn_out) {
     }
 
     const QString gpt_ini_path = gpt_path + "/GPT.INI";
-    const int ini_file = smbc_open(cstr(gpt_ini_path), O_WRONLY | O_CREAT, 0644);
+    const int ini_file = smbc_open(CString(gpt_ini_path).get(), O_WRONLY | O_CREAT, 0644);
     if (ini_file < 0) {
         error_message(tr("Failed to open GPT ini file."));
 
@@ -1279,6 +1534,8 @@ bool AdInterface::gpo_add(const QString &display_name, QString &dn_out) {
         return false;
     }
 
+    smb_timer.finish(true, bytes_written);
+
     //
     // Create AD object for gpo
     //
@@ -1364,7 +1621,7 @@ QList<QString> AdInterfacePrivate::gpo_get_gpt_contents(const QString &gpt_root_
     while (!explore_stack.isEmpty()) {
         const QString path = explore_stack.takeLast();
 
-        const int dirp = smbc_opendir(cstr(path));
+        const int dirp = smbc_opendir(CString(path).get());
 
         if (dirp < 0) {
             *ok = false;
@@ -1433,7 +1690,11 @@ bool AdInterface::gpo_delete(const QString &dn, bool *deleted_object) {
         d->error_message(tr("Failed to delete GPC."), d->default_error());
     }
 
+    AdInterfacePrivate::gpt_cache_remove(dn);
+
+    AdOperationTimer smb_timer(d, AdOperation_Smb);
     const bool delete_gpt_success = d->delete_gpt(smb_path);
+    smb_timer.finish(delete_gpt_success);
     if (!delete_gpt_success) {
         d->error_message_plain(tr("Failed to delete GPT."));
     }
@@ -1490,6 +1751,8 @@ QString AdInterface::filesys_path_to_smb_path(const QString &filesys_path) const
 }
 
 bool AdInterface::ldap_init() {
+    TRACE_SCOPE("ldap", "AdInterface::ldap_init");
+
     const QString connect_error_context = tr("Failed to connect.");
 
     const QString uri = [&]() {
@@ -1499,7 +1762,7 @@ bool AdInterface::ldap_init() {
             out = "ldap://" + d->dc;
 
             if (AdInterfacePrivate::s_port > 0) {
-                out = out + ":" + AdInterfacePrivate::s_port;
+                out = out + ":" + QString::number(AdInterfacePrivate::s_port);
             }
         }
 
@@ -1513,7 +1776,7 @@ bool AdInterface::ldap_init() {
     int result;
 
     // NOTE: this doesn't leak memory. False positive.
-    result = ldap_initialize(&d->ld, cstr(uri));
+    result = ldap_initialize(&d->ld, CString(uri).get());
     if (result != LDAP_SUCCESS) {
         ldap_memfree(d->ld);
         d->error_message(tr("Failed to initialize LDAP library."), strerror(errno));
@@ -1574,6 +1837,23 @@ bool AdInterface::ldap_init() {
         return false;
     }
 
+    // NOTE: test servers don't have kerberos, so bind
+    // anonymously
+    if (!AdInterfacePrivate::s_test_server.isEmpty()) {
+        struct berval empty_credentials = {0, NULL};
+        AdOperationTimer bind_timer(d, AdOperation_Bind);
+        result = ldap_sasl_bind_s(d->ld, NULL, LDAP_SASL_SIMPLE, &empty_credentials, NULL, NULL, NULL);
+        bind_timer.finish(result == LDAP_SUCCESS);
+        if (result != LDAP_SUCCESS) {
+            d->error_message_plain(tr("Failed to connect to test server."));
+            d->error_message_plain(d->default_error());
+
+            return false;
+        }
+
+        return true;
+    }
+
     // Setup sasl_defaults_gssapi
     struct sasl_defaults_gssapi defaults;
     defaults.mech = (char *) "GSSAPI";
@@ -1584,7 +1864,9 @@ bool AdInterface::ldap_init() {
 
     // Perform bind operation
     unsigned sasl_flags = LDAP_SASL_QUIET;
+    AdOperationTimer bind_timer(d, AdOperation_Bind);
     result = ldap_sasl_interactive_bind_s(d->ld, NULL, defaults.mech, NULL, NULL, sasl_flags, sasl_interact_gssapi, &defaults);
+    bind_timer.finish(result == LDAP_SUCCESS);
     ldap_memfree(defaults.realm);
     ldap_memfree(defaults.authcid);
     ldap_memfree(defaults.authzid);
@@ -1651,7 +1933,15 @@ bool AdInterface::gpo_check_perms(const QString &gpo, bool *ok) {
     const QString gpt_sd = [&]() {
         const QString filesys_path = gpc_object.get_string(ATTRIBUTE_GPC_FILE_SYS_PATH);
         const QString smb_path = filesys_path_to_smb_path(filesys_path);
-        const char *smb_path_cstr = cstr(smb_path);
+
+        GptCacheEntry cache_entry = AdInterfacePrivate::gpt_cache_get(gpc_object, smb_path);
+        if (cache_entry.has_sd) {
+            return cache_entry.sd;
+        }
+
+        const CString smb_path_cstr(smb_path);
+
+        AdOperationTimer smb_timer(d, AdOperation_Smb);
 
         // NOTE: the length of gpt sd string doesn't have a
         // well defined bound, so we have to use an
@@ -1660,7 +1950,7 @@ bool AdInterface::gpo_check_perms(const QString &gpo, bool *ok) {
         char *buffer = (char *) malloc(buffer_size);
 
         while (true) {
-            const int getxattr_result = smbc_getxattr(smb_path_cstr, "system.nt_sec_desc.*", buffer, buffer_size);
+            const int getxattr_result = smbc_getxattr(smb_path_cstr.get(), "system.nt_sec_desc.*", buffer, buffer_size);
 
             // NOTE: for some reason getxattr() returns positive
             // non-zero return code on success, even though f-n
@@ -1693,6 +1983,12 @@ bool AdInterface::gpo_check_perms(const QString &gpo, bool *ok) {
 
         free(buffer);
 
+        smb_timer.finish(true, out.size());
+
+        cache_entry.has_sd = true;
+        cache_entry.sd = out;
+        AdInterfacePrivate::gpt_cache_set(gpc_object, cache_entry);
+
         return out;
     }();
 
@@ -1769,15 +2065,41 @@ bool AdInterface::gpo_sync_perms(const QString &dn) {
     const QString filesys_path = gpc_object.get_string(ATTRIBUTE_GPC_FILE_SYS_PATH);
     const QString smb_path = filesys_path_to_smb_path(filesys_path);
     bool ok = true;
-    const QList<QString> path_list = d->gpo_get_gpt_contents(smb_path, &ok);
+    const QList<QString> path_list = [&]() {
+        GptCacheEntry cache_entry = AdInterfacePrivate::gpt_cache_get(gpc_object, smb_path);
+        if (cache_entry.has_contents) {
+            return cache_entry.contents;
+        }
+
+        AdOperationTimer smb_timer(d, AdOperation_Smb);
+        const QList<QString> out = d->gpo_get_gpt_contents(smb_path, &ok);
+        smb_timer.finish(ok);
+
+        if (ok) {
+            cache_entry.has_contents = true;
+            cache_entry.contents = out;
+            AdInterfacePrivate::gpt_cache_set(gpc_object, cache_entry);
+        }
+
+        return out;
+    }();
     if (!ok || path_list.isEmpty()) {
         d->error_message(error_context, QString(tr("Failed to read GPT contents of \"%1\".")).arg(smb_path));
         return false;
     }
 
+    // NOTE: GPT permissions are about to change, so cached
+    // descriptor becomes invalid. GPC version is not
+    // changed by this.
+    AdInterfacePrivate::gpt_cache_remove(dn);
+
     // Set descriptor on all GPT contents
+    const CString gpt_sd_cstr(gpt_sd_string);
+
+    AdOperationTimer smb_timer(d, AdOperation_Smb);
+
     for (const QString &path : path_list) {
-        const int set_sd_result = smbc_setxattr(cstr(path), "system.nt_sec_desc.*", cstr(gpt_sd_string), strlen(cstr(gpt_sd_string)), 0);
+        const int set_sd_result = smbc_setxattr(CString(path).get(), "system.nt_sec_desc.*", gpt_sd_cstr.get(), gpt_sd_cstr.size(), 0);
         if (set_sd_result != 0) {
             const QString error = QString(tr("Failed to set permissions, %1.")).arg(strerror(errno));
             d->error_message(error_context, error);
@@ -1786,6 +2108,8 @@ bool AdInterface::gpo_sync_perms(const QString &dn) {
         }
     }
 
+    smb_timer.finish(true, (qint64) gpt_sd_cstr.size() * path_list.size());
+
     d->success_message(QString(tr("Synced permissions of GPO \"%1\".")).arg(name));
 
     return true;
@@ -1794,13 +2118,22 @@ bool AdInterface::gpo_sync_perms(const QString &dn) {
 bool AdInterface::gpo_get_sysvol_version(const AdObject &gpc_object, int *version_out) {
     const QString error_context = tr("Failed to load GPO's sysvol version.");
 
-    const QString ini_contents = [&]() {
-        const QString filesys_path = gpc_object.get_string(ATTRIBUTE_GPC_FILE_SYS_PATH);
-        const QString smb_path = filesys_path_to_smb_path(filesys_path);
+    const QString filesys_path = gpc_object.get_string(ATTRIBUTE_GPC_FILE_SYS_PATH);
+    const QString smb_path = filesys_path_to_smb_path(filesys_path);
+
+    GptCacheEntry cache_entry = AdInterfacePrivate::gpt_cache_get(gpc_object, smb_path);
+    if (cache_entry.has_sysvol_version) {
+        *version_out = cache_entry.sysvol_version;
+
+        return true;
+    }
 
+    const QString ini_contents = [&]() {
         const QString ini_path = smb_path + "/GPT.INI";
 
-        const int ini_fd = smbc_open(cstr(ini_path), O_RDONLY, 0);
+        AdOperationTimer smb_timer(d, AdOperation_Smb);
+
+        const int ini_fd = smbc_open(CString(ini_path).get(), O_RDONLY, 0);
 
         if (ini_fd < 0) {
             const QString error_text = QString(tr("Failed to open GPT.INI, %1.")).arg(strerror(errno));
@@ -1822,6 +2155,8 @@ bool AdInterface::gpo_get_sysvol_version(const AdObject &gpc_object, int *versio
 
         smbc_close(ini_fd);
 
+        smb_timer.finish(true, bytes_read);
+
         return QString(buffer);
     }();
 
@@ -1832,7 +2167,7 @@ bool AdInterface::gpo_get_sysvol_version(const AdObject &gpc_object, int *versio
     const int version = [&]() {
         int out;
 
-        const int scan_result = sscanf(cstr(ini_contents), "[General]\r\nVersion=%i\r\n", &out);
+        const int scan_result = sscanf(CString(ini_contents).get(), "[General]\r\nVersion=%i\r\n", &out);
         const bool scan_success = (scan_result > 0);
 
         if (!scan_success) {
@@ -1848,12 +2183,249 @@ bool AdInterface::gpo_get_sysvol_version(const AdObject &gpc_object, int *versio
     if (version >= 0) {
         *version_out = version;
 
+        // NOTE: cache entry is only valid for the GPC
+        // version it was loaded for. If GPT.INI version
+        // doesn't match it, then sysvol is out of sync,
+        // for example because replication is in progress.
+        // Sysvol can catch up without GPC version
+        // changing, so a mismatched version must be
+        // reread every time.
+        const bool version_matches_gpc = (version == cache_entry.gpc_version);
+        if (version_matches_gpc) {
+            cache_entry.has_sysvol_version = true;
+            cache_entry.sysvol_version = version;
+            AdInterfacePrivate::gpt_cache_set(gpc_object, cache_entry);
+        }
+
         return true;
     } else {
         return false;
     }
 }
 
+bool AdInterface::gplink_edit(const QList<GplinkEdit> &edit_list, QHash<QString, QString> *gplink_map_out) {
+    if (edit_list.isEmpty()) {
+        return true;
+    }
+
+    // Group edits by OU, preserving order of edits
+    QList<QString> ou_list;
+    QHash<QString, QList<GplinkEdit>> edit_map;
+    for (const GplinkEdit &edit : edit_list) {
+        const QString key = edit.ou_dn.toLower();
+
+        if (!edit_map.contains(key)) {
+            ou_list.append(edit.ou_dn);
+        }
+
+        edit_map[key].append(edit);
+    }
+
+    // Load original gplinks of all OU's in one search
+    const QHash<QString, QString> old_gplink_map = [&]() {
+        const QString base = adconfig()->domain_dn();
+        const SearchScope scope = SearchScope_All;
+        const QString filter = filter_dn_list(ou_list);
+        const QList<QString> attributes = {ATTRIBUTE_GPLINK};
+        const QHash<QString, AdObject> results = search(base, scope, filter, attributes);
+
+        QHash<QString, QString> out;
+
+        for (const AdObject &object : results.values()) {
+            const QString key = object.get_dn().toLower();
+            out[key] = object.get_string(ATTRIBUTE_GPLINK);
+        }
+
+        return out;
+    }();
+
+    class Request {
+    public:
+        QString ou_dn;
+        QString old_gplink;
+        QString new_gplink;
+    };
+
+    QList<Request> request_list;
+    bool total_success = true;
+
+    for (const QString &ou_dn : ou_list) {
+        const QString key = ou_dn.toLower();
+
+        if (!old_gplink_map.contains(key)) {
+            const QString error_context = QString(tr("Failed to change policy links of %1.")).arg(dn_get_name(ou_dn));
+            d->error_message(error_context, tr("No such object"));
+            total_success = false;
+
+            continue;
+        }
+
+        const QString old_gplink = old_gplink_map[key];
+
+        const QString new_gplink = [&]() {
+            Gplink gplink = Gplink(old_gplink);
+
+            for (const GplinkEdit &edit : edit_map[key]) {
+                edit.apply(gplink);
+            }
+
+            return gplink.to_string();
+        }();
+
+        const bool gplink_changed = (new_gplink != Gplink(old_gplink).to_string());
+        if (!gplink_changed) {
+            continue;
+        }
+
+        Request request;
+        request.ou_dn = ou_dn;
+        request.old_gplink = old_gplink;
+        request.new_gplink = new_gplink;
+        request_list.append(request);
+    }
+
+    auto send_request = [&](const int index, int *msgid) {
+        const Request &request = request_list[index];
+
+        // NOTE: instead of replacing the value, delete
+        // old value and add new one in one request. If
+        // gplink was changed by someone else, deletion of
+        // old value fails and server rejects the whole
+        // request, so concurrent edits are not lost.
+        const QByteArray old_gplink_bytes = request.old_gplink.toUtf8();
+        const QByteArray new_gplink_bytes = request.new_gplink.toUtf8();
+        char *old_values[] = {(char *) old_gplink_bytes.constData(), NULL};
+        char *new_values[] = {(char *) new_gplink_bytes.constData(), NULL};
+
+        LDAPMod delete_mod;
+        delete_mod.mod_op = LDAP_MOD_DELETE;
+        delete_mod.mod_type = (char *) ATTRIBUTE_GPLINK;
+        delete_mod.mod_values = old_values;
+
+        LDAPMod add_mod;
+        add_mod.mod_op = LDAP_MOD_ADD;
+        add_mod.mod_type = (char *) ATTRIBUTE_GPLINK;
+        add_mod.mod_values = new_values;
+
+        LDAPMod *mods[3] = {NULL, NULL, NULL};
+        int mods_count = 0;
+        if (!request.old_gplink.isEmpty()) {
+            mods[mods_count] = &delete_mod;
+            mods_count++;
+        }
+        if (!request.new_gplink.isEmpty()) {
+            mods[mods_count] = &add_mod;
+            mods_count++;
+        }
+
+        return ldap_modify_ext(d->ld, CString(request.ou_dn).get(), mods, NULL, NULL, msgid);
+    };
+
+    auto handle_result = [&](const int index, const int request_result, const qint64 usec) {
+        const Request &request = request_list[index];
+        const QString name = dn_get_name(request.ou_dn);
+
+        const bool success = (request_result == LDAP_SUCCESS);
+        d->record_operation(AdOperation_Modify, usec, success, request.new_gplink.toUtf8().size());
+
+        if (success) {
+            d->success_message(QString(tr("Policy links of %1 were changed.")).arg(name));
+
+            if (gplink_map_out != nullptr) {
+                gplink_map_out->insert(request.ou_dn, request.new_gplink);
+            }
+        } else {
+            const QString error_context = QString(tr("Failed to change policy links of %1.")).arg(name);
+
+            const QString error = [&]() {
+                const bool concurrent_edit = (request_result == LDAP_NO_SUCH_ATTRIBUTE || request_result == LDAP_ATTRIBUTE_OR_VALUE_EXISTS || request_result == LDAP_CONSTRAINT_VIOLATION);
+
+                if (concurrent_edit) {
+                    return tr("Links were modified by someone else, refresh and try again");
+                } else {
+                    return QString(ldap_err2string(request_result));
+                }
+            }();
+
+            d->error_message(error_context, error);
+            total_success = false;
+        }
+    };
+
+    d->send_pipelined(request_list.size(), send_request, handle_result);
+
+    return total_success;
+}
+
+GptCacheEntry::GptCacheEntry() {
+    gpc_version = -1;
+    has_sd = false;
+    has_sysvol_version = false;
+    sysvol_version = 0;
+    has_contents = false;
+}
+
+GptCacheEntry AdInterfacePrivate::gpt_cache_get(const AdObject &gpc_object, const QString &smb_path) {
+    GptCacheEntry empty_entry;
+    empty_entry.gpc_version = gpc_object.get_int(ATTRIBUTE_VERSION_NUMBER);
+    empty_entry.smb_path = smb_path;
+
+    // NOTE: can't validate entry without a version
+    if (!gpc_object.contains(ATTRIBUTE_VERSION_NUMBER)) {
+        return empty_entry;
+    }
+
+    const QString key = gpt_cache_key(gpc_object.get_dn());
+
+    QMutexLocker locker(&gpt_cache_mutex);
+
+    if (!s_gpt_cache.contains(key)) {
+        return empty_entry;
+    }
+
+    const GptCacheEntry entry = s_gpt_cache[key];
+    const bool entry_is_valid = (entry.gpc_version == empty_entry.gpc_version && entry.smb_path == smb_path);
+
+    if (entry_is_valid) {
+        return entry;
+    } else {
+        s_gpt_cache.remove(key);
+
+        return empty_entry;
+    }
+}
+
+void AdInterfacePrivate::gpt_cache_set(const AdObject &gpc_object, const GptCacheEntry &entry) {
+    if (!gpc_object.contains(ATTRIBUTE_VERSION_NUMBER)) {
+        return;
+    }
+
+    const QString key = gpt_cache_key(gpc_object.get_dn());
+
+    QMutexLocker locker(&gpt_cache_mutex);
+
+    s_gpt_cache[key] = entry;
+}
+
+void AdInterfacePrivate::gpt_cache_remove(const QString &gpc_dn) {
+    const QString key = gpt_cache_key(gpc_dn);
+
+    QMutexLocker locker(&gpt_cache_mutex);
+
+    s_gpt_cache.remove(key);
+}
+
+void AdInterfacePrivate::gpt_cache_clear() {
+    QMutexLocker locker(&gpt_cache_mutex);
+
+    s_gpt_cache.clear();
+}
+
+// NOTE: GPC name is the GPO's GUID
+QString gpt_cache_key(const QString &gpc_dn) {
+    return dn_get_name(gpc_dn).toLower();
+}
+
 void AdInterfacePrivate::success_message(const QString &msg, const DoStatusMsg do_msg) {
     if (do_msg == DoStatusMsg_No) {
         return;
@@ -1914,6 +2486,92 @@ int AdInterfacePrivate::get_ldap_result() const {
     return result;
 }
 
+void AdInterfacePrivate::send_pipelined(const int count, std::function<int(const int index, int *msgid)> send_f, std::function<void(const int index, const int result, const qint64 usec)> result_f) {
+    // NOTE: requests are pipelined, so latency of each
+    // request is measured from start of the batch
+    QElapsedTimer batch_timer;
+    batch_timer.start();
+
+    // msgid => request index
+    QHash<int, int> pending_map;
+
+    for (int i = 0; i < count; i++) {
+        int msgid;
+        const int send_result = send_f(i, &msgid);
+
+        if (send_result == LDAP_SUCCESS) {
+            pending_map[msgid] = i;
+        } else {
+            result_f(i, send_result, batch_timer.nsecsElapsed() / 1000);
+        }
+    }
+
+    // Collect results of sent requests in whatever order
+    // they arrive
+    while (!pending_map.isEmpty()) {
+        LDAPMessage *res = NULL;
+        const int result_type = ldap_result(ld, LDAP_RES_ANY, LDAP_MSG_ALL, NULL, &res);
+
+        if (result_type <= 0) {
+            ldap_msgfree(res);
+
+            const int connection_result = [&]() {
+                const int out = get_ldap_result();
+
+                if (out == LDAP_SUCCESS) {
+                    return LDAP_OTHER;
+                } else {
+                    return out;
+                }
+            }();
+
+            for (const int index : pending_map.values()) {
+                result_f(index, connection_result, batch_timer.nsecsElapsed() / 1000);
+            }
+
+            return;
+        }
+
+        const int msgid = ldap_msgid(res);
+
+        int error_code = LDAP_SUCCESS;
+        const int free_res = 1;
+        const int parse_result = ldap_parse_result(ld, res, &error_code, NULL, NULL, NULL, NULL, free_res);
+
+        if (!pending_map.contains(msgid)) {
+            continue;
+        }
+
+        const int index = pending_map.take(msgid);
+        const int request_result = [&]() {
+            if (parse_result != LDAP_SUCCESS) {
+                return parse_result;
+            } else {
+                return error_code;
+            }
+        }();
+
+        result_f(index, request_result, batch_timer.nsecsElapsed() / 1000);
+    }
+}
+
+bool AdInterfacePrivate::is_cancelled() const {
+    const bool out = (cancel_flag != nullptr && cancel_flag->loadAcquire() != 0);
+
+    return out;
+}
+
+void AdInterfacePrivate::record_operation(const AdOperation operation, const qint64 usec, const bool success, const qint64 bytes) const {
+    AdOperationSample sample;
+    sample.operation = operation;
+    sample.dc = dc;
+    sample.usec = usec;
+    sample.success = success;
+    sample.bytes = bytes;
+
+    ad_metrics_record(sample);
+}
+
 bool AdInterfacePrivate::delete_gpt(const QString &parent_path) {
     bool ok = true;
 
@@ -1933,7 +2591,7 @@ bool AdInterfacePrivate::delete_gpt(const QString &parent_path) {
         }
 
         if (is_dir) {
-            const int result_rmdir = smbc_rmdir(cstr(path));
+            const int result_rmdir = smbc_rmdir(CString(path).get());
 
             if (result_rmdir != 0) {
                 error_message(QString(tr("Failed to delete GPT folder %1.")).arg(path), strerror(errno));
@@ -1941,7 +2599,7 @@ bool AdInterfacePrivate::delete_gpt(const QString &parent_path) {
                 return false;
             }
         } else {
-            const int result_unlink = smbc_unlink(cstr(path));
+            const int result_unlink = smbc_unlink(CString(path).get());
 
             if (result_unlink != 0) {
                 error_message(QString(tr("Failed to delete GPT file %1.")).arg(path), strerror(errno));
@@ -1956,7 +2614,7 @@ bool AdInterfacePrivate::delete_gpt(const QString &parent_path) {
 
 bool AdInterfacePrivate::smb_path_is_dir(const QString &path, bool *ok) {
     struct stat filestat;
-    const int stat_result = smbc_stat(cstr(path), &filestat);
+    const int stat_result = smbc_stat(CString(path).get(), &filestat);
     if (stat_result != 0) {
         error_message(QString(tr("Failed to get filestat for \"%1\".")).arg(path), strerror(errno));
 
@@ -2068,7 +2726,7 @@ QList<QString> get_domain_hosts(const QString &domain, const QString &site) {
     // Query site hosts
     if (!site.isEmpty()) {
         char dname[1000];
-        snprintf(dname, sizeof(dname), "_ldap._tcp.%s._sites.%s", cstr(site), cstr(domain));
+        snprintf(dname, sizeof(dname), "_ldap._tcp.%s._sites.%s", CString(site).get(), CString(domain).get());
 
         const QList<QString> site_hosts = query_server_for_hosts(dname);
         hosts.append(site_hosts);
@@ -2076,7 +2734,7 @@ QList<QString> get_domain_hosts(const QString &domain, const QString &site) {
 
     // Query default hosts
     char dname_default[1000];
-    snprintf(dname_default, sizeof(dname_default), "_ldap._tcp.%s", cstr(domain));
+    snprintf(dname_default, sizeof(dname_default), "_ldap._tcp.%s", CString(domain).get());
 
     const QList<QString> default_hosts = query_server_for_hosts(dname_default);
     hosts.append(default_hosts);
@@ -2316,16 +2974,110 @@ QString get_gpt_sd_string(const AdObject &gpc_object, const AceMaskFormat format
 
 AdCookie::AdCookie() {
     cookie = NULL;
+
+    reset_metrics();
 }
 
 bool AdCookie::more_pages() const {
     return (cookie != NULL);
 }
 
+// NOTE: searches that were stopped before last page,
+// because of display limit or cancel, never get to
+// record_search() in search_paged(), so record them here
 AdCookie::~AdCookie() {
+    if (metrics_pending) {
+        record_search(true, false);
+    }
+
     ber_bvfree(cookie);
 }
 
+AdSearchRecord AdCookie::record_search(const bool success, const bool complete) {
+    AdSearchRecord record;
+    record.time = QDateTime::currentDateTime();
+    record.dc = metrics_dc;
+    record.base = metrics_base;
+    record.scope = metrics_scope;
+    record.filter = metrics_filter;
+    record.success = success;
+    record.complete = complete;
+    record.usec = metrics_usec;
+    record.server_usec = metrics_server_usec;
+    record.entries = metrics_entries;
+    record.pages = metrics_pages;
+    record.bytes = metrics_bytes;
+
+    ad_metrics_record_search(record);
+
+    reset_metrics();
+
+    return record;
+}
+
+void AdCookie::reset_metrics() {
+    metrics_pending = false;
+    metrics_dc = QString();
+    metrics_base = QString();
+    metrics_scope = SearchScope_All;
+    metrics_filter = QString();
+    metrics_usec = 0;
+    metrics_server_usec = 0;
+    metrics_pages = 0;
+    metrics_entries = 0;
+    metrics_bytes = 0;
+}
+
+// NOTE: span is initialized here because it can't be
+// default constructed
+AdOperationTimer::AdOperationTimer(const AdInterfacePrivate *d_arg, const AdOperation operation_arg)
+: span("ldap", ad_operation_trace_name(operation_arg)) {
+    d = d_arg;
+    operation = operation_arg;
+    finished = false;
+
+    timer.start();
+}
+
+AdOperationTimer::~AdOperationTimer() {
+    if (!finished) {
+        finish(false);
+    }
+}
+
+void AdOperationTimer::finish(const bool success, const qint64 bytes) {
+    if (finished) {
+        return;
+    }
+
+    finished = true;
+
+    d->record_operation(operation, timer.nsecsElapsed() / 1000, success, bytes);
+
+    span.add_arg("success", success);
+    if (bytes > 0) {
+        span.add_arg("bytes", bytes);
+    }
+    span.end();
+}
+
+// NOTE: trace names have to be literals, so can't reuse
+// ad_operation_string() which is translated
+const char *ad_operation_trace_name(const AdOperation operation) {
+    switch (operation) {
+        case AdOperation_Search: return "search";
+        case AdOperation_Modify: return "modify";
+        case AdOperation_Add: return "add";
+        case AdOperation_Delete: return "delete";
+        case AdOperation_Rename: return "rename";
+        case AdOperation_Bind: return "bind";
+        case AdOperation_Smb: return "smb";
+        case AdOperation_COUNT: break;
+    }
+
+    return "operation";
+}
+
 AdMessage::AdMessage(const QString &text, const AdMessageType &type) {
     m_text = text;
     m_type = type;
@@ -2338,3 +3090,14 @@ QString AdMessage::text() const {
 AdMessageType AdMessage::type() const {
     return m_type;
 }
+
+// NOTE: tokens include nested groups, so a membership
+// change can affect tokens of any principal. Clear whole
+// cache instead of tracking which tokens are affected.
+void clear_token_cache_if_membership(const QString &attribute) {
+    const bool is_membership = (attribute == ATTRIBUTE_MEMBER || attribute == ATTRIBUTE_PRIMARY_GROUP_ID);
+
+    if (is_membership) {
+        ad_security_clear_token_cache();
+    }
+}
@@ -33,11 +33,14 @@
 #include "ad_defines.h"
 
 class AdInterfacePrivate;
+class QAtomicInt;
 class QString;
 class QByteArray;
 class QDateTime;
 class AdObject;
 class AdConfig;
+class AdSearchRecord;
+class GplinkEdit;
 template <typename T>
 class QList;
 typedef void TALLOC_CTX;
@@ -65,6 +68,24 @@ public:
 private:
     struct berval *cookie;
 
+    // NOTE: metrics of the search are accumulated over
+    // pages and recorded after last page. If search is
+    // stopped before last page, it is recorded as
+    // incomplete when cookie is destroyed.
+    bool metrics_pending;
+    QString metrics_dc;
+    QString metrics_base;
+    SearchScope metrics_scope;
+    QString metrics_filter;
+    qint64 metrics_usec;
+    qint64 metrics_server_usec;
+    int metrics_pages;
+    int metrics_entries;
+    qint64 metrics_bytes;
+
+    AdSearchRecord record_search(const bool success, const bool complete);
+    void reset_metrics();
+
     friend class AdInterface;
     friend class AdInterfacePrivate;
 };
@@ -107,6 +128,13 @@ public:
     static void set_domain_is_default(const bool is_default);
     static void set_custom_domain(const QString &domain);
 
+    // NOTE: for testing against a local stand-in server.
+    // If set, connects to this host instead of looking up
+    // domain controllers and binds anonymously instead of
+    // using kerberos. Use set_port() to set server's port.
+    // Set to empty string to restore normal behavior.
+    static void set_test_server(const QString &host);
+
     bool is_connected() const;
     QList<AdMessage> messages() const;
     bool any_error_messages() const;
@@ -121,6 +149,19 @@ public:
     // It is needed when DC changes after AdInterface object was constructed.
     void update_dc();
 
+    // NOTE: while waiting for search results, searches
+    // check this flag and if it's set, abandon the
+    // operation on the server and fail. Flag can be set
+    // from any thread. Flag is owned by caller and must
+    // outlive this AdInterface or be unset.
+    void set_cancel_flag(const QAtomicInt *flag);
+
+    // NOTE: if enabled, searches also return deleted
+    // objects, which are normally hidden by the server.
+    // Deleted objects are moved to "Deleted Objects"
+    // container and have "isDeleted" set to TRUE.
+    void set_show_deleted(const bool enabled);
+
     // NOTE: If request attributes list is empty, all
     // attributes are returned
 
@@ -143,6 +184,14 @@ public:
     bool attribute_replace_values(const QString &dn, const QString &attribute, const QList<QByteArray> &values, const DoStatusMsg do_msg = DoStatusMsg_Yes, const bool set_dacl = false);
 
     bool attribute_replace_value(const QString &dn, const QString &attribute, const QByteArray &value, const DoStatusMsg do_msg = DoStatusMsg_Yes, const bool set_dacl = false);
+
+    // Replaces value of an attribute for many objects.
+    // "value_map" maps object dn to new value. Requests for
+    // all objects are sent without waiting for results.
+    // Returns true if all objects were updated.
+    // "error_map_out" is filled with errors of objects
+    // which failed to update.
+    bool attribute_replace_value_batch(const QHash<QString, QByteArray> &value_map, const QString &attribute, const DoStatusMsg do_msg = DoStatusMsg_Yes, const bool set_dacl = false, QHash<QString, QString> *error_map_out = nullptr);
     bool attribute_add_value(const QString &dn, const QString &attribute, const QByteArray &value, const DoStatusMsg do_msg = DoStatusMsg_Yes);
     bool attribute_delete_value(const QString &dn, const QString &attribute, const QByteArray &value, const DoStatusMsg do_msg = DoStatusMsg_Yes);
 
@@ -182,6 +231,16 @@ public:
     bool gpo_sync_perms(const QString &gpo);
     bool gpo_get_sysvol_version(const AdObject &gpc_object, int *version);
 
+    // Applies a batch of gplink edits. Edits are grouped by
+    // OU and gplink of each OU is written once. Requests
+    // for all OU's are sent without waiting for results.
+    // Write to an OU fails if it's gplink was changed by
+    // someone else after it was loaded. Returns true if all
+    // OU's were updated. "gplink_map_out" is filled with
+    // new gplink strings of OU's that were changed. OU's
+    // for which edits changed nothing are not included.
+    bool gplink_edit(const QList<GplinkEdit> &edit_list, QHash<QString, QString> *gplink_map_out = nullptr);
+
     QString filesys_path_to_smb_path(const QString &filesys_path) const;
 
 private:
@@ -21,16 +21,47 @@
 #ifndef AD_INTERFACE_P_H
 #define AD_INTERFACE_P_H
 
+#include "ad_metrics.h"
+#include "ad_trace.h"
+
+#include <QAtomicInt>
 #include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QList>
 #include <QMutex>
+#include <functional>
 
 class AdInterface;
 class AdConfig;
+class AdObject;
 class QString;
 typedef struct ldap LDAP;
 typedef struct _SMBCCTX SMBCCTX;
 
+/**
+ * GPT data read from sysvol for one GPO. Entry is valid
+ * only while GPC's versionNumber and GPT path stay the
+ * same. Fields are loaded lazily, "has_*" flags mark which
+ * ones are present.
+ */
+class GptCacheEntry {
+public:
+    GptCacheEntry();
+
+    int gpc_version;
+    QString smb_path;
+
+    bool has_sd;
+    QString sd;
+
+    bool has_sysvol_version;
+    int sysvol_version;
+
+    bool has_contents;
+    QList<QString> contents;
+};
+
 class AdInterfacePrivate {
     Q_DECLARE_TR_FUNCTIONS(AdInterfacePrivate)
 
@@ -46,21 +77,45 @@ public:
     QString dc;
     QString client_user;
     QList<AdMessage> messages;
+    const QAtomicInt *cancel_flag;
+    bool show_deleted;
 
     void success_message(const QString &msg, const DoStatusMsg do_msg = DoStatusMsg_Yes);
     void error_message(const QString &context, const QString &error, const DoStatusMsg do_msg = DoStatusMsg_Yes);
     void error_message_plain(const QString &text, const DoStatusMsg do_msg = DoStatusMsg_Yes);
     QString default_error() const;
     int get_ldap_result() const;
+    bool is_cancelled() const;
     bool search_paged_internal(const char *base, const int scope, const char *filter, char **attributes, QHash<QString, AdObject> *results, AdCookie *cookie, const bool get_sacl);
+    void record_operation(const AdOperation operation, const qint64 usec, const bool success, const qint64 bytes = 0) const;
+    void record_search(AdCookie *cookie, const bool success);
     bool connect_via_ldap(const char *uri);
     bool delete_gpt(const QString &parent_path);
     bool smb_path_is_dir(const QString &path, bool *ok);
 
+    // Sends "count" requests without waiting for results,
+    // then collects results in whatever order they
+    // arrive. "send_f" sends request with given index,
+    // sets it's msgid and returns LDAP result of sending.
+    // "result_f" is called once for every request with
+    // it's LDAP result and latency. Requests which failed
+    // to send or were pending when connection failed also
+    // get a call with the error.
+    void send_pipelined(const int count, std::function<int(const int index, int *msgid)> send_f, std::function<void(const int index, const int result, const qint64 usec)> result_f);
+
     // Returns GPT contents including the root path, in
     // order of increasing depth, so root path is first
     QList<QString> gpo_get_gpt_contents(const QString &gpt_root_path, bool *ok);
 
+    // NOTE: GPT data is cached between AdInterface
+    // instances so that repeated views of same GPO's don't
+    // go to sysvol. Returns empty entry if there's no
+    // valid cached data for this GPC.
+    static GptCacheEntry gpt_cache_get(const AdObject &gpc_object, const QString &smb_path);
+    static void gpt_cache_set(const AdObject &gpc_object, const GptCacheEntry &entry);
+    static void gpt_cache_remove(const QString &gpc_dn);
+    static void gpt_cache_clear();
+
 private:
     static AdConfig *adconfig;
     static bool s_log_searches;
@@ -69,9 +124,34 @@ private:
     static int s_port;
     static bool s_domain_is_default;
     static QString s_custom_domain;
+    static QString s_test_server;
     static CertStrategy s_cert_strat;
     static SMBCCTX *smbc;
+    static QHash<QString, GptCacheEntry> s_gpt_cache;
+    static QMutex gpt_cache_mutex;
     AdInterface *q;
 };
 
+/**
+ * Measures one operation and records it to metrics when
+ * finished. If timer is destroyed before it's finished,
+ * operation is recorded as failed, so early returns on
+ * errors don't need to finish the timer.
+ */
+class AdOperationTimer {
+public:
+    AdOperationTimer(const AdInterfacePrivate *d, const AdOperation operation);
+    ~AdOperationTimer();
+
+    // "bytes" is the size of sent values
+    void finish(const bool success, const qint64 bytes = 0);
+
+private:
+    const AdInterfacePrivate *d;
+    AdOperation operation;
+    QElapsedTimer timer;
+    TraceSpan span;
+    bool finished;
+};
+
 #endif /* AD_INTERFACE_P_H */
@@ -0,0 +1,391 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ad_metrics.h"
+
+#include "ad_utils.h"
+
+#include <QCoreApplication>
+#include <QMap>
+#include <QMutex>
+#include <QPair>
+
+#include <algorithm>
+
+QString usec_to_msec_string(const qint64 usec);
+int get_bucket_index(const qint64 usec);
+void record_operation_locked(const AdOperationSample &sample);
+
+// NOTE: metrics are recorded from search threads, so all
+// access goes through this mutex
+QMutex metrics_mutex;
+QMap<QPair<int, QString>, AdOperationMetrics> operation_map;
+QList<AdSearchRecord> slowest_search_list;
+
+AdOperationSample::AdOperationSample() {
+    operation = AdOperation_Search;
+    usec = 0;
+    success = true;
+    entries = 0;
+    pages = 0;
+    bytes = 0;
+}
+
+AdSearchRecord::AdSearchRecord() {
+    scope = SearchScope_All;
+    success = true;
+    complete = true;
+    usec = 0;
+    server_usec = 0;
+    entries = 0;
+    pages = 0;
+    bytes = 0;
+}
+
+AdOperationMetrics::AdOperationMetrics() {
+    operation = AdOperation_Search;
+    count = 0;
+    error_count = 0;
+    total_usec = 0;
+    max_usec = 0;
+    entries = 0;
+    pages = 0;
+    bytes = 0;
+    histogram = QVector<int>(ad_metrics_get_bucket_count(), 0);
+}
+
+qint64 AdOperationMetrics::average_usec() const {
+    if (count == 0) {
+        return 0;
+    }
+
+    return total_usec / count;
+}
+
+qint64 AdOperationMetrics::percentile_usec(const double percentile) const {
+    if (count == 0) {
+        return 0;
+    }
+
+    const QList<qint64> &bounds = ad_metrics_get_bucket_bounds();
+    const double target = percentile * count;
+
+    int cumulative = 0;
+    for (int bucket = 0; bucket < histogram.size(); bucket++) {
+        cumulative += histogram[bucket];
+
+        if (cumulative >= target && cumulative > 0) {
+            // NOTE: last bucket has no upper bound, so use
+            // max instead. Also don't report more than max
+            // for other buckets.
+            if (bucket < bounds.size()) {
+                return std::min(bounds[bucket], max_usec);
+            } else {
+                return max_usec;
+            }
+        }
+    }
+
+    return max_usec;
+}
+
+const QList<qint64> &ad_metrics_get_bucket_bounds() {
+    static const QList<qint64> out = {
+        1000,
+        2000,
+        5000,
+        10000,
+        20000,
+        50000,
+        100000,
+        200000,
+        500000,
+        1000000,
+        2000000,
+        5000000,
+        10000000,
+    };
+
+    return out;
+}
+
+int ad_metrics_get_bucket_count() {
+    return ad_metrics_get_bucket_bounds().size() + 1;
+}
+
+QString ad_metrics_get_bucket_name(const int bucket) {
+    const QList<qint64> &bounds = ad_metrics_get_bucket_bounds();
+
+    if (bucket < bounds.size()) {
+        return QString("<%1ms").arg(bounds[bucket] / 1000);
+    } else {
+        return QString(">=%1ms").arg(bounds.last() / 1000);
+    }
+}
+
+void ad_metrics_record(const AdOperationSample &sample) {
+    QMutexLocker locker(&metrics_mutex);
+
+    record_operation_locked(sample);
+}
+
+void ad_metrics_record_search(const AdSearchRecord &record) {
+    QMutexLocker locker(&metrics_mutex);
+
+    const AdOperationSample sample = [&]() {
+        AdOperationSample out;
+        out.operation = AdOperation_Search;
+        out.dc = record.dc;
+        out.usec = record.usec;
+        out.success = record.success;
+        out.entries = record.entries;
+        out.pages = record.pages;
+        out.bytes = record.bytes;
+
+        return out;
+    }();
+
+    record_operation_locked(sample);
+
+    // Insert into list of slowest searches, keeping it
+    // sorted and limited in size
+    const bool list_is_full = (slowest_search_list.size() >= AD_METRICS_SLOWEST_SEARCH_MAX);
+    if (list_is_full && record.usec <= slowest_search_list.last().usec) {
+        return;
+    }
+
+    auto is_slower = [](const AdSearchRecord &a, const AdSearchRecord &b) {
+        return (a.usec > b.usec);
+    };
+
+    const auto position = std::upper_bound(slowest_search_list.begin(), slowest_search_list.end(), record, is_slower);
+    slowest_search_list.insert(position, record);
+
+    if (slowest_search_list.size() > AD_METRICS_SLOWEST_SEARCH_MAX) {
+        slowest_search_list.removeLast();
+    }
+}
+
+QList<AdOperationMetrics> ad_metrics_get_operations() {
+    QList<AdOperationMetrics> out = [&]() {
+        QMutexLocker locker(&metrics_mutex);
+
+        return operation_map.values();
+    }();
+
+    std::sort(out.begin(), out.end(),
+        [](const AdOperationMetrics &a, const AdOperationMetrics &b) {
+            return (a.total_usec > b.total_usec);
+        });
+
+    return out;
+}
+
+QList<AdSearchRecord> ad_metrics_get_slowest_searches() {
+    QMutexLocker locker(&metrics_mutex);
+
+    return slowest_search_list;
+}
+
+void ad_metrics_reset() {
+    QMutexLocker locker(&metrics_mutex);
+
+    operation_map.clear();
+    slowest_search_list.clear();
+}
+
+QString ad_operation_string(const AdOperation operation) {
+    switch (operation) {
+        case AdOperation_Search: return QCoreApplication::translate("ad_metrics", "Search");
+        case AdOperation_Modify: return QCoreApplication::translate("ad_metrics", "Modify");
+        case AdOperation_Add: return QCoreApplication::translate("ad_metrics", "Add");
+        case AdOperation_Delete: return QCoreApplication::translate("ad_metrics", "Delete");
+        case AdOperation_Rename: return QCoreApplication::translate("ad_metrics", "Rename");
+        case AdOperation_Bind: return QCoreApplication::translate("ad_metrics", "Bind");
+        case AdOperation_Smb: return QCoreApplication::translate("ad_metrics", "SMB");
+        case AdOperation_COUNT: break;
+    }
+
+    return QString();
+}
+
+QString search_scope_string(const SearchScope scope) {
+    switch (scope) {
+        case SearchScope_Object: return "object";
+        case SearchScope_Children: return "children";
+        case SearchScope_Descendants: return "descendants";
+        case SearchScope_All: return "all";
+    }
+
+    return QString();
+}
+
+QString ad_metrics_operations_csv() {
+    QString out;
+
+    const QList<QString> header = [&]() {
+        QList<QString> header_out = {
+            "Operation",
+            "DC",
+            "Count",
+            "Errors",
+            "Total ms",
+            "Average ms",
+            "p50 ms",
+            "p95 ms",
+            "p99 ms",
+            "Max ms",
+            "Entries",
+            "Pages",
+            "Bytes",
+        };
+
+        for (int bucket = 0; bucket < ad_metrics_get_bucket_count(); bucket++) {
+            header_out.append(csv_escape(ad_metrics_get_bucket_name(bucket)));
+        }
+
+        return header_out;
+    }();
+    out.append(header.join(','));
+    out.append('\n');
+
+    // NOTE: operation names are not translated in the
+    // report so that reports can be compared
+    const QList<QString> operation_name_list = {
+        "search",
+        "modify",
+        "add",
+        "delete",
+        "rename",
+        "bind",
+        "smb",
+    };
+
+    for (const AdOperationMetrics &metrics : ad_metrics_get_operations()) {
+        QList<QString> row = {
+            operation_name_list.value(metrics.operation),
+            csv_escape(metrics.dc),
+            QString::number(metrics.count),
+            QString::number(metrics.error_count),
+            usec_to_msec_string(metrics.total_usec),
+            usec_to_msec_string(metrics.average_usec()),
+            usec_to_msec_string(metrics.percentile_usec(0.5)),
+            usec_to_msec_string(metrics.percentile_usec(0.95)),
+            usec_to_msec_string(metrics.percentile_usec(0.99)),
+            usec_to_msec_string(metrics.max_usec),
+            QString::number(metrics.entries),
+            QString::number(metrics.pages),
+            QString::number(metrics.bytes),
+        };
+
+        for (const int bucket_count : metrics.histogram) {
+            row.append(QString::number(bucket_count));
+        }
+
+        out.append(row.join(','));
+        out.append('\n');
+    }
+
+    return out;
+}
+
+QString ad_metrics_searches_csv() {
+    QString out;
+
+    const QList<QString> header = {
+        "Time",
+        "Total ms",
+        "Server ms",
+        "Client ms",
+        "Entries",
+        "Pages",
+        "Bytes",
+        "Success",
+        "Complete",
+        "DC",
+        "Base",
+        "Scope",
+        "Filter",
+    };
+    out.append(header.join(','));
+    out.append('\n');
+
+    for (const AdSearchRecord &record : ad_metrics_get_slowest_searches()) {
+        const QList<QString> row = {
+            record.time.toString(Qt::ISODateWithMs),
+            usec_to_msec_string(record.usec),
+            usec_to_msec_string(record.server_usec),
+            usec_to_msec_string(record.usec - record.server_usec),
+            QString::number(record.entries),
+            QString::number(record.pages),
+            QString::number(record.bytes),
+            (record.success ? "TRUE" : "FALSE"),
+            (record.complete ? "TRUE" : "FALSE"),
+            csv_escape(record.dc),
+            csv_escape(record.base),
+            search_scope_string(record.scope),
+            csv_escape(record.filter),
+        };
+        out.append(row.join(','));
+        out.append('\n');
+    }
+
+    return out;
+}
+
+void record_operation_locked(const AdOperationSample &sample) {
+    const QPair<int, QString> key = {sample.operation, sample.dc};
+
+    if (!operation_map.contains(key)) {
+        AdOperationMetrics metrics;
+        metrics.operation = sample.operation;
+        metrics.dc = sample.dc;
+
+        operation_map.insert(key, metrics);
+    }
+
+    AdOperationMetrics &metrics = operation_map[key];
+
+    metrics.count++;
+    if (!sample.success) {
+        metrics.error_count++;
+    }
+    metrics.total_usec += sample.usec;
+    metrics.max_usec = std::max(metrics.max_usec, sample.usec);
+    metrics.entries += sample.entries;
+    metrics.pages += sample.pages;
+    metrics.bytes += sample.bytes;
+
+    const int bucket = get_bucket_index(sample.usec);
+    metrics.histogram[bucket]++;
+}
+
+int get_bucket_index(const qint64 usec) {
+    const QList<qint64> &bounds = ad_metrics_get_bucket_bounds();
+
+    const auto position = std::upper_bound(bounds.begin(), bounds.end(), usec);
+    const int out = (int) (position - bounds.begin());
+
+    return out;
+}
+
+QString usec_to_msec_string(const qint64 usec) {
+    return QString::number(usec / 1000.0, 'f', 3);
+}
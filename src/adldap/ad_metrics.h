@@ -0,0 +1,156 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AD_METRICS_H
+#define AD_METRICS_H
+
+/**
+ * Collects latency and size metrics of operations done by
+ * AdInterface. Metrics are grouped by operation type and
+ * by DC and are kept for the lifetime of the process.
+ * Latency of every operation is counted in a histogram
+ * with fixed buckets. Slowest searches are also kept
+ * together with their arguments. Search latency is split
+ * into time spent waiting for the server and time spent
+ * on the client parsing results, to tell slow DC's and
+ * networks apart from slow clients. All f-ns are
+ * thread-safe.
+ */
+
+#include "ad_defines.h"
+
+#include <QDateTime>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+enum AdOperation {
+    AdOperation_Search,
+    AdOperation_Modify,
+    AdOperation_Add,
+    AdOperation_Delete,
+    AdOperation_Rename,
+    AdOperation_Bind,
+    AdOperation_Smb,
+
+    AdOperation_COUNT,
+};
+
+// Max amount of searches kept by
+// ad_metrics_get_slowest_searches()
+#define AD_METRICS_SLOWEST_SEARCH_MAX 50
+
+class AdOperationSample {
+public:
+    AdOperationSample();
+
+    AdOperation operation;
+    QString dc;
+    qint64 usec;
+    bool success;
+    int entries;
+    int pages;
+    qint64 bytes;
+};
+
+class AdSearchRecord {
+public:
+    AdSearchRecord();
+
+    QDateTime time;
+    QString dc;
+    QString base;
+    SearchScope scope;
+    QString filter;
+    bool success;
+
+    // False if search was stopped before last page, for
+    // example because of display limit or cancel. Then
+    // entries and pages are of fetched pages only.
+    bool complete;
+
+    // Total time of the search, including all pages
+    qint64 usec;
+
+    // Part of total time spent waiting for results from
+    // server. The rest is spent on the client.
+    qint64 server_usec;
+
+    int entries;
+    int pages;
+
+    // Size of received DN's, attribute names and values
+    qint64 bytes;
+};
+
+class AdOperationMetrics {
+public:
+    AdOperationMetrics();
+
+    AdOperation operation;
+    QString dc;
+    int count;
+    int error_count;
+    qint64 total_usec;
+    qint64 max_usec;
+    qint64 entries;
+    qint64 pages;
+    qint64 bytes;
+
+    // Counts of operations in each latency bucket, see
+    // ad_metrics_get_bucket_bounds()
+    QVector<int> histogram;
+
+    qint64 average_usec() const;
+
+    // Estimated from histogram, returns upper bound of the
+    // bucket which contains the percentile. Percentile is
+    // in range [0, 1].
+    qint64 percentile_usec(const double percentile) const;
+};
+
+// Upper bounds of latency buckets, in microseconds. Last
+// bucket has no upper bound and is not included.
+const QList<qint64> &ad_metrics_get_bucket_bounds();
+int ad_metrics_get_bucket_count();
+QString ad_metrics_get_bucket_name(const int bucket);
+
+void ad_metrics_record(const AdOperationSample &sample);
+
+// Also records search as an operation
+void ad_metrics_record_search(const AdSearchRecord &record);
+
+// Sorted by total time, in descending order
+QList<AdOperationMetrics> ad_metrics_get_operations();
+
+// Sorted by duration, in descending order
+QList<AdSearchRecord> ad_metrics_get_slowest_searches();
+
+void ad_metrics_reset();
+
+QString ad_operation_string(const AdOperation operation);
+QString search_scope_string(const SearchScope scope);
+
+// Reports as comma-separated values. Operations report
+// has a column for every histogram bucket.
+QString ad_metrics_operations_csv();
+QString ad_metrics_searches_csv();
+
+#endif /* AD_METRICS_H */
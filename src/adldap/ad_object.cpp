@@ -39,12 +39,16 @@ AdObject::AdObject() {
 }
 
 void AdObject::load(const QString &dn_arg, const QHash<QString, QList<QByteArray>> &attributes_data_arg) {
-    dn = dn_arg;
+    dn_view = DnView(dn_arg);
     attributes_data = attributes_data_arg;
 }
 
 QString AdObject::get_dn() const {
-    return dn;
+    return dn_view.dn();
+}
+
+const DnView &AdObject::get_dn_view() const {
+    return dn_view;
 }
 
 QHash<QString, QList<QByteArray>> AdObject::get_attributes_data() const {
@@ -32,6 +32,7 @@
  */
 
 #include "ad_defines.h"
+#include "ad_dn.h"
 
 #include <QByteArray>
 #include <QHash>
@@ -51,6 +52,11 @@ public:
     void load(const QString &dn_arg, const QHash<QString, QList<QByteArray>> &attributes_data_arg);
 
     QString get_dn() const;
+
+    // NOTE: parsed form of dn, shared by all users of
+    // this object so that name, parent and canonical
+    // forms are only computed once
+    const DnView &get_dn_view() const;
     QHash<QString, QList<QByteArray>> get_attributes_data() const;
     bool is_empty() const;
     bool contains(const QString &attribute) const;
@@ -88,7 +94,7 @@ public:
     security_descriptor *get_security_descriptor(TALLOC_CTX *mem_ctx = nullptr) const;
 
 private:
-    QString dn;
+    DnView dn_view;
     QHash<QString, QList<QByteArray>> attributes_data;
 };
 
@@ -30,6 +30,10 @@
 #include "ad_filter.h"
 
 #include <QDebug>
+#include <QMutex>
+#include <QQueue>
+#include <QSet>
+#include <QThreadStorage>
 
 #define UNUSED_ARG(x) (void) (x)
 
@@ -40,7 +44,14 @@ bool check_ace_match(const security_ace &ace, const QByteArray &trustee, const Q
 QList<security_ace> security_descriptor_get_dacl(const security_descriptor *sd);
 void ad_security_replace_dacl(security_descriptor *sd, const QList<security_ace> &new_dacl);
 uint32_t ad_security_map_access_mask(const uint32_t access_mask);
+QByteArray dom_sid_key(const dom_sid &sid);
+security_descriptor *security_descriptor_parse(TALLOC_CTX *mem_ctx, const QByteArray &sd_bytes);
+security_descriptor *security_descriptor_make_empty(TALLOC_CTX *mem_ctx);
+QPair<quint64, quint64> guid_key_from_bytes(const QByteArray &bytes);
+int security_right_state_bit(const int inherited, const int type);
+SecurityRightState security_right_state_from_bits(const int state_bits);
 int ace_compare_simplified(const security_ace &ace1, const security_ace &ace2);
+bool security_descriptor_dacl_equal(const security_descriptor *sd1, const security_descriptor *sd2);
 
 // NOTE: these "base" f-ns are used by the full
 // versions of add/remove right f-ns. Base f-ns do only
@@ -50,6 +61,8 @@ int ace_compare_simplified(const security_ace &ace1, const security_ace &ace2);
 // handle sorting themselves.
 void security_descriptor_add_right_base(security_descriptor *sd, const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type, const bool allow);
 void security_descriptor_remove_right_base(security_descriptor *sd, const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type, const bool allow);
+void security_descriptor_add_right_unsorted(security_descriptor *sd, AdConfig *adconfig, const QList<QString> &class_list, const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type, const bool allow);
+void security_descriptor_remove_right_unsorted(security_descriptor *sd, AdConfig *adconfig, const QList<QString> &class_list, const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type, const bool allow);
 
 const QList<int> ace_types_with_object = {
     SEC_ACE_TYPE_ACCESS_ALLOWED_OBJECT,
@@ -170,12 +183,107 @@ bool SecurityRightState::get(const SecurityRightStateInherited inherited, const
     return data[inherited][type];
 }
 
-security_descriptor *security_descriptor_make_from_bytes(TALLOC_CTX *mem_ctx, const QByteArray &sd_bytes) {
+// Parsed sd's are stored in a talloc arena owned by the
+// cache. Each thread has it's own cache, so no locking
+// is needed and parsed sd's are never shared between
+// threads.
+class SdCache {
+public:
+    SdCache();
+    ~SdCache();
+
+    TALLOC_CTX *arena;
+    QHash<QByteArray, security_descriptor *> sd_map;
+    QQueue<QByteArray> insert_order;
+};
+
+const int SD_CACHE_CAPACITY = 64;
+
+QThreadStorage<SdCache *> sd_cache_storage;
+
+SdCache::SdCache() {
+    arena = talloc_new(NULL);
+}
+
+SdCache::~SdCache() {
+    talloc_free(arena);
+}
+
+// Returns nullptr if bytes are not a valid sd
+security_descriptor *security_descriptor_parse(TALLOC_CTX *mem_ctx, const QByteArray &sd_bytes) {
     DATA_BLOB blob = data_blob_const(sd_bytes.data(), sd_bytes.size());
 
-    security_descriptor *out = talloc(mem_ctx, struct security_descriptor);
+    security_descriptor *out = talloc_zero(mem_ctx, struct security_descriptor);
 
-    ndr_pull_struct_blob(&blob, out, out, (ndr_pull_flags_fn_t) ndr_pull_security_descriptor);
+    const enum ndr_err_code ndr_err = ndr_pull_struct_blob(&blob, out, out, (ndr_pull_flags_fn_t) ndr_pull_security_descriptor);
+
+    if (!NDR_ERR_CODE_IS_SUCCESS(ndr_err)) {
+        talloc_free(out);
+
+        return nullptr;
+    }
+
+    return out;
+}
+
+// NOTE: used in place of sd's that failed to parse, so
+// that callers which expect a valid sd don't crash
+security_descriptor *security_descriptor_make_empty(TALLOC_CTX *mem_ctx) {
+    security_descriptor *out = talloc_zero(mem_ctx, struct security_descriptor);
+    out->revision = SECURITY_DESCRIPTOR_REVISION_1;
+    out->dacl = talloc_zero(out, struct security_acl);
+
+    return out;
+}
+
+const security_descriptor *security_descriptor_get_cached(const QByteArray &sd_bytes) {
+    if (!sd_cache_storage.hasLocalData()) {
+        sd_cache_storage.setLocalData(new SdCache());
+    }
+
+    SdCache *cache = sd_cache_storage.localData();
+
+    if (cache->sd_map.contains(sd_bytes)) {
+        return cache->sd_map[sd_bytes];
+    }
+
+    // NOTE: evict oldest entries. Simple FIFO is
+    // enough here because typical access pattern is
+    // the same sd being accessed several times in a row
+    // by different tabs and helper f-ns.
+    while (cache->insert_order.size() >= SD_CACHE_CAPACITY) {
+        const QByteArray oldest = cache->insert_order.dequeue();
+        security_descriptor *oldest_sd = cache->sd_map.take(oldest);
+        talloc_free(oldest_sd);
+    }
+
+    security_descriptor *sd = security_descriptor_parse(cache->arena, sd_bytes);
+
+    // NOTE: don't cache failures, so that they are not
+    // mistaken for valid sd's
+    if (sd == nullptr) {
+        qDebug() << "Failed to parse security descriptor";
+
+        return nullptr;
+    }
+
+    cache->sd_map.insert(sd_bytes, sd);
+    cache->insert_order.enqueue(sd_bytes);
+
+    return sd;
+}
+
+// NOTE: copying is much cheaper than NDR decoding, so
+// return a copy of cached sd instead of parsing bytes
+// every time
+security_descriptor *security_descriptor_make_from_bytes(TALLOC_CTX *mem_ctx, const QByteArray &sd_bytes) {
+    const security_descriptor *cached_sd = security_descriptor_get_cached(sd_bytes);
+
+    if (cached_sd == nullptr) {
+        return security_descriptor_make_empty(mem_ctx);
+    }
+
+    security_descriptor *out = security_descriptor_copy(mem_ctx, cached_sd);
 
     return out;
 }
@@ -267,18 +375,59 @@ QByteArray dom_sid_to_bytes(const dom_sid &sid) {
 }
 
 // Copy sid bytes into dom_sid struct and adds padding
-// if necessary
+// if necessary. Sid's read from server are shorter than
+// dom_sid, so only copy what's there.
 dom_sid dom_sid_from_bytes(const QByteArray &bytes) {
     dom_sid out;
     memset(&out, '\0', sizeof(dom_sid));
-    memcpy(&out, bytes.data(), sizeof(dom_sid));
+
+    const int copy_size = qMin(bytes.size(), (int) sizeof(dom_sid));
+    memcpy(&out, bytes.constData(), copy_size);
 
     return out;
 }
 
+// Returns only the meaningful part of sid, without unused
+// sub auths, so that sids can be compared as bytes
+QByteArray dom_sid_key(const dom_sid &sid) {
+    const int num_auths = qBound(0, (int) sid.num_auths, 15);
+    const int size = 8 + 4 * num_auths;
+    const QByteArray out = QByteArray((const char *) &sid, size);
+
+    return out;
+}
+
+QPair<quint64, quint64> guid_key_from_bytes(const QByteArray &bytes) {
+    quint64 first = 0;
+    quint64 second = 0;
+
+    if (bytes.size() >= 16) {
+        memcpy(&first, bytes.constData(), sizeof(quint64));
+        memcpy(&second, bytes.constData() + sizeof(quint64), sizeof(quint64));
+    }
+
+    return QPair<quint64, quint64>(first, second);
+}
+
+int security_right_state_bit(const int inherited, const int type) {
+    return (1 << (inherited * SecurityRightStateType_COUNT + type));
+}
+
+SecurityRightState security_right_state_from_bits(const int state_bits) {
+    bool data[SecurityRightStateInherited_COUNT][SecurityRightStateType_COUNT];
+
+    for (int inherited = 0; inherited < SecurityRightStateInherited_COUNT; inherited++) {
+        for (int type = 0; type < SecurityRightStateType_COUNT; type++) {
+            data[inherited][type] = bitmask_is_set(state_bits, security_right_state_bit(inherited, type));
+        }
+    }
+
+    return SecurityRightState(data);
+}
+
 QByteArray dom_sid_string_to_bytes(const QString &string) {
     dom_sid sid;
-    dom_sid_parse(cstr(string), &sid);
+    dom_sid_parse(CString(string).get(), &sid);
     const QByteArray bytes = dom_sid_to_bytes(sid);
 
     return bytes;
@@ -289,13 +438,15 @@ void security_descriptor_sort_dacl(security_descriptor *sd) {
 }
 
 bool ad_security_get_protected_against_deletion(const AdObject &object) {
-    security_descriptor *sd = object.get_security_descriptor();
+    const QByteArray sd_bytes = object.get_value(ATTRIBUTE_SECURITY_DESCRIPTOR);
+    const security_descriptor *sd = security_descriptor_get_cached(sd_bytes);
 
     const QByteArray trustee_everyone = sid_string_to_bytes(SID_WORLD);
+    const SecurityDaclIndex dacl_index = SecurityDaclIndex(sd);
 
     const bool is_enabled_for_trustee = [&]() {
         for (const uint32_t &mask : protect_deletion_mask_list) {
-            const SecurityRightState state = security_descriptor_get_right(sd, trustee_everyone, mask, QByteArray());
+            const SecurityRightState state = dacl_index.get_right(trustee_everyone, mask, QByteArray());
 
             const bool deny = state.get(SecurityRightStateInherited_No, SecurityRightStateType_Deny);
 
@@ -307,13 +458,13 @@ bool ad_security_get_protected_against_deletion(const AdObject &object) {
         return true;
     }();
 
-    security_descriptor_free(sd);
-
     return is_enabled_for_trustee;
 }
 
 bool ad_security_get_user_cant_change_pass(const AdObject *object, AdConfig *adconfig) {
-    security_descriptor *sd = object->get_security_descriptor();
+    const QByteArray sd_bytes = object->get_value(ATTRIBUTE_SECURITY_DESCRIPTOR);
+    const security_descriptor *sd = security_descriptor_get_cached(sd_bytes);
+    const SecurityDaclIndex dacl_index = SecurityDaclIndex(sd);
 
     const bool enabled = [&]() {
         bool out = false;
@@ -322,7 +473,7 @@ bool ad_security_get_user_cant_change_pass(const AdObject *object, AdConfig *adc
             const bool is_denied = [&]() {
                 const QByteArray trustee = sid_string_to_bytes(trustee_cn);
                 const QByteArray change_pass_right = adconfig->get_right_guid("User-Change-Password");
-                const SecurityRightState state = security_descriptor_get_right(sd, trustee, SEC_ADS_CONTROL_ACCESS, change_pass_right);
+                const SecurityRightState state = dacl_index.get_right(trustee, SEC_ADS_CONTROL_ACCESS, change_pass_right);
                 const bool out_denied = state.get(SecurityRightStateInherited_No, SecurityRightStateType_Deny);
 
                 return out_denied;
@@ -341,8 +492,6 @@ bool ad_security_get_user_cant_change_pass(const AdObject *object, AdConfig *adc
         return out;
     }();
 
-    security_descriptor_free(sd);
-
     return enabled;
 }
 
@@ -451,86 +600,302 @@ QList<security_ace> security_descriptor_get_dacl(const security_descriptor *sd)
     return out;
 }
 
-SecurityRightState security_descriptor_get_right(const security_descriptor *sd, const QByteArray &trustee, const uint32_t access_mask_arg, const QByteArray &object_type) {
-    bool out_data[SecurityRightStateInherited_COUNT][SecurityRightStateType_COUNT];
+SecurityRightState security_descriptor_get_right(const security_descriptor *sd, const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type) {
+    const SecurityDaclIndex index = SecurityDaclIndex(sd);
+    const SecurityRightState out = index.get_right(trustee, access_mask, object_type);
 
-    const uint32_t access_mask = ad_security_map_access_mask(access_mask_arg);
+    return out;
+}
 
-    for (int x = 0; x < SecurityRightStateInherited_COUNT; x++) {
-        for (int y = 0; y < SecurityRightStateType_COUNT; y++) {
-            out_data[x][y] = false;
-        }
+SecurityDaclIndex::SecurityDaclIndex(const security_descriptor *sd) {
+    if (sd == nullptr || sd->dacl == nullptr) {
+        return;
     }
 
-    const QList<security_ace> dacl = security_descriptor_get_dacl(sd);
+    const security_acl *dacl = sd->dacl;
 
-    for (const security_ace &ace : dacl) {
-        const bool match = [&]() {
-            const bool trustee_match = [&]() {
-                const dom_sid trustee_sid = dom_sid_from_bytes(trustee);
-                const bool trustees_are_equal = (dom_sid_compare(&ace.trustee, &trustee_sid) == 0);
+    for (size_t i = 0; i < dacl->num_aces; i++) {
+        const security_ace &ace = dacl->aces[i];
 
-                return trustees_are_equal;
-            }();
+        const bool allow = ace_type_allow_set.contains(ace.type);
+        const bool deny = ace_type_deny_set.contains(ace.type);
+        if (!allow && !deny) {
+            continue;
+        }
 
-            const bool access_mask_match = bitmask_is_set(ace.access_mask, access_mask);
+        const int inherit_i = [&]() {
+            const bool ace_is_inherited = bitmask_is_set(ace.flags, SEC_ACE_FLAG_INHERITED_ACE);
 
-            const bool object_match = [&]() {
-                const bool object_present = ace_types_with_object.contains(ace.type);
+            if (ace_is_inherited) {
+                return SecurityRightStateInherited_Yes;
+            } else {
+                return SecurityRightStateInherited_No;
+            }
+        }();
 
-                if (object_present) {
-                    const GUID out_guid = ace.object.object.type.type;
-                    const QByteArray ace_object_type = QByteArray((char *) &out_guid, sizeof(GUID));
-                    const bool types_are_equal = (ace_object_type == object_type);
+        Entry entry;
+        entry.access_mask = ace.access_mask;
+        entry.state_bits = 0;
+        if (allow) {
+            entry.state_bits |= security_right_state_bit(inherit_i, SecurityRightStateType_Allow);
+        }
+        if (deny) {
+            entry.state_bits |= security_right_state_bit(inherit_i, SecurityRightStateType_Deny);
+        }
 
-                    return types_are_equal;
-                } else {
-                    // NOTE: if compared ace doesn't
-                    // have an object it can still
-                    // match if it's access mask
-                    // matches with given ace. Example:
-                    // ace that allows "generic read"
-                    // (mask contains bit for "read
-                    // property" and object is empty)
-                    // will also allow right for
-                    // reading personal info (mask *is*
-                    // "read property" and contains
-                    // some object)
-                    return access_mask_match;
-                }
-            }();
+        TrusteeEntry &trustee_entry = trustee_map[dom_sid_key(ace.trustee)];
 
-            const bool out = (trustee_match && access_mask_match && object_match);
+        const bool object_present = ace_types_with_object.contains(ace.type);
+        if (object_present) {
+            const GUID &guid = ace.object.object.type.type;
+            const GuidKey key = guid_key_from_bytes(QByteArray::fromRawData((const char *) &guid, sizeof(GUID)));
 
-            return out;
+            trustee_entry.object_map[key].append(entry);
+        } else {
+            trustee_entry.plain_list.append(entry);
+        }
+    }
+}
+
+SecurityRightState SecurityDaclIndex::get_right(const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type) const {
+    const QByteArray trustee_key = dom_sid_key(dom_sid_from_bytes(trustee));
+
+    int state_bits = 0;
+
+    auto it = trustee_map.find(trustee_key);
+    if (it != trustee_map.end()) {
+        state_bits = get_state_bits(it.value(), access_mask, object_type);
+    }
+
+    return security_right_state_from_bits(state_bits);
+}
+
+QList<SecurityRightState> SecurityDaclIndex::get_right_list(const QByteArray &trustee, const QList<SecurityRight> &right_list) const {
+    const QByteArray trustee_key = dom_sid_key(dom_sid_from_bytes(trustee));
+
+    QList<SecurityRightState> out;
+    out.reserve(right_list.size());
+
+    auto it = trustee_map.find(trustee_key);
+    const bool trustee_has_aces = (it != trustee_map.end());
+
+    for (const SecurityRight &right : right_list) {
+        const int state_bits = [&]() {
+            if (trustee_has_aces) {
+                return get_state_bits(it.value(), right.access_mask, right.object_type);
+            } else {
+                return 0;
+            }
         }();
 
-        if (match) {
-            bool state_list[2];
-            state_list[SecurityRightStateType_Allow] = ace_type_allow_set.contains(ace.type);
-            state_list[SecurityRightStateType_Deny] = ace_type_deny_set.contains(ace.type);
+        out.append(security_right_state_from_bits(state_bits));
+    }
 
-            const int inherit_i = [&]() {
-                const bool ace_is_inherited = bitmask_is_set(ace.flags, SEC_ACE_FLAG_INHERITED_ACE);
+    return out;
+}
 
-                if (ace_is_inherited) {
-                    return SecurityRightStateInherited_Yes;
-                } else {
-                    return SecurityRightStateInherited_No;
-                }
-            }();
+int SecurityDaclIndex::get_state_bits(const TrusteeEntry &trustee_entry, const uint32_t access_mask_arg, const QByteArray &object_type) const {
+    const uint32_t access_mask = ad_security_map_access_mask(access_mask_arg);
+
+    int out = 0;
+
+    // NOTE: if ace doesn't have an object it can still
+    // match if it's access mask matches with given ace.
+    // Example: ace that allows "generic read" (mask
+    // contains bit for "read property" and object is
+    // empty) will also allow right for reading personal
+    // info (mask *is* "read property" and contains some
+    // object)
+    for (const Entry &entry : trustee_entry.plain_list) {
+        if (bitmask_is_set(entry.access_mask, access_mask)) {
+            out |= entry.state_bits;
+        }
+    }
 
-            for (int type_i = 0; type_i < SecurityRightStateType_COUNT; type_i++) {
-                const bool right_state = state_list[type_i];
+    if (object_type.size() == sizeof(GUID)) {
+        auto it = trustee_entry.object_map.find(guid_key_from_bytes(object_type));
 
-                if (right_state) {
-                    out_data[inherit_i][type_i] = true;
+        if (it != trustee_entry.object_map.end()) {
+            for (const Entry &entry : it.value()) {
+                if (bitmask_is_set(entry.access_mask, access_mask)) {
+                    out |= entry.state_bits;
                 }
             }
         }
     }
 
-    const SecurityRightState out = SecurityRightState(out_data);
+    return out;
+}
+
+QHash<QString, QList<QByteArray>> token_cache;
+QMutex token_cache_mutex;
+
+QList<QByteArray> ad_security_get_token(AdInterface &ad, const QString &principal_dn, const QString &target_dn) {
+    const QString key = principal_dn.toLower();
+
+    // NOTE: SELF depends on target, so it's not cached
+    // and is added to the cached part of the token
+    const bool target_is_principal = (target_dn.compare(principal_dn, Qt::CaseInsensitive) == 0);
+
+    auto add_self = [&](const QList<QByteArray> &token) {
+        QList<QByteArray> out = token;
+
+        if (target_is_principal && !out.isEmpty()) {
+            out.append(sid_string_to_bytes(SID_NT_SELF));
+        }
+
+        return out;
+    };
+
+    {
+        QMutexLocker locker(&token_cache_mutex);
+
+        if (token_cache.contains(key)) {
+            return add_self(token_cache[key]);
+        }
+    }
+
+    // NOTE: tokenGroups is a constructed attribute, so
+    // it can only be read with a base scope search
+    const QList<QString> attributes = {
+        ATTRIBUTE_OBJECT_SID,
+        ATTRIBUTE_TOKEN_GROUPS,
+    };
+    const AdObject object = ad.search_object(principal_dn, attributes);
+
+    if (object.is_empty()) {
+        return QList<QByteArray>();
+    }
+
+    QList<QByteArray> out;
+    out.append(object.get_value(ATTRIBUTE_OBJECT_SID));
+    out.append(object.get_values(ATTRIBUTE_TOKEN_GROUPS));
+    out.append(sid_string_to_bytes(SID_WORLD));
+    out.append(sid_string_to_bytes(SID_NT_AUTHENTICATED_USERS));
+
+    {
+        QMutexLocker locker(&token_cache_mutex);
+        token_cache[key] = out;
+    }
+
+    return add_self(out);
+}
+
+void ad_security_clear_token_cache() {
+    QMutexLocker locker(&token_cache_mutex);
+
+    token_cache.clear();
+}
+
+QList<bool> security_descriptor_get_effective_rights(const security_descriptor *sd, const QList<QByteArray> &token, const QList<SecurityRight> &right_list) {
+    const int right_count = right_list.size();
+
+    // NOTE: sd without a DACL allows everything to
+    // everyone, same as in Windows. This is different
+    // from an empty DACL, which allows nothing.
+    const bool dacl_is_null = (sd != nullptr && sd->dacl == nullptr);
+    if (dacl_is_null) {
+        QList<bool> out;
+
+        for (int i = 0; i < right_count; i++) {
+            out.append(true);
+        }
+
+        return out;
+    }
+
+    QVector<uint32_t> mask_list(right_count);
+    QVector<uint32_t> allowed_list(right_count, 0);
+    QVector<uint32_t> denied_list(right_count, 0);
+
+    // Map object types to rights, so that object ACE's
+    // only touch rights with same object type
+    QHash<QPair<quint64, quint64>, QList<int>> object_right_map;
+    for (int i = 0; i < right_count; i++) {
+        const SecurityRight &right = right_list[i];
+
+        mask_list[i] = ad_security_map_access_mask(right.access_mask);
+
+        if (right.object_type.size() == sizeof(GUID)) {
+            object_right_map[guid_key_from_bytes(right.object_type)].append(i);
+        }
+    }
+
+    const QSet<QByteArray> token_set = [&]() {
+        QSet<QByteArray> out;
+
+        for (const QByteArray &sid : token) {
+            out.insert(dom_sid_key(dom_sid_from_bytes(sid)));
+        }
+
+        return out;
+    }();
+
+    auto apply_ace = [&](const int i, const uint32_t ace_mask, const bool allow) {
+        const uint32_t undecided = mask_list[i] & ~(allowed_list[i] | denied_list[i]);
+        const uint32_t decided = ace_mask & undecided;
+
+        if (allow) {
+            allowed_list[i] |= decided;
+        } else {
+            denied_list[i] |= decided;
+        }
+    };
+
+    if (sd != nullptr && sd->owner_sid != nullptr && token_set.contains(dom_sid_key(*sd->owner_sid))) {
+        const uint32_t owner_mask = (SEC_STD_READ_CONTROL | SEC_STD_WRITE_DAC);
+
+        for (int i = 0; i < right_count; i++) {
+            apply_ace(i, owner_mask, true);
+        }
+    }
+
+    const security_acl *dacl = (sd != nullptr) ? sd->dacl : nullptr;
+    const size_t ace_count = (dacl != nullptr) ? dacl->num_aces : 0;
+
+    for (size_t ace_i = 0; ace_i < ace_count; ace_i++) {
+        const security_ace &ace = dacl->aces[ace_i];
+
+        // NOTE: inherit-only ACE's apply only to children
+        const bool inherit_only = bitmask_is_set(ace.flags, SEC_ACE_FLAG_INHERIT_ONLY);
+        if (inherit_only) {
+            continue;
+        }
+
+        const bool allow = ace_type_allow_set.contains(ace.type);
+        const bool deny = ace_type_deny_set.contains(ace.type);
+        if (!allow && !deny) {
+            continue;
+        }
+
+        if (!token_set.contains(dom_sid_key(ace.trustee))) {
+            continue;
+        }
+
+        const bool object_type_present = (ace_types_with_object.contains(ace.type) && bitmask_is_set(ace.object.object.flags, SEC_ACE_OBJECT_TYPE_PRESENT));
+
+        if (object_type_present) {
+            const GUID &guid = ace.object.object.type.type;
+            const QPair<quint64, quint64> key = guid_key_from_bytes(QByteArray::fromRawData((const char *) &guid, sizeof(GUID)));
+
+            for (const int i : object_right_map.value(key)) {
+                apply_ace(i, ace.access_mask, allow);
+            }
+        } else {
+            for (int i = 0; i < right_count; i++) {
+                apply_ace(i, ace.access_mask, allow);
+            }
+        }
+    }
+
+    QList<bool> out;
+    out.reserve(right_count);
+
+    for (int i = 0; i < right_count; i++) {
+        const bool allowed = ((allowed_list[i] & mask_list[i]) == mask_list[i]);
+
+        out.append(allowed);
+    }
 
     return out;
 }
@@ -551,11 +916,11 @@ void security_descriptor_print(security_descriptor *sd, AdInterface &ad) {
 void security_descriptor_add_right_base(security_descriptor *sd, const QByteArray &trustee, const uint32_t access_mask_arg, const QByteArray &object_type, const bool allow) {
     const uint32_t access_mask = ad_security_map_access_mask(access_mask_arg);
 
-    const QList<security_ace> dacl = security_descriptor_get_dacl(sd);
+    const int ace_count = (sd->dacl != NULL) ? sd->dacl->num_aces : 0;
 
     const int matching_index = [&]() {
-        for (int i = 0; i < dacl.size(); i++) {
-            const security_ace ace = dacl[i];
+        for (int i = 0; i < ace_count; i++) {
+            const security_ace &ace = sd->dacl->aces[i];
 
             // NOTE: access mask match doesn't matter
             // because we also want to add right to
@@ -574,7 +939,7 @@ void security_descriptor_add_right_base(security_descriptor *sd, const QByteArra
 
     if (matching_index != -1) {
         const bool right_already_set = [&]() {
-            const security_ace matching_ace = dacl[matching_index];
+            const security_ace &matching_ace = sd->dacl->aces[matching_index];
             const bool out = bitmask_is_set(matching_ace.access_mask, access_mask);
 
             return out;
@@ -583,9 +948,8 @@ void security_descriptor_add_right_base(security_descriptor *sd, const QByteArra
         // Matching ace exists, so reuse it by adding
         // given mask to this ace, but only if it's not set already
         if (!right_already_set) {
-            security_ace new_ace = dacl[matching_index];
-            new_ace.access_mask = bitmask_set(new_ace.access_mask, access_mask, true);
-            sd->dacl->aces[matching_index] = new_ace;
+            security_ace &matching_ace = sd->dacl->aces[matching_index];
+            matching_ace.access_mask = bitmask_set(matching_ace.access_mask, access_mask, true);
         }
     } else {
         // No matching ace, so make a new ace for this
@@ -696,67 +1060,67 @@ bool check_ace_match(const security_ace &ace, const QByteArray &trustee, const Q
 void security_descriptor_remove_right_base(security_descriptor *sd, const QByteArray &trustee, const uint32_t access_mask_arg, const QByteArray &object_type, const bool allow) {
     const uint32_t access_mask = ad_security_map_access_mask(access_mask_arg);
 
-    const QList<security_ace> new_dacl = [&]() {
-        QList<security_ace> out;
+    security_acl *dacl = sd->dacl;
+    if (dacl == NULL) {
+        return;
+    }
 
-        const QList<security_ace> old_dacl = security_descriptor_get_dacl(sd);
+    // NOTE: edit DACL in place, moving remaining ace's
+    // to the front, instead of rebuilding it from a
+    // list. This is called many times for each right
+    // edit, so rebuilding was a large part of edit time.
+    uint32_t new_count = 0;
 
-        for (const security_ace &ace : old_dacl) {
-            const bool match = check_ace_match(ace, trustee, object_type, allow, false);
-            const bool ace_mask_contains_mask = bitmask_is_set(ace.access_mask, access_mask);
-
-            if (match && ace_mask_contains_mask) {
-                const security_ace edited_ace = [&]() {
-                    security_ace out_ace = ace;
-
-                    // NOTE: need to handle a special
-                    // case due to read and write
-                    // rights sharing the "read
-                    // control" bit. When setting
-                    // either read/write, don't change
-                    // that shared bit if the other of
-                    // these rights is set
-                    const uint32_t mask_to_unset = [&]() {
-                        const QHash<uint32_t, uint32_t> opposite_map = {
-                            {GENERIC_READ_FIXED, SEC_ADS_GENERIC_WRITE},
-                            {SEC_ADS_GENERIC_WRITE, GENERIC_READ_FIXED},
-                        };
-
-                        if (opposite_map.contains(access_mask)) {
-                            const uint32_t opposite = opposite_map[access_mask];
-                            const bool opposite_is_set = bitmask_is_set(ace.access_mask, opposite);
-
-                            if (opposite_is_set) {
-                                const uint32_t out_mask = (access_mask & ~SEC_STD_READ_CONTROL);
-
-                                return out_mask;
-                            } else {
-                                return access_mask;
-                            }
-                        } else {
-                            return access_mask;
-                        }
-                    }();
+    for (uint32_t i = 0; i < dacl->num_aces; i++) {
+        security_ace ace = dacl->aces[i];
 
-                    out_ace.access_mask = bitmask_set(ace.access_mask, mask_to_unset, false);
+        const bool match = check_ace_match(ace, trustee, object_type, allow, false);
+        const bool ace_mask_contains_mask = bitmask_is_set(ace.access_mask, access_mask);
+
+        if (match && ace_mask_contains_mask) {
+            // NOTE: need to handle a special
+            // case due to read and write
+            // rights sharing the "read
+            // control" bit. When setting
+            // either read/write, don't change
+            // that shared bit if the other of
+            // these rights is set
+            const uint32_t mask_to_unset = [&]() {
+                const QHash<uint32_t, uint32_t> opposite_map = {
+                    {GENERIC_READ_FIXED, SEC_ADS_GENERIC_WRITE},
+                    {SEC_ADS_GENERIC_WRITE, GENERIC_READ_FIXED},
+                };
+
+                if (opposite_map.contains(access_mask)) {
+                    const uint32_t opposite = opposite_map[access_mask];
+                    const bool opposite_is_set = bitmask_is_set(ace.access_mask, opposite);
+
+                    if (opposite_is_set) {
+                        const uint32_t out_mask = (access_mask & ~SEC_STD_READ_CONTROL);
+
+                        return out_mask;
+                    } else {
+                        return access_mask;
+                    }
+                } else {
+                    return access_mask;
+                }
+            }();
 
-                    return out_ace;
-                }();
+            ace.access_mask = bitmask_set(ace.access_mask, mask_to_unset, false);
 
-                const bool edited_ace_became_empty = (edited_ace.access_mask == 0);
+            const bool ace_became_empty = (ace.access_mask == 0);
 
-                if (!edited_ace_became_empty) {
-                    out.append(edited_ace);
-                }
-            } else {
-                out.append(ace);
+            if (ace_became_empty) {
+                continue;
             }
         }
 
-        return out;
-    }();
+        dacl->aces[new_count] = ace;
+        new_count++;
+    }
 
-    ad_security_replace_dacl(sd, new_dacl);
+    dacl->num_aces = new_count;
 }
 
 void security_descriptor_remove_trustee(security_descriptor *sd, const QList<QByteArray> &trustee_list) {
@@ -809,6 +1173,10 @@ bool security_descriptor_verify_acl_order(security_descriptor *sd) {
 
         QList<security_ace> dacl = security_descriptor_get_dacl(copy);
 
+        if (dacl.isEmpty()) {
+            return out;
+        }
+
         security_ace curr = dacl.takeFirst();
 
         while (!dacl.isEmpty()) {
@@ -831,6 +1199,59 @@ bool security_descriptor_verify_acl_order(security_descriptor *sd) {
     return order_is_correct;
 }
 
+// NOTE: this is called for every object in a subtree,
+// so avoid copying sd and DACL, unlike
+// security_descriptor_verify_acl_order()
+SecurityAuditResult ad_security_audit_sd(const QByteArray &sd_bytes, const QByteArray &trustee) {
+    SecurityAuditResult out;
+    out.parse_failed = false;
+    out.explicit_ace_count = 0;
+    out.acl_order_is_correct = true;
+
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+
+    DATA_BLOB blob = data_blob_const(sd_bytes.data(), sd_bytes.size());
+    security_descriptor *sd = talloc(tmp_ctx, struct security_descriptor);
+    const enum ndr_err_code ndr_err = ndr_pull_struct_blob(&blob, sd, sd, (ndr_pull_flags_fn_t) ndr_pull_security_descriptor);
+
+    if (!NDR_ERR_CODE_IS_SUCCESS(ndr_err)) {
+        out.parse_failed = true;
+
+        talloc_free(tmp_ctx);
+
+        return out;
+    }
+
+    const security_acl *dacl = sd->dacl;
+
+    if (dacl != nullptr) {
+        const QByteArray trustee_key = [&]() {
+            if (trustee.isEmpty()) {
+                return QByteArray();
+            } else {
+                return dom_sid_key(dom_sid_from_bytes(trustee));
+            }
+        }();
+
+        for (size_t i = 0; i < dacl->num_aces; i++) {
+            const security_ace &ace = dacl->aces[i];
+
+            const bool ace_is_inherited = bitmask_is_set(ace.flags, SEC_ACE_FLAG_INHERITED_ACE);
+            if (!trustee_key.isEmpty() && !ace_is_inherited && dom_sid_key(ace.trustee) == trustee_key) {
+                out.explicit_ace_count++;
+            }
+
+            if (i > 0 && ace_compare_simplified(dacl->aces[i - 1], ace) > 0) {
+                out.acl_order_is_correct = false;
+            }
+        }
+    }
+
+    talloc_free(tmp_ctx);
+
+    return out;
+}
+
 QString ad_security_get_right_name(AdConfig *adconfig, const uint32_t access_mask, const QByteArray &object_type, const QLocale::Language language) {
     const QString object_type_name = adconfig->get_right_name(object_type, language);
 
@@ -854,11 +1275,16 @@ QString ad_security_get_right_name(AdConfig *adconfig, const uint32_t access_mas
     }
 }
 
-void security_descriptor_add_right(security_descriptor *sd, AdConfig *adconfig, const QList<QString> &class_list, const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type, const bool allow) {
+void security_descriptor_add_right_unsorted(security_descriptor *sd, AdConfig *adconfig, const QList<QString> &class_list, const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type, const bool allow) {
     const QList<SecurityRight> superior_list = ad_security_get_superior_right_list(access_mask, object_type);
+
+    // NOTE: index is reused for all superiors and only
+    // rebuilt after sd is modified
+    SecurityDaclIndex dacl_index = SecurityDaclIndex(sd);
+
     for (const SecurityRight &superior : superior_list) {
         const bool opposite_superior_is_set = [&]() {
-            const SecurityRightState state = security_descriptor_get_right(sd, trustee, superior.access_mask, superior.object_type);
+            const SecurityRightState state = dacl_index.get_right(trustee, superior.access_mask, superior.object_type);
             const SecurityRightStateType type = [&]() {
                 // NOTE: opposite!
                 if (!allow) {
@@ -888,6 +1314,8 @@ void security_descriptor_add_right(security_descriptor *sd, AdConfig *adconfig,
 
             security_descriptor_add_right_base(sd, trustee, subordinate.access_mask, subordinate.object_type, !allow);
         }
+
+        dacl_index = SecurityDaclIndex(sd);
     }
 
     // Remove subordinates
@@ -906,17 +1334,25 @@ void security_descriptor_add_right(security_descriptor *sd, AdConfig *adconfig,
 
     // Add target
     security_descriptor_add_right_base(sd, trustee, access_mask, object_type, allow);
+}
+
+void security_descriptor_add_right(security_descriptor *sd, AdConfig *adconfig, const QList<QString> &class_list, const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type, const bool allow) {
+    security_descriptor_add_right_unsorted(sd, adconfig, class_list, trustee, access_mask, object_type, allow);
 
     security_descriptor_sort_dacl(sd);
 }
 
-void security_descriptor_remove_right(security_descriptor *sd, AdConfig *adconfig, const QList<QString> &class_list, const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type, const bool allow) {
+void security_descriptor_remove_right_unsorted(security_descriptor *sd, AdConfig *adconfig, const QList<QString> &class_list, const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type, const bool allow) {
     const QList<SecurityRight> target_superior_list = ad_security_get_superior_right_list(access_mask, object_type);
 
+    // NOTE: index is reused for all superiors and only
+    // rebuilt after sd is modified
+    SecurityDaclIndex dacl_index = SecurityDaclIndex(sd);
+
     // Remove superiors
     for (const SecurityRight &superior : target_superior_list) {
         const bool superior_is_set = [&]() {
-            const SecurityRightState state = security_descriptor_get_right(sd, trustee, superior.access_mask, superior.object_type);
+            const SecurityRightState state = dacl_index.get_right(trustee, superior.access_mask, superior.object_type);
             const SecurityRightStateType type = [&]() {
                 if (allow) {
                     return SecurityRightStateType_Allow;
@@ -942,6 +1378,8 @@ void security_descriptor_remove_right(security_descriptor *sd, AdConfig *adconfi
         for (const SecurityRight &subordinate : superior_subordinate_list) {
             security_descriptor_add_right_base(sd, trustee, subordinate.access_mask, subordinate.object_type, allow);
         }
+
+        dacl_index = SecurityDaclIndex(sd);
     }
 
     // Remove target right
@@ -952,11 +1390,221 @@ void security_descriptor_remove_right(security_descriptor *sd, AdConfig *adconfi
     for (const SecurityRight &subordinate : tarad_security_get_subordinate_right_list) {
         security_descriptor_add_right_base(sd, trustee, subordinate.access_mask, subordinate.object_type, allow);
     }
+}
+
+void security_descriptor_remove_right(security_descriptor *sd, AdConfig *adconfig, const QList<QString> &class_list, const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type, const bool allow) {
+    security_descriptor_remove_right_unsorted(sd, adconfig, class_list, trustee, access_mask, object_type, allow);
 
     security_descriptor_sort_dacl(sd);
 }
 
+void security_descriptor_apply_right_edits(security_descriptor *sd, AdConfig *adconfig, const QList<QString> &class_list, const QList<SecurityRightEdit> &edit_list) {
+    for (const SecurityRightEdit &edit : edit_list) {
+        switch (edit.type) {
+            case SecurityRightEditType_Add: {
+                security_descriptor_add_right_unsorted(sd, adconfig, class_list, edit.trustee, edit.access_mask, edit.object_type, edit.allow);
+
+                break;
+            }
+            case SecurityRightEditType_Remove: {
+                security_descriptor_remove_right_unsorted(sd, adconfig, class_list, edit.trustee, edit.access_mask, edit.object_type, edit.allow);
+
+                break;
+            }
+            case SecurityRightEditType_AddBase: {
+                security_descriptor_add_right_base(sd, edit.trustee, edit.access_mask, edit.object_type, edit.allow);
+
+                break;
+            }
+            case SecurityRightEditType_RemoveBase: {
+                security_descriptor_remove_right_base(sd, edit.trustee, edit.access_mask, edit.object_type, edit.allow);
+
+                break;
+            }
+        }
+    }
+
+    security_descriptor_sort_dacl(sd);
+}
+
+bool ad_security_apply_right_edits_to_bytes(AdConfig *adconfig, const QByteArray &sd_bytes, const QList<QString> &class_list, const QList<SecurityRightEdit> &edit_list, QByteArray *sd_bytes_out, bool *changed_out) {
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+
+    const security_descriptor *old_sd = security_descriptor_parse(tmp_ctx, sd_bytes);
+    if (old_sd == nullptr) {
+        talloc_free(tmp_ctx);
+
+        return false;
+    }
+
+    security_descriptor *sd = security_descriptor_copy(tmp_ctx, old_sd);
+    security_descriptor_apply_right_edits(sd, adconfig, class_list, edit_list);
+
+    // NOTE: can't compare bytes because re-encoding and
+    // sorting changes them even if edits changed nothing
+    *changed_out = !security_descriptor_dacl_equal(old_sd, sd);
+
+    DATA_BLOB blob;
+    const enum ndr_err_code ndr_err = ndr_push_struct_blob(&blob, tmp_ctx, sd, (ndr_push_flags_fn_t) ndr_push_security_descriptor);
+
+    if (!NDR_ERR_CODE_IS_SUCCESS(ndr_err)) {
+        talloc_free(tmp_ctx);
+
+        return false;
+    }
+
+    *sd_bytes_out = QByteArray((char *) blob.data, blob.length);
+
+    talloc_free(tmp_ctx);
+
+    return true;
+}
+
+// Returns true if DACL's contain the same ace's. Order of
+// ace's is ignored.
+bool security_descriptor_dacl_equal(const security_descriptor *sd1, const security_descriptor *sd2) {
+    const QList<security_ace> dacl1 = security_descriptor_get_dacl(sd1);
+    QList<security_ace> dacl2 = security_descriptor_get_dacl(sd2);
+
+    if (dacl1.size() != dacl2.size()) {
+        return false;
+    }
+
+    for (const security_ace &ace : dacl1) {
+        const int match_index = [&]() {
+            for (int i = 0; i < dacl2.size(); i++) {
+                if (security_ace_equal(&ace, &dacl2.at(i))) {
+                    return i;
+                }
+            }
+
+            return -1;
+        }();
+
+        if (match_index == -1) {
+            return false;
+        }
+
+        dacl2.removeAt(match_index);
+    }
+
+    return true;
+}
+
+QList<SecurityRightEdit> ad_security_get_protect_against_deletion_edit_list(const bool enabled) {
+    QList<SecurityRightEdit> out;
+
+    const QByteArray trustee_everyone = sid_string_to_bytes(SID_WORLD);
+
+    // NOTE: same as
+    // ad_security_set_protected_against_deletion(), only
+    // deny entries are added/removed
+    for (const uint32_t &mask : protect_deletion_mask_list) {
+        SecurityRightEdit edit;
+        edit.type = (enabled ? SecurityRightEditType_AddBase : SecurityRightEditType_RemoveBase);
+        edit.trustee = trustee_everyone;
+        edit.access_mask = mask;
+        edit.object_type = QByteArray();
+        edit.allow = false;
+
+        out.append(edit);
+    }
+
+    return out;
+}
+
+bool ad_security_edit_rights(AdInterface &ad, const QList<QString> &dn_list, const QList<SecurityRightEdit> &edit_list, QHash<QString, QString> *error_map_out) {
+    if (dn_list.isEmpty() || edit_list.isEmpty()) {
+        return true;
+    }
+
+    // Load descriptors of all objects in one search
+    const QHash<QString, AdObject> object_map = [&]() {
+        const QString base = ad.adconfig()->domain_dn();
+        const SearchScope scope = SearchScope_All;
+        const QString filter = filter_dn_list(dn_list);
+        const QList<QString> attributes = {
+            ATTRIBUTE_SECURITY_DESCRIPTOR,
+            ATTRIBUTE_OBJECT_CLASS,
+        };
+        const QHash<QString, AdObject> results = ad.search(base, scope, filter, attributes);
+
+        QHash<QString, AdObject> out;
+
+        for (const AdObject &object : results.values()) {
+            const QString key = object.get_dn().toLower();
+            out[key] = object;
+        }
+
+        return out;
+    }();
+
+    bool total_success = true;
+
+    QHash<QString, QByteArray> sd_bytes_map;
+
+    auto add_error = [&](const QString &dn, const QString &error) {
+        total_success = false;
+
+        if (error_map_out != nullptr) {
+            error_map_out->insert(dn, error);
+        }
+    };
+
+    for (const QString &dn : dn_list) {
+        const QString key = dn.toLower();
+
+        // NOTE: search doesn't fail for missing objects,
+        // they are just not in results
+        if (!object_map.contains(key)) {
+            add_error(dn, QCoreApplication::translate("ad_security.cpp", "Object not found"));
+
+            continue;
+        }
+
+        const AdObject object = object_map[key];
+        const QByteArray old_sd_bytes = object.get_value(ATTRIBUTE_SECURITY_DESCRIPTOR);
+        const QList<QString> class_list = object.get_strings(ATTRIBUTE_OBJECT_CLASS);
+
+        QByteArray new_sd_bytes;
+        bool sd_changed;
+        const bool edit_success = ad_security_apply_right_edits_to_bytes(ad.adconfig(), old_sd_bytes, class_list, edit_list, &new_sd_bytes, &sd_changed);
+
+        if (!edit_success) {
+            add_error(dn, QCoreApplication::translate("ad_security.cpp", "Failed to parse security descriptor"));
+
+            continue;
+        }
+
+        // NOTE: skip objects that already have all of
+        // the rights
+        if (sd_changed) {
+            sd_bytes_map[object.get_dn()] = new_sd_bytes;
+        }
+    }
+
+    const bool set_dacl = true;
+    const bool apply_success = ad.attribute_replace_value_batch(sd_bytes_map, ATTRIBUTE_SECURITY_DESCRIPTOR, DoStatusMsg_Yes, set_dacl, error_map_out);
+
+    total_success = (total_success && apply_success);
+
+    return total_success;
+}
+
+QHash<QString, QList<SecurityRight>> right_list_cache;
+QMutex right_list_cache_mutex;
+
 QList<SecurityRight> ad_security_get_right_list_for_class(AdConfig *adconfig, const QList<QString> &class_list) {
+    // NOTE: include adconfig in key, in case there are
+    // multiple instances
+    const QString cache_key = QString("%1:%2").arg((quintptr) adconfig).arg(class_list.join(','));
+
+    QMutexLocker locker(&right_list_cache_mutex);
+
+    if (right_list_cache.contains(cache_key)) {
+        return right_list_cache[cache_key];
+    }
+
     QList<SecurityRight> out;
 
     for (const uint32_t &access_mask : common_rights_list) {
@@ -990,9 +1638,17 @@ QList<SecurityRight> ad_security_get_right_list_for_class(AdConfig *adconfig, co
         }
     }
 
+    right_list_cache.insert(cache_key, out);
+
     return out;
 }
 
+void ad_security_clear_right_list_cache() {
+    QMutexLocker locker(&right_list_cache_mutex);
+
+    right_list_cache.clear();
+}
+
 QList<SecurityRight> ad_security_get_superior_right_list(const uint32_t access_mask, const QByteArray &object_type) {
     QList<SecurityRight> out;
 
@@ -29,7 +29,10 @@
 #include "ad_defines.h"
 
 #include <QByteArray>
+#include <QHash>
 #include <QLocale>
+#include <QPair>
+#include <QVector>
 
 class AdInterface;
 class AdConfig;
@@ -69,6 +72,45 @@ public:
     QByteArray object_type;
 };
 
+/**
+ * Index of a DACL with ACE's grouped by trustee and object
+ * type. Used to get states of many rights at once, for
+ * example to fill a checklist of rights for a trustee.
+ * Results are the same as from
+ * security_descriptor_get_right(), but DACL is traversed
+ * only once, when index is created. Note that index is not
+ * updated when descriptor changes, so it needs to be
+ * recreated after edits.
+ */
+class SecurityDaclIndex {
+public:
+    SecurityDaclIndex(const security_descriptor *sd);
+
+    SecurityRightState get_right(const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type) const;
+    QList<SecurityRightState> get_right_list(const QByteArray &trustee, const QList<SecurityRight> &right_list) const;
+
+private:
+    typedef QPair<quint64, quint64> GuidKey;
+
+    class Entry {
+    public:
+        uint32_t access_mask;
+
+        // Bits for each pair of inherited and type state
+        int state_bits;
+    };
+
+    class TrusteeEntry {
+    public:
+        QVector<Entry> plain_list;
+        QHash<GuidKey, QVector<Entry>> object_map;
+    };
+
+    QHash<QByteArray, TrusteeEntry> trustee_map;
+
+    int get_state_bits(const TrusteeEntry &trustee_entry, const uint32_t access_mask, const QByteArray &object_type) const;
+};
+
 QString ad_security_get_well_known_trustee_name(const QByteArray &trustee);
 QString ad_security_get_trustee_name(AdInterface &ad, const QByteArray &trustee);
 bool ad_security_get_protected_against_deletion(const AdObject &object);
@@ -82,13 +124,27 @@ bool ad_security_replace_security_descriptor(AdInterface &ad, const QString &dn,
 QString ad_security_get_right_name(AdConfig *adconfig, const uint32_t access_mask, const QByteArray &object_type, QLocale::Language language);
 
 // NOTE: returned sd needs to be free'd with
-// security_descriptor_free()
+// security_descriptor_free(). If bytes are not a valid
+// sd, returns an empty sd.
 security_descriptor *security_descriptor_make_from_bytes(const QByteArray &sd_bytes);
 security_descriptor *security_descriptor_make_from_bytes(TALLOC_CTX *mem_ctx, const QByteArray &sd_bytes);
 security_descriptor *security_descriptor_copy(security_descriptor *sd);
+
+// Returns sd parsed from bytes using a per-thread cache,
+// so repeated access to same sd doesn't decode it again.
+// Returned sd is owned by the cache, it must not be
+// modified or free'd and is only valid until the next
+// call to this f-n in the same thread. Use
+// security_descriptor_make_from_bytes() to get a copy
+// that can be modified. Returns nullptr if bytes are not
+// a valid sd.
+const security_descriptor *security_descriptor_get_cached(const QByteArray &sd_bytes);
 void security_descriptor_free(security_descriptor *sd);
 void security_descriptor_sort_dacl(security_descriptor *sd);
 QList<QByteArray> security_descriptor_get_trustee_list(security_descriptor *sd);
+
+// NOTE: builds a SecurityDaclIndex for every call. To get
+// states of many rights of same sd, use an index directly.
 SecurityRightState security_descriptor_get_right(const security_descriptor *sd, const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type);
 void security_descriptor_print(security_descriptor *sd, AdInterface &ad);
 bool security_descriptor_verify_acl_order(security_descriptor *sd);
@@ -98,6 +154,24 @@ bool security_descriptor_verify_acl_order(security_descriptor *sd);
 // still have ace's remaining after this is called.
 void security_descriptor_remove_trustee(security_descriptor *sd, const QList<QByteArray> &trustee_list);
 
+enum SecurityRightEditType {
+    SecurityRightEditType_Add,
+    SecurityRightEditType_Remove,
+    // "Base" edits only add/remove matching ace, without
+    // touching superiors, subordinates and opposites
+    SecurityRightEditType_AddBase,
+    SecurityRightEditType_RemoveBase,
+};
+
+class SecurityRightEdit {
+public:
+    SecurityRightEditType type;
+    QByteArray trustee;
+    uint32_t access_mask;
+    QByteArray object_type;
+    bool allow;
+};
+
 // "Complete" versions of add/remove right f-ns that do A
 // LOT more than just add rights. They also take care
 // of superior and subordinate rights to follow a logic
@@ -105,7 +179,79 @@ void security_descriptor_remove_trustee(security_descriptor *sd, const QList<QBy
 void security_descriptor_add_right(security_descriptor *sd, AdConfig *adconfig, const QList<QString> &class_list, const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type, const bool allow);
 void security_descriptor_remove_right(security_descriptor *sd, AdConfig *adconfig, const QList<QString> &class_list, const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type, const bool allow);
 
+// Applies a list of right edits to sd. Result is the same
+// as calling add/remove right f-ns one by one, but DACL is
+// sorted only once, after all edits.
+void security_descriptor_apply_right_edits(security_descriptor *sd, AdConfig *adconfig, const QList<QString> &class_list, const QList<SecurityRightEdit> &edit_list);
+
+// Parses sd bytes, applies edits and writes the result to
+// "sd_bytes_out". "changed_out" is set to false if DACL
+// already had all of the rights, in which case there's
+// no need to write the result. Returns false if sd bytes
+// couldn't be parsed. Safe to call from multiple threads
+// at once.
+bool ad_security_apply_right_edits_to_bytes(AdConfig *adconfig, const QByteArray &sd_bytes, const QList<QString> &class_list, const QList<SecurityRightEdit> &edit_list, QByteArray *sd_bytes_out, bool *changed_out);
+
+// Returns edits that enable or disable protection against
+// deletion. Equivalent to
+// ad_security_set_protected_against_deletion().
+QList<SecurityRightEdit> ad_security_get_protect_against_deletion_edit_list(const bool enabled);
+
+// Applies same right edits to security descriptors of
+// many objects. Descriptors are loaded in one search,
+// each descriptor is written once and requests for all
+// objects are sent without waiting for results. Objects
+// which already have all of the rights are not written.
+// Returns true if all objects were updated.
+// "error_map_out" is filled with errors of objects which
+// were not found, had invalid descriptors or failed to
+// update.
+bool ad_security_edit_rights(AdInterface &ad, const QList<QString> &dn_list, const QList<SecurityRightEdit> &edit_list, QHash<QString, QString> *error_map_out = nullptr);
+
+// Returns sid's of principal and all groups it is a
+// member of, including nested groups and primary group.
+// Loaded in one read of constructed "tokenGroups"
+// attribute. Well-known sid's that apply to all
+// authenticated principals are also added. If target is
+// the principal itself, "Principal Self" is added, so that
+// ACE's for SELF apply. Results are cached per principal.
+// Cache is cleared when AdInterface changes memberships or
+// deletes an object, when DC is changed and when AdConfig
+// is reloaded.
+QList<QByteArray> ad_security_get_token(AdInterface &ad, const QString &principal_dn, const QString &target_dn);
+void ad_security_clear_token_cache();
+
+// Evaluates which rights from the list are allowed for
+// a token. ACE's are processed in DACL order and the first
+// ACE that allows or denies a bit decides it's state, same
+// as Windows access check. Right is allowed if all of it's
+// bits are allowed. Owner is implicitly allowed to read
+// and write DACL. Sd without a DACL allows all rights,
+// while an empty DACL allows none. If sd is nullptr, no
+// rights are allowed.
+QList<bool> security_descriptor_get_effective_rights(const security_descriptor *sd, const QList<QByteArray> &token, const QList<SecurityRight> &right_list);
+
+// Result of auditing one security descriptor for
+// ad_security_audit_sd()
+class SecurityAuditResult {
+public:
+    bool parse_failed;
+    int explicit_ace_count;
+    bool acl_order_is_correct;
+};
+
+// Counts explicit (not inherited) ACE's of trustee and
+// checks that DACL is in canonical order. Trustee may be
+// empty, in that case only order is checked. Doesn't use
+// any shared state, so it's safe to call from multiple
+// threads at once.
+SecurityAuditResult ad_security_audit_sd(const QByteArray &sd_bytes, const QByteArray &trustee);
+
+// Returns common rights and extended rights that apply to
+// given classes. Results are memoized per class list, so
+// repeated calls return the same shared list.
 QList<SecurityRight> ad_security_get_right_list_for_class(AdConfig *adconfig, const QList<QString> &class_list);
+void ad_security_clear_right_list_cache();
 QList<SecurityRight> ad_security_get_superior_right_list(const uint32_t access_mask, const QByteArray &object_type);
 QList<SecurityRight> ad_security_get_subordinate_right_list(AdConfig *adconfig, const uint32_t access_mask, const QByteArray &object_type, const QList<QString> &class_list);
 
@@ -0,0 +1,310 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ad_trace.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+
+// NOTE: limit memory used by a long trace, events after
+// the limit are dropped
+const int trace_event_max = 2000000;
+
+class TraceEvent {
+public:
+    char phase;
+    const char *category;
+    const char *name;
+    int tid;
+    qint64 ts_nsec;
+    qint64 dur_nsec;
+    QString id;
+    QJsonObject args;
+};
+
+void trace_add_event(const char phase, const char *category, const char *name, const qint64 ts_nsec, const qint64 dur_nsec, const QString &id, const QJsonObject &args);
+int trace_get_tid_locked();
+QJsonObject trace_event_to_json(const TraceEvent &event, const qint64 pid);
+
+QAtomicInt trace_enabled;
+QElapsedTimer trace_clock;
+
+// NOTE: spans end in multiple threads, so all access to
+// these goes through this mutex
+QMutex trace_mutex;
+QString trace_path;
+QVector<TraceEvent> trace_event_list;
+QHash<Qt::HANDLE, int> trace_tid_map;
+QHash<int, QString> trace_thread_name_map;
+int trace_dropped_count = 0;
+
+bool trace_start(const QString &path) {
+    trace_stop();
+
+    // NOTE: check that file can be written now, instead of
+    // finding out after the whole session
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Failed to open trace file" << path;
+
+        return false;
+    }
+    file.close();
+
+    QMutexLocker locker(&trace_mutex);
+
+    trace_path = path;
+    trace_event_list.clear();
+    trace_tid_map.clear();
+    trace_thread_name_map.clear();
+    trace_dropped_count = 0;
+
+    trace_clock.start();
+    trace_enabled.storeRelease(1);
+
+    return true;
+}
+
+void trace_stop() {
+    if (!trace_is_enabled()) {
+        return;
+    }
+
+    trace_enabled.storeRelease(0);
+
+    QMutexLocker locker(&trace_mutex);
+
+    QFile file(trace_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Failed to open trace file" << trace_path;
+
+        trace_event_list.clear();
+
+        return;
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    // NOTE: write events one by one instead of making one
+    // big document, trace can be large
+    bool is_first_event = true;
+    auto write_event = [&](const QJsonObject &object) {
+        if (!is_first_event) {
+            file.write(",\n");
+        }
+        is_first_event = false;
+
+        file.write(QJsonDocument(object).toJson(QJsonDocument::Compact));
+    };
+
+    file.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    const QString process_name = [&]() {
+        if (QCoreApplication::instance() != nullptr) {
+            return QCoreApplication::applicationName();
+        } else {
+            return QString("admc");
+        }
+    }();
+
+    write_event({
+        {"ph", "M"},
+        {"name", "process_name"},
+        {"pid", pid},
+        {"args", QJsonObject({{"name", process_name}})},
+    });
+
+    for (const int tid : trace_thread_name_map.keys()) {
+        write_event({
+            {"ph", "M"},
+            {"name", "thread_name"},
+            {"pid", pid},
+            {"tid", tid},
+            {"args", QJsonObject({{"name", trace_thread_name_map[tid]}})},
+        });
+    }
+
+    for (const TraceEvent &event : trace_event_list) {
+        write_event(trace_event_to_json(event, pid));
+    }
+
+    if (trace_dropped_count > 0) {
+        qDebug() << "Trace event limit reached, dropped" << trace_dropped_count << "events";
+    }
+
+    file.write("\n]}\n");
+
+    trace_event_list.clear();
+    trace_event_list.squeeze();
+}
+
+bool trace_is_enabled() {
+    return (trace_enabled.loadAcquire() != 0);
+}
+
+void trace_flow_begin(const char *category, const char *name, const QString &id) {
+    if (!trace_is_enabled()) {
+        return;
+    }
+
+    trace_add_event('s', category, name, trace_clock.nsecsElapsed(), 0, id, QJsonObject());
+}
+
+void trace_flow_end(const char *category, const char *name, const QString &id) {
+    if (!trace_is_enabled()) {
+        return;
+    }
+
+    trace_add_event('f', category, name, trace_clock.nsecsElapsed(), 0, id, QJsonObject());
+}
+
+TraceSpan::TraceSpan(const char *category_arg, const char *name_arg) {
+    category = category_arg;
+    name = name_arg;
+    active = trace_is_enabled();
+
+    if (active) {
+        start_nsec = trace_clock.nsecsElapsed();
+    } else {
+        start_nsec = 0;
+    }
+}
+
+TraceSpan::~TraceSpan() {
+    end();
+}
+
+void TraceSpan::add_arg(const char *key, const QJsonValue &value) {
+    if (!active) {
+        return;
+    }
+
+    args.insert(QLatin1String(key), value);
+}
+
+void TraceSpan::end() {
+    if (!active) {
+        return;
+    }
+
+    active = false;
+
+    const qint64 end_nsec = trace_clock.nsecsElapsed();
+
+    trace_add_event('X', category, name, start_nsec, end_nsec - start_nsec, QString(), args);
+}
+
+void trace_add_event(const char phase, const char *category, const char *name, const qint64 ts_nsec, const qint64 dur_nsec, const QString &id, const QJsonObject &args) {
+    QMutexLocker locker(&trace_mutex);
+
+    // NOTE: tracing might have been stopped while span
+    // was open
+    if (!trace_is_enabled()) {
+        return;
+    }
+
+    if (trace_event_list.size() >= trace_event_max) {
+        trace_dropped_count++;
+
+        return;
+    }
+
+    TraceEvent event;
+    event.phase = phase;
+    event.category = category;
+    event.name = name;
+    event.tid = trace_get_tid_locked();
+    event.ts_nsec = ts_nsec;
+    event.dur_nsec = dur_nsec;
+    event.id = id;
+    event.args = args;
+
+    trace_event_list.append(event);
+}
+
+// Maps threads to small numbers so that tracks are easier
+// to read. Also saves thread's name.
+int trace_get_tid_locked() {
+    const Qt::HANDLE handle = QThread::currentThreadId();
+
+    if (trace_tid_map.contains(handle)) {
+        return trace_tid_map[handle];
+    }
+
+    const int tid = trace_tid_map.size() + 1;
+    trace_tid_map[handle] = tid;
+
+    const QString thread_name = [&]() {
+        QThread *thread = QThread::currentThread();
+        const bool is_main_thread = (QCoreApplication::instance() != nullptr && thread == QCoreApplication::instance()->thread());
+
+        if (is_main_thread) {
+            return QString("Main thread");
+        } else if (!thread->objectName().isEmpty()) {
+            return QString("%1 %2").arg(thread->objectName(), QString::number(tid));
+        } else {
+            return QString("Thread %1").arg(tid);
+        }
+    }();
+
+    trace_thread_name_map[tid] = thread_name;
+
+    return tid;
+}
+
+QJsonObject trace_event_to_json(const TraceEvent &event, const qint64 pid) {
+    QJsonObject out = {
+        {"ph", QString(QChar(event.phase))},
+        {"cat", event.category},
+        {"name", event.name},
+        {"pid", pid},
+        {"tid", event.tid},
+        // NOTE: timestamps are in microseconds
+        {"ts", event.ts_nsec / 1000.0},
+    };
+
+    if (event.phase == 'X') {
+        out["dur"] = event.dur_nsec / 1000.0;
+    }
+
+    if (!event.id.isEmpty()) {
+        out["id"] = event.id;
+    }
+
+    // NOTE: bind flow end to the span that encloses it,
+    // by default it's bound to the next span
+    if (event.phase == 'f') {
+        out["bp"] = "e";
+    }
+
+    if (!event.args.isEmpty()) {
+        out["args"] = event.args;
+    }
+
+    return out;
+}
@@ -0,0 +1,93 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AD_TRACE_H
+#define AD_TRACE_H
+
+/**
+ * Scoped tracing spans for finding out where time goes in
+ * searches and console updates. Spans are written to a
+ * file in Chrome trace event format, which can be opened
+ * in Perfetto (ui.perfetto.dev) or chrome://tracing.
+ *
+ * Tracing is compiled in but disabled by default. While
+ * disabled, a span costs one atomic load. Start tracing
+ * with trace_start(), events are kept in memory and
+ * written to file by trace_stop().
+ *
+ * Spans nest by scope, each thread gets it's own track.
+ * Work which continues in another thread, for example
+ * results passed through a queued signal, can be linked
+ * with flow events, which are drawn as arrows.
+ *
+ * NOTE: category and name of spans and flows must be
+ * string literals, they are stored as pointers.
+ */
+
+#include <QJsonObject>
+#include <QString>
+
+// Returns false if failed to open output file
+bool trace_start(const QString &path);
+
+// Writes collected events to output file and disables
+// tracing
+void trace_stop();
+
+bool trace_is_enabled();
+
+// Flow events connect the span that is open at
+// trace_flow_begin() in one thread to the span that is
+// open at trace_flow_end() in another thread. Id must be
+// the same for both calls and unique among flows with
+// same name.
+void trace_flow_begin(const char *category, const char *name, const QString &id);
+void trace_flow_end(const char *category, const char *name, const QString &id);
+
+class TraceSpan {
+public:
+    TraceSpan(const char *category, const char *name);
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+    // Arguments are shown in span details. Does nothing if
+    // tracing is disabled.
+    void add_arg(const char *key, const QJsonValue &value);
+
+    // Ends span before end of scope
+    void end();
+
+private:
+    const char *category;
+    const char *name;
+    qint64 start_nsec;
+    bool active;
+    QJsonObject args;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// Span for the rest of current scope
+#define TRACE_SCOPE(category, name) TraceSpan TRACE_CONCAT(trace_span_, __LINE__)(category, name)
+
+#endif /* AD_TRACE_H */
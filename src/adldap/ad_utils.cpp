@@ -22,6 +22,7 @@
 
 #include "ad_config.h"
 #include "ad_display.h"
+#include "ad_dn.h"
 #include "samba/dom_sid.h"
 
 #include <krb5.h>
@@ -34,6 +35,9 @@
 #include <QLocale>
 #include <QString>
 #include <QTranslator>
+#include <cctype>
+#include <climits>
+#include <cstring>
 
 #define GENERALIZED_TIME_FORMAT_STRING "yyyyMMddhhmmss.zZ"
 #define UTC_TIME_FORMAT_STRING "yyMMddhhmmss.zZ"
@@ -41,6 +45,20 @@
 const QDateTime ntfs_epoch = QDateTime(QDate(1601, 1, 1), QTime(), Qt::UTC);
 
 QString escape_name_for_dn(const QString &unescaped);
+int qstring_to_ascii_buffer(const QString &string, char *out, const int out_size);
+char *buffer_append_decimal(char *out, quint64 value);
+char *buffer_append_hex(char *out, quint64 value);
+int hex_char_value(const char c);
+bool buffer_parse_sid_number(const char **p, const char *end, quint64 *out);
+
+static_assert(SID_BYTES_SIZE == sizeof(dom_sid), "SID_BYTES_SIZE must match size of dom_sid");
+
+const char hex_digit_list[] = "0123456789abcdef";
+
+// NOTE: Windows displays first 3 segments of a guid in
+// reversed byte order. This maps display position of a
+// byte to it's position in guid bytes and vice versa.
+const int guid_byte_order[GUID_BYTES_SIZE] = {3, 2, 1, 0, 5, 4, 7, 6, 8, 9, 10, 11, 12, 13, 14, 15};
 
 bool large_integer_datetime_is_never(const QString &value) {
     const bool is_never = (value == AD_LARGE_INTEGER_DATETIME_NEVER_1 || value == AD_LARGE_INTEGER_DATETIME_NEVER_2);
@@ -226,8 +244,8 @@ bool ad_string_to_bool(const QString &string) {
 // =>
 // "CN=foo"
 QString dn_get_rdn(const QString &dn) {
-    const QStringList exploded_dn = dn.split(',');
-    const QString rdn = exploded_dn[0];
+    const DnView dn_view(dn);
+    const QString rdn = dn_view.rdn().toString();
 
     return rdn;
 }
@@ -236,50 +254,44 @@ QString dn_get_rdn(const QString &dn) {
 // =>
 // "foo"
 QString dn_get_name(const QString &dn) {
-    int equals_i = dn.indexOf('=') + 1;
-    int comma_i = dn.indexOf(',');
-    int segment_length = comma_i - equals_i;
-
-    QString name = dn.mid(equals_i, segment_length);
-
-    // Unescape name
-    name.replace("\\?", "?");
+    const DnView dn_view(dn);
+    const QString name = dn_view.name();
 
     return name;
 }
 
 QString dn_get_parent(const QString &dn) {
-    const int comma_i = dn.indexOf(',');
-    const QString parent_dn = dn.mid(comma_i + 1);
+    const DnView dn_view(dn);
+    const QString parent_dn = dn_view.parent().toString();
 
     return parent_dn;
 }
 
 QString dn_get_parent_canonical(const QString &dn) {
-    const QString parent_dn = dn_get_parent(dn);
+    const DnView dn_view(dn);
 
-    return dn_canonical(parent_dn);
+    return dn_view.parent_canonical();
 }
 
 QString dn_rename(const QString &dn, const QString &new_name) {
-    const QStringList exploded_dn = dn.split(',');
-
-    const QString new_rdn = [=]() {
-        const QString old_rdn = exploded_dn[0];
-        const int prefix_index = old_rdn.indexOf('=') + 1;
-        const QString prefix = old_rdn.left(prefix_index);
+    const DnView dn_view(dn);
 
+    const QString new_rdn = [&]() {
+        const QString prefix = dn_view.rdn_type().toString() + "=";
         const QString new_name_escaped = escape_name_for_dn(new_name);
 
         return (prefix + new_name_escaped);
     }();
 
-    QStringList new_exploded_dn(exploded_dn);
-    new_exploded_dn.replace(0, new_rdn);
+    const QString parent_dn = dn_view.parent().toString();
 
-    const QString new_dn = new_exploded_dn.join(',');
+    if (parent_dn.isEmpty()) {
+        return new_rdn;
+    } else {
+        const QString new_dn = QString("%1,%2").arg(new_rdn, parent_dn);
 
-    return new_dn;
+        return new_dn;
+    }
 }
 
 QString dn_move(const QString &dn, const QString &new_parent_dn) {
@@ -293,11 +305,9 @@ QString dn_move(const QString &dn, const QString &new_parent_dn) {
 // =>
 // "domain.com/bar/foo"
 QString dn_canonical(const QString &dn) {
-    char *canonical_cstr = ldap_dn2ad_canonical(cstr(dn));
-    const QString canonical = QString(canonical_cstr);
-    ldap_memfree(canonical_cstr);
+    const DnView dn_view(dn);
 
-    return canonical;
+    return dn_view.canonical();
 }
 
 QString dn_from_name_and_parent(const QString &name, const QString &parent, const QString &object_class) {
@@ -357,6 +367,14 @@ QString get_default_domain_from_krb5() {
     return out;
 }
 
+QString csv_escape(const QString &value) {
+    QString out = value;
+    out.replace("\"", "\"\"");
+    out = QString("\"%1\"").arg(out);
+
+    return out;
+}
+
 int bitmask_set(const int input_mask, const int mask_to_set, const bool is_set) {
     if (is_set) {
         return input_mask | mask_to_set;
@@ -369,19 +387,78 @@ bool bitmask_is_set(const int input_mask, const int mask_to_read) {
     return ((input_mask & mask_to_read) == mask_to_read);
 }
 
-const char *cstr(const QString &qstr) {
-    static QList<QByteArray> buffer;
+CString::CString(const QString &string) {
+    // NOTE: a utf16 code unit takes at most 3 bytes in
+    // utf8, surrogate pairs take 4 bytes for 2 units
+    const bool fits_in_stack_buffer = (string.size() * 3 < (int) sizeof(stack_buffer));
+
+    if (fits_in_stack_buffer) {
+        const QChar *string_data = string.constData();
+        const int string_size = string.size();
+        char *p = stack_buffer;
+
+        for (int i = 0; i < string_size; i++) {
+            uint c = string_data[i].unicode();
+
+            if (QChar::isHighSurrogate(c) && i + 1 < string_size && QChar::isLowSurrogate(string_data[i + 1].unicode())) {
+                c = QChar::surrogateToUcs4(c, string_data[i + 1].unicode());
+                i++;
+            } else if (QChar::isSurrogate(c)) {
+                c = QChar::ReplacementCharacter;
+            }
+
+            if (c < 0x80) {
+                *p++ = (char) c;
+            } else if (c < 0x800) {
+                *p++ = (char) (0xC0 | (c >> 6));
+                *p++ = (char) (0x80 | (c & 0x3F));
+            } else if (c < 0x10000) {
+                *p++ = (char) (0xE0 | (c >> 12));
+                *p++ = (char) (0x80 | ((c >> 6) & 0x3F));
+                *p++ = (char) (0x80 | (c & 0x3F));
+            } else {
+                *p++ = (char) (0xF0 | (c >> 18));
+                *p++ = (char) (0x80 | ((c >> 12) & 0x3F));
+                *p++ = (char) (0x80 | ((c >> 6) & 0x3F));
+                *p++ = (char) (0x80 | (c & 0x3F));
+            }
+        }
+
+        *p = '\0';
+
+        data = stack_buffer;
+        length = p - stack_buffer;
+    } else {
+        heap_buffer = string.toUtf8();
+
+        data = heap_buffer.constData();
+        length = heap_buffer.size();
+    }
+}
+
+const char *CString::get() const {
+    return data;
+}
+
+int CString::size() const {
+    return length;
+}
 
-    const QByteArray bytes = qstr.toUtf8();
-    buffer.append(bytes);
+CStringList::CStringList(const QList<QString> &list) {
+    array.reserve(list.size() + 1);
 
-    // Limit buffer to 100 strings
-    if (buffer.size() > 100) {
-        buffer.removeAt(0);
+    // NOTE: QByteArray data is stable as long as it's not
+    // modified, so pointers stay valid when list grows
+    for (const QString &string : list) {
+        bytes_list.append(string.toUtf8());
+        array.append(bytes_list.last().data());
     }
 
-    // NOTE: return data of bytes in buffer NOT the temp local bytes
-    return buffer.last().constData();
+    array.append(NULL);
+}
+
+char **CStringList::get() {
+    return array.data();
 }
 
 bool load_adldap_translation(QTranslator &translator, const QLocale &locale) {
@@ -393,43 +470,223 @@ QByteArray guid_string_to_bytes(const QString &guid_string) {
         return QByteArray();
     }
 
-    const QList<QByteArray> segment_list = [&]() {
-        QList<QByteArray> out;
+    // NOTE: leave room for braces
+    char string_buffer[GUID_STRING_BUFFER_SIZE + 2];
+    const int length = qstring_to_ascii_buffer(guid_string, string_buffer, sizeof(string_buffer));
+    if (length == -1) {
+        return QByteArray();
+    }
+
+    char guid_bytes[GUID_BYTES_SIZE];
+    const bool parse_success = guid_from_string_buffer(string_buffer, length, guid_bytes);
+    if (!parse_success) {
+        return QByteArray();
+    }
+
+    const QByteArray out = QByteArray(guid_bytes, GUID_BYTES_SIZE);
+
+    return out;
+}
+
+QByteArray sid_string_to_bytes(const QString &sid_string) {
+    char string_buffer[SID_STRING_BUFFER_SIZE];
+    const int length = qstring_to_ascii_buffer(sid_string, string_buffer, SID_STRING_BUFFER_SIZE);
+    if (length == -1) {
+        return QByteArray();
+    }
+
+    char sid_bytes[SID_BYTES_SIZE];
+    const bool parse_success = sid_from_string_buffer(string_buffer, length, sid_bytes);
+    if (!parse_success) {
+        return QByteArray();
+    }
+
+    // NOTE: output is the full dom_sid struct, including
+    // unused sub auths, same as what samba f-ns produce
+    const QByteArray out = QByteArray(sid_bytes, SID_BYTES_SIZE);
+
+    return out;
+}
+
+// NOTE: sid bytes have the same layout as dom_sid:
+// revision, sub auth count, 6 byte big endian identifier
+// authority and then up to 15 sub auths in host byte
+// order. Output matches samba's dom_sid_string().
+int sid_to_string_buffer(const char *sid_bytes, const int size, char *out) {
+    if (size < 8) {
+        return -1;
+    }
+
+    const int num_auths = (uchar) sid_bytes[1];
+    if (num_auths > 15 || size < 8 + 4 * num_auths) {
+        return -1;
+    }
+
+    char *p = out;
+
+    *p++ = 'S';
+    *p++ = '-';
+    p = buffer_append_decimal(p, (uchar) sid_bytes[0]);
+    *p++ = '-';
+
+    quint64 id_auth = 0;
+    for (int i = 0; i < 6; i++) {
+        id_auth = (id_auth << 8) | (uchar) sid_bytes[2 + i];
+    }
+
+    if (id_auth >= 0xFFFFFFFFULL) {
+        *p++ = '0';
+        *p++ = 'x';
+        p = buffer_append_hex(p, id_auth);
+    } else {
+        p = buffer_append_decimal(p, id_auth);
+    }
+
+    for (int i = 0; i < num_auths; i++) {
+        quint32 sub_auth;
+        memcpy(&sub_auth, sid_bytes + 8 + 4 * i, sizeof(quint32));
+
+        *p++ = '-';
+        p = buffer_append_decimal(p, sub_auth);
+    }
+
+    *p = '\0';
+
+    const int length = p - out;
+
+    return length;
+}
+
+// NOTE: accepts same input as samba's dom_sid_parse(),
+// including hex numbers and trailing characters after
+// last sub auth. Output buffer must be SID_BYTES_SIZE.
+bool sid_from_string_buffer(const char *string, const int length, char *out) {
+    memset(out, '\0', SID_BYTES_SIZE);
+
+    const char *p = string;
+    const char *end = string + length;
+
+    if (length < 2 || (p[0] != 'S' && p[0] != 's') || p[1] != '-') {
+        return false;
+    }
+    p += 2;
+
+    quint64 revision;
+    if (!buffer_parse_sid_number(&p, end, &revision)) {
+        return false;
+    }
+
+    if (p == end || *p != '-') {
+        return false;
+    }
+    p++;
+
+    quint64 id_auth;
+    if (!buffer_parse_sid_number(&p, end, &id_auth)) {
+        return false;
+    }
+
+    if (id_auth >= (1ULL << 48)) {
+        return false;
+    }
+
+    out[0] = (char) revision;
 
-        const QList<QString> string_segment_list = guid_string.split('-');
+    for (int i = 0; i < 6; i++) {
+        out[2 + i] = (char) ((id_auth >> (8 * (5 - i))) & 0xFF);
+    }
+
+    int num_auths = 0;
+
+    while (p != end && *p == '-') {
+        p++;
 
-        for (const QString &string_segment : string_segment_list) {
-            const QByteArray segment = QByteArray::fromHex(string_segment.toLatin1());
-            out.append(segment);
+        quint64 sub_auth;
+        if (!buffer_parse_sid_number(&p, end, &sub_auth)) {
+            return false;
         }
 
-        std::reverse(out[0].begin(), out[0].end());
-        std::reverse(out[1].begin(), out[1].end());
-        std::reverse(out[2].begin(), out[2].end());
+        if (num_auths >= 15) {
+            return false;
+        }
 
-        return out;
-    }();
+        const quint32 sub_auth_32 = (quint32) sub_auth;
+        memcpy(out + 8 + 4 * num_auths, &sub_auth_32, sizeof(quint32));
 
-    const QByteArray guid_bytes = [&]() {
-        QByteArray out;
+        num_auths++;
+    }
+
+    out[1] = (char) num_auths;
+
+    return true;
+}
+
+int guid_to_string_buffer(const char *guid_bytes, const int size, char *out) {
+    if (size < GUID_BYTES_SIZE) {
+        return -1;
+    }
 
-        for (const QByteArray &segment : segment_list) {
-            out.append(segment);
+    char *p = out;
+
+    for (int i = 0; i < GUID_BYTES_SIZE; i++) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) {
+            *p++ = '-';
         }
 
-        return out;
-    }();
+        const uchar byte = (uchar) guid_bytes[guid_byte_order[i]];
+
+        *p++ = hex_digit_list[byte >> 4];
+        *p++ = hex_digit_list[byte & 0x0F];
+    }
+
+    *p = '\0';
 
-    return guid_bytes;
+    const int length = p - out;
+
+    return length;
 }
 
-QByteArray sid_string_to_bytes(const QString &sid_string) {
-    dom_sid sid;
-    string_to_sid(&sid, cstr(sid_string));
+// NOTE: accepts "00112233-4455-6677-8899-aabbccddeeff",
+// optionally surrounded by braces, in any case. Output
+// buffer must be GUID_BYTES_SIZE.
+bool guid_from_string_buffer(const char *string, const int length, char *out) {
+    const char *p = string;
+    const char *end = string + length;
+
+    if (length == GUID_STRING_BUFFER_SIZE + 1) {
+        if (p[0] != '{' || p[length - 1] != '}') {
+            return false;
+        }
+
+        p++;
+        end--;
+    }
+
+    if (end - p != GUID_STRING_BUFFER_SIZE - 1) {
+        return false;
+    }
 
-    const QByteArray sid_bytes = QByteArray((char *) &sid, sizeof(dom_sid));
+    for (int i = 0; i < GUID_BYTES_SIZE; i++) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) {
+            if (*p != '-') {
+                return false;
+            }
+
+            p++;
+        }
+
+        const int high = hex_char_value(p[0]);
+        const int low = hex_char_value(p[1]);
+        if (high == -1 || low == -1) {
+            return false;
+        }
+
+        out[guid_byte_order[i]] = (char) ((high << 4) | low);
+
+        p += 2;
+    }
 
-    return sid_bytes;
+    return true;
 }
 
 QString attribute_type_display_string(const AttributeType type) {
@@ -463,8 +720,10 @@ QString int_to_hex_string(const int n) {
 }
 
 QString escape_name_for_dn(const QString &unescaped) {
-    QString out = unescaped;
+    QString out = dn_value_escape(unescaped);
 
+    // NOTE: '?' is not special in RFC 4514 but names
+    // with it have always been escaped this way
     out.replace("?", "\\?");
 
     return out;
@@ -491,3 +750,128 @@ QHash<int, QString> attribute_value_bit_string_map(const QString &attribute)
     }
     return bit_string_map;
 }
+
+// Copies string into buffer as ascii. Returns length or
+// -1 if string doesn't fit or contains non-ascii chars.
+int qstring_to_ascii_buffer(const QString &string, char *out, const int out_size) {
+    const int length = string.size();
+    if (length >= out_size) {
+        return -1;
+    }
+
+    const QChar *data = string.constData();
+
+    for (int i = 0; i < length; i++) {
+        const ushort c = data[i].unicode();
+        if (c > 0x7F) {
+            return -1;
+        }
+
+        out[i] = (char) c;
+    }
+
+    out[length] = '\0';
+
+    return length;
+}
+
+char *buffer_append_decimal(char *out, quint64 value) {
+    char reversed[20];
+    int count = 0;
+
+    do {
+        reversed[count] = (char) ('0' + value % 10);
+        count++;
+        value /= 10;
+    } while (value != 0);
+
+    for (int i = count - 1; i >= 0; i--) {
+        *out++ = reversed[i];
+    }
+
+    return out;
+}
+
+char *buffer_append_hex(char *out, quint64 value) {
+    char reversed[16];
+    int count = 0;
+
+    do {
+        reversed[count] = hex_digit_list[value & 0x0F];
+        count++;
+        value >>= 4;
+    } while (value != 0);
+
+    for (int i = count - 1; i >= 0; i--) {
+        *out++ = reversed[i];
+    }
+
+    return out;
+}
+
+int hex_char_value(const char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    } else {
+        return -1;
+    }
+}
+
+// Parses a sid number the same way samba does it with
+// strtoull(): leading zeroes are skipped instead of
+// starting an octal number, "0x" starts a hex number and
+// values that overflow are saturated. Advances p past
+// the number.
+bool buffer_parse_sid_number(const char **p, const char *end, quint64 *out) {
+    const char *q = *p;
+
+    if (q == end || !isdigit((uchar) *q)) {
+        return false;
+    }
+
+    while (q + 1 != end && q[0] == '0' && isdigit((uchar) q[1])) {
+        q++;
+    }
+
+    const bool is_hex = (end - q > 2 && q[0] == '0' && (q[1] == 'x' || q[1] == 'X') && hex_char_value(q[2]) != -1);
+
+    quint64 value = 0;
+    bool overflow = false;
+
+    if (is_hex) {
+        q += 2;
+
+        while (q != end && hex_char_value(*q) != -1) {
+            if (value > (ULLONG_MAX >> 4)) {
+                overflow = true;
+            }
+
+            value = (value << 4) | (quint64) hex_char_value(*q);
+            q++;
+        }
+    } else {
+        while (q != end && isdigit((uchar) *q)) {
+            const quint64 digit = (quint64) (*q - '0');
+
+            if (value > (ULLONG_MAX - digit) / 10) {
+                overflow = true;
+            }
+
+            value = value * 10 + digit;
+            q++;
+        }
+    }
+
+    if (overflow) {
+        value = ULLONG_MAX;
+    }
+
+    *p = q;
+    *out = value;
+
+    return true;
+}
@@ -27,11 +27,13 @@
  */
 
 #include "ad_defines.h"
+#include <QByteArray>
 #include <QHash>
+#include <QList>
+#include <QVector>
 
 class QString;
 class QDateTime;
-class QByteArray;
 class AdConfig;
 class QTranslator;
 class QLocale;
@@ -66,14 +68,53 @@ QString dn_from_name_and_parent(const QString &name, const QString &parent, cons
 
 QString get_default_domain_from_krb5();
 
+// Quotes a value for a CSV field, doubling quotes inside
+// it
+QString csv_escape(const QString &value);
+
 int bitmask_set(const int input_mask, const int mask_to_set, const bool is_set);
 bool bitmask_is_set(const int input_mask, const int mask_to_read);
 
-// NOTE: uses a buffer that is capped at 100 strings, so
-// pointers returned from this become invalid after 99 more
-// calls. Only use this to give cstr args to C routines in
-// the same scope. Keep this far away from any recursion.
-const char *cstr(const QString &qstr);
+// Converts a string to utf8 for passing to C routines.
+// Converted data is owned by the object, so pointer from
+// get() is valid for as long as the object lives. Short
+// strings are converted into a stack buffer without
+// allocating. Safe to use from multiple threads. Use as a
+// temporary for args or as a local if pointer needs to
+// outlive the statement:
+//
+// ldap_delete_ext_s(ld, CString(dn).get(), NULL, NULL);
+class CString {
+public:
+    explicit CString(const QString &string);
+    CString(const CString &) = delete;
+    CString &operator=(const CString &) = delete;
+
+    const char *get() const;
+    int size() const;
+
+private:
+    char stack_buffer[256];
+    QByteArray heap_buffer;
+    const char *data;
+    int length;
+};
+
+// Converts a list of strings to a NULL-terminated array
+// of utf8 strings, for attribute lists. Array is valid
+// for as long as the object lives.
+class CStringList {
+public:
+    explicit CStringList(const QList<QString> &list);
+    CStringList(const CStringList &) = delete;
+    CStringList &operator=(const CStringList &) = delete;
+
+    char **get();
+
+private:
+    QList<QByteArray> bytes_list;
+    QVector<char *> array;
+};
 
 // NOTE: you must call Q_INIT_RESOURCE(adldap) before
 // calling this
@@ -82,6 +123,22 @@ bool load_adldap_translation(QTranslator &translator, const QLocale &locale);
 QByteArray guid_string_to_bytes(const QString &guid_string);
 QByteArray sid_string_to_bytes(const QString &sid_string);
 
+// NOTE: fixed buffer codecs for sid's and guid's. These
+// don't allocate and don't go through samba, so they can
+// be used on hot paths. String buffer sizes include the
+// null terminator. Encoders return string length or -1
+// if input is invalid. Decoders accept strings which are
+// not null terminated.
+#define SID_BYTES_SIZE 68
+#define SID_STRING_BUFFER_SIZE 190
+#define GUID_BYTES_SIZE 16
+#define GUID_STRING_BUFFER_SIZE 37
+
+int sid_to_string_buffer(const char *sid_bytes, const int size, char *out);
+bool sid_from_string_buffer(const char *string, const int length, char *out);
+int guid_to_string_buffer(const char *guid_bytes, const int size, char *out);
+bool guid_from_string_buffer(const char *string, const int length, char *out);
+
 QString attribute_type_display_string(const AttributeType type);
 
 QString int_to_hex_string(const int n);
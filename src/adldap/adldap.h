@@ -24,11 +24,15 @@
 #include "ad_config.h"
 #include "ad_defines.h"
 #include "ad_display.h"
+#include "ad_dn.h"
 #include "ad_filter.h"
 #include "ad_interface.h"
+#include "ad_metrics.h"
 #include "ad_object.h"
 #include "ad_security.h"
+#include "ad_trace.h"
 #include "ad_utils.h"
 #include "gplink.h"
+#include "gpo_coverage.h"
 
 #endif /* ADLDAP_H */
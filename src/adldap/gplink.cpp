@@ -3,65 +3,69 @@
 #include "adldap.h"
 
 #include <QObject>
+#include <QStringView>
+#include <algorithm>
+#include <climits>
 
 #define LDAP_PREFIX "LDAP://"
 
-Gplink::Gplink() {
-}
+bool gplink_parse_part(QStringView part, QStringView *gpo_out, int *option_out);
+int gplink_parse_option(QStringView option_string);
+void gplink_append_rdn(QString *out, const QString &dn, const int rdn_start, const int rdn_end, const bool is_first_rdn);
+QString gplink_dn_to_ldap_case(const QString &dn);
 
-Gplink::Gplink(const Gplink &other) : gpo_list(other.gpo_list), options(other.options) {
+Gplink::Gplink()
+: string_cache_is_valid(false) {
+}
 
+Gplink::Gplink(const Gplink &other)
+: link_list(other.link_list), string_cache(other.string_cache), string_cache_is_valid(other.string_cache_is_valid) {
 }
 
-Gplink::Gplink(const QString &gplink_string) {
+Gplink::Gplink(const QString &gplink_string)
+: string_cache_is_valid(false) {
     if (gplink_string.isEmpty()) {
         return;
     }
 
     // "[gpo_1;option_1][gpo_2;option_2][gpo_3;option_3]..."
-    // =>
-    // {"gpo_1;option_1", "gpo_2;option_2", "gpo_3;option_3"}
-    QString gplink_string_without_brackets = gplink_string;
-    gplink_string_without_brackets.replace("[", "");
-    const QList<QString> gplink_string_split = gplink_string_without_brackets.split(']');
-
-    for (auto part : gplink_string_split) {
-        if (part.isEmpty()) {
-            continue;
-        }
+    //
+    // NOTE: parse string in one pass, without creating
+    // intermediate strings and lists. Only the final lower
+    // case DN's are allocated.
+    const QStringView view = QStringView(gplink_string);
+
+    qsizetype part_start = 0;
+    for (qsizetype i = 0; i <= view.size(); i++) {
+        const bool at_end = (i == view.size());
+
+        if (!at_end && view[i] == '[') {
+            part_start = i + 1;
+        } else if (at_end || view[i] == ']') {
+            const QStringView part = view.mid(part_start, i - part_start);
+            part_start = i + 1;
+
+            QStringView gpo_view;
+            int option;
+            const bool part_is_valid = gplink_parse_part(part, &gpo_view, &option);
+            if (!part_is_valid) {
+                continue;
+            }
 
-        // "gpo;option"
-        // =>
-        // gpo and option
-        const QList<QString> part_split = part.split(';');
+            // "LDAP://cn={UUID},cn=something,DC=a,DC=b"
+            // =>
+            // "cn={uuid},cn=something,dc=a,dc=b"
+            Link link;
+            link.dn = gpo_view.toString().toLower();
+            link.option = option;
 
-        if (part_split.size() != 2) {
-            continue;
+            link_list.append(link);
         }
-
-        // "LDAP://cn={UUID},cn=something,DC=a,DC=b"
-        // =>
-        // "cn={uuid},cn=something,dc=a,dc=b"
-        const QString gpo = [&]() {
-            QString out;
-
-            out = part_split[0];
-            out.remove(LDAP_PREFIX);
-            out = out.toLower();
-
-            return out;
-        }();
-
-        const int option = [&]() {
-            const QString option_string = part_split[1];
-            const int option_int = option_string.toInt();
-
-            return option_int;
-        }();
-
-        gpo_list.prepend(gpo);
-        options[gpo] = option;
     }
+
+    // NOTE: order of links in gplink string is reversed
+    // compared to the order used by this class
+    std::reverse(link_list.begin(), link_list.end());
 }
 
 Gplink &Gplink::operator=(const Gplink &other) {
@@ -69,132 +73,69 @@ Gplink &Gplink::operator=(const Gplink &other) {
         return *this;
     }
 
-    gpo_list = other.gpo_list;
-    options = other.options;
+    link_list = other.link_list;
+    string_cache = other.string_cache;
+    string_cache_is_valid = other.string_cache_is_valid;
+
     return *this;
 }
 
 // Transform into gplink format. Have to uppercase some
 // parts of the output.
 QString Gplink::to_string() const {
-    QList<QString> part_list;
+    if (string_cache_is_valid) {
+        return string_cache;
+    }
+
+    QString out;
+
+    for (int i = link_list.size() - 1; i >= 0; i--) {
+        const Link &link = link_list[i];
+
+        out.append('[');
+        out.append(LDAP_PREFIX);
 
-    QList<QString>::const_reverse_iterator i;
-    for (i = gpo_list.rbegin(); i != gpo_list.rend(); ++i) {
         // Convert gpo dn from lower case to gplink case
         // format
-        const QString gpo_case = [&]() {
-            const QList<QString> rdn_list = i->split(",");
-
-            QList<QString> rdn_list_case;
-
-            for (const QString &rdn : rdn_list) {
-                const QString rdn_case = [&]() {
-                    const QList<QString> attribute_value = rdn.split("=");
-
-                    // Do no processing if data is malformed
-                    if (attribute_value.size() != 2) {
-                        return rdn;
-                    }
-
-                    const QString attribute = attribute_value[0];
-                    const QString value = attribute_value[1];
-
-                    const QString attribute_case = [&]() {
-                        // "DC" attribute is upper-cased
-                        if (attribute == "dc") {
-                            return attribute.toUpper();
-                        } else {
-                            return attribute;
-                        }
-                    }();
-
-                    const QString value_case = [&]() {
-                        // uuid (the first rdn) is upper-cased
-                        if (rdn_list.indexOf(rdn) == 0) {
-                            return value.toUpper();
-                        } else {
-                            return value;
-                        }
-                    }();
-
-                    const QList<QString> attribute_value_case = {
-                        attribute_case,
-                        value_case,
-                    };
-
-                    const QString out = attribute_value_case.join("=");
-
-                    return out;
-                }();
-
-                rdn_list_case.append(rdn_case);
-            }
+        int rdn_start = 0;
+        for (int j = 0; j <= link.dn.size(); j++) {
+            const bool rdn_ended = (j == link.dn.size() || link.dn[j] == ',');
 
-            const QString out = rdn_list_case.join(",");
+            if (rdn_ended) {
+                if (rdn_start > 0) {
+                    out.append(',');
+                }
 
-            return out;
-        }();
-        const int option = options[*i];
-        const QString option_string = QString::number(option);
+                const bool is_first_rdn = (rdn_start == 0);
+                gplink_append_rdn(&out, link.dn, rdn_start, j, is_first_rdn);
 
-        const QString part = QString("[%1%2;%3]").arg(LDAP_PREFIX, gpo_case, option_string);
+                rdn_start = j + 1;
+            }
+        }
 
-        part_list.append(part);
+        out.append(';');
+        out.append(QString::number(link.option));
+        out.append(']');
     }
 
-    const QString out = part_list.join("");
+    string_cache = out;
+    string_cache_is_valid = true;
 
     return out;
 }
 
 bool Gplink::contains(const QString &gpo_case) const {
-    const QString gpo = gpo_case.toLower();
+    const int index = get_index(gpo_case);
 
-    return options.contains(gpo);
+    return (index != -1);
 }
 
 QList<QString> Gplink::get_gpo_list() const {
     QList<QString> gpo_list_case;
+    gpo_list_case.reserve(link_list.size());
 
-    for (auto gpo : gpo_list) {
-        const QString gpo_case = [&]() {
-            QList<QString> rdn_list = gpo.split(",");
-
-            const bool rdn_list_is_malformed = rdn_list.isEmpty();
-            if (rdn_list_is_malformed) {
-                return gpo;
-            }
-
-            const QString guid_rdn = rdn_list[0];
-            rdn_list[0] = guid_rdn.toUpper();
-
-            for (int i = 1; i < rdn_list.size(); i++) {
-                const QString rdn = rdn_list[i];
-                QList<QString> rdn_split = rdn.split("=");
-
-                const bool rdn_is_malformed = (rdn_split.size() != 2);
-                if (rdn_is_malformed) {
-                    continue;
-                }
-
-                // Uppercase all rdn left halves
-                rdn_split[0] = rdn_split[0].toUpper();
-
-                // Modify some right halves
-                if (rdn_split[1] == "system") {
-                    rdn_split[1] = "System";
-                } else if (rdn_split[1] == "policies") {
-                    rdn_split[1] = "Policies";
-                }
-
-                rdn_list[i] = rdn_split.join("=");
-            }
-
-            const QString out = rdn_list.join(",");
-
-            return out;
-        }();
+    for (const Link &link : link_list) {
+        const QString gpo_case = gplink_dn_to_ldap_case(link.dn);
 
         gpo_list_case.append(gpo_case);
     }
@@ -203,91 +144,85 @@ QList<QString> Gplink::get_gpo_list() const {
 }
 
 void Gplink::add(const QString &gpo_case) {
-    const QString gpo = gpo_case.toLower();
-
-    const bool gpo_already_in_link = contains(gpo);
+    const bool gpo_already_in_link = contains(gpo_case);
     if (gpo_already_in_link) {
         return;
     }
 
-    gpo_list.append(gpo);
-    options[gpo] = 0;
+    Link link;
+    link.dn = gpo_case.toLower();
+    link.option = 0;
+
+    link_list.append(link);
+    invalidate_cache();
 }
 
 void Gplink::remove(const QString &gpo_case) {
-    const QString gpo = gpo_case.toLower();
+    const int index = get_index(gpo_case);
 
-    if (!contains(gpo)) {
+    if (index == -1) {
         return;
     }
 
-    gpo_list.removeAll(gpo);
-    options.remove(gpo);
+    link_list.remove(index);
+    invalidate_cache();
 }
 
 void Gplink::move_up(const QString &gpo_case) {
-    const QString gpo = gpo_case.toLower();
-
-    if (!contains(gpo)) {
-        return;
-    }
-
-    const int current_index = gpo_list.indexOf(gpo);
+    const int current_index = get_index(gpo_case);
 
     if (current_index > 0) {
         const int new_index = current_index - 1;
-        gpo_list.move(current_index, new_index);
+        link_list.move(current_index, new_index);
+        invalidate_cache();
     }
 }
 
 void Gplink::move_down(const QString &gpo_case) {
-    const QString gpo = gpo_case.toLower();
-
-    if (!contains(gpo)) {
-        return;
-    }
+    const int current_index = get_index(gpo_case);
 
-    const int current_index = gpo_list.indexOf(gpo);
-
-    if (current_index < gpo_list.size() - 1) {
+    if (current_index != -1 && current_index < link_list.size() - 1) {
         const int new_index = current_index + 1;
 
-        gpo_list.move(current_index, new_index);
+        link_list.move(current_index, new_index);
+        invalidate_cache();
     }
 }
 
 void Gplink::move(int from_order, int to_order) {
-    if (from_order > (int)gpo_list.size() || to_order > (int)gpo_list.size() ||
+    if (from_order > (int)link_list.size() || to_order > (int)link_list.size() ||
             from_order < 1 || to_order < 1) {
         return;
     }
 
-    gpo_list.move(from_order - 1, to_order - 1);
+    link_list.move(from_order - 1, to_order - 1);
+    invalidate_cache();
 }
 
 bool Gplink::get_option(const QString &gpo_case, const GplinkOption option) const {
-    const QString gpo = gpo_case.toLower();
+    const int index = get_index(gpo_case);
 
-    if (!contains(gpo)) {
+    if (index == -1) {
         return false;
     }
 
-    const int option_bits = options[gpo];
+    const int option_bits = link_list[index].option;
     const bool is_set = bitmask_is_set(option_bits, (int) option);
 
     return is_set;
 }
 
 void Gplink::set_option(const QString &gpo_case, const GplinkOption option, const bool value) {
-    const QString gpo = gpo_case.toLower();
+    const int index = get_index(gpo_case);
 
-    if (!contains(gpo)) {
+    if (index == -1) {
         return;
     }
 
-    const int option_bits = options[gpo];
+    const int option_bits = link_list[index].option;
     const int option_bits_new = bitmask_set(option_bits, (int) option, value);
-    options[gpo] = option_bits_new;
+    link_list[index].option = option_bits_new;
+    invalidate_cache();
 }
 
 bool Gplink::equals(const Gplink &other) const {
@@ -295,22 +230,21 @@ bool Gplink::equals(const Gplink &other) const {
 }
 
 int Gplink::get_gpo_order(const QString &gpo_case) const {
-    const QString gpo = gpo_case.toLower();
-    const int out = gpo_list.indexOf(gpo) + 1;
+    const int out = get_index(gpo_case) + 1;
 
     return out;
 }
 
 int Gplink::get_max_order() const {
-    return gpo_list.size();
+    return link_list.size();
 }
 
 QStringList Gplink::enforced_gpo_dn_list() const
 {
     QStringList enforced_dn_list;
-    for (QString gpo_dn : get_gpo_list()) {
-        if (get_option(gpo_dn, GplinkOption_Enforced))
-            enforced_dn_list.append(gpo_dn);
+    for (const Link &link : link_list) {
+        if (bitmask_is_set(link.option, GplinkOption_Enforced))
+            enforced_dn_list.append(gplink_dn_to_ldap_case(link.dn));
     }
     return enforced_dn_list;
 }
@@ -318,9 +252,248 @@ QStringList Gplink::enforced_gpo_dn_list() const
 QStringList Gplink::disabled_gpo_dn_list() const
 {
     QStringList disabled_dn_list;
-    for (QString gpo_dn : get_gpo_list()) {
-        if (get_option(gpo_dn, GplinkOption_Disabled))
-            disabled_dn_list.append(gpo_dn);
+    for (const Link &link : link_list) {
+        if (bitmask_is_set(link.option, GplinkOption_Disabled))
+            disabled_dn_list.append(gplink_dn_to_ldap_case(link.dn));
     }
     return disabled_dn_list;
 }
+
+GplinkEdit::GplinkEdit(const QString &ou_dn_arg, const QString &gpo_dn_arg, const GplinkEditType type_arg, const GplinkOption option_arg, const bool value_arg)
+: ou_dn(ou_dn_arg), gpo_dn(gpo_dn_arg), type(type_arg), option(option_arg), value(value_arg) {
+}
+
+void GplinkEdit::apply(Gplink &gplink) const {
+    switch (type) {
+        case GplinkEditType_Add: {
+            gplink.add(gpo_dn);
+
+            break;
+        }
+        case GplinkEditType_Remove: {
+            gplink.remove(gpo_dn);
+
+            break;
+        }
+        case GplinkEditType_SetOption: {
+            gplink.set_option(gpo_dn, option, value);
+
+            break;
+        }
+        case GplinkEditType_MoveUp: {
+            gplink.move_up(gpo_dn);
+
+            break;
+        }
+        case GplinkEditType_MoveDown: {
+            gplink.move_down(gpo_dn);
+
+            break;
+        }
+    }
+}
+
+// NOTE: compare case-insensitively instead of lowering
+// given dn to avoid an allocation per lookup
+int Gplink::get_index(const QString &gpo_case) const {
+    for (int i = 0; i < link_list.size(); i++) {
+        const bool match = (QString::compare(link_list[i].dn, gpo_case, Qt::CaseInsensitive) == 0);
+
+        if (match) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+void Gplink::invalidate_cache() {
+    string_cache_is_valid = false;
+    string_cache.clear();
+}
+
+// "LDAP://gpo;option"
+// =>
+// gpo and option
+// NOTE: returns false for malformed parts, which should
+// be skipped
+bool gplink_parse_part(QStringView part, QStringView *gpo_out, int *option_out) {
+    if (part.isEmpty()) {
+        return false;
+    }
+
+    qsizetype separator_i = -1;
+    for (qsizetype i = 0; i < part.size(); i++) {
+        if (part[i] == ';') {
+            // NOTE: part must contain exactly one
+            // separator
+            if (separator_i != -1) {
+                return false;
+            }
+
+            separator_i = i;
+        }
+    }
+
+    if (separator_i == -1) {
+        return false;
+    }
+
+    QStringView gpo = part.left(separator_i);
+
+    const QLatin1String ldap_prefix = QLatin1String(LDAP_PREFIX);
+    if (gpo.startsWith(ldap_prefix)) {
+        gpo = gpo.mid(ldap_prefix.size());
+    }
+
+    *gpo_out = gpo;
+    *option_out = gplink_parse_option(part.mid(separator_i + 1));
+
+    return true;
+}
+
+// NOTE: behaves like QString::toInt(), returning 0 for
+// invalid input, but without creating a temporary string.
+// Only ascii digits are accepted and values which don't
+// fit in int are invalid, same as for toInt().
+int gplink_parse_option(QStringView option_string) {
+    const QStringView trimmed = option_string.trimmed();
+
+    if (trimmed.isEmpty()) {
+        return 0;
+    }
+
+    const bool is_negative = (trimmed[0] == '-');
+    const bool has_sign = (is_negative || trimmed[0] == '+');
+    const qsizetype digits_start = (has_sign ? 1 : 0);
+
+    if (digits_start == trimmed.size()) {
+        return 0;
+    }
+
+    // NOTE: magnitude of INT_MIN is one more than
+    // INT_MAX, so negative values have a higher limit
+    const uint limit = (is_negative ? (uint) INT_MAX + 1 : (uint) INT_MAX);
+
+    uint magnitude = 0;
+    for (qsizetype i = digits_start; i < trimmed.size(); i++) {
+        const ushort c = trimmed[i].unicode();
+
+        if (c < '0' || c > '9') {
+            return 0;
+        }
+
+        const uint digit = c - '0';
+
+        if (magnitude > (limit - digit) / 10) {
+            return 0;
+        }
+
+        magnitude = magnitude * 10 + digit;
+    }
+
+    if (is_negative && magnitude > 0) {
+        return -(int) (magnitude - 1) - 1;
+    } else {
+        return (int) magnitude;
+    }
+}
+
+// Appends rdn in gplink case. "DC" attribute is
+// upper-cased and value of the first rdn (uuid) is
+// upper-cased.
+void gplink_append_rdn(QString *out, const QString &dn, const int rdn_start, const int rdn_end, const bool is_first_rdn) {
+    int equals_i = -1;
+    int equals_count = 0;
+    for (int i = rdn_start; i < rdn_end; i++) {
+        if (dn[i] == '=') {
+            equals_i = i;
+            equals_count++;
+        }
+    }
+
+    // Do no processing if data is malformed
+    if (equals_count != 1) {
+        out->append(dn.constData() + rdn_start, rdn_end - rdn_start);
+
+        return;
+    }
+
+    const QStringRef attribute = dn.midRef(rdn_start, equals_i - rdn_start);
+    if (attribute == QLatin1String("dc")) {
+        out->append(QLatin1String("DC"));
+    } else {
+        out->append(attribute);
+    }
+
+    out->append('=');
+
+    if (is_first_rdn) {
+        for (int i = equals_i + 1; i < rdn_end; i++) {
+            out->append(dn[i].toUpper());
+        }
+    } else {
+        out->append(dn.constData() + equals_i + 1, rdn_end - equals_i - 1);
+    }
+}
+
+// Converts dn from lower case used by gplink to case
+// appropriate for LDAP operations
+QString gplink_dn_to_ldap_case(const QString &dn) {
+    QString out;
+    out.reserve(dn.size());
+
+    int rdn_start = 0;
+    for (int i = 0; i <= dn.size(); i++) {
+        const bool rdn_ended = (i == dn.size() || dn[i] == ',');
+        if (!rdn_ended) {
+            continue;
+        }
+
+        const bool is_first_rdn = (rdn_start == 0);
+
+        if (!is_first_rdn) {
+            out.append(',');
+        }
+
+        int equals_i = -1;
+        int equals_count = 0;
+        for (int j = rdn_start; j < i; j++) {
+            if (dn[j] == '=') {
+                equals_i = j;
+                equals_count++;
+            }
+        }
+        const bool rdn_is_malformed = (equals_count != 1);
+
+        if (is_first_rdn) {
+            // Guid rdn is upper-cased completely
+            for (int j = rdn_start; j < i; j++) {
+                out.append(dn[j].toUpper());
+            }
+        } else if (rdn_is_malformed) {
+            out.append(dn.constData() + rdn_start, i - rdn_start);
+        } else {
+            // Uppercase all rdn left halves
+            for (int j = rdn_start; j < equals_i; j++) {
+                out.append(dn[j].toUpper());
+            }
+
+            out.append('=');
+
+            // Modify some right halves
+            const QStringRef value = dn.midRef(equals_i + 1, i - equals_i - 1);
+            if (value == QLatin1String("system")) {
+                out.append(QLatin1String("System"));
+            } else if (value == QLatin1String("policies")) {
+                out.append(QLatin1String("Policies"));
+            } else {
+                out.append(value);
+            }
+        }
+
+        rdn_start = i + 1;
+    }
+
+    return out;
+}
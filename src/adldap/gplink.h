@@ -21,9 +21,9 @@
 #ifndef GPLINK_H
 #define GPLINK_H
 
-#include <QHash>
 #include <QList>
 #include <QString>
+#include <QVector>
 
 enum GplinkOption {
     GplinkOption_NoOption,
@@ -31,12 +31,47 @@ enum GplinkOption {
     GplinkOption_Enforced
 };
 
+enum GplinkEditType {
+    GplinkEditType_Add,
+    GplinkEditType_Remove,
+    GplinkEditType_SetOption,
+    GplinkEditType_MoveUp,
+    GplinkEditType_MoveDown,
+};
+
+class Gplink;
+
+/**
+ * Describes one change to gplink of an OU. Used for
+ * batched gplink edits, see AdInterface::gplink_edit().
+ * Option and value are only used for SetOption edits.
+ */
+
+class GplinkEdit {
+public:
+    GplinkEdit(const QString &ou_dn_arg, const QString &gpo_dn_arg, const GplinkEditType type_arg, const GplinkOption option_arg = GplinkOption_NoOption, const bool value_arg = false);
+
+    QString ou_dn;
+    QString gpo_dn;
+    GplinkEditType type;
+    GplinkOption option;
+    bool value;
+
+    void apply(Gplink &gplink) const;
+};
+
 /**
  * Class to store a gplink attribute for easy manipulation.
  * Gplink attribute primer: an ordered list of GPO container
  * DN's with each GPO being assigned an "option" value.
  * Options specify whether policy is disabled and/or
  * enforced.
+ *
+ * NOTE: links are stored in a flat ordered vector and
+ * parsed in one pass, because gplinks are parsed for
+ * every OU in policy tree and inheritance computations.
+ * Output of to_string() is cached until next
+ * modification.
  */
 
 class Gplink {
@@ -74,8 +109,18 @@ public:
     QStringList disabled_gpo_dn_list() const;
 
 private:
-    QList<QString> gpo_list;
-    QHash<QString, int> options;
+    struct Link {
+        // NOTE: dn is stored in lower case
+        QString dn;
+        int option;
+    };
+
+    QVector<Link> link_list;
+    mutable QString string_cache;
+    mutable bool string_cache_is_valid;
+
+    int get_index(const QString &gpo_case) const;
+    void invalidate_cache();
 };
 
 #endif /* GPLINK_H */
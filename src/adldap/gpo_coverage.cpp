@@ -0,0 +1,379 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gpo_coverage.h"
+
+#include "adldap.h"
+
+#include <QSet>
+#include <algorithm>
+
+GpoCoverage::GpoCoverage() {
+}
+
+void GpoCoverage::load(AdInterface &ad) {
+    gpo_list.clear();
+    gpo_name_map.clear();
+    container_list.clear();
+    container_index_map.clear();
+    coverage_map.clear();
+
+    load_gpos(ad);
+    load_containers(ad);
+    load_object_counts(ad);
+    compute_coverage();
+}
+
+QList<QString> GpoCoverage::get_gpo_list() const {
+    return gpo_list;
+}
+
+QString GpoCoverage::get_gpo_name(const QString &gpo_dn) const {
+    return gpo_name_map.value(gpo_dn.toLower());
+}
+
+QList<GpoCoverageItem> GpoCoverage::get_coverage(const QString &gpo_dn) const {
+    return coverage_map.value(gpo_dn.toLower());
+}
+
+QList<QString> GpoCoverage::get_container_list() const {
+    QList<QString> out;
+    out.reserve(container_list.size());
+
+    for (const Container &container : container_list) {
+        out.append(container.dn);
+    }
+
+    return out;
+}
+
+int GpoCoverage::get_user_count(const QString &container_dn) const {
+    const int index = container_index_map.value(container_dn.toLower(), -1);
+
+    if (index == -1) {
+        return 0;
+    }
+
+    return container_list[index].user_count;
+}
+
+int GpoCoverage::get_computer_count(const QString &container_dn) const {
+    const int index = container_index_map.value(container_dn.toLower(), -1);
+
+    if (index == -1) {
+        return 0;
+    }
+
+    return container_list[index].computer_count;
+}
+
+int GpoCoverage::get_affected_user_count(const QString &gpo_dn) const {
+    int out = 0;
+
+    for (const GpoCoverageItem &item : get_coverage(gpo_dn)) {
+        out += get_user_count(item.container_dn);
+    }
+
+    return out;
+}
+
+int GpoCoverage::get_affected_computer_count(const QString &gpo_dn) const {
+    int out = 0;
+
+    for (const GpoCoverageItem &item : get_coverage(gpo_dn)) {
+        out += get_computer_count(item.container_dn);
+    }
+
+    return out;
+}
+
+QString GpoCoverage::to_csv() const {
+    QString out;
+
+    const QList<QString> header = {
+        "GPO",
+        "Name",
+        "Container",
+        "Linked at",
+        "Enforced",
+        "Users",
+        "Computers",
+    };
+    out.append(header.join(','));
+    out.append('\n');
+
+    for (const QString &gpo_dn : gpo_list) {
+        const QString name = get_gpo_name(gpo_dn);
+        const QList<GpoCoverageItem> coverage = get_coverage(gpo_dn);
+
+        if (coverage.isEmpty()) {
+            const QList<QString> row = {
+                csv_escape(gpo_dn),
+                csv_escape(name),
+                QString(),
+                QString(),
+                QString(),
+                QString::number(0),
+                QString::number(0),
+            };
+            out.append(row.join(','));
+            out.append('\n');
+
+            continue;
+        }
+
+        for (const GpoCoverageItem &item : coverage) {
+            const QList<QString> row = {
+                csv_escape(gpo_dn),
+                csv_escape(name),
+                csv_escape(item.container_dn),
+                csv_escape(item.link_dn),
+                (item.is_enforced ? "TRUE" : "FALSE"),
+                QString::number(get_user_count(item.container_dn)),
+                QString::number(get_computer_count(item.container_dn)),
+            };
+            out.append(row.join(','));
+            out.append('\n');
+        }
+    }
+
+    return out;
+}
+
+void GpoCoverage::load_gpos(AdInterface &ad) {
+    const QString base = ad.adconfig()->policies_dn();
+    const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_GP_CONTAINER);
+    const QList<QString> attributes = {ATTRIBUTE_DISPLAY_NAME};
+    const QHash<QString, AdObject> results = ad.search(base, SearchScope_Children, filter, attributes);
+
+    for (const AdObject &object : results.values()) {
+        const QString dn = object.get_dn();
+        const QString name = object.get_string(ATTRIBUTE_DISPLAY_NAME);
+
+        gpo_list.append(dn);
+        gpo_name_map[dn.toLower()] = name;
+    }
+
+    std::sort(gpo_list.begin(), gpo_list.end(),
+        [this](const QString &a, const QString &b) {
+            return (get_gpo_name(a).compare(get_gpo_name(b), Qt::CaseInsensitive) < 0);
+        });
+}
+
+void GpoCoverage::load_containers(AdInterface &ad) {
+    const QString base = ad.adconfig()->domain_dn();
+    const QString filter = filter_OR({
+        filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_OU),
+        filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_DOMAIN),
+    });
+    const QList<QString> attributes = {
+        ATTRIBUTE_GPLINK,
+        ATTRIBUTE_GPOPTIONS,
+    };
+    const QHash<QString, AdObject> results = ad.search(base, SearchScope_All, filter, attributes);
+
+    container_list.reserve(results.size());
+
+    for (const AdObject &object : results.values()) {
+        Container container;
+        container.dn = object.get_dn();
+        container.gplink = object.get_string(ATTRIBUTE_GPLINK);
+        container.inheritance_blocked = (object.get_string(ATTRIBUTE_GPOPTIONS) == GPOPTIONS_BLOCK_INHERITANCE);
+        container.user_count = 0;
+        container.computer_count = 0;
+
+        container_index_map[container.dn.toLower()] = container_list.size();
+        container_list.append(container);
+    }
+}
+
+// NOTE: objects are counted towards the closest container
+// that can have links. Results of ancestor lookups are
+// cached by parent DN because most objects share a small
+// number of parents.
+void GpoCoverage::load_object_counts(AdInterface &ad) {
+    const QString base = ad.adconfig()->domain_dn();
+    const QString filter = filter_OR({
+        filter_AND({
+            filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CATEGORY, CLASS_PERSON),
+            filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_USER),
+        }),
+        filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_COMPUTER),
+    });
+    const QList<QString> attributes = {ATTRIBUTE_OBJECT_CLASS};
+    const QHash<QString, AdObject> results = ad.search(base, SearchScope_All, filter, attributes);
+
+    QHash<QString, int> parent_cache;
+
+    for (const AdObject &object : results.values()) {
+        const QString parent_dn = dn_get_parent(object.get_dn()).toLower();
+
+        if (!parent_cache.contains(parent_dn)) {
+            parent_cache[parent_dn] = get_container_index(parent_dn);
+        }
+
+        const int index = parent_cache[parent_dn];
+        if (index == -1) {
+            continue;
+        }
+
+        if (object.is_class(CLASS_COMPUTER)) {
+            container_list[index].computer_count++;
+        } else {
+            container_list[index].user_count++;
+        }
+    }
+}
+
+// NOTE: containers are processed in tree order, starting
+// from the domain. Each container receives enforced and
+// inheritable links of it's parent, so each container is
+// processed once.
+void GpoCoverage::compute_coverage() {
+    QHash<int, QList<int>> children_map;
+    QList<int> root_list;
+
+    for (int i = 0; i < container_list.size(); i++) {
+        const QString dn = container_list[i].dn;
+        const QString parent_dn = dn_get_parent(dn);
+
+        const int parent_index = [&]() {
+            if (parent_dn == dn) {
+                return -1;
+            }
+
+            return get_container_index(parent_dn);
+        }();
+
+        if (parent_index == -1) {
+            root_list.append(i);
+        } else {
+            children_map[parent_index].append(i);
+        }
+    }
+
+    class State {
+    public:
+        int index;
+        QList<Link> enforced_list;
+        QList<Link> inherited_list;
+    };
+
+    QList<State> stack;
+    for (const int root : root_list) {
+        State state;
+        state.index = root;
+        stack.append(state);
+    }
+
+    QList<Container> container_list_sorted;
+    container_list_sorted.reserve(container_list.size());
+
+    while (!stack.isEmpty()) {
+        State state = stack.takeLast();
+        const Container &container = container_list[state.index];
+
+        if (container.inheritance_blocked) {
+            state.inherited_list.clear();
+        }
+
+        const Gplink gplink = Gplink(container.gplink);
+
+        for (const QString &gpo_dn : gplink.get_gpo_list()) {
+            if (gplink.get_option(gpo_dn, GplinkOption_Disabled)) {
+                continue;
+            }
+
+            Link link;
+            link.gpo_dn = gpo_dn;
+            link.link_dn = container.dn;
+            link.is_enforced = gplink.get_option(gpo_dn, GplinkOption_Enforced);
+
+            if (link.is_enforced) {
+                state.enforced_list.append(link);
+            } else {
+                state.inherited_list.append(link);
+            }
+        }
+
+        // NOTE: same GPO may be linked at multiple levels,
+        // only the first effective link is recorded
+        QSet<QString> added_gpo_set;
+        for (const QList<Link> &link_list : {state.enforced_list, state.inherited_list}) {
+            for (const Link &link : link_list) {
+                const QString gpo_key = link.gpo_dn.toLower();
+
+                if (added_gpo_set.contains(gpo_key)) {
+                    continue;
+                }
+
+                added_gpo_set.insert(gpo_key);
+
+                GpoCoverageItem item;
+                item.container_dn = container.dn;
+                item.link_dn = link.link_dn;
+                item.is_enforced = link.is_enforced;
+
+                coverage_map[gpo_key].append(item);
+            }
+        }
+
+        for (const int child : children_map.value(state.index)) {
+            State child_state;
+            child_state.index = child;
+            child_state.enforced_list = state.enforced_list;
+            child_state.inherited_list = state.inherited_list;
+
+            stack.append(child_state);
+        }
+
+        container_list_sorted.append(container);
+    }
+
+    container_list = container_list_sorted;
+
+    container_index_map.clear();
+    for (int i = 0; i < container_list.size(); i++) {
+        const QString dn = container_list[i].dn;
+        container_index_map[dn.toLower()] = i;
+    }
+}
+
+// Returns index of container with given dn or it's closest
+// ancestor, -1 if none are found
+int GpoCoverage::get_container_index(const QString &dn) const {
+    QString current = dn.toLower();
+
+    while (!current.isEmpty()) {
+        const int index = container_index_map.value(current, -1);
+        if (index != -1) {
+            return index;
+        }
+
+        const QString parent = dn_get_parent(current);
+        if (parent == current) {
+            break;
+        }
+
+        current = parent;
+    }
+
+    return -1;
+}
@@ -0,0 +1,118 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GPO_COVERAGE_H
+#define GPO_COVERAGE_H
+
+/**
+ * Computes where each GPO in the domain is effective.
+ * Containers which can have links (domain and OU's) are
+ * loaded in one search, then effective links are
+ * propagated from parents to children in one pass over the
+ * container tree, accounting for enforced links, disabled
+ * links and blocked inheritance. Same rules are used as in
+ * the "Inherited policies" tab. Also counts users and
+ * computers contained in each container, including
+ * objects in nested non-OU containers like "CN=Users".
+ *
+ * NOTE: all DN's returned by this class are in the case
+ * returned by the server, while lookups are
+ * case-insensitive.
+ */
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+class AdInterface;
+
+class GpoCoverageItem {
+public:
+    // Container where GPO is effective
+    QString container_dn;
+
+    // Container where GPO is linked. Equal to container
+    // for direct links.
+    QString link_dn;
+
+    bool is_enforced;
+};
+
+class GpoCoverage {
+
+public:
+    GpoCoverage();
+
+    void load(AdInterface &ad);
+
+    // All GPO's present in the domain, including unlinked
+    // ones
+    QList<QString> get_gpo_list() const;
+    QString get_gpo_name(const QString &gpo_dn) const;
+
+    // Containers where given GPO is effective, in order of
+    // the container tree
+    QList<GpoCoverageItem> get_coverage(const QString &gpo_dn) const;
+
+    QList<QString> get_container_list() const;
+    int get_user_count(const QString &container_dn) const;
+    int get_computer_count(const QString &container_dn) const;
+
+    // Sums of object counts over all containers where GPO
+    // is effective
+    int get_affected_user_count(const QString &gpo_dn) const;
+    int get_affected_computer_count(const QString &gpo_dn) const;
+
+    // Report as comma-separated values, one row for every
+    // pair of GPO and container where it's effective.
+    // Unlinked GPO's get one row with empty container.
+    QString to_csv() const;
+
+private:
+    class Link {
+    public:
+        QString gpo_dn;
+        QString link_dn;
+        bool is_enforced;
+    };
+
+    class Container {
+    public:
+        QString dn;
+        QString gplink;
+        bool inheritance_blocked;
+        int user_count;
+        int computer_count;
+    };
+
+    QList<QString> gpo_list;
+    QHash<QString, QString> gpo_name_map;
+    QList<Container> container_list;
+    QHash<QString, int> container_index_map;
+    QHash<QString, QList<GpoCoverageItem>> coverage_map;
+
+    void load_containers(AdInterface &ad);
+    void load_gpos(AdInterface &ad);
+    void load_object_counts(AdInterface &ad);
+    void compute_coverage();
+    int get_container_index(const QString &dn) const;
+};
+
+#endif /* GPO_COVERAGE_H */
@@ -0,0 +1,273 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "acl_audit_dialog.h"
+#include "ui_acl_audit_dialog.h"
+
+#include "acl_audit_thread.h"
+#include "adldap.h"
+#include "select_dialogs/select_object_dialog.h"
+#include "settings.h"
+#include "status.h"
+#include "utils.h"
+
+#include <QFile>
+#include <QFileDialog>
+#include <QStandardItemModel>
+#include <QStandardPaths>
+
+enum AclAuditColumn {
+    AclAuditColumn_Name,
+    AclAuditColumn_ExplicitAces,
+    AclAuditColumn_Order,
+    AclAuditColumn_Dn,
+
+    AclAuditColumn_COUNT,
+};
+
+AclAuditDialog::AclAuditDialog(const QString &base_arg, QWidget *parent)
+: QDialog(parent) {
+    ui = new Ui::AclAuditDialog();
+    ui->setupUi(this);
+
+    setAttribute(Qt::WA_DeleteOnClose);
+
+    base = base_arg;
+    thread = nullptr;
+    scanned_count = 0;
+
+    const QString base_text = QString(tr("Audit permissions of objects in %1.")).arg(dn_get_name(base));
+    ui->base_label->setText(base_text);
+
+    model = new QStandardItemModel(0, AclAuditColumn_COUNT, this);
+    set_horizontal_header_labels_from_map(model,
+        {
+            {AclAuditColumn_Name, tr("Name")},
+            {AclAuditColumn_ExplicitAces, tr("Explicit ACE's")},
+            {AclAuditColumn_Order, tr("Canonical order")},
+            {AclAuditColumn_Dn, tr("DN")},
+        });
+
+    ui->view->setModel(model);
+    ui->view->setColumnWidth(AclAuditColumn_Name, 200);
+
+    update_status_label();
+    update_buttons();
+
+    settings_setup_dialog_geometry(SETTING_acl_audit_dialog_geometry, this);
+
+    connect(
+        ui->select_trustee_button, &QPushButton::clicked,
+        this, &AclAuditDialog::on_select_trustee);
+    connect(
+        ui->clear_trustee_button, &QPushButton::clicked,
+        this, &AclAuditDialog::on_clear_trustee);
+    connect(
+        ui->start_button, &QPushButton::clicked,
+        this, &AclAuditDialog::on_start);
+    connect(
+        ui->stop_button, &QPushButton::clicked,
+        this, &AclAuditDialog::on_stop);
+    connect(
+        ui->export_button, &QPushButton::clicked,
+        this, &AclAuditDialog::on_export);
+}
+
+AclAuditDialog::~AclAuditDialog() {
+    object_scan_thread_stop_and_delete(thread, this);
+
+    delete ui;
+}
+
+void AclAuditDialog::on_select_trustee() {
+    auto dialog = new SelectObjectDialog({CLASS_USER, CLASS_GROUP, CLASS_COMPUTER}, SelectObjectDialogMultiSelection_No, this);
+    dialog->setWindowTitle(tr("Select Trustee"));
+    dialog->open();
+
+    connect(
+        dialog, &SelectObjectDialog::accepted,
+        this,
+        [this, dialog]() {
+            const QList<QString> selected_list = dialog->get_selected();
+            if (selected_list.isEmpty()) {
+                return;
+            }
+
+            AdInterface ad;
+            if (ad_failed(ad, this)) {
+                return;
+            }
+
+            const QString trustee_dn = selected_list[0];
+            const AdObject trustee_object = ad.search_object(trustee_dn, {ATTRIBUTE_OBJECT_SID});
+
+            g_status->display_ad_messages(ad, this);
+
+            trustee = trustee_object.get_value(ATTRIBUTE_OBJECT_SID);
+            ui->trustee_edit->setText(dn_get_name(trustee_dn));
+        });
+}
+
+void AclAuditDialog::on_clear_trustee() {
+    trustee = QByteArray();
+    ui->trustee_edit->clear();
+}
+
+void AclAuditDialog::on_start() {
+    model->removeRows(0, model->rowCount());
+    scanned_count = 0;
+
+    // NOTE: disable sorting while scanning so that rows
+    // are not resorted on every batch
+    ui->view->setSortingEnabled(false);
+
+    thread = new AclAuditThread(base, trustee);
+
+    connect(
+        thread, &AclAuditThread::results_ready,
+        this, &AclAuditDialog::on_results_ready,
+        Qt::QueuedConnection);
+    connect(
+        thread, &AclAuditThread::finished,
+        this, &AclAuditDialog::on_thread_finished);
+
+    thread->start();
+
+    update_status_label();
+    update_buttons();
+}
+
+void AclAuditDialog::on_stop() {
+    if (thread != nullptr) {
+        thread->stop();
+    }
+}
+
+void AclAuditDialog::on_results_ready(const QList<AclAuditFinding> &findings, const int scanned_count_batch) {
+    scanned_count += scanned_count_batch;
+
+    for (const AclAuditFinding &finding : findings) {
+        const QList<QStandardItem *> row = make_item_row(AclAuditColumn_COUNT);
+
+        const QString order_text = [&]() {
+            if (finding.parse_failed) {
+                return tr("Failed to read");
+            } else if (finding.acl_order_is_correct) {
+                return tr("Yes");
+            } else {
+                return tr("No");
+            }
+        }();
+
+        row[AclAuditColumn_Name]->setText(dn_get_name(finding.dn));
+        // NOTE: set count as int so that column is sorted
+        // numerically
+        row[AclAuditColumn_ExplicitAces]->setData(finding.explicit_ace_count, Qt::DisplayRole);
+        row[AclAuditColumn_Order]->setText(order_text);
+        row[AclAuditColumn_Dn]->setText(finding.dn);
+
+        model->appendRow(row);
+    }
+
+    update_status_label();
+}
+
+void AclAuditDialog::on_thread_finished() {
+    object_scan_thread_display_errors(thread, tr("Failed to connect to server while auditing permissions."), this);
+
+    thread->deleteLater();
+    thread = nullptr;
+
+    ui->view->setSortingEnabled(true);
+
+    update_status_label();
+    update_buttons();
+}
+
+void AclAuditDialog::on_export() {
+    const QString file_path = [&]() {
+        const QString caption = tr("Export Audit Report");
+        const QString suggested_file = QString("%1/%2.csv").arg(QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation), tr("acl_audit"));
+        const QString filter = tr("CSV (*.csv)");
+
+        const QString out = QFileDialog::getSaveFileName(this, caption, suggested_file, filter);
+
+        return out;
+    }();
+
+    if (file_path.isEmpty()) {
+        return;
+    }
+
+    QString csv;
+
+    const QList<QString> header = {
+        "DN",
+        "Explicit ACEs",
+        "Canonical order",
+    };
+    csv.append(header.join(','));
+    csv.append('\n');
+
+    // NOTE: export in the order that is currently
+    // displayed in the view
+    for (int row = 0; row < model->rowCount(); row++) {
+        const QList<QString> row_values = {
+            csv_escape(model->item(row, AclAuditColumn_Dn)->text()),
+            model->item(row, AclAuditColumn_ExplicitAces)->text(),
+            csv_escape(model->item(row, AclAuditColumn_Order)->text()),
+        };
+        csv.append(row_values.join(','));
+        csv.append('\n');
+    }
+
+    QFile file(file_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error_log({QString(tr("Failed to open file \"%1\".")).arg(file_path)}, this);
+
+        return;
+    }
+
+    file.write(csv.toUtf8());
+}
+
+void AclAuditDialog::update_status_label() {
+    const QString text = [&]() {
+        const bool is_running = (thread != nullptr);
+
+        if (is_running) {
+            return QString(tr("Scanning... %1 objects scanned, %2 found.")).arg(scanned_count).arg(model->rowCount());
+        } else {
+            return QString(tr("%1 objects scanned, %2 found.")).arg(scanned_count).arg(model->rowCount());
+        }
+    }();
+
+    ui->status_label->setText(text);
+}
+
+void AclAuditDialog::update_buttons() {
+    const bool is_running = (thread != nullptr);
+
+    ui->start_button->setEnabled(!is_running);
+    ui->stop_button->setEnabled(is_running);
+    ui->select_trustee_button->setEnabled(!is_running);
+    ui->clear_trustee_button->setEnabled(!is_running);
+    ui->export_button->setEnabled(!is_running);
+}
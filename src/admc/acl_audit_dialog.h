@@ -0,0 +1,67 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ACL_AUDIT_DIALOG_H
+#define ACL_AUDIT_DIALOG_H
+
+/**
+ * Shows results of an ACL audit of a subtree. Findings
+ * are added as the scan progresses and can be sorted and
+ * exported to CSV.
+ */
+
+#include <QDialog>
+
+class AclAuditFinding;
+class AclAuditThread;
+class QStandardItemModel;
+
+namespace Ui {
+class AclAuditDialog;
+}
+
+class AclAuditDialog final : public QDialog {
+    Q_OBJECT
+
+public:
+    Ui::AclAuditDialog *ui;
+
+    AclAuditDialog(const QString &base, QWidget *parent);
+    ~AclAuditDialog();
+
+private:
+    QString base;
+    QByteArray trustee;
+    QStandardItemModel *model;
+    AclAuditThread *thread;
+    int scanned_count;
+
+    void on_select_trustee();
+    void on_clear_trustee();
+    void on_start();
+    void on_stop();
+    void on_export();
+    void on_results_ready(const QList<AclAuditFinding> &findings, const int scanned_count_batch);
+    void on_thread_finished();
+    void update_status_label();
+    void update_buttons();
+};
+
+#endif /* ACL_AUDIT_DIALOG_H */
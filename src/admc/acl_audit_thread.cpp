@@ -0,0 +1,111 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "acl_audit_thread.h"
+
+#include "adldap.h"
+#include "utils.h"
+
+#include <QRunnable>
+
+// Audits a chunk of objects from one page. Each task
+// writes to it's own output list, so no locking is
+// needed.
+class AclAuditTask final : public QRunnable {
+public:
+    AclAuditTask(const QList<AdObject> &object_list, const QByteArray &trustee, QList<AclAuditFinding> *findings_out);
+
+    void run() override;
+
+private:
+    QList<AdObject> object_list;
+    QByteArray trustee;
+    QList<AclAuditFinding> *findings_out;
+};
+
+AclAuditThread::AclAuditThread(const QString &base_arg, const QByteArray &trustee_arg)
+: ObjectScanThread(base_arg, QString(), {ATTRIBUTE_SECURITY_DESCRIPTOR}) {
+    trustee = trustee_arg;
+    chunk_findings_list.resize(pool.maxThreadCount());
+    pending_scanned_count = 0;
+}
+
+// NOTE: tasks are not waited for here, so that parsing
+// overlaps with loading of next page
+void AclAuditThread::process_page(AdInterface &ad, const QVector<QList<AdObject>> &chunk_list) {
+    UNUSED_ARG(ad);
+
+    for (int chunk_i = 0; chunk_i < chunk_list.size(); chunk_i++) {
+        if (chunk_list[chunk_i].isEmpty()) {
+            continue;
+        }
+
+        pending_scanned_count += chunk_list[chunk_i].size();
+
+        auto task = new AclAuditTask(chunk_list[chunk_i], trustee, &chunk_findings_list[chunk_i]);
+        pool.start(task);
+    }
+}
+
+// Waits for tasks of previous page and emits their
+// findings
+void AclAuditThread::page_loaded() {
+    pool.waitForDone();
+
+    if (pending_scanned_count == 0) {
+        return;
+    }
+
+    QList<AclAuditFinding> findings;
+    for (QList<AclAuditFinding> &chunk_findings : chunk_findings_list) {
+        findings.append(chunk_findings);
+        chunk_findings.clear();
+    }
+
+    emit results_ready(findings, pending_scanned_count);
+
+    pending_scanned_count = 0;
+}
+
+AclAuditTask::AclAuditTask(const QList<AdObject> &object_list_arg, const QByteArray &trustee_arg, QList<AclAuditFinding> *findings_out_arg) {
+    object_list = object_list_arg;
+    trustee = trustee_arg;
+    findings_out = findings_out_arg;
+}
+
+void AclAuditTask::run() {
+    for (const AdObject &object : object_list) {
+        const QByteArray sd_bytes = object.get_value(ATTRIBUTE_SECURITY_DESCRIPTOR);
+        const SecurityAuditResult result = ad_security_audit_sd(sd_bytes, trustee);
+
+        const bool is_finding = (result.parse_failed || result.explicit_ace_count > 0 || !result.acl_order_is_correct);
+        if (!is_finding) {
+            continue;
+        }
+
+        AclAuditFinding finding;
+        finding.dn = object.get_dn();
+        finding.explicit_ace_count = result.explicit_ace_count;
+        finding.acl_order_is_correct = result.acl_order_is_correct;
+        finding.parse_failed = result.parse_failed;
+
+        findings_out->append(finding);
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ACL_AUDIT_THREAD_H
+#define ACL_AUDIT_THREAD_H
+
+/**
+ * Scans security descriptors of all objects in a subtree
+ * and reports objects where given trustee has explicit
+ * ACE's or where DACL is not in canonical order. Pages
+ * are loaded in this thread while descriptors of previous
+ * page are parsed in a thread pool. Only findings are
+ * kept, descriptors are discarded after parsing so memory
+ * usage doesn't grow with subtree size.
+ */
+
+#include "object_scan_thread.h"
+
+class AclAuditFinding {
+public:
+    QString dn;
+    int explicit_ace_count;
+    bool acl_order_is_correct;
+    bool parse_failed;
+};
+
+class AclAuditThread final : public ObjectScanThread {
+    Q_OBJECT
+
+public:
+    AclAuditThread(const QString &base, const QByteArray &trustee);
+
+signals:
+    // NOTE: scanned_count is the number of objects
+    // scanned for this batch, including objects without
+    // findings
+    void results_ready(const QList<AclAuditFinding> &findings, const int scanned_count);
+
+private:
+    QByteArray trustee;
+    QVector<QList<AclAuditFinding>> chunk_findings_list;
+    int pending_scanned_count;
+
+    void process_page(AdInterface &ad, const QVector<QList<AdObject>> &chunk_list) override;
+    void page_loaded() override;
+};
+
+#endif /* ACL_AUDIT_THREAD_H */
@@ -26,6 +26,7 @@
 #include "utils.h"
 #include "fsmo/fsmo_utils.h"
 #include "globals.h"
+#include "search_scheduler.h"
 #include "status.h"
 
 #include <QPushButton>
@@ -176,6 +177,11 @@ void ConnectionOptionsDialog::accept() {
         settings_set_variant(setting, settings.value(setting));
     }
 
+    // NOTE: searches in flight were started with old
+    // options, so their results may be from a different
+    // host or domain
+    g_search_scheduler->cancel_all();
+
     const bool domain_is_changed = (domain_was_default != domain_is_default) || custom_domain_changed;
     if (domain_is_changed) {
         load_g_adconfig(ad);
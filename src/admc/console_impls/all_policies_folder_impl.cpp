@@ -27,25 +27,53 @@
 #include "console_widget/results_view.h"
 #include "create_dialogs/create_policy_dialog.h"
 #include "globals.h"
+#include "gpo_coverage_export_thread.h"
 #include "gplink.h"
 #include "status.h"
 #include "utils.h"
 #include "fsmo/fsmo_utils.h"
 
 #include <QAction>
+#include <QFileDialog>
 #include <QList>
 #include <QStandardItem>
+#include <QStandardPaths>
 #include <QMessageBox>
+#include <QPersistentModelIndex>
+#include <QSet>
+#include <algorithm>
+
+QString deleted_object_original_dn(const AdObject &object);
+bool search_all_pages(AdInterface &ad, const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, QHash<QString, AdObject> *results);
 
 AllPoliciesFolderImpl::AllPoliciesFolderImpl(ConsoleWidget *console_arg)
 : ConsoleImpl(console_arg) {
+    highest_usn = 0;
+    export_thread = nullptr;
+
     set_results_view(new ResultsView(console_arg));
 
     create_policy_action = new QAction(tr("Create policy"), this);
+    export_coverage_action = new QAction(tr("Export coverage report..."), this);
 
     connect(
         create_policy_action, &QAction::triggered,
         this, &AllPoliciesFolderImpl::create_policy);
+    connect(
+        export_coverage_action, &QAction::triggered,
+        this, &AllPoliciesFolderImpl::export_coverage);
+}
+
+// NOTE: export thread might still be running, finished()
+// slot won't be called after this, so delete it here
+AllPoliciesFolderImpl::~AllPoliciesFolderImpl() {
+    if (export_thread != nullptr) {
+        disconnect(export_thread, nullptr, this, nullptr);
+        export_thread->stop();
+        export_thread->wait();
+
+        delete export_thread;
+    }
 }
 
 void AllPoliciesFolderImpl::fetch(const QModelIndex &index) {
@@ -54,26 +82,37 @@ void AllPoliciesFolderImpl::fetch(const QModelIndex &index) {
         return;
     }
 
-    const QString base = g_adconfig->policies_dn();
-    const SearchScope scope = SearchScope_All;
-    const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_GP_CONTAINER);
-    const QList<QString> attributes = QList<QString>();
-    const QHash<QString, AdObject> results = ad.search(base, scope, filter, attributes);
-
-    all_policies_folder_impl_add_objects(console, results.values(), index);
+    load_all(ad, index);
 }
 
+// NOTE: instead of reloading all policies, only load
+// policies that changed since last load and remove
+// policies which were deleted since last load. Both are
+// found by uSNChanged, so refresh doesn't depend on the
+// amount of policies in the domain.
 void AllPoliciesFolderImpl::refresh(const QList<QModelIndex> &index_list) {
     const QModelIndex index = index_list[0];
 
-    console->delete_children(index);
-    fetch(index);
+    AdInterface ad;
+    if (ad_failed(ad, console)) {
+        return;
+    }
+
+    const bool can_load_changes = (highest_usn != 0 && highest_usn_dc == ad.get_dc() && console_item_get_was_fetched(index));
+
+    if (can_load_changes) {
+        load_changes(ad, index);
+    } else {
+        console->delete_children(index);
+        load_all(ad, index);
+    }
 }
 
 QList<QAction *> AllPoliciesFolderImpl::get_all_custom_actions() const {
     QList<QAction *> out;
 
     out.append(create_policy_action);
+    out.append(export_coverage_action);
 
     return out;
 }
@@ -85,6 +124,7 @@ QSet<QAction *> AllPoliciesFolderImpl::get_custom_actions(const QModelIndex &ind
     QSet<QAction *> out;
 
     out.insert(create_policy_action);
+    out.insert(export_coverage_action);
 
     return out;
 }
@@ -155,6 +195,220 @@ void AllPoliciesFolderImpl::create_policy() {
         });
 }
 
+void AllPoliciesFolderImpl::export_coverage() {
+    const QString file_path = [&]() {
+        const QString caption = tr("Export Coverage Report");
+        const QString suggested_file = QString("%1/%2.csv").arg(QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation), tr("policy_coverage"));
+        const QString filter = tr("CSV (*.csv)");
+
+        const QString out = QFileDialog::getSaveFileName(console, caption, suggested_file, filter);
+
+        return out;
+    }();
+
+    if (file_path.isEmpty()) {
+        return;
+    }
+
+    // NOTE: loading coverage searches whole domain, so it
+    // is done in a thread. Action is disabled until
+    // export finishes to allow only one export at a time.
+    export_thread = new GpoCoverageExportThread(file_path);
+
+    connect(
+        export_thread, &QThread::finished,
+        this, &AllPoliciesFolderImpl::on_export_thread_finished);
+
+    export_coverage_action->setEnabled(false);
+    g_status->add_message(tr("Exporting coverage report..."), StatusType_Success);
+
+    export_thread->start();
+}
+
+void AllPoliciesFolderImpl::on_export_thread_finished() {
+    g_status->display_ad_messages(export_thread->get_ad_messages(), console);
+
+    const QString file_path = export_thread->get_file_path();
+
+    if (export_thread->failed_to_connect()) {
+        error_log({tr("Failed to connect to server while exporting coverage report.")}, console);
+    } else if (export_thread->failed_to_write_file()) {
+        error_log({QString(tr("Failed to open file \"%1\".")).arg(file_path)}, console);
+    } else if (!export_thread->is_stopped()) {
+        g_status->add_message(QString(tr("Coverage report was saved to \"%1\".")).arg(file_path), StatusType_Success);
+    }
+
+    export_thread->deleteLater();
+    export_thread = nullptr;
+
+    export_coverage_action->setEnabled(true);
+}
+
+void AllPoliciesFolderImpl::load_all(AdInterface &ad, const QModelIndex &index) {
+    const QString base = g_adconfig->policies_dn();
+    const SearchScope scope = SearchScope_All;
+    const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_GP_CONTAINER);
+    const QList<QString> attributes = console_policy_search_attributes();
+    const QHash<QString, AdObject> results = ad.search(base, scope, filter, attributes);
+
+    all_policies_folder_impl_add_objects(console, results.values(), index);
+
+    highest_usn = 0;
+    update_highest_usn(ad, results.values());
+}
+
+void AllPoliciesFolderImpl::load_changes(AdInterface &ad, const QModelIndex &index) {
+    const QString base = g_adconfig->policies_dn();
+    const SearchScope scope = SearchScope_All;
+    const QString class_filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_GP_CONTAINER);
+    const QString usn_filter = QString("(%1>=%2)").arg(ATTRIBUTE_USN_CHANGED, QString::number(highest_usn + 1));
+
+    QHash<QString, QPersistentModelIndex> loaded_map;
+    for (int row = 0; row < index.model()->rowCount(index); row++) {
+        const QModelIndex child = index.model()->index(row, 0, index);
+        const QString dn = child.data(PolicyRole_DN).toString();
+
+        loaded_map[dn.toLower()] = QPersistentModelIndex(child);
+    }
+
+    // Load policies which were created or modified since
+    // last load and patch rows in place. If this search
+    // fails, changes can't be trusted, so reload all.
+    const QString changed_filter = filter_AND({class_filter, usn_filter});
+    const QList<QString> changed_attributes = console_policy_search_attributes();
+    QHash<QString, AdObject> changed_results;
+    const bool changed_success = search_all_pages(ad, base, scope, changed_filter, changed_attributes, &changed_results);
+
+    if (!changed_success) {
+        console->delete_children(index);
+        load_all(ad, index);
+
+        return;
+    }
+
+    QList<AdObject> created_list;
+    for (const AdObject &object : changed_results.values()) {
+        const QString key = object.get_dn().toLower();
+
+        if (loaded_map.contains(key)) {
+            const QList<QStandardItem *> row = console->get_row(loaded_map[key]);
+            console_policy_load(row, object);
+        } else {
+            created_list.append(object);
+        }
+    }
+
+    all_policies_folder_impl_add_objects(console, created_list, index);
+
+    // Remove policies which were deleted since last load.
+    // Deleting an object changes it's uSNChanged, so
+    // these are found by the same USN condition among
+    // deleted objects in "Deleted Objects" container.
+    //
+    // NOTE: by default only admins can read "Deleted
+    // Objects". For other users the search fails because
+    // container is not visible. In that case, compare
+    // loaded rows to DN's of current policies instead.
+    // That search returns only DN's, so it stays cheap.
+    const QString deleted_filter = [&]() {
+        const QString is_deleted_filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_IS_DELETED, LDAP_BOOL_TRUE);
+
+        return filter_AND({class_filter, is_deleted_filter, usn_filter});
+    }();
+    const QString deleted_objects_dn = QString("CN=Deleted Objects,%1").arg(g_adconfig->domain_dn());
+    const QList<QString> deleted_attributes = {ATTRIBUTE_NAME, ATTRIBUTE_LAST_KNOWN_PARENT, ATTRIBUTE_USN_CHANGED};
+    QHash<QString, AdObject> deleted_results;
+
+    ad.set_show_deleted(true);
+    const bool deleted_success = search_all_pages(ad, deleted_objects_dn, SearchScope_Children, deleted_filter, deleted_attributes, &deleted_results);
+    ad.set_show_deleted(false);
+
+    QList<QString> deleted_dn_list;
+    bool deleted_loaded = deleted_success;
+
+    if (deleted_success) {
+        for (const AdObject &object : deleted_results.values()) {
+            const QString original_dn = deleted_object_original_dn(object);
+
+            deleted_dn_list.append(original_dn);
+        }
+    } else {
+        QHash<QString, AdObject> current_results;
+        deleted_loaded = search_all_pages(ad, base, scope, class_filter, {ATTRIBUTE_DN}, &current_results);
+
+        QSet<QString> current_set;
+        for (const QString &dn : current_results.keys()) {
+            current_set.insert(dn.toLower());
+        }
+
+        if (deleted_loaded) {
+            for (const QString &key : loaded_map.keys()) {
+                if (!current_set.contains(key)) {
+                    deleted_dn_list.append(key);
+                }
+            }
+        }
+    }
+
+    for (const QString &dn : deleted_dn_list) {
+        const QString key = dn.toLower();
+
+        if (loaded_map.contains(key) && loaded_map[key].isValid()) {
+            console->delete_item(loaded_map[key]);
+        }
+    }
+
+    update_highest_usn(ad, changed_results.values() + deleted_results.values());
+
+    // NOTE: if deleted policies couldn't be found either
+    // way, they can't be found by USN later, so do a full
+    // reload on next refresh
+    if (!deleted_loaded) {
+        highest_usn = 0;
+    }
+}
+
+void AllPoliciesFolderImpl::update_highest_usn(AdInterface &ad, const QList<AdObject> &object_list) {
+    for (const AdObject &object : object_list) {
+        const qint64 usn = object.get_string(ATTRIBUTE_USN_CHANGED).toLongLong();
+
+        highest_usn = std::max(highest_usn, usn);
+    }
+
+    highest_usn_dc = ad.get_dc();
+}
+
+// NOTE: name of a deleted object is it's original name
+// followed by "\nDEL:" and object's GUID. Original parent
+// is saved in "lastKnownParent".
+QString deleted_object_original_dn(const AdObject &object) {
+    const QString deleted_name = object.get_string(ATTRIBUTE_NAME);
+    const QString original_name = deleted_name.section('\n', 0, 0);
+    const QString original_parent = object.get_string(ATTRIBUTE_LAST_KNOWN_PARENT);
+
+    const QString out = dn_from_name_and_parent(original_name, original_parent, CLASS_GP_CONTAINER);
+
+    return out;
+}
+
+// NOTE: unlike AdInterface::search(), reports whether
+// all pages were loaded successfully
+bool search_all_pages(AdInterface &ad, const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, QHash<QString, AdObject> *results) {
+    AdCookie cookie;
+
+    while (true) {
+        const bool success = ad.search_paged(base, scope, filter, attributes, results, &cookie);
+
+        if (!success) {
+            return false;
+        }
+
+        if (!cookie.more_pages()) {
+            return true;
+        }
+    }
+}
+
 QModelIndex get_all_policies_folder_index(ConsoleWidget *console) {
     const QModelIndex policy_tree_root = get_policy_tree_root(console);
     const QModelIndex out = console->search_item(policy_tree_root, {ItemType_AllPoliciesFolder});
@@ -31,12 +31,14 @@
 
 class AdObject;
 class AdInterface;
+class GpoCoverageExportThread;
 
 class AllPoliciesFolderImpl final : public ConsoleImpl {
     Q_OBJECT
 
 public:
     AllPoliciesFolderImpl(ConsoleWidget *console_arg);
+    ~AllPoliciesFolderImpl();
 
     void fetch(const QModelIndex &index) override;
     void refresh(const QList<QModelIndex> &index_list) override;
@@ -50,8 +52,23 @@ public:
 
 private:
     QAction *create_policy_action;
+    QAction *export_coverage_action;
+    GpoCoverageExportThread *export_thread;
+
+    // NOTE: highest uSNChanged of loaded policies and the
+    // DC it was read from. Used to refresh only the
+    // policies that changed since last load. USN's are
+    // local to a DC, so a different DC requires a full
+    // reload.
+    qint64 highest_usn;
+    QString highest_usn_dc;
 
     void create_policy();
+    void export_coverage();
+    void on_export_thread_finished();
+    void load_all(AdInterface &ad, const QModelIndex &index);
+    void load_changes(AdInterface &ad, const QModelIndex &index);
+    void update_highest_usn(AdInterface &ad, const QList<AdObject> &object_list);
 };
 
 QModelIndex get_all_policies_folder_index(ConsoleWidget *console);
@@ -24,7 +24,7 @@
 #include "console_widget/console_widget.h"
 
 enum MyConsoleRole {
-    MyConsoleRole_SearchThreadId = ConsoleRole_LAST + 1,
+    MyConsoleRole_SearchId = ConsoleRole_LAST + 1,
     MyConsoleRole_LAST,
 };
 
@@ -20,6 +20,7 @@
 
 #include "console_impls/object_impl.h"
 
+#include "acl_audit_dialog.h"
 #include "adldap.h"
 #include "attribute_dialogs/list_attribute_dialog.h"
 #include "console_filter_dialog.h"
@@ -45,7 +46,9 @@
 #include "rename_dialogs/rename_object_dialog.h"
 #include "rename_dialogs/rename_other_dialog.h"
 #include "rename_dialogs/rename_user_dialog.h"
+#include "search_scheduler.h"
 #include "search_thread.h"
+#include "security_bulk_edit_dialog.h"
 #include "select_dialogs/select_container_dialog.h"
 #include "select_dialogs/select_object_dialog.h"
 #include "settings.h"
@@ -57,6 +60,7 @@
 #include "create_dialogs/create_pso_dialog.h"
 #include "results_widgets/pso_results_widget/pso_results_widget.h"
 
+#include <QDateTime>
 #include <QDebug>
 #include <QMenu>
 #include <QSet>
@@ -78,6 +82,7 @@ QString get_selected_target_dn_object(ConsoleWidget *console);
 void console_object_delete_dn_list(ConsoleWidget *console, const QList<QString> &dn_list, const QModelIndex &tree_root, const int type, const int dn_role);
 bool can_create_class_at_parent(const QString &create_class, const QString &parent_class);
 void console_object_move_and_rename(const QList<ConsoleWidget *> &console_list, AdInterface &ad, const QHash<QString, QString> &old_to_new_dn_map_arg, const QString &new_parent_dn);
+bool attribute_sort_number(const QString &attribute, const QByteArray &value, qint64 *out);
 
 ObjectImpl::ObjectImpl(ConsoleWidget *console_arg)
 : ConsoleImpl(console_arg) {
@@ -114,6 +119,8 @@ ObjectImpl::ObjectImpl(ConsoleWidget *console_arg)
     new_action_map[CLASS_INET_ORG_PERSON] = new QAction(tr("inetOrgPerson"), this);
     new_action_map[CLASS_CONTACT] = new QAction(tr("Contact"), this);
     find_action = new QAction(tr("Find..."), this);
+    audit_permissions_action = new QAction(tr("Audit permissions..."), this);
+    protect_from_deletion_action = new QAction(tr("Protect from deletion..."), this);
     move_action = new QAction(tr("Move..."), this);
     add_to_group_action = new QAction(tr("Add to group..."), this);
     enable_action = new QAction(tr("Enable"), this);
@@ -179,6 +186,12 @@ ObjectImpl::ObjectImpl(ConsoleWidget *console_arg)
     connect(
         find_action, &QAction::triggered,
         this, &ObjectImpl::on_find);
+    connect(
+        audit_permissions_action, &QAction::triggered,
+        this, &ObjectImpl::on_audit_permissions);
+    connect(
+        protect_from_deletion_action, &QAction::triggered,
+        this, &ObjectImpl::on_protect_from_deletion);
     connect(
         edit_upn_suffixes_action, &QAction::triggered,
         this, &ObjectImpl::on_edit_upn_suffixes);
@@ -332,6 +345,8 @@ QList<QAction *> ObjectImpl::get_all_custom_actions() const {
     QList<QAction *> out = {
         new_action,
         find_action,
+        audit_permissions_action,
+        protect_from_deletion_action,
         add_to_group_action,
         enable_action,
         disable_action,
@@ -372,6 +387,9 @@ QSet<QAction *> ObjectImpl::get_custom_actions(const QModelIndex &index, const b
             if (find_action_enabled) {
                 out.insert(find_action);
             }
+
+            out.insert(audit_permissions_action);
+            out.insert(protect_from_deletion_action);
         }
 
         if (is_user) {
@@ -700,6 +718,12 @@ void ObjectImpl::delete_action(const QList<QModelIndex> &index_list) {
 
 void ObjectImpl::selected_as_scope(const QModelIndex &index)
 {
+    // NOTE: if item is still being fetched, for example
+    // after it was expanded, move it's search ahead of
+    // others
+    const int search_id = index.data(MyConsoleRole_SearchId).toInt();
+    g_search_scheduler->prioritize(search_id);
+
     AdInterface ad;
     if (ad_failed(ad, console)) {
         return;
@@ -1017,6 +1041,20 @@ void ObjectImpl::on_find() {
     find_dialog->open();
 }
 
+void ObjectImpl::on_audit_permissions() {
+    const QString dn = get_selected_target_dn_object(console);
+
+    auto dialog = new AclAuditDialog(dn, console);
+    dialog->open();
+}
+
+void ObjectImpl::on_protect_from_deletion() {
+    const QString dn = get_selected_target_dn_object(console);
+
+    auto dialog = new SecurityBulkEditDialog(dn, console);
+    dialog->open();
+}
+
 void ObjectImpl::on_reset_password() {
     AdInterface ad;
     if (ad_failed(ad, console)) {
@@ -1499,6 +1537,9 @@ void ObjectImpl::update_toolbar_actions() {
 }
 
 void object_impl_add_objects_to_console(ConsoleWidget *console, const QList<AdObject> &object_list, const QModelIndex &parent) {
+    TraceSpan span("console", "object_impl_add_objects_to_console");
+    span.add_arg("objects", object_list.size());
+
     if (!parent.isValid()) {
         return;
     }
@@ -1561,6 +1602,8 @@ void object_impl_add_objects_to_console_from_dns(ConsoleWidget *console, AdInter
 }
 
 void console_object_load(const QList<QStandardItem *> row, const AdObject &object) {
+    TRACE_SCOPE("console", "console_object_load");
+
     // Load attribute columns
     for (int i = 0; i < g_adconfig->get_columns().count(); i++) {
         if (g_adconfig->get_columns().count() > row.size()) {
@@ -1595,6 +1638,19 @@ void console_object_load(const QList<QStandardItem *> row, const AdObject &objec
         }();
 
         row[i]->setText(display_value);
+
+        // NOTE: numbers and dates are displayed in ways
+        // that don't sort correctly as text, so sort them
+        // by raw value
+        qint64 sort_number;
+        const bool is_number = attribute_sort_number(attribute, object.get_value(attribute), &sort_number);
+        if (is_number) {
+            row[i]->setData(sort_number, ConsoleRole_SortNumber);
+        } else {
+            // NOTE: clear number left from previous load,
+            // for example if value was removed
+            row[i]->setData(QVariant(), ConsoleRole_SortNumber);
+        }
     }
 
     console_object_item_data_load(row[0], object);
@@ -1606,6 +1662,37 @@ void console_object_load(const QList<QStandardItem *> row, const AdObject &objec
     }
 }
 
+bool attribute_sort_number(const QString &attribute, const QByteArray &value, qint64 *out) {
+    if (value.isEmpty()) {
+        return false;
+    }
+
+    const AttributeType type = g_adconfig->get_attribute_type(attribute);
+
+    switch (type) {
+        case AttributeType_Integer:
+        case AttributeType_Enumeration:
+        case AttributeType_LargeInteger: {
+            bool ok;
+            *out = value.toLongLong(&ok);
+
+            return ok;
+        }
+        case AttributeType_UTCTime:
+        case AttributeType_GeneralizedTime: {
+            const QDateTime datetime = datetime_string_to_qdatetime(attribute, QString(value), g_adconfig);
+            if (!datetime.isValid()) {
+                return false;
+            }
+
+            *out = datetime.toMSecsSinceEpoch();
+
+            return true;
+        }
+        default: return false;
+    }
+}
+
 void console_object_item_data_load(QStandardItem *item, const AdObject &object) {
     item->setData(object.get_dn(), ObjectRole_DN);
 
@@ -1677,21 +1764,28 @@ QList<QString> console_object_search_attributes() {
 }
 
 // NOTE: it is possible for a search to start while a
-// previous one hasn't finished. For that reason, this f-n
-// contains multiple workarounds for issues caused by that
-// case.
+// previous one hasn't finished. For that reason, previous
+// search for the item is cancelled and results of
+// searches that are not current for the item are
+// ignored.
 void console_object_search(ConsoleWidget *console, const QModelIndex &index, const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes) {
-    auto search_id_matches = [](QStandardItem *item, SearchThread *thread) {
-        const int id_from_item = item->data(MyConsoleRole_SearchThreadId).toInt();
-        const int thread_id = thread->get_id();
+    auto search_id_matches = [](QStandardItem *item, SearchHandle *handle) {
+        const int id_from_item = item->data(MyConsoleRole_SearchId).toInt();
+        const int handle_id = handle->get_id();
 
-        const bool match = (id_from_item == thread_id);
+        const bool match = (id_from_item == handle_id);
 
         return match;
     };
 
     QStandardItem *item = console->get_item(index);
 
+    // NOTE: cancel previous search for this item so that
+    // it doesn't keep downloading results which would be
+    // discarded anyway
+    const int previous_search_id = item->data(MyConsoleRole_SearchId).toInt();
+    g_search_scheduler->cancel(previous_search_id);
+
     // Set icon to indicate that item is in "search" state
     item->setIcon(g_icon_manager->get_indicator_icon(g_icon_manager->search_indicator));
 
@@ -1700,22 +1794,30 @@ void console_object_search(ConsoleWidget *console, const QModelIndex &index, con
     item->setData(true, ObjectRole_Fetching);
     item->setDragEnabled(false);
 
-    auto search_thread = new SearchThread(base, scope, filter, attributes);
+    // NOTE: search for currently selected item goes
+    // ahead of other searches, for example ones started
+    // by expanding items in the tree
+    const SearchPriority priority = [&]() {
+        const bool is_current = (index == console->get_current_scope_item());
+
+        if (is_current) {
+            return SearchPriority_High;
+        } else {
+            return SearchPriority_Normal;
+        }
+    }();
+
+    SearchHandle *search_handle = g_search_scheduler->start(base, scope, filter, attributes, priority);
 
-    // NOTE: change item's search thread, this will be used
-    // later to handle situations where a thread is started
-    // while another is running
-    item->setData(search_thread->get_id(), MyConsoleRole_SearchThreadId);
+    // NOTE: change item's search, this will be used later
+    // to handle situations where a search is started while
+    // another is running
+    item->setData(search_handle->get_id(), MyConsoleRole_SearchId);
 
     const QPersistentModelIndex persistent_index = index;
 
-    // NOTE: need to pass console as receiver object to
-    // connect() even though we're using lambda as a slot.
-    // This is to be able to define queuedconnection type,
-    // because there's no connect() version with no receiver
-    // which has a connection type argument.
     QObject::connect(
-        search_thread, &SearchThread::results_ready,
+        search_handle, &SearchHandle::results_ready,
         console,
         [=](const QHash<QString, AdObject> &results) {
             // NOTE: fetched index might become invalid for
@@ -1723,46 +1825,47 @@ void console_object_search(ConsoleWidget *console, const QModelIndex &index, con
             // item at the index itself might get modified.
             // Since this slot runs in the main thread, it's
             // not possible for any catastrophic conflict to
-            // happen, so it's enough to just stop the
+            // happen, so it's enough to just cancel the
             // search.
             if (!persistent_index.isValid()) {
-                search_thread->stop();
+                g_search_scheduler->cancel(search_handle->get_id());
 
                 return;
             }
 
             QStandardItem *item_now = console->get_item(persistent_index);
 
-            // NOTE: if another thread was started for this
-            // item, abort this thread
-            const bool thread_id_match = search_id_matches(item_now, search_thread);
-            if (!thread_id_match) {
-                search_thread->stop();
+            // NOTE: if another search was started for this
+            // item, cancel this search
+            const bool search_id_match = search_id_matches(item_now, search_handle);
+            if (!search_id_match) {
+                g_search_scheduler->cancel(search_handle->get_id());
 
                 return;
             }
 
             object_impl_add_objects_to_console(console, results.values(), persistent_index);
-        },
-        Qt::QueuedConnection);
+        });
     QObject::connect(
-        search_thread, &SearchThread::finished,
+        search_handle, &SearchHandle::finished,
         console,
         [=]() {
+            search_handle->deleteLater();
+
             if (!persistent_index.isValid()) {
                 return;
             }
 
-            g_status->display_ad_messages(search_thread->get_ad_messages(), console);
-            search_thread_display_errors(search_thread, console);
+            g_status->display_ad_messages(search_handle->get_ad_messages(), console);
+            search_display_errors(search_handle->failed_to_connect(), search_handle->hit_object_display_limit(), console);
 
             QStandardItem *item_now = console->get_item(persistent_index);
 
-            // NOTE: if another thread was started for this
+            // NOTE: if another search was started for this
             // item, don't change item data. It will be
-            // changed by that other thread.
-            const bool thread_id_match = search_id_matches(item_now, search_thread);
-            if (!thread_id_match) {
+            // changed by that other search.
+            const bool search_id_match = search_id_matches(item_now, search_handle);
+            if (!search_id_match) {
                 return;
             }
 
@@ -1771,12 +1874,7 @@ void console_object_search(ConsoleWidget *console, const QModelIndex &index, con
 
             item_now->setData(false, ObjectRole_Fetching);
             item_now->setDragEnabled(true);
-
-            search_thread->deleteLater();
-        },
-        Qt::QueuedConnection);
-
-    search_thread->start();
+        });
 }
 
 void console_object_tree_init(ConsoleWidget *console, AdInterface &ad) {
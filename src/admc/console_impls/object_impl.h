@@ -119,6 +119,8 @@ private slots:
     void on_disable();
     void on_add_to_group();
     void on_find();
+    void on_audit_permissions();
+    void on_protect_from_deletion();
     void on_reset_password();
     void on_edit_upn_suffixes();
     void on_reset_account();
@@ -129,6 +131,8 @@ private:
     bool object_filter_enabled;
 
     QAction *find_action;
+    QAction *audit_permissions_action;
+    QAction *protect_from_deletion_action;
     QAction *move_action;
     QAction *add_to_group_action;
     QAction *enable_action;
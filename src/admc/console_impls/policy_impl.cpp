@@ -262,14 +262,16 @@ void PolicyImpl::on_change_gplink_option_action(QAction *action)
 
     bool checked = action->isChecked();
 
-    const QString gplink_string = ou_index.data(PolicyOURole_Gplink_String).toString();
-    Gplink gplink = Gplink(gplink_string);
-    gplink.set_option(gpo_dn, option, checked);
-    const QString updated_gplink_string = gplink.to_string();
-
-    bool success = ad.attribute_replace_string(ou_dn, ATTRIBUTE_GPLINK, updated_gplink_string);
+    const QList<GplinkEdit> edit_list = {GplinkEdit(ou_dn, gpo_dn, GplinkEditType_SetOption, option, checked)};
+    QHash<QString, QString> new_gplink_map;
+    const bool success = ad.gplink_edit(edit_list, &new_gplink_map);
     if (success) {
-        update_ou_item_gplink_data(updated_gplink_string, ou_index, console);
+        // NOTE: map doesn't contain OU if option already
+        // had this value on the server
+        if (new_gplink_map.contains(ou_dn)) {
+            update_ou_item_gplink_data(new_gplink_map[ou_dn], ou_index, console);
+        }
+
         set_policy_item_icon(policy_index, checked, option);
         policy_results->update(gpo_dn);
     }
@@ -355,6 +357,16 @@ void console_policy_load_item(QStandardItem *main_item, const AdObject &object)
     main_item->setData(gpo_status, PolicyRole_GPO_Status);
 }
 
+QList<QString> console_policy_search_attributes() {
+    return {
+        ATTRIBUTE_DISPLAY_NAME,
+        ATTRIBUTE_FLAGS,
+        ATTRIBUTE_OBJECT_CATEGORY,
+        ATTRIBUTE_OBJECT_CLASS,
+        ATTRIBUTE_USN_CHANGED,
+    };
+}
+
 void console_policy_edit(ConsoleWidget *console, const int item_type, const int dn_role) {
     const QString dn = get_selected_target_dn(console, item_type, dn_role);
 
@@ -524,28 +536,27 @@ void console_policy_remove_link(const QList<ConsoleWidget *> &console_list, Poli
 
     show_busy_indicator();
 
-    const QString gplink_new_string = [&]() {
-        Gplink gplink = [&]() {
-            const AdObject parent_object = ad.search_object(ou_dn);
-            const QString gplink_old_string = parent_object.get_string(ATTRIBUTE_GPLINK);
-            const Gplink out = Gplink(gplink_old_string);
-
-            return out;
-        }();
+    const QList<GplinkEdit> edit_list = [&]() {
+        QList<GplinkEdit> out;
 
         for (const QString &dn : dn_list) {
-            gplink.remove(dn);
+            out.append(GplinkEdit(ou_dn, dn, GplinkEditType_Remove));
         }
 
-        const QString out = gplink.to_string();
-
         return out;
     }();
 
-    const bool replace_success = ad.attribute_replace_string(ou_dn, ATTRIBUTE_GPLINK, gplink_new_string);
+    QHash<QString, QString> new_gplink_map;
+    const bool edit_success = ad.gplink_edit(edit_list, &new_gplink_map);
 
-    if (replace_success) {
-        auto apply_changes = [&ou_dn, &dn_list, &gplink_new_string, policy_results](ConsoleWidget *target_console) {
+    if (edit_success) {
+        // NOTE: map doesn't contain OU if policies were
+        // already unlinked on the server, in which case
+        // only items need to be removed
+        const bool gplink_changed = new_gplink_map.contains(ou_dn);
+        const QString gplink_new_string = new_gplink_map.value(ou_dn);
+
+        auto apply_changes = [&ou_dn, &dn_list, gplink_changed, &gplink_new_string, policy_results](ConsoleWidget *target_console) {
             const QModelIndex policy_root = get_policy_tree_root(target_console);
 
             // NOTE: there can be duplicate items for
@@ -555,7 +566,9 @@ void console_policy_remove_link(const QList<ConsoleWidget *> &console_list, Poli
                 const QModelIndex ou_index = target_console->search_item(policy_root, PolicyOURole_DN, ou_dn, {ItemType_PolicyOU});
 
                 if (ou_index.isValid()) {
-                    update_ou_item_gplink_data(gplink_new_string, ou_index, target_console);
+                    if (gplink_changed) {
+                        update_ou_item_gplink_data(gplink_new_string, ou_index, target_console);
+                    }
 
                     for (const QString &dn : dn_list) {
                         const QModelIndex gpo_index = get_ou_child_policy_index(target_console, ou_index, dn);
@@ -754,23 +767,19 @@ void policy_add_links(const QList<ConsoleWidget *> &console_list, PolicyResultsW
 
     show_busy_indicator();
 
-    for (const QString &ou_dn : ou_list) {
-        const QString base = ou_dn;
-        const SearchScope scope = SearchScope_Object;
-        const QString filter = QString();
-        const QList<QString> attributes = {ATTRIBUTE_GPLINK};
-        const QHash<QString, AdObject> results = ad.search(base, scope, filter, attributes);
+    const QList<GplinkEdit> edit_list = [&]() {
+        QList<GplinkEdit> out;
 
-        const AdObject ou_object = results[ou_dn];
-        const QString gplink_string = ou_object.get_string(ATTRIBUTE_GPLINK);
-        Gplink gplink = Gplink(gplink_string);
-
-        for (const QString &policy : policy_list) {
-            gplink.add(policy);
+        for (const QString &ou_dn : ou_list) {
+            for (const QString &policy : policy_list) {
+                out.append(GplinkEdit(ou_dn, policy, GplinkEditType_Add));
+            }
         }
 
-        ad.attribute_replace_string(ou_dn, ATTRIBUTE_GPLINK, gplink.to_string());
-    }
+        return out;
+    }();
+
+    ad.gplink_edit(edit_list);
 
     // TODO: serch for all policy objects once, then add
     // them to OU's
@@ -401,32 +401,34 @@ void PolicyOUImpl::link_gpo_to_ou(const QModelIndex &ou_index, const QString &ou
         return;
     }
 
-    const Gplink original_gplink = [&]() {
-        const AdObject target_object = ad.search_object(ou_dn);
-        const QString gplink_string = target_object.get_string(ATTRIBUTE_GPLINK);
-        const Gplink out = Gplink(gplink_string);
-
-        return out;
-    }();
-
-    const Gplink new_gplink = [&]() {
-        Gplink out = original_gplink;
+    const QList<GplinkEdit> edit_list = [&]() {
+        QList<GplinkEdit> out;
 
         for (const QString &gpo : gpo_list) {
-            out.add(gpo);
+            out.append(GplinkEdit(ou_dn, gpo, GplinkEditType_Add));
         }
 
         return out;
     }();
 
-    const QString new_gplink_string = new_gplink.to_string();
-
-    bool success = ad.attribute_replace_string(ou_dn, ATTRIBUTE_GPLINK, new_gplink_string);
+    QHash<QString, QString> new_gplink_map;
+    const bool success = ad.gplink_edit(edit_list, &new_gplink_map);
 
     g_status->display_ad_messages(ad, console);
 
-    if (!success)
+    // NOTE: map doesn't contain OU if all policies were
+    // already linked
+    if (!success || !new_gplink_map.contains(ou_dn)) {
         return;
+    }
+
+    const QString new_gplink_string = new_gplink_map[ou_dn];
+    const Gplink new_gplink = Gplink(new_gplink_string);
+
+    // NOTE: compare against gplink that console items
+    // were loaded from, so that only missing policy
+    // items are added
+    const Gplink original_gplink = Gplink(ou_index.data(PolicyOURole_Gplink_String).toString());
 
     update_ou_item_gplink_data(new_gplink_string, ou_index, console);
 
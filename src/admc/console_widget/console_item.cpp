@@ -0,0 +1,74 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "console_widget/console_item.h"
+
+#include "console_widget/console_widget.h"
+#include "console_widget/console_widget_p.h"
+
+ConsoleItem::ConsoleItem()
+: QStandardItem() {
+    sort_key_is_valid = false;
+}
+
+QVariant ConsoleItem::data(int role) const {
+    if (role != ConsoleRole_SortKey) {
+        return QStandardItem::data(role);
+    }
+
+    if (!sort_key_is_valid) {
+        const QVariant sort_number = QStandardItem::data(ConsoleRole_SortNumber);
+
+        if (sort_number.isValid()) {
+            sort_key = ConsoleSortKey::from_number(sort_number.toLongLong());
+        } else {
+            sort_key = ConsoleSortKey::from_string(text());
+        }
+
+        const int sort_index = QStandardItem::data(ConsoleRole_SortIndex).toInt();
+        sort_key.set_sort_index(sort_index);
+
+        sort_key_is_valid = true;
+    }
+
+    return QVariant::fromValue(sort_key);
+}
+
+void ConsoleItem::setData(const QVariant &value, int role) {
+    // NOTE: sort key is not stored, so ignore attempts
+    // to set it
+    if (role == ConsoleRole_SortKey) {
+        return;
+    }
+
+    const bool sort_key_changed = (role == Qt::DisplayRole || role == Qt::EditRole || role == ConsoleRole_SortNumber || role == ConsoleRole_SortIndex);
+    if (sort_key_changed) {
+        sort_key_is_valid = false;
+    }
+
+    QStandardItem::setData(value, role);
+}
+
+QStandardItem *ConsoleItem::clone() const {
+    auto out = new ConsoleItem();
+    *out = *this;
+
+    return out;
+}
@@ -0,0 +1,50 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONSOLE_ITEM_H
+#define CONSOLE_ITEM_H
+
+/**
+ * Item used for all rows of the console model. Provides
+ * ConsoleRole_SortKey, which is built from item's text,
+ * sort number and sort index the first time it's needed
+ * and then reused until one of those changes. This makes
+ * sorting large results a matter of comparing keys.
+ */
+
+#include "console_widget/console_sort_key.h"
+
+#include <QStandardItem>
+
+class ConsoleItem final : public QStandardItem {
+
+public:
+    ConsoleItem();
+
+    QVariant data(int role = Qt::UserRole + 1) const override;
+    void setData(const QVariant &value, int role = Qt::UserRole + 1) override;
+    QStandardItem *clone() const override;
+
+private:
+    mutable ConsoleSortKey sort_key;
+    mutable bool sort_key_is_valid;
+};
+
+#endif /* CONSOLE_ITEM_H */
@@ -0,0 +1,113 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "console_widget/console_sort_key.h"
+
+#include "console_widget/console_widget_p.h"
+
+#include <QCollator>
+#include <QModelIndex>
+#include <QString>
+
+const QCollator &console_collator();
+
+ConsoleSortKey::ConsoleSortKey() {
+    sort_index = 0;
+    kind = Kind_Empty;
+    number = 0;
+}
+
+ConsoleSortKey ConsoleSortKey::from_string(const QString &string) {
+    ConsoleSortKey out;
+
+    if (!string.isEmpty()) {
+        // NOTE: fold case here instead of making the
+        // collator case insensitive, because posix
+        // collator backend doesn't support case
+        // insensitivity
+        const QString folded = string.toCaseFolded();
+
+        out.kind = Kind_String;
+        out.string_key = QSharedPointer<QCollatorSortKey>::create(console_collator().sortKey(folded));
+    }
+
+    return out;
+}
+
+ConsoleSortKey ConsoleSortKey::from_number(const qint64 number) {
+    ConsoleSortKey out;
+    out.kind = Kind_Number;
+    out.number = number;
+
+    return out;
+}
+
+void ConsoleSortKey::set_sort_index(const int sort_index_arg) {
+    sort_index = sort_index_arg;
+}
+
+bool ConsoleSortKey::operator<(const ConsoleSortKey &other) const {
+    if (sort_index != other.sort_index) {
+        return (sort_index < other.sort_index);
+    }
+
+    if (kind != other.kind) {
+        return (kind < other.kind);
+    }
+
+    switch (kind) {
+        case Kind_Empty: return false;
+        case Kind_Number: return (number < other.number);
+        case Kind_String: return (string_key->compare(*other.string_key) < 0);
+    }
+
+    return false;
+}
+
+bool console_sort_key_less_than(const QModelIndex &left, const QModelIndex &right, bool *ok) {
+    const QVariant left_variant = left.data(ConsoleRole_SortKey);
+    const QVariant right_variant = right.data(ConsoleRole_SortKey);
+
+    const int key_type = qMetaTypeId<ConsoleSortKey>();
+    const bool both_have_keys = (left_variant.userType() == key_type && right_variant.userType() == key_type);
+
+    *ok = both_have_keys;
+
+    if (!both_have_keys) {
+        return false;
+    }
+
+    // NOTE: compare in place to avoid copying keys out
+    // of variants
+    const ConsoleSortKey *left_key = static_cast<const ConsoleSortKey *>(left_variant.constData());
+    const ConsoleSortKey *right_key = static_cast<const ConsoleSortKey *>(right_variant.constData());
+
+    const bool out = (*left_key < *right_key);
+
+    return out;
+}
+
+// NOTE: creating a collator is expensive, so share one
+// for all keys. Keys are only made in the main thread.
+const QCollator &console_collator() {
+    static const QCollator collator;
+
+    return collator;
+}
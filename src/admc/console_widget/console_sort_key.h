@@ -0,0 +1,76 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONSOLE_SORT_KEY_H
+#define CONSOLE_SORT_KEY_H
+
+/**
+ * Precomputed key for sorting console items. Keys are
+ * made once per item, so comparing two items doesn't
+ * involve case folding or locale-aware string compares.
+ * Text is compared using collation keys of the current
+ * locale. Numbers, like integer attributes and dates, are
+ * compared numerically. Sort index, which scope items use
+ * to put some items before others, is part of the key.
+ */
+
+#include <QMetaType>
+#include <QSharedPointer>
+
+class QCollatorSortKey;
+class QModelIndex;
+class QString;
+
+class ConsoleSortKey {
+
+public:
+    ConsoleSortKey();
+
+    static ConsoleSortKey from_string(const QString &string);
+    static ConsoleSortKey from_number(const qint64 number);
+
+    void set_sort_index(const int sort_index);
+
+    bool operator<(const ConsoleSortKey &other) const;
+
+private:
+    // NOTE: order of kinds is the order of sorting, so
+    // empty values come before everything else
+    enum Kind {
+        Kind_Empty,
+        Kind_Number,
+        Kind_String,
+    };
+
+    int sort_index;
+    Kind kind;
+    qint64 number;
+    QSharedPointer<QCollatorSortKey> string_key;
+};
+
+Q_DECLARE_METATYPE(ConsoleSortKey)
+
+// Compares indexes using their ConsoleRole_SortKey. Sets
+// "ok" to false if one of the indexes doesn't have a sort
+// key, which is the case for indexes of models that don't
+// use console items.
+bool console_sort_key_less_than(const QModelIndex &left, const QModelIndex &right, bool *ok);
+
+#endif /* CONSOLE_SORT_KEY_H */
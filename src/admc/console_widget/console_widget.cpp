@@ -21,8 +21,10 @@
 #include "console_widget/console_widget.h"
 #include "console_widget/console_widget_p.h"
 
+#include "ad_trace.h"
 #include "console_widget/console_drag_model.h"
 #include "console_widget/console_impl.h"
+#include "console_widget/console_item.h"
 #include "console_widget/customize_columns_dialog.h"
 #include "console_widget/results_view.h"
 #include "console_widget/scope_proxy_model.h"
@@ -108,6 +110,7 @@ ConsoleWidget::ConsoleWidget(QWidget *parent)
     d->scope_view->setRootIsDecorated(false);
 
     d->model = new ConsoleDragModel(this);
+    d->model->setItemPrototype(new ConsoleItem());
 
     // NOTE: using a proxy model for scope to be able to do
     // case insensitive sorting
@@ -259,17 +262,23 @@ void ConsoleWidget::register_impl(const int type, ConsoleImpl *impl) {
 }
 
 QList<QStandardItem *> ConsoleWidget::add_scope_item(const int type, const QModelIndex &parent) {
+    TRACE_SCOPE("console", "ConsoleWidget::add_scope_item");
+
     const QList<QStandardItem *> row = add_results_item(type, parent);
 
     row[0]->setData(false, ConsoleRole_WasFetched);
     row[0]->setData(true, ConsoleRole_IsScope);
 
+    TraceSpan sort_span("console", "scope_sort");
     d->scope_proxy_model->sort(0, Qt::AscendingOrder);
+    sort_span.end();
 
     return row;
 }
 
 QList<QStandardItem *> ConsoleWidget::add_results_item(const int type, const QModelIndex &parent) {
+    TRACE_SCOPE("console", "ConsoleWidget::add_results_item");
+
     QStandardItem *parent_item = [&]() {
         if (parent.isValid()) {
             return d->model->itemFromIndex(parent);
@@ -292,7 +301,7 @@ QList<QStandardItem *> ConsoleWidget::add_results_item(const int type, const QMo
         }();
 
         for (int i = 0; i < column_count; i++) {
-            const auto item = new QStandardItem();
+            const auto item = new ConsoleItem();
             out.append(item);
         }
 
@@ -308,6 +317,8 @@ QList<QStandardItem *> ConsoleWidget::add_results_item(const int type, const QMo
 }
 
 void ConsoleWidget::delete_item(const QModelIndex &index) {
+    TRACE_SCOPE("console", "ConsoleWidget::delete_item");
+
     if (!index.isValid()) {
         return;
     }
@@ -328,6 +339,8 @@ void ConsoleWidget::set_current_scope(const QModelIndex &index) {
 }
 
 void ConsoleWidget::refresh_scope(const QModelIndex &index) {
+    TRACE_SCOPE("console", "ConsoleWidget::refresh_scope");
+
     if (!index.isValid()) {
         return;
     }
@@ -572,6 +585,9 @@ void ConsoleWidget::set_scope_view_visible(const bool visible) {
 }
 
 void ConsoleWidget::delete_children(const QModelIndex &parent) {
+    TraceSpan span("console", "ConsoleWidget::delete_children");
+    span.add_arg("rows", d->model->rowCount(parent));
+
     d->model->removeRows(0, d->model->rowCount(parent), parent);
 }
 
@@ -908,6 +924,8 @@ void ConsoleWidgetPrivate::set_results_to_type(const ResultsViewType type) {
 }
 
 void ConsoleWidgetPrivate::fetch_scope(const QModelIndex &index) {
+    TRACE_SCOPE("console", "ConsoleWidgetPrivate::fetch_scope");
+
     const bool was_fetched = index.data(ConsoleRole_WasFetched).toBool();
 
     if (!was_fetched) {
@@ -1004,6 +1022,8 @@ QList<QAction *> ConsoleWidgetPrivate::get_custom_action_list() const {
 }
 
 void ConsoleWidgetPrivate::on_current_scope_item_changed(const QModelIndex &current_proxy, const QModelIndex &previous_proxy) {
+    TRACE_SCOPE("console", "ConsoleWidgetPrivate::on_current_scope_item_changed");
+
     // NOTE: technically this slot should never be called
     // with invalid current index
     if (!current_proxy.isValid()) {
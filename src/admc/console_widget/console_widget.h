@@ -48,6 +48,11 @@ class ConsoleDragModel;
 #define UNUSED_ARG(x) (void) (x)
 
 enum ConsoleRolePublic {
+    // Set this role to a number to sort item's column
+    // by that number instead of by text. Useful for
+    // numbers and dates.
+    ConsoleRole_SortNumber = Qt::UserRole + 18,
+
     ConsoleRole_Type = Qt::UserRole + 19,
 
     // NOTE: when implementing custom roles, make sure they do
@@ -48,10 +48,15 @@ enum ConsoleRole {
 
     ConsoleRole_IsScope = Qt::UserRole + 3,
 
+    // Precomputed key used by proxy models for sorting,
+    // see ConsoleItem
+    ConsoleRole_SortKey = Qt::UserRole + 4,
+
     // NOTE: don't go above ConsoleRole_Type and
     // ConsoleRole_LAST (defined in public header)
 
     // NOTE: these roles are "public" defined in public header
+    // ConsoleRole_SortNumber = Qt::UserRole + 18,
     // ConsoleRole_Type = Qt::UserRole + 19,
     // ConsoleRole_LAST = Qt::UserRole + 20
 };
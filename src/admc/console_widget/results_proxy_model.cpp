@@ -0,0 +1,41 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "console_widget/results_proxy_model.h"
+
+#include "console_widget/console_sort_key.h"
+
+ResultsProxyModel::ResultsProxyModel(QObject *parent)
+: QSortFilterProxyModel(parent) {
+    setSortCaseSensitivity(Qt::CaseInsensitive);
+}
+
+bool ResultsProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const {
+    bool key_ok;
+    const bool key_less_than = console_sort_key_less_than(left, right, &key_ok);
+
+    if (key_ok) {
+        return key_less_than;
+    }
+
+    const bool out = QSortFilterProxyModel::lessThan(left, right);
+
+    return out;
+}
@@ -0,0 +1,42 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RESULTS_PROXY_MODEL_H
+#define RESULTS_PROXY_MODEL_H
+
+#include <QSortFilterProxyModel>
+
+/**
+ * Proxy model for results views. Sorts using precomputed
+ * sort keys of console items. Falls back to case
+ * insensitive compare of text for models that don't
+ * provide sort keys.
+ */
+
+class ResultsProxyModel final : public QSortFilterProxyModel {
+    Q_OBJECT
+
+public:
+    ResultsProxyModel(QObject *parent);
+
+    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+};
+
+#endif /* RESULTS_PROXY_MODEL_H */
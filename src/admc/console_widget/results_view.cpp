@@ -20,6 +20,8 @@
 
 #include "console_widget/results_view.h"
 
+#include "console_widget/results_proxy_model.h"
+
 #include <QHeaderView>
 #include <QListView>
 #include <QSortFilterProxyModel>
@@ -43,13 +45,21 @@ ResultsView::ResultsView(QWidget *parent)
     icons_view->setGridSize(QSize(100, 100));
     icons_view->setIconSize(QSize(64, 64));
 
+    // NOTE: all items in list views have the same size,
+    // so let them skip measuring each item. Batched
+    // layout keeps the view responsive while a large
+    // amount of items is laid out.
+    for (QListView *view : {list_view, icons_view}) {
+        view->setUniformItemSizes(true);
+        view->setLayoutMode(QListView::Batched);
+    }
+
     // Put child views into map
     views[ResultsViewType_Icons] = icons_view;
     views[ResultsViewType_List] = list_view;
     views[ResultsViewType_Detail] = m_detail_view;
 
-    proxy_model = new QSortFilterProxyModel(this);
-    proxy_model->setSortCaseSensitivity(Qt::CaseInsensitive);
+    proxy_model = new ResultsProxyModel(this);
 
     // Perform common setup on child views
     for (auto view : views.values()) {
@@ -58,16 +68,6 @@ ResultsView::ResultsView(QWidget *parent)
         view->setSelectionMode(QAbstractItemView::ExtendedSelection);
         view->setDragDropOverwriteMode(true);
 
-        // NOTE: a proxy is model is inserted between
-        // results views and results models for more
-        // efficient sorting. If results views and models
-        // are connected directly, deletion of results
-        // models becomes extremely slow.
-        view->setModel(proxy_model);
-
-        connect(
-            view->selectionModel(), &QItemSelectionModel::selectionChanged,
-            this, &ResultsView::selection_changed);
     }
 
     set_drag_drop_enabled(true);
@@ -93,6 +93,7 @@ ResultsView::ResultsView(QWidget *parent)
             this, &ResultsView::context_menu);
     }
 
+    m_current_view_type = ResultsViewType_Detail;
     set_view_type(ResultsViewType_Detail);
 }
 
@@ -101,9 +102,12 @@ void ResultsView::set_model(QAbstractItemModel *model) {
 }
 
 void ResultsView::set_parent(const QModelIndex &source_index) {
-    const QModelIndex proxy_index = proxy_model->mapFromSource(source_index);
+    proxy_root = proxy_model->mapFromSource(source_index);
+
     for (auto view : views.values()) {
-        view->setRootIndex(proxy_index);
+        if (view->model() == proxy_model) {
+            view->setRootIndex(proxy_root);
+        }
     }
 }
 
@@ -115,6 +119,16 @@ void ResultsView::set_view_type(const ResultsViewType type) {
     // change
     m_current_view_type = type;
 
+    // NOTE: only the current view is attached to the
+    // model, so that hidden views don't have to process
+    // row insertions and layout changes. Detail view is
+    // always attached because it's header holds column
+    // and sort state.
+    for (auto the_view : views.values()) {
+        const bool attached = (the_view == view || the_view == m_detail_view);
+        set_view_attached(the_view, attached);
+    }
+
     stacked_widget->setCurrentWidget(view);
 
     // Clear selection since view type changed
@@ -229,3 +243,38 @@ void ResultsView::set_row_hidden(int row, bool hidden)
 {
     m_detail_view->setRowHidden(row, QModelIndex(), hidden);
 }
+
+void ResultsView::set_view_attached(QAbstractItemView *view, const bool attached) {
+    QAbstractItemModel *model = [&]() -> QAbstractItemModel * {
+        if (attached) {
+            // NOTE: a proxy is model is inserted between
+            // results views and results models for more
+            // efficient sorting. If results views and
+            // models are connected directly, deletion of
+            // results models becomes extremely slow.
+            return proxy_model;
+        } else {
+            return nullptr;
+        }
+    }();
+
+    if (view->model() == model) {
+        return;
+    }
+
+    // NOTE: setModel() creates a new selection model
+    // but doesn't delete the old one
+    QItemSelectionModel *old_selection_model = view->selectionModel();
+
+    view->setModel(model);
+
+    delete old_selection_model;
+
+    if (attached) {
+        view->setRootIndex(proxy_root);
+
+        connect(
+            view->selectionModel(), &QItemSelectionModel::selectionChanged,
+            this, &ResultsView::selection_changed);
+    }
+}
@@ -28,6 +28,7 @@
  * switch between views.
  */
 
+#include <QPersistentModelIndex>
 #include <QWidget>
 
 class QTreeView;
@@ -35,7 +36,6 @@ class QStackedWidget;
 class QAbstractItemView;
 class QAbstractItemModel;
 class QSortFilterProxyModel;
-class QModelIndex;
 
 enum ResultsViewType {
     ResultsViewType_Icons,
@@ -81,10 +81,12 @@ private:
     QStackedWidget *stacked_widget;
     QHash<ResultsViewType, QAbstractItemView *> views;
     QSortFilterProxyModel *proxy_model;
+    QPersistentModelIndex proxy_root;
     ResultsViewType m_current_view_type;
     QTreeView *m_detail_view;
 
     void on_item_activated(const QModelIndex &index);
+    void set_view_attached(QAbstractItemView *view, const bool attached);
 };
 
 #endif /* RESULTS_VIEW_H */
@@ -20,6 +20,7 @@
 
 #include "console_widget/scope_proxy_model.h"
 
+#include "console_widget/console_sort_key.h"
 #include "console_widget/console_widget_p.h"
 
 // This tricks the view into thinking that an item in tree
@@ -46,13 +47,12 @@ bool ScopeProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source
 }
 
 bool ScopeProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const {
-    const int left_sort_index = left.data(ConsoleRole_SortIndex).toInt();
-    const int right_sort_index = right.data(ConsoleRole_SortIndex).toInt();
+    // NOTE: sort index is part of the sort key
+    bool key_ok;
+    const bool key_less_than = console_sort_key_less_than(left, right, &key_ok);
 
-    if (left_sort_index != right_sort_index) {
-        const bool out = (left_sort_index < right_sort_index);
-
-        return out;
+    if (key_ok) {
+        return key_less_than;
     }
 
     const bool out = QSortFilterProxyModel::lessThan(left, right);
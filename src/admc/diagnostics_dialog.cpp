@@ -0,0 +1,319 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "diagnostics_dialog.h"
+#include "ui_diagnostics_dialog.h"
+
+#include "adldap.h"
+#include "settings.h"
+#include "status.h"
+#include "utils.h"
+
+#include <QFile>
+#include <QFileDialog>
+#include <QStandardItemModel>
+#include <QStandardPaths>
+
+enum OperationColumn {
+    OperationColumn_Operation,
+    OperationColumn_Dc,
+    OperationColumn_Count,
+    OperationColumn_Errors,
+    OperationColumn_Total,
+    OperationColumn_Average,
+    OperationColumn_P50,
+    OperationColumn_P95,
+    OperationColumn_Max,
+    OperationColumn_Entries,
+    OperationColumn_Pages,
+    OperationColumn_Bytes,
+
+    OperationColumn_COUNT,
+};
+
+enum HistogramColumn {
+    HistogramColumn_Latency,
+    HistogramColumn_Count,
+    HistogramColumn_Percent,
+    HistogramColumn_Cumulative,
+
+    HistogramColumn_COUNT,
+};
+
+enum SearchColumn {
+    SearchColumn_Total,
+    SearchColumn_Server,
+    SearchColumn_Client,
+    SearchColumn_Entries,
+    SearchColumn_Pages,
+    SearchColumn_Bytes,
+    SearchColumn_Base,
+    SearchColumn_Scope,
+    SearchColumn_Filter,
+    SearchColumn_Dc,
+    SearchColumn_Time,
+
+    SearchColumn_COUNT,
+};
+
+enum DiagnosticsTab {
+    DiagnosticsTab_Operations,
+    DiagnosticsTab_Searches,
+};
+
+const int DiagnosticsRole_Histogram = Qt::UserRole;
+
+double usec_to_msec(const qint64 usec);
+
+DiagnosticsDialog::DiagnosticsDialog(QWidget *parent)
+: QDialog(parent) {
+    ui = new Ui::DiagnosticsDialog();
+    ui->setupUi(this);
+
+    setAttribute(Qt::WA_DeleteOnClose);
+
+    operations_model = new QStandardItemModel(0, OperationColumn_COUNT, this);
+    set_horizontal_header_labels_from_map(operations_model,
+        {
+            {OperationColumn_Operation, tr("Operation")},
+            {OperationColumn_Dc, tr("DC")},
+            {OperationColumn_Count, tr("Count")},
+            {OperationColumn_Errors, tr("Errors")},
+            {OperationColumn_Total, tr("Total, ms")},
+            {OperationColumn_Average, tr("Average, ms")},
+            {OperationColumn_P50, tr("Median, ms")},
+            {OperationColumn_P95, tr("95%, ms")},
+            {OperationColumn_Max, tr("Max, ms")},
+            {OperationColumn_Entries, tr("Entries")},
+            {OperationColumn_Pages, tr("Pages")},
+            {OperationColumn_Bytes, tr("Bytes")},
+        });
+
+    histogram_model = new QStandardItemModel(0, HistogramColumn_COUNT, this);
+    set_horizontal_header_labels_from_map(histogram_model,
+        {
+            {HistogramColumn_Latency, tr("Latency")},
+            {HistogramColumn_Count, tr("Count")},
+            {HistogramColumn_Percent, tr("Percent")},
+            {HistogramColumn_Cumulative, tr("Cumulative percent")},
+        });
+
+    searches_model = new QStandardItemModel(0, SearchColumn_COUNT, this);
+    set_horizontal_header_labels_from_map(searches_model,
+        {
+            {SearchColumn_Total, tr("Total, ms")},
+            {SearchColumn_Server, tr("Server, ms")},
+            {SearchColumn_Client, tr("Client, ms")},
+            {SearchColumn_Entries, tr("Entries")},
+            {SearchColumn_Pages, tr("Pages")},
+            {SearchColumn_Bytes, tr("Bytes")},
+            {SearchColumn_Base, tr("Base")},
+            {SearchColumn_Scope, tr("Scope")},
+            {SearchColumn_Filter, tr("Filter")},
+            {SearchColumn_Dc, tr("DC")},
+            {SearchColumn_Time, tr("Time")},
+        });
+
+    ui->operations_view->setModel(operations_model);
+    ui->histogram_view->setModel(histogram_model);
+    ui->searches_view->setModel(searches_model);
+
+    ui->searches_view->setColumnWidth(SearchColumn_Base, 200);
+    ui->searches_view->setColumnWidth(SearchColumn_Filter, 300);
+
+    load();
+
+    settings_setup_dialog_geometry(SETTING_diagnostics_dialog_geometry, this);
+
+    connect(
+        ui->operations_view->selectionModel(), &QItemSelectionModel::currentChanged,
+        this, &DiagnosticsDialog::on_operation_selected);
+    connect(
+        ui->refresh_button, &QPushButton::clicked,
+        this, &DiagnosticsDialog::load);
+    connect(
+        ui->reset_button, &QPushButton::clicked,
+        this, &DiagnosticsDialog::on_reset);
+    connect(
+        ui->export_button, &QPushButton::clicked,
+        this, &DiagnosticsDialog::on_export);
+}
+
+DiagnosticsDialog::~DiagnosticsDialog() {
+    delete ui;
+}
+
+void DiagnosticsDialog::load() {
+    // NOTE: disable sorting while loading so that rows are
+    // not resorted after every insert
+    ui->operations_view->setSortingEnabled(false);
+    ui->searches_view->setSortingEnabled(false);
+
+    operations_model->removeRows(0, operations_model->rowCount());
+    histogram_model->removeRows(0, histogram_model->rowCount());
+    searches_model->removeRows(0, searches_model->rowCount());
+
+    // NOTE: set numbers as data instead of text so that
+    // columns are sorted numerically
+    for (const AdOperationMetrics &metrics : ad_metrics_get_operations()) {
+        const QList<QStandardItem *> row = make_item_row(OperationColumn_COUNT);
+
+        row[OperationColumn_Operation]->setText(ad_operation_string(metrics.operation));
+        row[OperationColumn_Operation]->setData(QVariant::fromValue(metrics.histogram), DiagnosticsRole_Histogram);
+        row[OperationColumn_Dc]->setText(metrics.dc);
+        row[OperationColumn_Count]->setData(metrics.count, Qt::DisplayRole);
+        row[OperationColumn_Errors]->setData(metrics.error_count, Qt::DisplayRole);
+        row[OperationColumn_Total]->setData(usec_to_msec(metrics.total_usec), Qt::DisplayRole);
+        row[OperationColumn_Average]->setData(usec_to_msec(metrics.average_usec()), Qt::DisplayRole);
+        row[OperationColumn_P50]->setData(usec_to_msec(metrics.percentile_usec(0.5)), Qt::DisplayRole);
+        row[OperationColumn_P95]->setData(usec_to_msec(metrics.percentile_usec(0.95)), Qt::DisplayRole);
+        row[OperationColumn_Max]->setData(usec_to_msec(metrics.max_usec), Qt::DisplayRole);
+        row[OperationColumn_Entries]->setData(metrics.entries, Qt::DisplayRole);
+        row[OperationColumn_Pages]->setData(metrics.pages, Qt::DisplayRole);
+        row[OperationColumn_Bytes]->setData(metrics.bytes, Qt::DisplayRole);
+
+        operations_model->appendRow(row);
+    }
+
+    for (const AdSearchRecord &record : ad_metrics_get_slowest_searches()) {
+        const QList<QStandardItem *> row = make_item_row(SearchColumn_COUNT);
+
+        row[SearchColumn_Total]->setData(usec_to_msec(record.usec), Qt::DisplayRole);
+        row[SearchColumn_Server]->setData(usec_to_msec(record.server_usec), Qt::DisplayRole);
+        row[SearchColumn_Client]->setData(usec_to_msec(record.usec - record.server_usec), Qt::DisplayRole);
+        row[SearchColumn_Entries]->setData(record.entries, Qt::DisplayRole);
+        row[SearchColumn_Pages]->setData(record.pages, Qt::DisplayRole);
+        row[SearchColumn_Bytes]->setData(record.bytes, Qt::DisplayRole);
+        row[SearchColumn_Base]->setText(record.base);
+        row[SearchColumn_Scope]->setText(search_scope_string(record.scope));
+        row[SearchColumn_Filter]->setText(record.filter);
+        row[SearchColumn_Dc]->setText(record.dc);
+        row[SearchColumn_Time]->setText(record.time.toString("hh:mm:ss.zzz"));
+
+        if (!record.success) {
+            row[SearchColumn_Total]->setToolTip(tr("Search failed"));
+        } else if (!record.complete) {
+            row[SearchColumn_Total]->setToolTip(tr("Search was stopped before last page"));
+        }
+
+        searches_model->appendRow(row);
+    }
+
+    // NOTE: metrics are already sorted by total time and
+    // duration
+    ui->operations_view->setSortingEnabled(true);
+    ui->operations_view->sortByColumn(OperationColumn_Total, Qt::DescendingOrder);
+    ui->searches_view->setSortingEnabled(true);
+    ui->searches_view->sortByColumn(SearchColumn_Total, Qt::DescendingOrder);
+
+    const QString status_text = QString(tr("Showing %1 operation types and %2 slowest searches.")).arg(operations_model->rowCount()).arg(searches_model->rowCount());
+    ui->status_label->setText(status_text);
+
+    if (operations_model->rowCount() > 0) {
+        ui->operations_view->setCurrentIndex(operations_model->index(0, 0));
+    }
+}
+
+void DiagnosticsDialog::on_reset() {
+    ad_metrics_reset();
+    load();
+}
+
+void DiagnosticsDialog::on_operation_selected() {
+    histogram_model->removeRows(0, histogram_model->rowCount());
+
+    const QModelIndex current = ui->operations_view->currentIndex();
+    if (!current.isValid()) {
+        return;
+    }
+
+    const QModelIndex operation_index = current.siblingAtColumn(OperationColumn_Operation);
+    const QVector<int> histogram = operation_index.data(DiagnosticsRole_Histogram).value<QVector<int>>();
+
+    const int total = [&]() {
+        int out = 0;
+
+        for (const int count : histogram) {
+            out += count;
+        }
+
+        return out;
+    }();
+
+    if (total == 0) {
+        return;
+    }
+
+    int cumulative = 0;
+    for (int bucket = 0; bucket < histogram.size(); bucket++) {
+        const int count = histogram[bucket];
+        cumulative += count;
+
+        const QList<QStandardItem *> row = make_item_row(HistogramColumn_COUNT);
+
+        const double percent = 100.0 * count / total;
+        const double cumulative_percent = 100.0 * cumulative / total;
+
+        row[HistogramColumn_Latency]->setText(ad_metrics_get_bucket_name(bucket));
+        row[HistogramColumn_Count]->setData(count, Qt::DisplayRole);
+        row[HistogramColumn_Percent]->setText(QString::number(percent, 'f', 1));
+        row[HistogramColumn_Cumulative]->setText(QString::number(cumulative_percent, 'f', 1));
+
+        histogram_model->appendRow(row);
+    }
+}
+
+// NOTE: exports metrics shown in current tab, not
+// necessarily in the displayed order
+void DiagnosticsDialog::on_export() {
+    const bool export_searches = (ui->tab_widget->currentIndex() == DiagnosticsTab_Searches);
+
+    const QString file_path = [&]() {
+        const QString caption = tr("Export Diagnostics");
+        const QString file_name = (export_searches ? tr("slowest_searches") : tr("operations"));
+        const QString suggested_file = QString("%1/%2.csv").arg(QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation), file_name);
+        const QString filter = tr("CSV (*.csv)");
+
+        const QString out = QFileDialog::getSaveFileName(this, caption, suggested_file, filter);
+
+        return out;
+    }();
+
+    if (file_path.isEmpty()) {
+        return;
+    }
+
+    const QString csv = (export_searches ? ad_metrics_searches_csv() : ad_metrics_operations_csv());
+
+    QFile file(file_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error_log({QString(tr("Failed to open file \"%1\".")).arg(file_path)}, this);
+
+        return;
+    }
+
+    file.write(csv.toUtf8());
+}
+
+// NOTE: round to 0.1ms so that view doesn't show long
+// fractions
+double usec_to_msec(const qint64 usec) {
+    return qRound64(usec / 100.0) / 10.0;
+}
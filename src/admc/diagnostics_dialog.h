@@ -0,0 +1,61 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DIAGNOSTICS_DIALOG_H
+#define DIAGNOSTICS_DIALOG_H
+
+/**
+ * Shows metrics of LDAP and SMB operations done in this
+ * session: latency, sizes and errors for each operation
+ * type and DC, with a latency histogram for the selected
+ * operation, and a list of slowest searches. Metrics are
+ * a snapshot taken when dialog is opened or refreshed and
+ * can be exported to CSV.
+ */
+
+#include <QDialog>
+
+class QStandardItemModel;
+
+namespace Ui {
+class DiagnosticsDialog;
+}
+
+class DiagnosticsDialog final : public QDialog {
+    Q_OBJECT
+
+public:
+    Ui::DiagnosticsDialog *ui;
+
+    DiagnosticsDialog(QWidget *parent);
+    ~DiagnosticsDialog();
+
+private:
+    QStandardItemModel *operations_model;
+    QStandardItemModel *histogram_model;
+    QStandardItemModel *searches_model;
+
+    void load();
+    void on_reset();
+    void on_export();
+    void on_operation_selected();
+};
+
+#endif /* DIAGNOSTICS_DIALOG_H */
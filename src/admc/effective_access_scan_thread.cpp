@@ -0,0 +1,113 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "effective_access_scan_thread.h"
+
+#include "adldap.h"
+
+#include <QRunnable>
+
+// Evaluates effective access for a chunk of objects from
+// one page. Each task writes to it's own output list, so
+// no locking is needed.
+class EffectiveAccessScanTask final : public QRunnable {
+public:
+    EffectiveAccessScanTask(AdConfig *adconfig, const QList<AdObject> &object_list, const QString &principal_dn, const QList<QByteArray> &token, const QList<QByteArray> &self_token, QList<EffectiveAccessScanResult> *results_out);
+
+    void run() override;
+
+private:
+    AdConfig *adconfig;
+    QList<AdObject> object_list;
+    QString principal_dn;
+    QList<QByteArray> token;
+    QList<QByteArray> self_token;
+    QList<EffectiveAccessScanResult> *results_out;
+};
+
+EffectiveAccessScanThread::EffectiveAccessScanThread(const QString &base_arg, const QString &principal_dn_arg, const QList<QByteArray> &token_arg, const QList<QByteArray> &self_token_arg)
+: ObjectScanThread(base_arg, QString(), {ATTRIBUTE_SECURITY_DESCRIPTOR, ATTRIBUTE_OBJECT_CLASS}) {
+    principal_dn = principal_dn_arg;
+    token = token_arg;
+    self_token = self_token_arg;
+}
+
+void EffectiveAccessScanThread::process_page(AdInterface &ad, const QVector<QList<AdObject>> &chunk_list) {
+    const int chunk_count = chunk_list.size();
+
+    QVector<QList<EffectiveAccessScanResult>> results_list(chunk_count);
+
+    for (int chunk_i = 0; chunk_i < chunk_count; chunk_i++) {
+        if (chunk_list[chunk_i].isEmpty()) {
+            continue;
+        }
+
+        auto task = new EffectiveAccessScanTask(ad.adconfig(), chunk_list[chunk_i], principal_dn, token, self_token, &results_list[chunk_i]);
+        pool.start(task);
+    }
+
+    pool.waitForDone();
+
+    QList<EffectiveAccessScanResult> results;
+    for (const QList<EffectiveAccessScanResult> &chunk_results : results_list) {
+        results.append(chunk_results);
+    }
+
+    emit results_ready(results);
+}
+
+EffectiveAccessScanTask::EffectiveAccessScanTask(AdConfig *adconfig_arg, const QList<AdObject> &object_list_arg, const QString &principal_dn_arg, const QList<QByteArray> &token_arg, const QList<QByteArray> &self_token_arg, QList<EffectiveAccessScanResult> *results_out_arg) {
+    adconfig = adconfig_arg;
+    object_list = object_list_arg;
+    principal_dn = principal_dn_arg;
+    token = token_arg;
+    self_token = self_token_arg;
+    results_out = results_out_arg;
+}
+
+void EffectiveAccessScanTask::run() {
+    for (const AdObject &object : object_list) {
+        const QString dn = object.get_dn();
+        const QList<QString> class_list = object.get_strings(ATTRIBUTE_OBJECT_CLASS);
+        const QList<SecurityRight> right_list = ad_security_get_right_list_for_class(adconfig, class_list);
+
+        EffectiveAccessScanResult result;
+        result.dn = dn;
+        result.allowed_count = 0;
+        result.right_count = right_list.size();
+
+        // NOTE: descriptor is missing if we don't have
+        // permission to read it. Report that instead of
+        // showing that no rights are allowed.
+        const QByteArray sd_bytes = object.get_value(ATTRIBUTE_SECURITY_DESCRIPTOR);
+        const security_descriptor *sd = security_descriptor_get_cached(sd_bytes);
+        result.read_failed = (sd == nullptr);
+
+        if (!result.read_failed) {
+            const bool object_is_principal = (dn.compare(principal_dn, Qt::CaseInsensitive) == 0);
+            const QList<QByteArray> &object_token = (object_is_principal ? self_token : token);
+            const QList<bool> allowed_list = security_descriptor_get_effective_rights(sd, object_token, right_list);
+
+            result.allowed_count = allowed_list.count(true);
+        }
+
+        results_out->append(result);
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EFFECTIVE_ACCESS_SCAN_THREAD_H
+#define EFFECTIVE_ACCESS_SCAN_THREAD_H
+
+/**
+ * Evaluates effective access of a principal to all
+ * objects in a subtree. Token of the principal is loaded
+ * once and reused for every object, descriptors are loaded
+ * page by page and evaluated in a thread pool. Emits a
+ * result for every scanned object.
+ */
+
+#include "object_scan_thread.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+class EffectiveAccessScanResult {
+public:
+    QString dn;
+    int allowed_count;
+    int right_count;
+    bool read_failed;
+};
+
+class EffectiveAccessScanThread final : public ObjectScanThread {
+    Q_OBJECT
+
+public:
+    // NOTE: self_token is the token with "Principal Self"
+    // and is used only for the principal's own object
+    EffectiveAccessScanThread(const QString &base, const QString &principal_dn, const QList<QByteArray> &token, const QList<QByteArray> &self_token);
+
+signals:
+    void results_ready(const QList<EffectiveAccessScanResult> &results);
+
+private:
+    QString principal_dn;
+    QList<QByteArray> token;
+    QList<QByteArray> self_token;
+
+    void process_page(AdInterface &ad, const QVector<QList<AdObject>> &chunk_list) override;
+};
+
+#endif /* EFFECTIVE_ACCESS_SCAN_THREAD_H */
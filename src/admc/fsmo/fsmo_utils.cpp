@@ -6,6 +6,7 @@
 #include "utils.h"
 #include "settings.h"
 #include "console_widget/console_widget.h"
+#include "search_scheduler.h"
 #include "status.h"
 
 #include <QString>
@@ -56,6 +57,7 @@ void connect_host_with_role(AdInterface &ad, FSMORole role)
     settings_set_variant(SETTING_host, current_master);
     AdInterface::set_dc(current_master);
     ad.update_dc();
+    g_search_scheduler->cancel_all();
 }
 
 void connect_to_PDC_emulator(AdInterface &ad, ConsoleWidget *console)
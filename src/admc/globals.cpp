@@ -24,6 +24,7 @@
 #include "settings.h"
 #include "status.h"
 #include "icon_manager/icon_manager.h"
+#include "search_scheduler.h"
 
 #include <QLocale>
 
@@ -31,6 +32,7 @@
 AdConfig *g_adconfig = new AdConfig();
 Status *g_status = new Status();
 IconManager *g_icon_manager = new IconManager();
+SearchScheduler *g_search_scheduler = new SearchScheduler();
 
 void load_g_adconfig(AdInterface &ad) {
     const QLocale locale = settings_get_variant(SETTING_locale).toLocale();
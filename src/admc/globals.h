@@ -25,12 +25,15 @@ class AdConfig;
 class AdInterface;
 class Status;
 class IconManager;
+class SearchScheduler;
 
 extern AdConfig *g_adconfig;
 extern Status *g_status;
 
 extern IconManager *g_icon_manager;
 
+extern SearchScheduler *g_search_scheduler;
+
 void load_g_adconfig(AdInterface &ad);
 
 #endif /* GLOBALS_H */
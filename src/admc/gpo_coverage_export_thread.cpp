@@ -0,0 +1,92 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gpo_coverage_export_thread.h"
+
+#include "adldap.h"
+
+#include <QFile>
+
+GpoCoverageExportThread::GpoCoverageExportThread(const QString &file_path_arg) {
+    stop_flag.storeRelease(0);
+    file_path = file_path_arg;
+    m_failed_to_connect = false;
+    m_failed_to_write_file = false;
+}
+
+void GpoCoverageExportThread::stop() {
+    stop_flag.storeRelease(1);
+}
+
+QString GpoCoverageExportThread::get_file_path() const {
+    return file_path;
+}
+
+bool GpoCoverageExportThread::failed_to_connect() const {
+    return m_failed_to_connect;
+}
+
+bool GpoCoverageExportThread::failed_to_write_file() const {
+    return m_failed_to_write_file;
+}
+
+bool GpoCoverageExportThread::is_stopped() const {
+    return (stop_flag.loadAcquire() != 0);
+}
+
+QList<AdMessage> GpoCoverageExportThread::get_ad_messages() const {
+    return ad_messages;
+}
+
+void GpoCoverageExportThread::run() {
+    AdInterface ad;
+    if (!ad.is_connected()) {
+        m_failed_to_connect = true;
+
+        return;
+    }
+
+    ad.set_cancel_flag(&stop_flag);
+
+    GpoCoverage coverage;
+    coverage.load(ad);
+
+    ad_messages = ad.messages();
+
+    // NOTE: coverage is incomplete if loading was
+    // cancelled, so don't save it
+    if (is_stopped()) {
+        return;
+    }
+
+    const QByteArray csv_bytes = coverage.to_csv().toUtf8();
+
+    QFile file(file_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        m_failed_to_write_file = true;
+
+        return;
+    }
+
+    const qint64 written = file.write(csv_bytes);
+    if (written != csv_bytes.size()) {
+        m_failed_to_write_file = true;
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GPO_COVERAGE_EXPORT_THREAD_H
+#define GPO_COVERAGE_EXPORT_THREAD_H
+
+/**
+ * Loads GPO coverage and saves it as a CSV report. Loading
+ * searches for all containers and counts objects in them,
+ * which takes a while on large domains, so it is done
+ * outside of GUI thread. Use stop() to cancel loading.
+ * Note that creator of thread should delete it after it
+ * finishes.
+ */
+
+#include <QAtomicInt>
+#include <QThread>
+
+class AdMessage;
+
+class GpoCoverageExportThread final : public QThread {
+    Q_OBJECT
+
+public:
+    GpoCoverageExportThread(const QString &file_path);
+
+    void stop();
+    QString get_file_path() const;
+    bool failed_to_connect() const;
+    bool failed_to_write_file() const;
+    bool is_stopped() const;
+    QList<AdMessage> get_ad_messages() const;
+
+private:
+    QAtomicInt stop_flag;
+    QString file_path;
+    bool m_failed_to_connect;
+    bool m_failed_to_write_file;
+    QList<AdMessage> ad_messages;
+
+    void run() override;
+};
+
+#endif /* GPO_COVERAGE_EXPORT_THREAD_H */
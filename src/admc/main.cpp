@@ -18,20 +18,24 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "acl_audit_thread.h"
 #include "adldap.h"
 #include "config.h"
 #include "connection_options_dialog.h"
+#include "effective_access_scan_thread.h"
 #include "globals.h"
 #include "main_window.h"
 #include "main_window_connection_error.h"
+#include "search_scheduler.h"
+#include "security_bulk_edit_thread.h"
 #include "settings.h"
 #include "status.h"
+#include "trace_application.h"
 #include "utils.h"
 #include "connection_options_dialog.h"
 #include "locale.h"
 #include "icon_manager/icon_manager.h"
 
-#include <QApplication>
 #include <QDebug>
 #include <QLibraryInfo>
 #include <QTranslator>
@@ -44,8 +48,11 @@ int main(int argc, char **argv) {
     // passing this type from thread results in a runtime
     // error.
     qRegisterMetaType<QHash<QString, AdObject>>("QHash<QString, AdObject>");
+    qRegisterMetaType<QList<AclAuditFinding>>("QList<AclAuditFinding>");
+    qRegisterMetaType<QList<SecurityBulkEditResult>>("QList<SecurityBulkEditResult>");
+    qRegisterMetaType<QList<EffectiveAccessScanResult>>("QList<EffectiveAccessScanResult>");
 
-    QApplication app(argc, argv);
+    TraceApplication app(argc, argv);
     app.setApplicationDisplayName(ADMC_APPLICATION_DISPLAY_NAME);
     app.setApplicationName(ADMC_APPLICATION_NAME);
     app.setApplicationVersion(ADMC_VERSION);
@@ -95,6 +102,22 @@ int main(int argc, char **argv) {
 
     load_connection_options();
 
+    // NOTE: tracing is enabled by setting a path for the
+    // trace file. Resulting file can be opened in Perfetto
+    // or chrome://tracing.
+    const QString trace_path = [&]() {
+        const QString from_env = qEnvironmentVariable("ADMC_TRACE");
+
+        if (!from_env.isEmpty()) {
+            return from_env;
+        } else {
+            return settings_get_variant(SETTING_trace_file).toString();
+        }
+    }();
+    if (!trace_path.isEmpty()) {
+        trace_start(trace_path);
+    }
+
     // In case of failure to connect to AD and load
     // adconfig, we open a special alternative main window.
     // We do this to acomplish 2 objectives:
@@ -137,5 +160,13 @@ int main(int argc, char **argv) {
 
     delete first_main_window;
 
+    // NOTE: scheduler waits for running searches to be
+    // abandoned, so it has to be deleted while app and
+    // connection options are still alive
+    delete g_search_scheduler;
+    g_search_scheduler = nullptr;
+
+    trace_stop();
+
     return retval;
 }
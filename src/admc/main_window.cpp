@@ -36,6 +36,7 @@
 #include "console_impls/query_folder_impl.h"
 #include "console_impls/query_item_impl.h"
 #include "console_widget/console_widget.h"
+#include "diagnostics_dialog.h"
 #include "fsmo/fsmo_dialog.h"
 #include "globals.h"
 #include "main_window_connection_error.h"
@@ -290,6 +291,9 @@ MainWindow::MainWindow(AdInterface &ad, QWidget *parent)
     connect(
         ui->action_changelog, &QAction::triggered,
         this, &MainWindow::open_changelog);
+    connect(
+        ui->action_diagnostics, &QAction::triggered,
+        this, &MainWindow::open_diagnostics);
     connect(
         ui->action_about, &QAction::triggered,
         this, &MainWindow::open_about);
@@ -423,6 +427,11 @@ void MainWindow::open_changelog() {
     changelog_dialog->open();
 }
 
+void MainWindow::open_diagnostics() {
+    auto dialog = new DiagnosticsDialog(this);
+    dialog->open();
+}
+
 void MainWindow::open_about() {
     auto about_dialog = new AboutDialog(this);
     about_dialog->open();
@@ -50,6 +50,7 @@ private:
     void open_manual();
     void open_connection_options();
     void open_changelog();
+    void open_diagnostics();
     void open_about();
     void edit_fsmo_roles();
     void reload_console_tree();
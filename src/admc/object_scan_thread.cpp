@@ -0,0 +1,115 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "object_scan_thread.h"
+
+#include "adldap.h"
+#include "globals.h"
+#include "status.h"
+
+#include <QHash>
+
+ObjectScanThread::ObjectScanThread(const QString &base_arg, const QString &filter_arg, const QList<QString> &attributes_arg) {
+    stop_flag.storeRelease(0);
+    base = base_arg;
+    filter = filter_arg;
+    attributes = attributes_arg;
+    m_failed_to_connect = false;
+
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+void ObjectScanThread::stop() {
+    stop_flag.storeRelease(1);
+}
+
+bool ObjectScanThread::failed_to_connect() const {
+    return m_failed_to_connect;
+}
+
+QList<AdMessage> ObjectScanThread::get_ad_messages() const {
+    return ad_messages;
+}
+
+void ObjectScanThread::page_loaded() {
+}
+
+void ObjectScanThread::run() {
+    AdInterface ad;
+    if (!ad.is_connected()) {
+        m_failed_to_connect = true;
+
+        return;
+    }
+
+    const int chunk_count = pool.maxThreadCount();
+
+    AdCookie cookie;
+
+    while (true) {
+        QHash<QString, AdObject> results;
+
+        const bool success = ad.search_paged(base, SearchScope_All, filter, attributes, &results, &cookie);
+
+        page_loaded();
+
+        if (!success) {
+            break;
+        }
+
+        QVector<QList<AdObject>> chunk_list(chunk_count);
+        int i = 0;
+        for (const AdObject &object : results) {
+            chunk_list[i % chunk_count].append(object);
+            i++;
+        }
+
+        process_page(ad, chunk_list);
+
+        const bool stopped = (stop_flag.loadAcquire() != 0);
+        if (stopped || !cookie.more_pages()) {
+            break;
+        }
+    }
+
+    page_loaded();
+
+    ad_messages = ad.messages();
+}
+
+void object_scan_thread_display_errors(ObjectScanThread *thread, const QString &connect_error, QWidget *parent) {
+    g_status->display_ad_messages(thread->get_ad_messages(), parent);
+
+    if (thread->failed_to_connect()) {
+        error_log({connect_error}, parent);
+    }
+}
+
+void object_scan_thread_stop_and_delete(ObjectScanThread *thread, QObject *receiver) {
+    if (thread == nullptr) {
+        return;
+    }
+
+    QObject::disconnect(thread, nullptr, receiver, nullptr);
+    thread->stop();
+    thread->wait();
+
+    delete thread;
+}
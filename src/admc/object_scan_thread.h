@@ -0,0 +1,89 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OBJECT_SCAN_THREAD_H
+#define OBJECT_SCAN_THREAD_H
+
+/**
+ * Base for threads which go through all objects in a
+ * subtree. Pages are loaded in this thread and objects of
+ * each page are split into chunks, one chunk per thread of
+ * the pool, so that subclasses can process them in
+ * parallel. Use stop() to stop after current page. Note
+ * that creator of thread should delete it after it
+ * finishes.
+ */
+
+#include <QAtomicInt>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+
+class AdInterface;
+class AdMessage;
+class AdObject;
+class QWidget;
+
+class ObjectScanThread : public QThread {
+    Q_OBJECT
+
+public:
+    ObjectScanThread(const QString &base, const QString &filter, const QList<QString> &attributes);
+
+    void stop();
+    bool failed_to_connect() const;
+    QList<AdMessage> get_ad_messages() const;
+
+protected:
+    QThreadPool pool;
+
+    // Called with objects of every loaded page
+    virtual void process_page(AdInterface &ad, const QVector<QList<AdObject>> &chunk_list) = 0;
+
+    // Called after every page is loaded, before it's
+    // processed, and once more after the last page. Can be
+    // used to finish processing of previous page while
+    // next one was loading.
+    virtual void page_loaded();
+
+private:
+    QAtomicInt stop_flag;
+    QString base;
+    QString filter;
+    QList<QString> attributes;
+    bool m_failed_to_connect;
+    QList<AdMessage> ad_messages;
+
+    void run() override;
+};
+
+// Call this in destructor of the object that receives
+// thread's signals. Thread might still be running, so it
+// is stopped, waited for and deleted, because the
+// finished() slot which normally deletes it won't be
+// called anymore. Does nothing if thread is nullptr.
+void object_scan_thread_stop_and_delete(ObjectScanThread *thread, QObject *receiver);
+
+// Call this in your thread's finished() slot to display
+// messages and errors of the thread. Thread can't display
+// them because it is run in non-GUI thread.
+void object_scan_thread_display_errors(ObjectScanThread *thread, const QString &connect_error, QWidget *parent);
+
+#endif /* OBJECT_SCAN_THREAD_H */
@@ -98,6 +98,10 @@ LinkedPoliciesWidget::LinkedPoliciesWidget(ConsoleWidget *console_arg, QWidget *
             return;
         }
 
+        // NOTE: drag and drop produces a whole new order
+        // of links, which can't be described as edits of
+        // a gplink loaded from server, so gplink is
+        // replaced instead of going through gplink_edit()
         bool success = ad.attribute_replace_string(ou_dn, ATTRIBUTE_GPLINK, gplink_arg.to_string());
         if (!success) {
             model->arrange_orders_from_gplink(gplink);
@@ -166,10 +170,9 @@ void LinkedPoliciesWidget::on_item_changed(QStandardItem *item) {
     const GplinkOption option = column_to_option[column];
     const bool is_checked = (item->checkState() == Qt::Checked);
 
-    Gplink gplink_modified = gplink;
-    gplink_modified.set_option(gpo_dn, option, is_checked);
-    const QString gplink_string = gplink_modified.to_string();
-    bool success = ad.attribute_replace_string(ou_dn, ATTRIBUTE_GPLINK, gplink_string);
+    const GplinkEdit edit = GplinkEdit(ou_dn, gpo_dn, GplinkEditType_SetOption, option, is_checked);
+    QHash<QString, QString> new_gplink_map;
+    const bool success = ad.gplink_edit({edit}, &new_gplink_map);
 
     if (!success) {
         hide_busy_indicator();
@@ -179,10 +182,17 @@ void LinkedPoliciesWidget::on_item_changed(QStandardItem *item) {
 
     g_status->display_ad_messages(ad, this);
     update_policy_link_icons(this_index, is_checked, option);
-    gplink.set_option(gpo_dn, option, is_checked);
+
+    // NOTE: map doesn't contain OU if option was already
+    // set on server
+    if (new_gplink_map.contains(ou_dn)) {
+        gplink = Gplink(new_gplink_map[ou_dn]);
+    } else {
+        gplink.set_option(gpo_dn, option, is_checked);
+    }
 
     const QModelIndex scope_tree_ou_index = console->get_current_scope_item();
-    update_ou_item_gplink_data(gplink_string, scope_tree_ou_index, console);
+    update_ou_item_gplink_data(gplink.to_string(), scope_tree_ou_index, console);
     emit gplink_changed(scope_tree_ou_index);
 
     hide_busy_indicator();
@@ -200,7 +210,7 @@ void LinkedPoliciesWidget::open_context_menu(const QPoint &pos) {
 
 void LinkedPoliciesWidget::remove_link() {
     // NOTE: save gpo dn list before they are removed in
-    // modify_gplink()
+    // modify_gplink(), which reloads items
     const QList<QString> gpo_dn_list = [&]() {
         QList<QString> out;
 
@@ -215,11 +225,7 @@ void LinkedPoliciesWidget::remove_link() {
         return out;
     }();
 
-    auto modify_function = [](Gplink &gplink_arg, const QString &gpo) {
-        gplink_arg.remove(gpo);
-    };
-
-    modify_gplink(modify_function);
+    modify_gplink(GplinkEditType_Remove);
 
     // Also remove gpo from OU in console
     const QModelIndex policy_root = get_policy_tree_root(console);
@@ -239,19 +245,11 @@ void LinkedPoliciesWidget::remove_link() {
 }
 
 void LinkedPoliciesWidget::move_up() {
-    auto modify_function = [](Gplink &gplink_arg, const QString &gpo) {
-        gplink_arg.move_up(gpo);
-    };
-
-    modify_gplink(modify_function);
+    modify_gplink(GplinkEditType_MoveUp);
 }
 
 void LinkedPoliciesWidget::move_down() {
-    auto modify_function = [](Gplink &gplink_arg, const QString &gpo) {
-        gplink_arg.move_down(gpo);
-    };
-
-    modify_gplink(modify_function);
+    modify_gplink(GplinkEditType_MoveDown);
 }
 
 void LinkedPoliciesWidget::update_link_items() {
@@ -273,10 +271,10 @@ void LinkedPoliciesWidget::update_link_items() {
     model->sort(LinkedPoliciesColumn_Order);
 }
 
-// Takes as argument function that modifies the gplink.
-// Modify function accepts gplink as argument and gpo dn
-// used in the operation.
-void LinkedPoliciesWidget::modify_gplink(void (*modify_function)(Gplink &, const QString &)) {
+// Applies edit of given type to all selected policies.
+// Edits are applied to gplink loaded from server, so
+// changes made by others since last update are kept.
+void LinkedPoliciesWidget::modify_gplink(const GplinkEditType edit_type) {
     AdInterface ad;
     if (ad_failed(ad, this)) {
         return;
@@ -284,23 +282,33 @@ void LinkedPoliciesWidget::modify_gplink(void (*modify_function)(Gplink &, const
 
     show_busy_indicator();
 
-    const QList<QModelIndex> selected = ui->view->get_selected_indexes();
+    const QList<GplinkEdit> edit_list = [&]() {
+        QList<GplinkEdit> out;
 
-    for (const QModelIndex &index : selected) {
-        const QString gpo_dn = index.data(LinkedPoliciesRole_DN).toString();
+        const QList<QModelIndex> selected = ui->view->get_selected_indexes();
 
-        modify_function(gplink, gpo_dn);
-    }
+        for (const QModelIndex &index : selected) {
+            const QString gpo_dn = index.data(LinkedPoliciesRole_DN).toString();
+
+            out.append(GplinkEdit(ou_dn, gpo_dn, edit_type));
+        }
+
+        return out;
+    }();
 
-    const QString gplink_string = gplink.to_string();
-    ad.attribute_replace_string(ou_dn, ATTRIBUTE_GPLINK, gplink_string);
+    QHash<QString, QString> new_gplink_map;
+    ad.gplink_edit(edit_list, &new_gplink_map);
 
     g_status->display_ad_messages(ad, this);
 
+    if (new_gplink_map.contains(ou_dn)) {
+        gplink = Gplink(new_gplink_map[ou_dn]);
+    }
+
     update_link_items();
 
     const QModelIndex scope_tree_ou_index = console->get_current_scope_item();
-    update_ou_item_gplink_data(gplink_string, scope_tree_ou_index, console);
+    update_ou_item_gplink_data(gplink.to_string(), scope_tree_ou_index, console);
     emit gplink_changed(scope_tree_ou_index);
 
     hide_busy_indicator();
@@ -340,7 +348,7 @@ QList<AdObject> LinkedPoliciesWidget::gpo_object_list(AdInterface &ad) {
     const QString base = g_adconfig->policies_dn();
     const SearchScope scope = SearchScope_Children;
     const QString filter = filter_dn_list(gpo_dn_list);
-    const QList<QString> attributes = QList<QString>();
+    const QList<QString> attributes = console_policy_search_attributes();
 
     const QHash<QString, AdObject> search_results = ad.search(base, scope, filter, attributes);
 
@@ -149,11 +149,12 @@ void PolicyResultsWidget::update(const QString &new_gpo) {
     for (const AdObject &object : results.values()) {
         const QList<QStandardItem *> row = make_item_row(PolicyResultsColumn_COUNT);
 
-        const QString dn = object.get_dn();
-        const QString name = dn_get_name(dn);
+        const DnView &dn_view = object.get_dn_view();
+        const QString dn = dn_view.dn();
+        const QString name = dn_view.name();
         row[PolicyResultsColumn_Name]->setText(name);
 
-        row[PolicyResultsColumn_Path]->setText(dn_get_parent_canonical(dn));
+        row[PolicyResultsColumn_Path]->setText(dn_view.parent_canonical());
 
         const QString gplink_string = object.get_string(ATTRIBUTE_GPLINK);
         const Gplink gplink = Gplink(gplink_string);
@@ -231,11 +232,18 @@ void PolicyResultsWidget::on_item_changed(QStandardItem *item) {
 
     show_busy_indicator();
 
-    const bool success = ad.attribute_replace_string(ou_dn, ATTRIBUTE_GPLINK, updated_gplink_string);
+    const QList<GplinkEdit> edit_list = {GplinkEdit(ou_dn, gpo, GplinkEditType_SetOption, option, is_checked)};
+    QHash<QString, QString> new_gplink_map;
+    const bool success = ad.gplink_edit(edit_list, &new_gplink_map);
 
     if (success) {
-        model->setData(index, updated_gplink_string, PolicyResultsRole_GplinkString);
-        emit ou_gplink_changed(ou_dn, gplink, gpo, option);
+        // NOTE: map doesn't contain OU if option already
+        // had this value on the server
+        const QString new_gplink_string = new_gplink_map.value(ou_dn, updated_gplink_string);
+        const Gplink new_gplink = Gplink(new_gplink_string);
+
+        model->setData(index, new_gplink_string, PolicyResultsRole_GplinkString);
+        emit ou_gplink_changed(ou_dn, new_gplink, gpo, option);
 
     } else {
         const Qt::CheckState undo_check_state = [&]() {
@@ -273,27 +281,26 @@ void PolicyResultsWidget::delete_link() {
 
     const QList<QModelIndex> selected = ui->view->get_selected_indexes();
 
-    QList<QPersistentModelIndex> removed_indexes;
+    QList<GplinkEdit> edit_list;
+    QHash<QString, QPersistentModelIndex> index_map;
 
     for (const QModelIndex &index : selected) {
         const QString dn = index.data(PolicyResultsRole_DN).toString();
 
-        const QString gplink_string = index.data(PolicyResultsRole_GplinkString).toString();
-        Gplink gplink = Gplink(gplink_string);
-        gplink.remove(gpo);
-        const QString updated_gplink_string = gplink.to_string();
+        edit_list.append(GplinkEdit(dn, gpo, GplinkEditType_Remove));
+        index_map[dn] = QPersistentModelIndex(index);
+    }
 
-        const bool gplink_didnt_change = gplink.equals(gplink_string);
-        if (gplink_didnt_change) {
-            continue;
-        }
+    QHash<QString, QString> new_gplink_map;
+    ad.gplink_edit(edit_list, &new_gplink_map);
 
-        const bool success = ad.attribute_replace_string(dn, ATTRIBUTE_GPLINK, updated_gplink_string);
+    QList<QPersistentModelIndex> removed_indexes;
 
-        if (success) {
-            removed_indexes.append(QPersistentModelIndex(index));
-            emit ou_gplink_changed(dn, gplink, gpo);
-        }
+    for (const QString &dn : new_gplink_map.keys()) {
+        const Gplink gplink = Gplink(new_gplink_map[dn]);
+
+        removed_indexes.append(index_map[dn]);
+        emit ou_gplink_changed(dn, gplink, gpo);
     }
 
     for (const QPersistentModelIndex &index : removed_indexes) {
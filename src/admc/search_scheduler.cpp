@@ -0,0 +1,360 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "search_scheduler.h"
+
+#include "adldap.h"
+#include "settings.h"
+
+#include <QThreadPool>
+#include <QTimer>
+
+// NOTE: each search opens it's own connection, so this
+// also limits the number of connections to the DC
+const int max_concurrent_searches = 4;
+
+QString search_job_key(const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes);
+QString search_job_trace_id(const SearchJob *job, const int page_index);
+
+SearchHandle::SearchHandle(const int id_arg, SearchJob *job_arg) {
+    id = id_arg;
+    job = job_arg;
+    delivered_page_count = 0;
+    m_failed_to_connect = false;
+    m_hit_object_display_limit = false;
+}
+
+int SearchHandle::get_id() const {
+    return id;
+}
+
+bool SearchHandle::failed_to_connect() const {
+    return m_failed_to_connect;
+}
+
+bool SearchHandle::hit_object_display_limit() const {
+    return m_hit_object_display_limit;
+}
+
+QList<AdMessage> SearchHandle::get_ad_messages() const {
+    return ad_messages;
+}
+
+SearchJob::SearchJob(const QString &base_arg, const SearchScope scope_arg, const QString &filter_arg, const QList<QString> &attributes_arg) {
+    base = base_arg;
+    scope = scope_arg;
+    filter = filter_arg;
+    attributes = attributes_arg;
+    key = search_job_key(base, scope, filter, attributes);
+    priority = SearchPriority_Normal;
+    failed_to_connect = false;
+    hit_object_display_limit = false;
+
+    // NOTE: scheduler deletes jobs, because it needs to
+    // requeue them to change priority
+    setAutoDelete(false);
+}
+
+void SearchJob::run() {
+    TRACE_SCOPE("search", "SearchJob::run");
+
+    AdInterface ad;
+    if (!ad.is_connected()) {
+        failed_to_connect = true;
+
+        emit finished();
+
+        return;
+    }
+
+    ad.set_cancel_flag(&cancel_flag);
+
+    AdCookie cookie;
+
+    const int object_display_limit = settings_get_variant(SETTING_object_display_limit).toInt();
+
+    int total_results_count = 0;
+    int page_index = 0;
+
+    while (true) {
+        QHash<QString, AdObject> results;
+
+        const bool success = ad.search_paged(base, scope, filter, attributes, &results, &cookie);
+
+        const bool cancelled = (cancel_flag.loadAcquire() != 0);
+        if (cancelled) {
+            break;
+        }
+
+        total_results_count += results.count();
+
+        if (total_results_count > object_display_limit) {
+            hit_object_display_limit = true;
+
+            break;
+        }
+
+        // NOTE: flow shows the hop from this thread to
+        // on_page_ready() in the main thread
+        trace_flow_begin("search", "page_ready", search_job_trace_id(this, page_index));
+        page_index++;
+
+        emit page_ready(results);
+
+        if (!success) {
+            break;
+        }
+
+        if (!cookie.more_pages()) {
+            break;
+        }
+    }
+
+    ad_messages = ad.messages();
+
+    emit finished();
+}
+
+SearchScheduler::SearchScheduler(QObject *parent)
+: QObject(parent) {
+    pool = new QThreadPool(this);
+    pool->setMaxThreadCount(max_concurrent_searches);
+
+    id_max = 0;
+    prioritized_handle_id = 0;
+}
+
+SearchScheduler::~SearchScheduler() {
+    cancel_all();
+    pool->waitForDone();
+
+    // NOTE: delete jobs which were cancelled while running
+    // and so are still waiting for their finished() signal
+    qDeleteAll(job_list);
+}
+
+SearchHandle *SearchScheduler::start(const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, const SearchPriority priority) {
+    const QString key = search_job_key(base, scope, filter, attributes);
+
+    // NOTE: if an identical search is in flight, join it
+    // instead of starting a new one
+    SearchJob *job = [&]() {
+        if (job_map.contains(key)) {
+            return job_map[key];
+        }
+
+        auto out = new SearchJob(base, scope, filter, attributes);
+
+        connect(
+            out, &SearchJob::page_ready,
+            this,
+            [this, out](const QHash<QString, AdObject> &results) {
+                on_page_ready(out, results);
+            },
+            Qt::QueuedConnection);
+        connect(
+            out, &SearchJob::finished,
+            this,
+            [this, out]() {
+                on_job_finished(out);
+            },
+            Qt::QueuedConnection);
+
+        job_map[key] = out;
+        job_list.append(out);
+
+        pool->start(out, out->priority);
+
+        return out;
+    }();
+
+    id_max++;
+    auto handle = new SearchHandle(id_max, job);
+    handle_map[handle->get_id()] = handle;
+    job->handle_list.append(handle);
+
+    if (priority == SearchPriority_High) {
+        prioritize(handle->get_id());
+    }
+
+    // NOTE: if joined search already has results, replay
+    // them after caller has connected to the handle
+    if (!job->page_list.isEmpty()) {
+        QTimer::singleShot(0, handle,
+            [this, handle]() {
+                deliver_pages(handle);
+            });
+    }
+
+    return handle;
+}
+
+void SearchScheduler::cancel(const int handle_id) {
+    if (!handle_map.contains(handle_id)) {
+        return;
+    }
+
+    SearchHandle *handle = handle_map.take(handle_id);
+    SearchJob *job = handle->job;
+
+    handle->job = nullptr;
+    job->handle_list.removeAll(handle);
+
+    if (prioritized_handle_id == handle_id) {
+        prioritized_handle_id = 0;
+    }
+
+    // NOTE: cancel search if nobody else is waiting for
+    // it. Queued search is removed from the queue, running
+    // search is abandoned on the server.
+    if (job->handle_list.isEmpty()) {
+        job->cancel_flag.storeRelease(1);
+
+        if (job_map.value(job->key) == job) {
+            job_map.remove(job->key);
+        }
+
+        const bool job_was_queued = pool->tryTake(job);
+        if (job_was_queued) {
+            remove_job(job);
+        }
+    }
+
+    // NOTE: emit finished() later so that cancel() can be
+    // called from inside results_ready() slot
+    QTimer::singleShot(0, handle,
+        [handle]() {
+            emit handle->finished();
+        });
+}
+
+void SearchScheduler::prioritize(const int handle_id) {
+    if (handle_map.contains(prioritized_handle_id)) {
+        SearchHandle *previous_handle = handle_map[prioritized_handle_id];
+        set_job_priority(previous_handle->job, SearchPriority_Normal);
+    }
+
+    prioritized_handle_id = handle_id;
+
+    if (handle_map.contains(handle_id)) {
+        SearchHandle *handle = handle_map[handle_id];
+        set_job_priority(handle->job, SearchPriority_High);
+    }
+}
+
+void SearchScheduler::cancel_all() {
+    const QList<int> handle_id_list = handle_map.keys();
+
+    for (const int handle_id : handle_id_list) {
+        cancel(handle_id);
+    }
+}
+
+void SearchScheduler::on_page_ready(SearchJob *job, const QHash<QString, AdObject> &results) {
+    TraceSpan span("search", "SearchScheduler::on_page_ready");
+    span.add_arg("results", results.size());
+    trace_flow_end("search", "page_ready", search_job_trace_id(job, job->page_list.size()));
+
+    job->page_list.append(results);
+
+    // NOTE: iterate over a copy because handles may be
+    // cancelled from inside results_ready() slots
+    const QList<SearchHandle *> handle_list = job->handle_list;
+
+    for (SearchHandle *handle : handle_list) {
+        deliver_pages(handle);
+    }
+}
+
+void SearchScheduler::on_job_finished(SearchJob *job) {
+    if (job_map.value(job->key) == job) {
+        job_map.remove(job->key);
+    }
+
+    const QList<SearchHandle *> handle_list = job->handle_list;
+
+    for (SearchHandle *handle : handle_list) {
+        deliver_pages(handle);
+
+        // NOTE: handle might have been cancelled while
+        // pages were delivered
+        if (handle->job != job) {
+            continue;
+        }
+
+        handle->job = nullptr;
+        handle->m_failed_to_connect = job->failed_to_connect;
+        handle->m_hit_object_display_limit = job->hit_object_display_limit;
+        handle->ad_messages = job->ad_messages;
+
+        handle_map.remove(handle->get_id());
+        if (prioritized_handle_id == handle->get_id()) {
+            prioritized_handle_id = 0;
+        }
+
+        emit handle->finished();
+    }
+
+    job->handle_list.clear();
+
+    remove_job(job);
+}
+
+void SearchScheduler::deliver_pages(SearchHandle *handle) {
+    while (handle->job != nullptr && handle->delivered_page_count < handle->job->page_list.size()) {
+        const QHash<QString, AdObject> page = handle->job->page_list[handle->delivered_page_count];
+        handle->delivered_page_count++;
+
+        emit handle->results_ready(page);
+    }
+}
+
+// NOTE: pool doesn't allow changing priority of queued
+// tasks, so they are requeued. Jobs that already started
+// are not affected.
+void SearchScheduler::set_job_priority(SearchJob *job, const SearchPriority priority) {
+    if (job == nullptr || job->priority == priority) {
+        return;
+    }
+
+    job->priority = priority;
+
+    const bool job_was_queued = pool->tryTake(job);
+    if (job_was_queued) {
+        pool->start(job, job->priority);
+    }
+}
+
+void SearchScheduler::remove_job(SearchJob *job) {
+    job_list.removeAll(job);
+    job->deleteLater();
+}
+
+QString search_job_key(const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes) {
+    const QString out = QString("%1\n%2\n%3\n%4").arg(base, QString::number(scope), filter, attributes.join(","));
+
+    return out;
+}
+
+QString search_job_trace_id(const SearchJob *job, const int page_index) {
+    const QString out = QString("job-%1-%2").arg((quintptr) job, 0, 16).arg(page_index);
+
+    return out;
+}
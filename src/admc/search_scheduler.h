@@ -0,0 +1,156 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEARCH_SCHEDULER_H
+#define SEARCH_SCHEDULER_H
+
+/**
+ * Runs searches on a thread pool with a cap on the number
+ * of concurrent searches. Identical searches which are in
+ * flight are shared, results which arrived before a search
+ * was joined are replayed. Searches can be cancelled, in
+ * which case the request is abandoned on the server
+ * instead of downloading pages which are then discarded.
+ * Search for currently selected item can be prioritized
+ * so that it jumps ahead of other queued searches.
+ *
+ * start() returns a handle which emits results_ready() as
+ * pages arrive and finished() once. finished() is emitted
+ * even if search was cancelled. Creator of handle should
+ * call handle's deleteLater() in the finished() slot.
+ */
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QRunnable>
+
+#include "ad_defines.h"
+
+class AdObject;
+class AdMessage;
+class QThreadPool;
+class SearchJob;
+
+enum SearchPriority {
+    SearchPriority_Normal = 0,
+    SearchPriority_High = 1,
+};
+
+class SearchHandle final : public QObject {
+    Q_OBJECT
+
+public:
+    SearchHandle(const int id, SearchJob *job);
+
+    int get_id() const;
+    bool failed_to_connect() const;
+    bool hit_object_display_limit() const;
+    QList<AdMessage> get_ad_messages() const;
+
+signals:
+    void results_ready(const QHash<QString, AdObject> &results);
+    void finished();
+
+private:
+    int id;
+    SearchJob *job;
+    int delivered_page_count;
+    bool m_failed_to_connect;
+    bool m_hit_object_display_limit;
+    QList<AdMessage> ad_messages;
+
+    friend class SearchScheduler;
+};
+
+// NOTE: job runs in pool thread but lives in the thread
+// of the scheduler, so it's signals are delivered to the
+// scheduler in it's own thread
+class SearchJob final : public QObject, public QRunnable {
+    Q_OBJECT
+
+public:
+    SearchJob(const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes);
+
+    QString key;
+    QAtomicInt cancel_flag;
+    SearchPriority priority;
+    QList<SearchHandle *> handle_list;
+    QList<QHash<QString, AdObject>> page_list;
+
+    // NOTE: these are written by pool thread and should
+    // only be read after finished() is received
+    bool failed_to_connect;
+    bool hit_object_display_limit;
+    QList<AdMessage> ad_messages;
+
+    void run() override;
+
+signals:
+    void page_ready(const QHash<QString, AdObject> &results);
+    void finished();
+
+private:
+    QString base;
+    SearchScope scope;
+    QString filter;
+    QList<QString> attributes;
+};
+
+class SearchScheduler final : public QObject {
+    Q_OBJECT
+
+public:
+    SearchScheduler(QObject *parent = nullptr);
+    ~SearchScheduler();
+
+    SearchHandle *start(const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, const SearchPriority priority = SearchPriority_Normal);
+
+    // Stops delivering results to this handle. If no other
+    // handles are attached to the search, search is
+    // cancelled.
+    void cancel(const int handle_id);
+
+    // Gives high priority to search of this handle and
+    // returns previously prioritized search to normal
+    // priority
+    void prioritize(const int handle_id);
+
+    // Cancels all searches, for example when connection
+    // settings change
+    void cancel_all();
+
+private:
+    QThreadPool *pool;
+    int id_max;
+    int prioritized_handle_id;
+    QHash<QString, SearchJob *> job_map;
+    QHash<int, SearchHandle *> handle_map;
+    QList<SearchJob *> job_list;
+
+    void on_page_ready(SearchJob *job, const QHash<QString, AdObject> &results);
+    void on_job_finished(SearchJob *job);
+    void deliver_pages(SearchHandle *handle);
+    void set_job_priority(SearchJob *job, const SearchPriority priority);
+    void remove_job(SearchJob *job);
+};
+
+#endif /* SEARCH_SCHEDULER_H */
@@ -28,7 +28,7 @@
 #include <QHash>
 
 SearchThread::SearchThread(const QString base_arg, const SearchScope scope_arg, const QString &filter_arg, const QList<QString> attributes_arg) {
-    stop_flag = false;
+    stop_flag.storeRelease(0);
     base = base_arg;
     scope = scope_arg;
     filter = filter_arg;
@@ -39,13 +39,29 @@ SearchThread::SearchThread(const QString base_arg, const SearchScope scope_arg,
     static int id_max = 0;
     id = id_max;
     id_max++;
+
+    setObjectName("SearchThread");
+
+    // NOTE: this object lives in the main thread, so this
+    // slot runs there and ends the flow started in run()
+    received_page_count = 0;
+    connect(
+        this, &SearchThread::results_ready,
+        this,
+        [this]() {
+            TRACE_SCOPE("search", "SearchThread::results_ready");
+            trace_flow_end("search", "results_ready", trace_id(received_page_count));
+            received_page_count++;
+        });
 }
 
 void SearchThread::stop() {
-    stop_flag = true;
+    stop_flag.storeRelease(1);
 }
 
 void SearchThread::run() {
+    TRACE_SCOPE("search", "SearchThread::run");
+
     AdInterface ad;
     if (!ad.is_connected()) {
         m_failed_to_connect = true;
@@ -53,11 +69,14 @@ void SearchThread::run() {
         return;
     }
 
+    ad.set_cancel_flag(&stop_flag);
+
     AdCookie cookie;
 
     const int object_display_limit = settings_get_variant(SETTING_object_display_limit).toInt();
 
     int total_results_count = 0;
+    int page_index = 0;
 
     while (true) {
         QHash<QString, AdObject> results;
@@ -74,9 +93,12 @@ void SearchThread::run() {
 
         ad_messages = ad.messages();
 
+        trace_flow_begin("search", "results_ready", trace_id(page_index));
+        page_index++;
+
         emit results_ready(results);
 
-        const bool search_interrupted = (!success || stop_flag);
+        const bool search_interrupted = (!success || stop_flag.loadAcquire() != 0);
         if (search_interrupted) {
             break;
         }
@@ -103,10 +125,20 @@ QList<AdMessage> SearchThread::get_ad_messages() const {
     return ad_messages;
 }
 
+QString SearchThread::trace_id(const int page_index) const {
+    const QString out = QString("thread-%1-%2").arg(id).arg(page_index);
+
+    return out;
+}
+
 void search_thread_display_errors(SearchThread *thread, QWidget *parent) {
-    if (thread->failed_to_connect()) {
+    search_display_errors(thread->failed_to_connect(), thread->hit_object_display_limit(), parent);
+}
+
+void search_display_errors(const bool failed_to_connect, const bool hit_object_display_limit, QWidget *parent) {
+    if (failed_to_connect) {
         error_log({QCoreApplication::translate("object_impl.cpp", "Failed to connect to server while searching for objects.")}, parent);
-    } else if (thread->hit_object_display_limit()) {
+    } else if (hit_object_display_limit) {
         error_log({QCoreApplication::translate("object_impl.cpp", "Could not load all objects. Increase object display limit in Filter Options or reduce number of objects by applying a filter. Filter Options is accessible from main window's menubar via the \"View\" menu.")}, parent);
     }
 }
@@ -27,12 +27,14 @@
  * regular small searches this is overkill. results_ready()
  * signal returns search results as they arrive. If search
  * has multiple pages, then results_ready() will be emitted
- * multiple times. Use stop() to stop search. Note that search is
- * not stopped immediately but when current results page is
- * done processing. Note that creator of thread should call
- * thread's deleteLater() in the finished() slot.
+ * multiple times. Use stop() to stop search. If a page is
+ * being downloaded when search is stopped, the request is
+ * abandoned on the server. Note that creator of thread
+ * should call thread's deleteLater() in the finished()
+ * slot.
  */
 
+#include <QAtomicInt>
 #include <QThread>
 
 #include "ad_defines.h"
@@ -57,7 +59,7 @@ signals:
     void over_object_display_limit();
 
 private:
-    bool stop_flag;
+    QAtomicInt stop_flag;
     QString base;
     SearchScope scope;
     QString filter;
@@ -66,13 +68,16 @@ private:
     bool m_failed_to_connect;
     bool m_hit_object_display_limit;
     QList<AdMessage> ad_messages;
+    int received_page_count;
 
     void run() override;
+    QString trace_id(const int page_index) const;
 };
 
 // Call this in your finished() slot to display any
 // error dialogs. Search thread can't display them
 // because it is run in non-GUI thread.
 void search_thread_display_errors(SearchThread *thread, QWidget *parent);
+void search_display_errors(const bool failed_to_connect, const bool hit_object_display_limit, QWidget *parent);
 
 #endif /* SEARCH_THREAD_H */
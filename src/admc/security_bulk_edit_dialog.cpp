@@ -0,0 +1,209 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "security_bulk_edit_dialog.h"
+#include "ui_security_bulk_edit_dialog.h"
+
+#include "adldap.h"
+#include "security_bulk_edit_thread.h"
+#include "settings.h"
+#include "status.h"
+#include "utils.h"
+
+#include <QStandardItemModel>
+
+enum SecurityBulkEditColumn {
+    SecurityBulkEditColumn_Name,
+    SecurityBulkEditColumn_Result,
+    SecurityBulkEditColumn_Dn,
+
+    SecurityBulkEditColumn_COUNT,
+};
+
+SecurityBulkEditDialog::SecurityBulkEditDialog(const QString &base_arg, QWidget *parent)
+: QDialog(parent) {
+    ui = new Ui::SecurityBulkEditDialog();
+    ui->setupUi(this);
+
+    setAttribute(Qt::WA_DeleteOnClose);
+
+    base = base_arg;
+    thread = nullptr;
+    changed_count = 0;
+    unchanged_count = 0;
+    failed_count = 0;
+
+    const QString base_text = QString(tr("Change protection against deletion for objects in %1.")).arg(dn_get_name(base));
+    ui->base_label->setText(base_text);
+
+    model = new QStandardItemModel(0, SecurityBulkEditColumn_COUNT, this);
+    set_horizontal_header_labels_from_map(model,
+        {
+            {SecurityBulkEditColumn_Name, tr("Name")},
+            {SecurityBulkEditColumn_Result, tr("Result")},
+            {SecurityBulkEditColumn_Dn, tr("DN")},
+        });
+
+    ui->view->setModel(model);
+    ui->view->setColumnWidth(SecurityBulkEditColumn_Name, 200);
+    ui->view->setColumnWidth(SecurityBulkEditColumn_Result, 200);
+
+    ui->progress_bar->setVisible(false);
+
+    update_status_label();
+    update_buttons();
+
+    settings_setup_dialog_geometry(SETTING_security_bulk_edit_dialog_geometry, this);
+
+    connect(
+        ui->start_button, &QPushButton::clicked,
+        this, &SecurityBulkEditDialog::on_start);
+    connect(
+        ui->stop_button, &QPushButton::clicked,
+        this, &SecurityBulkEditDialog::on_stop);
+}
+
+SecurityBulkEditDialog::~SecurityBulkEditDialog() {
+    object_scan_thread_stop_and_delete(thread, this);
+
+    delete ui;
+}
+
+void SecurityBulkEditDialog::on_start() {
+    model->removeRows(0, model->rowCount());
+    changed_count = 0;
+    unchanged_count = 0;
+    failed_count = 0;
+
+    ui->view->setSortingEnabled(false);
+
+    const bool enabled = ui->enable_button->isChecked();
+    const QList<SecurityRightEdit> edit_list = ad_security_get_protect_against_deletion_edit_list(enabled);
+
+    const QString filter = [&]() {
+        const bool ou_only = ui->ou_only_check->isChecked();
+
+        if (ou_only) {
+            return filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_OU);
+        } else {
+            return QString();
+        }
+    }();
+
+    thread = new SecurityBulkEditThread(base, filter, edit_list);
+
+    connect(
+        thread, &SecurityBulkEditThread::results_ready,
+        this, &SecurityBulkEditDialog::on_results_ready,
+        Qt::QueuedConnection);
+    connect(
+        thread, &SecurityBulkEditThread::finished,
+        this, &SecurityBulkEditDialog::on_thread_finished);
+
+    thread->start();
+
+    update_status_label();
+    update_buttons();
+}
+
+void SecurityBulkEditDialog::on_stop() {
+    if (thread != nullptr) {
+        thread->stop();
+    }
+}
+
+void SecurityBulkEditDialog::on_results_ready(const QList<SecurityBulkEditResult> &results) {
+    for (const SecurityBulkEditResult &result : results) {
+        const QList<QStandardItem *> row = make_item_row(SecurityBulkEditColumn_COUNT);
+
+        const QString result_text = [&]() {
+            switch (result.type) {
+                case SecurityBulkEditResultType_Changed: {
+                    changed_count++;
+
+                    return tr("Changed");
+                }
+                case SecurityBulkEditResultType_Unchanged: {
+                    unchanged_count++;
+
+                    return tr("Already set");
+                }
+                case SecurityBulkEditResultType_Failed: {
+                    failed_count++;
+
+                    return QString(tr("Failed: %1")).arg(result.error);
+                }
+            }
+
+            return QString();
+        }();
+
+        row[SecurityBulkEditColumn_Name]->setText(dn_get_name(result.dn));
+        row[SecurityBulkEditColumn_Result]->setText(result_text);
+        row[SecurityBulkEditColumn_Dn]->setText(result.dn);
+
+        model->appendRow(row);
+    }
+
+    update_status_label();
+}
+
+void SecurityBulkEditDialog::on_thread_finished() {
+    object_scan_thread_display_errors(thread, tr("Failed to connect to server while changing protection against deletion."), this);
+
+    thread->deleteLater();
+    thread = nullptr;
+
+    ui->view->setSortingEnabled(true);
+
+    update_status_label();
+    update_buttons();
+}
+
+void SecurityBulkEditDialog::update_status_label() {
+    const int processed_count = changed_count + unchanged_count + failed_count;
+    const QString counts_text = QString(tr("%1 objects processed: %2 changed, %3 already set, %4 failed.")).arg(processed_count).arg(changed_count).arg(unchanged_count).arg(failed_count);
+
+    const QString text = [&]() {
+        const bool is_running = (thread != nullptr);
+
+        if (is_running) {
+            return QString(tr("Working... %1")).arg(counts_text);
+        } else {
+            return counts_text;
+        }
+    }();
+
+    ui->status_label->setText(text);
+}
+
+void SecurityBulkEditDialog::update_buttons() {
+    const bool is_running = (thread != nullptr);
+
+    ui->start_button->setEnabled(!is_running);
+    ui->stop_button->setEnabled(is_running);
+    ui->enable_button->setEnabled(!is_running);
+    ui->disable_button->setEnabled(!is_running);
+    ui->ou_only_check->setEnabled(!is_running);
+
+    // NOTE: total count is unknown because objects are
+    // loaded page by page, so show busy progress bar
+    ui->progress_bar->setVisible(is_running);
+}
@@ -0,0 +1,65 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SECURITY_BULK_EDIT_DIALOG_H
+#define SECURITY_BULK_EDIT_DIALOG_H
+
+/**
+ * Enables or disables protection against deletion for
+ * all objects in a subtree. Work is done in background,
+ * dialog shows progress and result for every object.
+ */
+
+#include <QDialog>
+
+class SecurityBulkEditResult;
+class SecurityBulkEditThread;
+class QStandardItemModel;
+
+namespace Ui {
+class SecurityBulkEditDialog;
+}
+
+class SecurityBulkEditDialog final : public QDialog {
+    Q_OBJECT
+
+public:
+    Ui::SecurityBulkEditDialog *ui;
+
+    SecurityBulkEditDialog(const QString &base, QWidget *parent);
+    ~SecurityBulkEditDialog();
+
+private:
+    QString base;
+    QStandardItemModel *model;
+    SecurityBulkEditThread *thread;
+    int changed_count;
+    int unchanged_count;
+    int failed_count;
+
+    void on_start();
+    void on_stop();
+    void on_results_ready(const QList<SecurityBulkEditResult> &results);
+    void on_thread_finished();
+    void update_status_label();
+    void update_buttons();
+};
+
+#endif /* SECURITY_BULK_EDIT_DIALOG_H */
@@ -0,0 +1,163 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "security_bulk_edit_thread.h"
+
+#include "adldap.h"
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QRunnable>
+
+// Computes new descriptors for a chunk of objects from
+// one page. Each task writes to it's own output map, so
+// no locking is needed.
+class SecurityBulkEditTask final : public QRunnable {
+public:
+    SecurityBulkEditTask(AdConfig *adconfig, const QList<AdObject> &object_list, const QList<SecurityRightEdit> &edit_list, QHash<QString, QByteArray> *changed_map_out, QList<QString> *unchanged_list_out, QHash<QString, QString> *error_map_out);
+
+    void run() override;
+
+private:
+    AdConfig *adconfig;
+    QList<AdObject> object_list;
+    QList<SecurityRightEdit> edit_list;
+    QHash<QString, QByteArray> *changed_map_out;
+    QList<QString> *unchanged_list_out;
+    QHash<QString, QString> *error_map_out;
+};
+
+SecurityBulkEditThread::SecurityBulkEditThread(const QString &base_arg, const QString &filter_arg, const QList<SecurityRightEdit> &edit_list_arg)
+: ObjectScanThread(base_arg, filter_arg, {ATTRIBUTE_SECURITY_DESCRIPTOR, ATTRIBUTE_OBJECT_CLASS}) {
+    edit_list = edit_list_arg;
+}
+
+void SecurityBulkEditThread::process_page(AdInterface &ad, const QVector<QList<AdObject>> &chunk_list) {
+    const int chunk_count = chunk_list.size();
+
+    // Compute new descriptors in parallel
+    QVector<QHash<QString, QByteArray>> changed_map_list(chunk_count);
+    QVector<QList<QString>> unchanged_list_list(chunk_count);
+    QVector<QHash<QString, QString>> error_map_list(chunk_count);
+
+    for (int chunk_i = 0; chunk_i < chunk_count; chunk_i++) {
+        if (chunk_list[chunk_i].isEmpty()) {
+            continue;
+        }
+
+        auto task = new SecurityBulkEditTask(ad.adconfig(), chunk_list[chunk_i], edit_list, &changed_map_list[chunk_i], &unchanged_list_list[chunk_i], &error_map_list[chunk_i]);
+        pool.start(task);
+    }
+
+    pool.waitForDone();
+
+    QHash<QString, QByteArray> changed_map;
+    for (const QHash<QString, QByteArray> &chunk_map : changed_map_list) {
+        for (const QString &dn : chunk_map.keys()) {
+            changed_map[dn] = chunk_map[dn];
+        }
+    }
+
+    QHash<QString, QString> error_map;
+    for (const QHash<QString, QString> &chunk_error_map : error_map_list) {
+        for (const QString &dn : chunk_error_map.keys()) {
+            error_map[dn] = chunk_error_map[dn];
+        }
+    }
+
+    // NOTE: don't add status messages for every
+    // object, result of every object is returned
+    // through results_ready() instead
+    const bool set_dacl = true;
+    ad.attribute_replace_value_batch(changed_map, ATTRIBUTE_SECURITY_DESCRIPTOR, DoStatusMsg_No, set_dacl, &error_map);
+
+    QList<SecurityBulkEditResult> results;
+
+    for (const QString &dn : error_map.keys()) {
+        SecurityBulkEditResult result;
+        result.dn = dn;
+        result.type = SecurityBulkEditResultType_Failed;
+        result.error = error_map[dn];
+
+        results.append(result);
+    }
+
+    for (const QString &dn : changed_map.keys()) {
+        if (error_map.contains(dn)) {
+            continue;
+        }
+
+        SecurityBulkEditResult result;
+        result.dn = dn;
+        result.type = SecurityBulkEditResultType_Changed;
+
+        results.append(result);
+    }
+
+    for (const QList<QString> &unchanged_list : unchanged_list_list) {
+        for (const QString &dn : unchanged_list) {
+            SecurityBulkEditResult result;
+            result.dn = dn;
+            result.type = SecurityBulkEditResultType_Unchanged;
+
+            results.append(result);
+        }
+    }
+
+    emit results_ready(results);
+}
+
+SecurityBulkEditTask::SecurityBulkEditTask(AdConfig *adconfig_arg, const QList<AdObject> &object_list_arg, const QList<SecurityRightEdit> &edit_list_arg, QHash<QString, QByteArray> *changed_map_out_arg, QList<QString> *unchanged_list_out_arg, QHash<QString, QString> *error_map_out_arg) {
+    adconfig = adconfig_arg;
+    object_list = object_list_arg;
+    edit_list = edit_list_arg;
+    changed_map_out = changed_map_out_arg;
+    unchanged_list_out = unchanged_list_out_arg;
+    error_map_out = error_map_out_arg;
+}
+
+void SecurityBulkEditTask::run() {
+    for (const AdObject &object : object_list) {
+        const QByteArray old_sd_bytes = object.get_value(ATTRIBUTE_SECURITY_DESCRIPTOR);
+
+        // NOTE: descriptor is missing if we don't have
+        // permission to read it. Don't try to edit it,
+        // that would write an empty descriptor.
+        if (old_sd_bytes.isEmpty()) {
+            error_map_out->insert(object.get_dn(), QCoreApplication::translate("security_bulk_edit_thread.cpp", "Failed to read security descriptor"));
+
+            continue;
+        }
+
+        const QList<QString> class_list = object.get_strings(ATTRIBUTE_OBJECT_CLASS);
+
+        QByteArray new_sd_bytes;
+        bool sd_changed;
+        const bool edit_success = ad_security_apply_right_edits_to_bytes(adconfig, old_sd_bytes, class_list, edit_list, &new_sd_bytes, &sd_changed);
+
+        if (!edit_success) {
+            error_map_out->insert(object.get_dn(), QCoreApplication::translate("security_bulk_edit_thread.cpp", "Failed to parse security descriptor"));
+        } else if (sd_changed) {
+            changed_map_out->insert(object.get_dn(), new_sd_bytes);
+        } else {
+            unchanged_list_out->append(object.get_dn());
+        }
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SECURITY_BULK_EDIT_THREAD_H
+#define SECURITY_BULK_EDIT_THREAD_H
+
+/**
+ * Applies same right edits to security descriptors of all
+ * objects in a subtree. Descriptors are loaded page by
+ * page, edits for a page are computed in a thread pool
+ * and then written with pipelined modify requests. Emits
+ * a result for every processed object.
+ */
+
+#include "object_scan_thread.h"
+
+#include "ad_security.h"
+
+enum SecurityBulkEditResultType {
+    SecurityBulkEditResultType_Changed,
+    SecurityBulkEditResultType_Unchanged,
+    SecurityBulkEditResultType_Failed,
+};
+
+class SecurityBulkEditResult {
+public:
+    QString dn;
+    SecurityBulkEditResultType type;
+    QString error;
+};
+
+class SecurityBulkEditThread final : public ObjectScanThread {
+    Q_OBJECT
+
+public:
+    SecurityBulkEditThread(const QString &base, const QString &filter, const QList<SecurityRightEdit> &edit_list);
+
+signals:
+    void results_ready(const QList<SecurityBulkEditResult> &results);
+
+private:
+    QList<SecurityRightEdit> edit_list;
+
+    void process_page(AdInterface &ad, const QVector<QList<AdObject>> &chunk_list) override;
+};
+
+#endif /* SECURITY_BULK_EDIT_THREAD_H */
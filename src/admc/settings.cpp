@@ -51,6 +51,7 @@ const QHash<QString, QVariant> setting_default_map = {
     {SETTING_object_filter_enabled, false},
     {SETTING_cert_strategy, CERT_STRATEGY_NEVER_define},
     {SETTING_object_display_limit, 1000},
+    {SETTING_trace_file, QString()},
 
     {SETTING_feature_logon_computers, false},
     {SETTING_feature_profile_tab, false},
@@ -66,6 +66,11 @@ DEFINE_SETTING(SETTING_connection_options_dialog_geometry);
 DEFINE_SETTING(SETTING_changelog_dialog_geometry);
 DEFINE_SETTING(SETTING_error_log_dialog_geometry);
 DEFINE_SETTING(SETTING_select_well_known_trustee_dialog_geometry);
+DEFINE_SETTING(SETTING_effective_access_dialog_geometry);
+DEFINE_SETTING(SETTING_effective_access_scan_dialog_geometry);
+DEFINE_SETTING(SETTING_acl_audit_dialog_geometry);
+DEFINE_SETTING(SETTING_diagnostics_dialog_geometry);
+DEFINE_SETTING(SETTING_security_bulk_edit_dialog_geometry);
 DEFINE_SETTING(SETTING_select_object_match_dialog_geometry);
 DEFINE_SETTING(SETTING_edit_query_item_dialog_geometry);
 DEFINE_SETTING(SETTING_create_user_dialog_geometry);
@@ -134,6 +139,9 @@ DEFINE_SETTING(SETTING_last_opened_version);
 DEFINE_SETTING(SETTING_object_filter);
 DEFINE_SETTING(SETTING_object_filter_enabled);
 DEFINE_SETTING(SETTING_object_display_limit);
+// NOTE: path of trace file, not editable within the app.
+// ADMC_TRACE environment variable overrides this.
+DEFINE_SETTING(SETTING_trace_file);
 DEFINE_SETTING(SETTING_custom_domain);
 DEFINE_SETTING(SETTING_current_icon_theme);
 DEFINE_SETTING(SETTING_custom_icon_themes_path)
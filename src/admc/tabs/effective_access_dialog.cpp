@@ -0,0 +1,92 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "effective_access_dialog.h"
+#include "ui_effective_access_dialog.h"
+
+#include "adldap.h"
+#include "effective_access_scan_dialog.h"
+#include "settings.h"
+#include "utils.h"
+
+#include <QStandardItemModel>
+
+enum EffectiveAccessColumn {
+    EffectiveAccessColumn_Name,
+    EffectiveAccessColumn_Allowed,
+
+    EffectiveAccessColumn_COUNT,
+};
+
+EffectiveAccessDialog::EffectiveAccessDialog(QWidget *parent)
+: QDialog(parent) {
+    ui = new Ui::EffectiveAccessDialog();
+    ui->setupUi(this);
+
+    setAttribute(Qt::WA_DeleteOnClose);
+
+    model = new QStandardItemModel(0, EffectiveAccessColumn_COUNT, this);
+    set_horizontal_header_labels_from_map(model,
+        {
+            {EffectiveAccessColumn_Name, tr("Name")},
+            {EffectiveAccessColumn_Allowed, tr("Allowed")},
+        });
+
+    ui->view->setModel(model);
+    ui->view->setColumnWidth(EffectiveAccessColumn_Name, 400);
+
+    settings_setup_dialog_geometry(SETTING_effective_access_dialog_geometry, this);
+
+    connect(
+        ui->scan_button, &QPushButton::clicked,
+        this, &EffectiveAccessDialog::on_scan_button);
+}
+
+EffectiveAccessDialog::~EffectiveAccessDialog() {
+    delete ui;
+}
+
+void EffectiveAccessDialog::load(const QString &principal_dn_arg, const QString &target_dn_arg, const QList<QString> &right_name_list, const QList<bool> &allowed_list) {
+    principal_dn = principal_dn_arg;
+    target_dn = target_dn_arg;
+
+    const QString label_text = QString(tr("Effective access of %1:")).arg(dn_get_name(principal_dn));
+    ui->label->setText(label_text);
+
+    model->removeRows(0, model->rowCount());
+
+    for (int i = 0; i < right_name_list.size(); i++) {
+        const QList<QStandardItem *> row = make_item_row(EffectiveAccessColumn_COUNT);
+
+        row[EffectiveAccessColumn_Name]->setText(right_name_list[i]);
+
+        QStandardItem *allowed_item = row[EffectiveAccessColumn_Allowed];
+        allowed_item->setCheckable(true);
+        allowed_item->setCheckState(allowed_list[i] ? Qt::Checked : Qt::Unchecked);
+        allowed_item->setEnabled(false);
+
+        model->appendRow(row);
+    }
+}
+
+void EffectiveAccessDialog::on_scan_button() {
+    auto scan_dialog = new EffectiveAccessScanDialog(target_dn, principal_dn, this);
+    scan_dialog->open();
+}
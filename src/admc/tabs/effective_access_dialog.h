@@ -0,0 +1,58 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EFFECTIVE_ACCESS_DIALOG_H
+#define EFFECTIVE_ACCESS_DIALOG_H
+
+/**
+ * Dialog displaying effective access of a principal to an
+ * object. Effective access takes into account all groups
+ * of the principal, including nested ones. Access to all
+ * objects in the subtree can be scanned from here.
+ */
+
+#include <QDialog>
+
+class QStandardItemModel;
+
+namespace Ui {
+class EffectiveAccessDialog;
+}
+
+class EffectiveAccessDialog final : public QDialog {
+    Q_OBJECT
+
+public:
+    Ui::EffectiveAccessDialog *ui;
+
+    EffectiveAccessDialog(QWidget *parent);
+    ~EffectiveAccessDialog();
+
+    void load(const QString &principal_dn, const QString &target_dn, const QList<QString> &right_name_list, const QList<bool> &allowed_list);
+
+private:
+    QStandardItemModel *model;
+    QString principal_dn;
+    QString target_dn;
+
+    void on_scan_button();
+};
+
+#endif /* EFFECTIVE_ACCESS_DIALOG_H */
@@ -0,0 +1,240 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "effective_access_scan_dialog.h"
+#include "ui_effective_access_scan_dialog.h"
+
+#include "adldap.h"
+#include "effective_access_scan_thread.h"
+#include "settings.h"
+#include "status.h"
+#include "utils.h"
+
+#include <QFile>
+#include <QFileDialog>
+#include <QStandardItemModel>
+#include <QStandardPaths>
+
+enum EffectiveAccessScanColumn {
+    EffectiveAccessScanColumn_Name,
+    EffectiveAccessScanColumn_Allowed,
+    EffectiveAccessScanColumn_Total,
+    EffectiveAccessScanColumn_Dn,
+
+    EffectiveAccessScanColumn_COUNT,
+};
+
+EffectiveAccessScanDialog::EffectiveAccessScanDialog(const QString &base_arg, const QString &principal_dn_arg, QWidget *parent)
+: QDialog(parent) {
+    ui = new Ui::EffectiveAccessScanDialog();
+    ui->setupUi(this);
+
+    setAttribute(Qt::WA_DeleteOnClose);
+
+    base = base_arg;
+    principal_dn = principal_dn_arg;
+    thread = nullptr;
+
+    const QString base_text = QString(tr("Effective access of %1 to objects in %2.")).arg(dn_get_name(principal_dn), dn_get_name(base));
+    ui->base_label->setText(base_text);
+
+    model = new QStandardItemModel(0, EffectiveAccessScanColumn_COUNT, this);
+    set_horizontal_header_labels_from_map(model,
+        {
+            {EffectiveAccessScanColumn_Name, tr("Name")},
+            {EffectiveAccessScanColumn_Allowed, tr("Allowed rights")},
+            {EffectiveAccessScanColumn_Total, tr("Total rights")},
+            {EffectiveAccessScanColumn_Dn, tr("DN")},
+        });
+
+    ui->view->setModel(model);
+    ui->view->setColumnWidth(EffectiveAccessScanColumn_Name, 200);
+
+    update_status_label();
+    update_buttons();
+
+    settings_setup_dialog_geometry(SETTING_effective_access_scan_dialog_geometry, this);
+
+    connect(
+        ui->start_button, &QPushButton::clicked,
+        this, &EffectiveAccessScanDialog::on_start);
+    connect(
+        ui->stop_button, &QPushButton::clicked,
+        this, &EffectiveAccessScanDialog::on_stop);
+    connect(
+        ui->export_button, &QPushButton::clicked,
+        this, &EffectiveAccessScanDialog::on_export);
+}
+
+EffectiveAccessScanDialog::~EffectiveAccessScanDialog() {
+    object_scan_thread_stop_and_delete(thread, this);
+
+    delete ui;
+}
+
+void EffectiveAccessScanDialog::on_start() {
+    AdInterface ad;
+    if (ad_failed(ad, this)) {
+        return;
+    }
+
+    // NOTE: load token once here, thread reuses it for
+    // all objects. Token with "Principal Self" is only
+    // needed for the principal's own object. Both come
+    // from the token cache, so this is one read.
+    const QList<QByteArray> token = ad_security_get_token(ad, principal_dn, QString());
+    const QList<QByteArray> self_token = ad_security_get_token(ad, principal_dn, principal_dn);
+
+    if (token.isEmpty()) {
+        g_status->display_ad_messages(ad, this);
+
+        return;
+    }
+
+    model->removeRows(0, model->rowCount());
+
+    // NOTE: disable sorting while scanning so that rows
+    // are not resorted on every batch
+    ui->view->setSortingEnabled(false);
+
+    thread = new EffectiveAccessScanThread(base, principal_dn, token, self_token);
+
+    connect(
+        thread, &EffectiveAccessScanThread::results_ready,
+        this, &EffectiveAccessScanDialog::on_results_ready,
+        Qt::QueuedConnection);
+    connect(
+        thread, &EffectiveAccessScanThread::finished,
+        this, &EffectiveAccessScanDialog::on_thread_finished);
+
+    thread->start();
+
+    update_status_label();
+    update_buttons();
+}
+
+void EffectiveAccessScanDialog::on_stop() {
+    if (thread != nullptr) {
+        thread->stop();
+    }
+}
+
+void EffectiveAccessScanDialog::on_results_ready(const QList<EffectiveAccessScanResult> &results) {
+    for (const EffectiveAccessScanResult &result : results) {
+        const QList<QStandardItem *> row = make_item_row(EffectiveAccessScanColumn_COUNT);
+
+        row[EffectiveAccessScanColumn_Name]->setText(dn_get_name(result.dn));
+
+        // NOTE: set counts as int so that columns are
+        // sorted numerically
+        if (result.read_failed) {
+            row[EffectiveAccessScanColumn_Allowed]->setText(tr("Failed to read"));
+        } else {
+            row[EffectiveAccessScanColumn_Allowed]->setData(result.allowed_count, Qt::DisplayRole);
+        }
+        row[EffectiveAccessScanColumn_Total]->setData(result.right_count, Qt::DisplayRole);
+        row[EffectiveAccessScanColumn_Dn]->setText(result.dn);
+
+        model->appendRow(row);
+    }
+
+    update_status_label();
+}
+
+void EffectiveAccessScanDialog::on_thread_finished() {
+    object_scan_thread_display_errors(thread, tr("Failed to connect to server while scanning effective access."), this);
+
+    thread->deleteLater();
+    thread = nullptr;
+
+    ui->view->setSortingEnabled(true);
+
+    update_status_label();
+    update_buttons();
+}
+
+void EffectiveAccessScanDialog::on_export() {
+    const QString file_path = [&]() {
+        const QString caption = tr("Export Effective Access");
+        const QString suggested_file = QString("%1/%2.csv").arg(QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation), tr("effective_access"));
+        const QString filter = tr("CSV (*.csv)");
+
+        const QString out = QFileDialog::getSaveFileName(this, caption, suggested_file, filter);
+
+        return out;
+    }();
+
+    if (file_path.isEmpty()) {
+        return;
+    }
+
+    QString csv;
+
+    const QList<QString> header = {
+        "DN",
+        "Allowed rights",
+        "Total rights",
+    };
+    csv.append(header.join(','));
+    csv.append('\n');
+
+    // NOTE: export in the order that is currently
+    // displayed in the view
+    for (int row = 0; row < model->rowCount(); row++) {
+        const QList<QString> row_values = {
+            csv_escape(model->item(row, EffectiveAccessScanColumn_Dn)->text()),
+            csv_escape(model->item(row, EffectiveAccessScanColumn_Allowed)->text()),
+            model->item(row, EffectiveAccessScanColumn_Total)->text(),
+        };
+        csv.append(row_values.join(','));
+        csv.append('\n');
+    }
+
+    QFile file(file_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error_log({QString(tr("Failed to open file \"%1\".")).arg(file_path)}, this);
+
+        return;
+    }
+
+    file.write(csv.toUtf8());
+}
+
+void EffectiveAccessScanDialog::update_status_label() {
+    const QString text = [&]() {
+        const bool is_running = (thread != nullptr);
+
+        if (is_running) {
+            return QString(tr("Scanning... %1 objects scanned.")).arg(model->rowCount());
+        } else {
+            return QString(tr("%1 objects scanned.")).arg(model->rowCount());
+        }
+    }();
+
+    ui->status_label->setText(text);
+}
+
+void EffectiveAccessScanDialog::update_buttons() {
+    const bool is_running = (thread != nullptr);
+
+    ui->start_button->setEnabled(!is_running);
+    ui->stop_button->setEnabled(is_running);
+    ui->export_button->setEnabled(!is_running);
+}
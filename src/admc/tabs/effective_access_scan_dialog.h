@@ -0,0 +1,66 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EFFECTIVE_ACCESS_SCAN_DIALOG_H
+#define EFFECTIVE_ACCESS_SCAN_DIALOG_H
+
+/**
+ * Shows effective access of a principal to every object
+ * in a subtree. Results are added as the scan progresses
+ * and can be sorted and exported to CSV. Note that scan
+ * uses descriptors saved on the server, so changes that
+ * weren't applied yet are not included.
+ */
+
+#include <QDialog>
+
+class EffectiveAccessScanResult;
+class EffectiveAccessScanThread;
+class QStandardItemModel;
+
+namespace Ui {
+class EffectiveAccessScanDialog;
+}
+
+class EffectiveAccessScanDialog final : public QDialog {
+    Q_OBJECT
+
+public:
+    Ui::EffectiveAccessScanDialog *ui;
+
+    EffectiveAccessScanDialog(const QString &base, const QString &principal_dn, QWidget *parent);
+    ~EffectiveAccessScanDialog();
+
+private:
+    QString base;
+    QString principal_dn;
+    QStandardItemModel *model;
+    EffectiveAccessScanThread *thread;
+
+    void on_start();
+    void on_stop();
+    void on_export();
+    void on_results_ready(const QList<EffectiveAccessScanResult> &results);
+    void on_thread_finished();
+    void update_status_label();
+    void update_buttons();
+};
+
+#endif /* EFFECTIVE_ACCESS_SCAN_DIALOG_H */
@@ -429,8 +429,9 @@ void MembershipTabEdit::reload_model() {
     const QSet<QString> all_values = current_values + current_primary_values;
 
     for (auto dn : all_values) {
-        const QString name = dn_get_name(dn);
-        const QString parent = dn_get_parent_canonical(dn);
+        const DnView dn_view(dn);
+        const QString name = dn_view.name();
+        const QString parent = dn_view.parent_canonical();
 
         const QList<QStandardItem *> row = make_item_row(MembersColumn_COUNT);
         row[MembersColumn_Name]->setText(name);
@@ -23,10 +23,12 @@
 
 #include "ad_security.h"
 #include "adldap.h"
+#include "effective_access_dialog.h"
 #include "globals.h"
 #include "select_dialogs/select_object_dialog.h"
 #include "select_well_known_trustee_dialog.h"
 #include "settings.h"
+#include "status.h"
 #include "utils.h"
 
 #include "samba/ndr_security.h"
@@ -143,6 +145,7 @@ SecurityTabEdit::SecurityTabEdit(Ui::SecurityTab *ui_arg, QObject *parent)
     ui = ui_arg;
 
     sd = nullptr;
+    dacl_index = nullptr;
 
     ignore_item_changed_signal = false;
     read_only = false;
@@ -182,16 +185,22 @@ SecurityTabEdit::SecurityTabEdit(Ui::SecurityTab *ui_arg, QObject *parent)
     connect(
         ui->remove_trustee_button, &QAbstractButton::clicked,
         this, &SecurityTabEdit::on_remove_trustee_button);
+    connect(
+        ui->effective_access_button, &QAbstractButton::clicked,
+        this, &SecurityTabEdit::on_effective_access_button);
 }
 
 SecurityTabEdit::~SecurityTabEdit() {
     if (sd != nullptr) {
         security_descriptor_free(sd);
     }
+
+    delete dacl_index;
 }
 
 void SecurityTabEdit::fix_acl_order() {
     security_descriptor_sort_dacl(sd);
+    update_dacl_index();
 
     emit edited();
 }
@@ -269,8 +278,10 @@ void SecurityTabEdit::load_current_sd(AdInterface &ad) {
 void SecurityTabEdit::load(AdInterface &ad, const AdObject &object) {
     security_descriptor_free(sd);
     sd = object.get_security_descriptor();
+    update_dacl_index();
 
     target_class_list = object.get_strings(ATTRIBUTE_OBJECT_CLASS);
+    target_dn = object.get_dn();
 
     // Create items in rights model. These will not
     // change until target object changes. Only the
@@ -336,16 +347,32 @@ void SecurityTabEdit::load_rights_model() {
 
     const QByteArray trustee = get_current_trustee();
 
-    for (int row = 0; row < rights_model->rowCount(); row++) {
-        const SecurityRightState state = [&]() {
+    // NOTE: get states of all rights at once using an
+    // index instead of calling
+    // security_descriptor_get_right() for each right,
+    // which would go through whole DACL every time. Index
+    // is shared by all trustee's and is only rebuilt when
+    // sd changes.
+    const QList<SecurityRightState> state_list = [&]() {
+        QList<SecurityRight> right_list;
+
+        for (int row = 0; row < rights_model->rowCount(); row++) {
             QStandardItem *item = rights_model->item(row, 0);
-            const uint32_t access_mask = item->data(RightsItemRole_AccessMask).toUInt();
 
-            const QByteArray object_type = item->data(RightsItemRole_ObjectType).toByteArray();
-            const SecurityRightState out = security_descriptor_get_right(sd, trustee, access_mask, object_type);
+            SecurityRight right;
+            right.access_mask = item->data(RightsItemRole_AccessMask).toUInt();
+            right.object_type = item->data(RightsItemRole_ObjectType).toByteArray();
 
-            return out;
-        }();
+            right_list.append(right);
+        }
+
+        const QList<SecurityRightState> out = dacl_index->get_right_list(trustee, right_list);
+
+        return out;
+    }();
+
+    for (int row = 0; row < rights_model->rowCount(); row++) {
+        const SecurityRightState state = state_list[row];
 
         const QHash<SecurityRightStateType, QStandardItem *> item_map = {
             {SecurityRightStateType_Allow, rights_model->item(row, AceColumn_Allowed)},
@@ -410,6 +437,13 @@ void SecurityTabEdit::make_rights_model_read_only() {
     ignore_item_changed_signal = false;
 }
 
+// NOTE: must be called every time sd changes, otherwise
+// rights model will show states of previous sd
+void SecurityTabEdit::update_dacl_index() {
+    delete dacl_index;
+    dacl_index = new SecurityDaclIndex(sd);
+}
+
 void SecurityTabEdit::on_item_changed(QStandardItem *item) {
     // NOTE: in some cases we need to ignore this signal
     if (ignore_item_changed_signal) {
@@ -438,6 +472,7 @@ void SecurityTabEdit::on_item_changed(QStandardItem *item) {
         security_descriptor_remove_right(sd, g_adconfig, target_class_list, trustee, access_mask, object_type, allow);
     }
 
+    update_dacl_index();
     load_rights_model();
 
     emit edited();
@@ -502,6 +537,60 @@ void SecurityTabEdit::on_add_trustee_button() {
         });
 }
 
+// NOTE: effective access is computed for current state
+// of the descriptor, including edits that weren't
+// applied yet
+void SecurityTabEdit::on_effective_access_button() {
+    auto dialog = new SelectObjectDialog({CLASS_USER, CLASS_GROUP, CLASS_COMPUTER}, SelectObjectDialogMultiSelection_No, ui->trustee_view);
+    dialog->setWindowTitle(tr("Select Principal"));
+    dialog->open();
+
+    connect(
+        dialog, &SelectObjectDialog::accepted,
+        this,
+        [this, dialog]() {
+            const QList<QString> selected_list = dialog->get_selected();
+            if (selected_list.isEmpty()) {
+                return;
+            }
+
+            AdInterface ad;
+            if (ad_failed(ad, ui->trustee_view)) {
+                return;
+            }
+
+            const QString principal_dn = selected_list[0];
+            const QList<QByteArray> token = ad_security_get_token(ad, principal_dn, target_dn);
+
+            if (token.isEmpty()) {
+                g_status->display_ad_messages(ad, ui->trustee_view);
+
+                return;
+            }
+
+            const QLocale::Language language = []() {
+                const QLocale saved_locale = settings_get_variant(SETTING_locale).toLocale();
+                const QLocale::Language out = saved_locale.language();
+
+                return out;
+            }();
+
+            const QList<SecurityRight> right_list = ad_security_get_right_list_for_class(g_adconfig, target_class_list);
+            const QList<bool> allowed_list = security_descriptor_get_effective_rights(sd, token, right_list);
+
+            QList<QString> right_name_list;
+            for (const SecurityRight &right : right_list) {
+                const QString right_name = ad_security_get_right_name(g_adconfig, right.access_mask, right.object_type, language);
+
+                right_name_list.append(right_name);
+            }
+
+            auto effective_access_dialog = new EffectiveAccessDialog(ui->trustee_view);
+            effective_access_dialog->load(principal_dn, target_dn, right_name_list, allowed_list);
+            effective_access_dialog->open();
+        });
+}
+
 void SecurityTabEdit::on_remove_trustee_button() {
     AdInterface ad;
     if (ad_failed(ad, ui->remove_trustee_button)) {
@@ -525,6 +614,7 @@ void SecurityTabEdit::on_remove_trustee_button() {
 
     // Remove from sd
     security_descriptor_remove_trustee(sd, removed_trustee_list);
+    update_dacl_index();
 
     // Reload sd
     //
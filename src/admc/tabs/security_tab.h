@@ -32,6 +32,7 @@ class RightsSortModel;
 class QStandardItemModel;
 class QStandardItem;
 class SecurityDescriptor;
+class SecurityDaclIndex;
 struct security_descriptor;
 
 enum AceColumn {
@@ -88,7 +89,9 @@ private:
     bool is_policy;
     bool ignore_item_changed_signal;
     security_descriptor *sd;
+    SecurityDaclIndex *dacl_index;
     QList<QString> target_class_list;
+    QString target_dn;
     bool read_only;
 
     void on_item_changed(QStandardItem *item);
@@ -96,8 +99,10 @@ private:
     void on_remove_trustee_button();
     void add_trustees(const QList<QByteArray> &sid_list, AdInterface &ad);
     void on_add_well_known_trustee();
+    void on_effective_access_button();
     void load_current_sd(AdInterface &ad);
     void load_rights_model();
+    void update_dacl_index();
     void make_rights_model_read_only();
     QByteArray get_current_trustee() const;
 };
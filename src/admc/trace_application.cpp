@@ -0,0 +1,65 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trace_application.h"
+
+#include "ad_trace.h"
+
+#include <QAbstractItemView>
+#include <QEvent>
+
+const char *trace_event_name(QObject *receiver, QEvent *event);
+
+bool TraceApplication::notify(QObject *receiver, QEvent *event) {
+    if (!trace_is_enabled() || receiver == nullptr) {
+        return QApplication::notify(receiver, event);
+    }
+
+    const char *name = trace_event_name(receiver, event);
+    if (name == nullptr) {
+        return QApplication::notify(receiver, event);
+    }
+
+    TraceSpan span("event", name);
+    span.add_arg("class", receiver->metaObject()->className());
+
+    return QApplication::notify(receiver, event);
+}
+
+// Returns name of span for events that are worth tracing,
+// otherwise nullptr
+const char *trace_event_name(QObject *receiver, QEvent *event) {
+    switch (event->type()) {
+        case QEvent::MetaCall: return "queued_call";
+        case QEvent::LayoutRequest: return "layout_request";
+        case QEvent::UpdateRequest: return "update_request";
+        case QEvent::Paint: return "paint";
+        case QEvent::Timer: {
+            // NOTE: item views do delayed relayout of
+            // items in a timer event
+            if (qobject_cast<QAbstractItemView *>(receiver) != nullptr) {
+                return "view_relayout";
+            } else {
+                return nullptr;
+            }
+        }
+        default: return nullptr;
+    }
+}
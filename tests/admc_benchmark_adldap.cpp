@@ -0,0 +1,388 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "admc_benchmark_adldap.h"
+
+#include "adldap.h"
+#include "fake_ad_server.h"
+#include "samba/ndr_security.h"
+
+#include <algorithm>
+
+// NOTE: benchmarks run against a generated domain served
+// by the fake AD server, so results don't depend on the
+// network or on contents of a real domain. Domain is the
+// same on every run, so results can be compared between
+// commits. Note that search times include time spent by
+// the fake server, which doesn't change between commits.
+
+// NOTE: gplink parsing and serialization is covered by
+// admc_benchmark_gplink
+
+#define USER_COUNT 2000
+#define GROUP_COUNT 100
+#define OU_COUNT 20
+#define GPO_COUNT 10
+
+const QList<int> ace_count_list = {10, 100, 1000};
+const QList<int> condition_count_list = {1, 10, 100};
+
+void ADMCBenchmarkAdldap::initTestCase() {
+    FakeAdDomainSize size;
+    size.users = USER_COUNT;
+    size.groups = GROUP_COUNT;
+    size.ous = OU_COUNT;
+    size.gpos = GPO_COUNT;
+
+    server = new FakeAdServer(size);
+    QVERIFY(server->start());
+    server->setup_ad_interface();
+
+    ad = new AdInterface();
+    QVERIFY(ad->is_connected());
+
+    adconfig_instance = new AdConfig();
+    adconfig_instance->load(*ad, QLocale(QLocale::English));
+    AdInterface::set_config(adconfig_instance);
+
+    const QString domain_dn = adconfig_instance->domain_dn();
+    const QString user_filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_USER);
+    const QHash<QString, AdObject> user_results = ad->search(domain_dn, SearchScope_All, user_filter, {ATTRIBUTE_DN});
+    user_dn_list = user_results.keys();
+    std::sort(user_dn_list.begin(), user_dn_list.end());
+    QVERIFY(user_dn_list.size() > USER_COUNT);
+
+    user = ad->search_object(QString("CN=User-0,OU=OU-0,%1").arg(domain_dn));
+    QVERIFY(!user.is_empty());
+}
+
+void ADMCBenchmarkAdldap::cleanupTestCase() {
+    AdInterface::set_config(nullptr);
+    AdInterface::set_test_server(QString());
+
+    delete ad;
+    delete adconfig_instance;
+    delete server;
+}
+
+void ADMCBenchmarkAdldap::search_paged_data() {
+    QTest::addColumn<QString>("base");
+    QTest::addColumn<int>("scope");
+    QTest::addColumn<QString>("filter");
+    QTest::addColumn<QList<QString>>("attributes");
+
+    const QString domain_dn = server->directory()->domain_dn();
+    const QString ou_dn = QString("OU=OU-0,%1").arg(domain_dn);
+    const QString user_filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_USER);
+    const QList<QString> all_attributes = QList<QString>();
+    const QList<QString> dn_attributes = {ATTRIBUTE_DN};
+
+    QTest::newRow("OU children, all attributes") << ou_dn << (int) SearchScope_Children << QString() << all_attributes;
+    QTest::newRow("domain users, dn") << domain_dn << (int) SearchScope_All << user_filter << dn_attributes;
+    QTest::newRow("domain users, all attributes") << domain_dn << (int) SearchScope_All << user_filter << all_attributes;
+}
+
+void ADMCBenchmarkAdldap::search_paged() {
+    QFETCH(QString, base);
+    QFETCH(int, scope);
+    QFETCH(QString, filter);
+    QFETCH(QList<QString>, attributes);
+
+    QBENCHMARK {
+        QHash<QString, AdObject> results;
+        AdCookie cookie;
+
+        while (true) {
+            const bool success = ad->search_paged(base, (SearchScope) scope, filter, attributes, &results, &cookie);
+            if (!success || !cookie.more_pages()) {
+                break;
+            }
+        }
+    }
+}
+
+void ADMCBenchmarkAdldap::object_getters() {
+    QBENCHMARK {
+        const QString name = user.get_string(ATTRIBUTE_NAME);
+        const QList<QString> object_class_list = user.get_strings(ATTRIBUTE_OBJECT_CLASS);
+        const int control = user.get_int(ATTRIBUTE_USER_ACCOUNT_CONTROL);
+        const QByteArray sid = user.get_value(ATTRIBUTE_OBJECT_SID);
+        const QDateTime when_changed = user.get_datetime(ATTRIBUTE_WHEN_CHANGED, adconfig_instance);
+        const bool is_user = user.is_class(CLASS_USER);
+        const bool disabled = user.get_account_option(AccountOption_Disabled, adconfig_instance);
+        const bool contains_mail = user.contains(ATTRIBUTE_MAIL);
+
+        Q_UNUSED(name);
+        Q_UNUSED(object_class_list);
+        Q_UNUSED(control);
+        Q_UNUSED(sid);
+        Q_UNUSED(when_changed);
+        Q_UNUSED(is_user);
+        Q_UNUSED(disabled);
+        Q_UNUSED(contains_mail);
+    }
+}
+
+void ADMCBenchmarkAdldap::attribute_display_value_data() {
+    QTest::addColumn<QString>("attribute");
+    QTest::addColumn<QByteArray>("value");
+
+    auto add_row = [&](const char *tag, const QString &attribute, const QByteArray &value) {
+        QTest::newRow(tag) << attribute << value;
+    };
+
+    add_row("Unicode", ATTRIBUTE_DESCRIPTION, user.get_value(ATTRIBUTE_DESCRIPTION));
+    add_row("Integer", ATTRIBUTE_USER_ACCOUNT_CONTROL, user.get_value(ATTRIBUTE_USER_ACCOUNT_CONTROL));
+    add_row("LargeInteger", ATTRIBUTE_USN_CHANGED, user.get_value(ATTRIBUTE_USN_CHANGED));
+    add_row("LargeInteger datetime", ATTRIBUTE_ACCOUNT_EXPIRES, user.get_value(ATTRIBUTE_ACCOUNT_EXPIRES));
+    add_row("GeneralizedTime", ATTRIBUTE_WHEN_CHANGED, user.get_value(ATTRIBUTE_WHEN_CHANGED));
+    add_row("Boolean", ATTRIBUTE_IS_CRITICAL_SYSTEM_OBJECT, "TRUE");
+    add_row("OID", ATTRIBUTE_OBJECT_CLASS, user.get_value(ATTRIBUTE_OBJECT_CLASS));
+    add_row("DSDN", ATTRIBUTE_OBJECT_CATEGORY, user.get_value(ATTRIBUTE_OBJECT_CATEGORY));
+    add_row("Sid", ATTRIBUTE_OBJECT_SID, user.get_value(ATTRIBUTE_OBJECT_SID));
+    add_row("Octet GUID", ATTRIBUTE_OBJECT_GUID, user.get_value(ATTRIBUTE_OBJECT_GUID));
+    add_row("NTSecDesc", ATTRIBUTE_SECURITY_DESCRIPTOR, user.get_value(ATTRIBUTE_SECURITY_DESCRIPTOR));
+}
+
+void ADMCBenchmarkAdldap::attribute_display_value() {
+    QFETCH(QString, attribute);
+    QFETCH(QByteArray, value);
+
+    QVERIFY(!value.isEmpty());
+
+    QBENCHMARK {
+        const QString out = ::attribute_display_value(attribute, value, adconfig_instance);
+        Q_UNUSED(out);
+    }
+}
+
+void ADMCBenchmarkAdldap::security_descriptor_get_right_data() {
+    QTest::addColumn<int>("ace_count");
+    QTest::addColumn<bool>("use_index");
+
+    for (const int ace_count : ace_count_list) {
+        for (const bool use_index : {false, true}) {
+            const QString impl = (use_index ? "index" : "linear");
+            const QByteArray tag = QString("%1 aces, %2").arg(QString::number(ace_count), impl).toUtf8();
+
+            QTest::newRow(tag.constData()) << ace_count << use_index;
+        }
+    }
+}
+
+// NOTE: DACL has one ace per trustee and the right is
+// checked for the last trustee, which is the worst case
+// for linear search
+void ADMCBenchmarkAdldap::security_descriptor_get_right() {
+    QFETCH(int, ace_count);
+    QFETCH(bool, use_index);
+
+    auto make_trustee = [](const int i) {
+        return sid_string_to_bytes(QString("S-1-5-21-1-2-3-%1").arg(10000 + i));
+    };
+
+    QList<SecurityRightEdit> edit_list;
+    for (int i = 0; i < ace_count; i++) {
+        SecurityRightEdit edit;
+        edit.type = SecurityRightEditType_AddBase;
+        edit.trustee = make_trustee(i);
+        edit.access_mask = SEC_ADS_GENERIC_READ;
+        edit.object_type = QByteArray();
+        edit.allow = true;
+
+        edit_list.append(edit);
+    }
+
+    const QList<QString> class_list = user.get_strings(ATTRIBUTE_OBJECT_CLASS);
+    QByteArray sd_bytes;
+    bool sd_changed;
+    QVERIFY(ad_security_apply_right_edits_to_bytes(adconfig_instance, user.get_value(ATTRIBUTE_SECURITY_DESCRIPTOR), class_list, edit_list, &sd_bytes, &sd_changed));
+    QVERIFY(sd_changed);
+
+    security_descriptor *sd = security_descriptor_make_from_bytes(sd_bytes);
+    const QByteArray trustee = make_trustee(ace_count - 1);
+
+    const SecurityRightState expected = ::security_descriptor_get_right(sd, trustee, SEC_ADS_GENERIC_READ, QByteArray());
+    QVERIFY(expected.get(SecurityRightStateInherited_No, SecurityRightStateType_Allow));
+
+    if (use_index) {
+        QBENCHMARK {
+            const SecurityDaclIndex index(sd);
+            const SecurityRightState state = index.get_right(trustee, SEC_ADS_GENERIC_READ, QByteArray());
+            Q_UNUSED(state);
+        }
+    } else {
+        QBENCHMARK {
+            const SecurityRightState state = ::security_descriptor_get_right(sd, trustee, SEC_ADS_GENERIC_READ, QByteArray());
+            Q_UNUSED(state);
+        }
+    }
+
+    security_descriptor_free(sd);
+}
+
+void ADMCBenchmarkAdldap::filter_data() {
+    QTest::addColumn<int>("condition_count");
+
+    for (const int condition_count : condition_count_list) {
+        const QByteArray tag = QString("%1 conditions").arg(condition_count).toUtf8();
+
+        QTest::newRow(tag.constData()) << condition_count;
+    }
+}
+
+// NOTE: builds a filter like the ones made by find
+// dialogs and the filter dialog
+void ADMCBenchmarkAdldap::filter() {
+    QFETCH(int, condition_count);
+
+    const QList<QString> dn_list = user_dn_list.mid(0, condition_count);
+
+    QBENCHMARK {
+        QList<QString> subfilter_list;
+
+        for (int i = 0; i < condition_count; i++) {
+            const QString name = QString("User-%1").arg(i);
+            subfilter_list.append(filter_CONDITION(Condition_StartsWith, ATTRIBUTE_NAME, name));
+        }
+
+        const QString name_filter = filter_OR(subfilter_list);
+        const QString dn_filter = filter_dn_list(dn_list);
+        const QString class_filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_USER);
+        const QString out = add_advanced_view_filter(filter_AND({class_filter, name_filter, dn_filter}));
+
+        Q_UNUSED(out);
+    }
+}
+
+void ADMCBenchmarkAdldap::dn_data() {
+    QTest::addColumn<QString>("helper");
+
+    const QList<QString> helper_list = {
+        "dn_get_name",
+        "dn_get_rdn",
+        "dn_get_parent",
+        "dn_get_parent_canonical",
+        "dn_canonical",
+        "dn_rename",
+        "dn_move",
+    };
+
+    for (const QString &helper : helper_list) {
+        const QByteArray tag = helper.toUtf8();
+
+        QTest::newRow(tag.constData()) << helper;
+    }
+}
+
+// NOTE: runs helper over dn's of all users in domain
+void ADMCBenchmarkAdldap::dn() {
+    QFETCH(QString, helper);
+
+    const QString new_parent = QString("OU=OU-1,%1").arg(server->directory()->domain_dn());
+
+    auto apply = [&](const QString &dn) -> QString {
+        if (helper == "dn_get_name") {
+            return dn_get_name(dn);
+        } else if (helper == "dn_get_rdn") {
+            return dn_get_rdn(dn);
+        } else if (helper == "dn_get_parent") {
+            return dn_get_parent(dn);
+        } else if (helper == "dn_get_parent_canonical") {
+            return dn_get_parent_canonical(dn);
+        } else if (helper == "dn_canonical") {
+            return dn_canonical(dn);
+        } else if (helper == "dn_rename") {
+            return dn_rename(dn, "new-name");
+        } else if (helper == "dn_move") {
+            return dn_move(dn, new_parent);
+        }
+
+        return QString();
+    };
+
+    QBENCHMARK {
+        for (const QString &dn : user_dn_list) {
+            const QString out = apply(dn);
+            Q_UNUSED(out);
+        }
+    }
+}
+
+void ADMCBenchmarkAdldap::adconfig_data() {
+    QTest::addColumn<QString>("query");
+
+    const QList<QString> query_list = {
+        "get_attribute_type",
+        "get_attribute_display_name",
+        "get_class_display_name",
+        "get_inherit_chain",
+        "get_possible_superiors",
+        "get_optional_attributes",
+    };
+
+    for (const QString &query : query_list) {
+        const QByteArray tag = query.toUtf8();
+
+        QTest::newRow(tag.constData()) << query;
+    }
+}
+
+// NOTE: runs query for every attribute and class of a
+// user object, which is what object properties do
+void ADMCBenchmarkAdldap::adconfig() {
+    QFETCH(QString, query);
+
+    const QList<QString> attribute_list = user.attributes();
+    const QList<QString> class_list = user.get_strings(ATTRIBUTE_OBJECT_CLASS);
+    const QString object_class = class_list.last();
+
+    QBENCHMARK {
+        if (query == "get_attribute_type") {
+            for (const QString &attribute : attribute_list) {
+                const AttributeType out = adconfig_instance->get_attribute_type(attribute);
+                Q_UNUSED(out);
+            }
+        } else if (query == "get_attribute_display_name") {
+            for (const QString &attribute : attribute_list) {
+                const QString out = adconfig_instance->get_attribute_display_name(attribute, object_class);
+                Q_UNUSED(out);
+            }
+        } else if (query == "get_class_display_name") {
+            for (const QString &class_name : class_list) {
+                const QString out = adconfig_instance->get_class_display_name(class_name);
+                Q_UNUSED(out);
+            }
+        } else if (query == "get_inherit_chain") {
+            for (const QString &class_name : class_list) {
+                const QList<QString> out = adconfig_instance->get_inherit_chain(class_name);
+                Q_UNUSED(out);
+            }
+        } else if (query == "get_possible_superiors") {
+            const QList<QString> out = adconfig_instance->get_possible_superiors(class_list);
+            Q_UNUSED(out);
+        } else if (query == "get_optional_attributes") {
+            const QList<QString> out = adconfig_instance->get_optional_attributes(class_list);
+            Q_UNUSED(out);
+        }
+    }
+}
+
+QTEST_MAIN(ADMCBenchmarkAdldap)
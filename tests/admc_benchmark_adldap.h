@@ -0,0 +1,63 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADMC_BENCHMARK_ADLDAP_H
+#define ADMC_BENCHMARK_ADLDAP_H
+
+#include "ad_object.h"
+
+#include <QObject>
+#include <QTest>
+
+class AdConfig;
+class AdInterface;
+class FakeAdServer;
+
+class ADMCBenchmarkAdldap : public QObject {
+    Q_OBJECT
+
+public slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+private slots:
+    void search_paged_data();
+    void search_paged();
+    void object_getters();
+    void attribute_display_value_data();
+    void attribute_display_value();
+    void security_descriptor_get_right_data();
+    void security_descriptor_get_right();
+    void filter_data();
+    void filter();
+    void dn_data();
+    void dn();
+    void adconfig_data();
+    void adconfig();
+
+private:
+    FakeAdServer *server;
+    AdConfig *adconfig_instance;
+    AdInterface *ad;
+    AdObject user;
+    QList<QString> user_dn_list;
+};
+
+#endif /* ADMC_BENCHMARK_ADLDAP_H */
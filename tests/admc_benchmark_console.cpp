@@ -0,0 +1,473 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "admc_benchmark_console.h"
+
+#include "adldap.h"
+#include "console_impls/item_type.h"
+#include "console_impls/object_impl.h"
+#include "console_widget/console_widget.h"
+#include "console_widget/console_widget_p.h"
+#include "console_widget/results_view.h"
+#include "console_widget/scope_proxy_model.h"
+#include "fake_ad_server.h"
+#include "globals.h"
+#include "settings.h"
+#include "tabs/membership_tab.h"
+#include "utils.h"
+
+#include <QAction>
+#include <QApplication>
+#include <QDateTime>
+#include <QLabel>
+#include <QPushButton>
+#include <QSettings>
+#include <QStandardItem>
+#include <QTreeView>
+
+#include <algorithm>
+
+// NOTE: benchmarks feed batches of generated objects into
+// a console, the same way as results of a search are
+// added. Objects are generated on the client, so these
+// benchmarks measure only GUI code. Searches and
+// AdConfig use the fake AD server.
+
+const QList<int> object_count_list = {1000, 10000, 100000};
+
+// NOTE: fake server keeps whole domain in memory, so
+// searches are measured on smaller amounts
+const QList<int> search_count_list = {1000, 10000};
+
+void add_object_count_data(const QList<int> &count_list);
+QString bench_ou_dn(const QString &domain_dn, const int count);
+AdObject make_synthetic_user(const QString &parent_dn, const int i);
+
+void ADMCBenchmarkConsole::initTestCase() {
+    qRegisterMetaType<QHash<QString, AdObject>>("QHash<QString, AdObject>");
+
+    // NOTE: keep settings in a temporary dir, so that
+    // benchmarks don't use or change user's settings.
+    // Display limit is raised so that searches fetch
+    // whole OU's.
+    QVERIFY(settings_dir.isValid());
+    QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope, settings_dir.path());
+    const int max_search_count = *std::max_element(search_count_list.begin(), search_count_list.end());
+    settings_set_variant(SETTING_object_display_limit, max_search_count);
+
+    server = new FakeAdServer(FakeAdDomainSize());
+
+    // Add OU's with many users for search benchmarks
+    FakeAdDirectory *directory = server->directory();
+    for (const int count : search_count_list) {
+        const QString ou_dn = bench_ou_dn(directory->domain_dn(), count);
+
+        FakeAdAttribute ou_class;
+        ou_class.name = ATTRIBUTE_OBJECT_CLASS;
+        ou_class.values = {CLASS_OU};
+        QCOMPARE(directory->add(ou_dn, {ou_class}), 0);
+
+        FakeAdAttribute user_class;
+        user_class.name = ATTRIBUTE_OBJECT_CLASS;
+        user_class.values = {CLASS_USER};
+
+        for (int i = 0; i < count; i++) {
+            const QString dn = QString("CN=User-%1,%2").arg(QString::number(i), ou_dn);
+            QCOMPARE(directory->add(dn, {user_class}), 0);
+        }
+    }
+
+    QVERIFY(server->start());
+    server->setup_ad_interface();
+
+    AdInterface ad;
+    QVERIFY(ad.is_connected());
+
+    g_adconfig->load(ad, QLocale(QLocale::English));
+    AdInterface::set_config(g_adconfig);
+
+    parent_widget = new QWidget();
+    console = new ConsoleWidget(parent_widget);
+
+    const ConsoleWidgetActions console_actions = [&]() {
+        ConsoleWidgetActions out;
+
+        out.navigate_up = new QAction(parent_widget);
+        out.navigate_back = new QAction(parent_widget);
+        out.navigate_forward = new QAction(parent_widget);
+        out.refresh = new QAction(parent_widget);
+        out.customize_columns = new QAction(parent_widget);
+        out.view_icons = new QAction(parent_widget);
+        out.view_list = new QAction(parent_widget);
+        out.view_detail = new QAction(parent_widget);
+        out.toggle_console_tree = new QAction(parent_widget);
+        out.toggle_description_bar = new QAction(parent_widget);
+
+        return out;
+    }();
+
+    auto object_impl = new ObjectImpl(console);
+    console->register_impl(ItemType_Object, object_impl);
+    console->set_actions(console_actions);
+
+    results_view = object_impl->view();
+    results_view->set_view_type(ResultsViewType_Detail);
+
+    parent_widget->resize(1024, 768);
+    parent_widget->show();
+    QVERIFY(QTest::qWaitForWindowExposed(parent_widget, 1000));
+}
+
+void ADMCBenchmarkConsole::cleanupTestCase() {
+    delete parent_widget;
+
+    AdInterface::set_config(nullptr);
+    AdInterface::set_test_server(QString());
+
+    delete server;
+}
+
+void ADMCBenchmarkConsole::cleanup() {
+    for (const QPersistentModelIndex &parent : parent_list) {
+        if (parent.isValid()) {
+            console->delete_item(parent);
+        }
+    }
+
+    parent_list.clear();
+}
+
+void ADMCBenchmarkConsole::add_objects_data() {
+    add_object_count_data(object_count_list);
+}
+
+// NOTE: objects are added once per run because console
+// has to be empty before adding
+void ADMCBenchmarkConsole::add_objects() {
+    QFETCH(int, count);
+
+    const QList<AdObject> &object_list = get_object_list(count);
+    const QModelIndex parent = add_parent(object_list[0].get_dn_view().parent().toString());
+
+    QBENCHMARK_ONCE {
+        object_impl_add_objects_to_console(console, object_list, parent);
+    }
+
+    QCOMPARE(console->get_child_count(parent), count);
+}
+
+void ADMCBenchmarkConsole::sort_data() {
+    QTest::addColumn<int>("count");
+    QTest::addColumn<QString>("attribute");
+
+    for (const int count : object_count_list) {
+        for (const QString &attribute : {ATTRIBUTE_NAME, ATTRIBUTE_WHEN_CHANGED}) {
+            const QByteArray tag = QString("%1 objects, %2").arg(QString::number(count), attribute).toUtf8();
+
+            QTest::newRow(tag.constData()) << count << attribute;
+        }
+    }
+}
+
+void ADMCBenchmarkConsole::sort() {
+    QFETCH(int, count);
+    QFETCH(QString, attribute);
+
+    add_parent_with_objects(count);
+
+    const int column = g_adconfig->get_column_index(attribute);
+    QVERIFY(column != -1);
+
+    QTreeView *view = results_view->detail_view();
+    Qt::SortOrder order = Qt::AscendingOrder;
+
+    // NOTE: flip order on every iteration, sorting in
+    // same order again could skip the work
+    QBENCHMARK {
+        order = (order == Qt::AscendingOrder ? Qt::DescendingOrder : Qt::AscendingOrder);
+        view->sortByColumn(column, order);
+    }
+}
+
+void ADMCBenchmarkConsole::filter_data() {
+    add_object_count_data(object_count_list);
+}
+
+// NOTE: scope tree filters out all non-scope items, so
+// refiltering goes over all results of the parent
+void ADMCBenchmarkConsole::filter() {
+    QFETCH(int, count);
+
+    add_parent_with_objects(count);
+
+    ScopeProxyModel *scope_proxy_model = console->findChild<ScopeProxyModel *>();
+    QVERIFY(scope_proxy_model != nullptr);
+
+    QBENCHMARK {
+        scope_proxy_model->invalidate();
+    }
+}
+
+void ADMCBenchmarkConsole::search_items_data() {
+    add_object_count_data(object_count_list);
+}
+
+// NOTE: search for object that was added last, this is
+// what is done to find items of modified objects
+void ADMCBenchmarkConsole::search_items() {
+    QFETCH(int, count);
+
+    const QModelIndex parent = add_parent_with_objects(count);
+    const QString target_dn = get_object_list(count).last().get_dn();
+
+    const QList<QModelIndex> expected = console->search_items(parent, ObjectRole_DN, target_dn, {ItemType_Object});
+    QCOMPARE(expected.size(), 1);
+
+    QBENCHMARK {
+        const QList<QModelIndex> found = console->search_items(parent, ObjectRole_DN, target_dn, {ItemType_Object});
+        Q_UNUSED(found);
+    }
+}
+
+void ADMCBenchmarkConsole::select_data() {
+    add_object_count_data(object_count_list);
+}
+
+void ADMCBenchmarkConsole::select() {
+    QFETCH(int, count);
+
+    add_parent_with_objects(count);
+
+    QAbstractItemView *view = results_view->current_view();
+
+    view->selectAll();
+    QCOMPARE(results_view->get_selected_indexes().size(), count);
+    view->clearSelection();
+
+    QBENCHMARK {
+        view->selectAll();
+        const QList<QModelIndex> selected = results_view->get_selected_indexes();
+        view->clearSelection();
+
+        Q_UNUSED(selected);
+    }
+}
+
+void ADMCBenchmarkConsole::delete_children_data() {
+    add_object_count_data(object_count_list);
+}
+
+void ADMCBenchmarkConsole::delete_children() {
+    QFETCH(int, count);
+
+    const QModelIndex parent = add_parent_with_objects(count);
+
+    QBENCHMARK_ONCE {
+        console->delete_children(parent);
+    }
+
+    QCOMPARE(console->get_child_count(parent), 0);
+}
+
+void ADMCBenchmarkConsole::console_object_search_data() {
+    add_object_count_data(search_count_list);
+}
+
+// NOTE: measures whole fetch of an OU, from starting the
+// search to all results being added to console
+void ADMCBenchmarkConsole::console_object_search() {
+    QFETCH(int, count);
+
+    const QString dn = bench_ou_dn(g_adconfig->domain_dn(), count);
+    const QModelIndex parent = add_parent(dn);
+    const QString filter = advanced_features_filter(QString());
+    const QList<QString> attributes = console_object_search_attributes();
+
+    QBENCHMARK_ONCE {
+        ::console_object_search(console, parent, dn, SearchScope_Children, filter, attributes);
+        QTRY_VERIFY_WITH_TIMEOUT(!parent.data(ObjectRole_Fetching).toBool(), 600000);
+    }
+
+    QCOMPARE(console->get_child_count(parent), count);
+}
+
+void ADMCBenchmarkConsole::membership_reload_data() {
+    add_object_count_data(object_count_list);
+}
+
+// NOTE: load() also searches for primary members, which
+// takes the same time for all rows
+void ADMCBenchmarkConsole::membership_reload() {
+    QFETCH(int, count);
+
+    QWidget widget;
+    auto view = new QTreeView(&widget);
+    auto primary_button = new QPushButton(&widget);
+    auto add_button = new QPushButton(&widget);
+    auto remove_button = new QPushButton(&widget);
+    auto properties_button = new QPushButton(&widget);
+    auto primary_group_label = new QLabel(&widget);
+
+    auto edit = new MembershipTabEdit(view, primary_button, add_button, remove_button, properties_button, primary_group_label, MembershipTabType_Members, &widget);
+
+    const AdObject group = [&]() {
+        const QString dn = QString("CN=bench-group,%1").arg(g_adconfig->domain_dn());
+
+        QList<QByteArray> member_list;
+        for (const AdObject &object : get_object_list(count)) {
+            member_list.append(object.get_dn().toUtf8());
+        }
+
+        const QByteArray sid = sid_string_to_bytes(QString("%1-%2").arg(g_adconfig->domain_sid(), "900000"));
+
+        const QHash<QString, QList<QByteArray>> attributes_data = {
+            {ATTRIBUTE_OBJECT_CLASS, {"top", CLASS_GROUP}},
+            {ATTRIBUTE_DN, {dn.toUtf8()}},
+            {ATTRIBUTE_OBJECT_SID, {sid}},
+            {ATTRIBUTE_MEMBER, member_list},
+        };
+
+        AdObject out;
+        out.load(dn, attributes_data);
+
+        return out;
+    }();
+
+    AdInterface ad;
+    QVERIFY(ad.is_connected());
+
+    QBENCHMARK {
+        edit->load(ad, group);
+    }
+
+    QCOMPARE(view->model()->rowCount(), count);
+}
+
+const QList<AdObject> &ADMCBenchmarkConsole::get_object_list(const int count) {
+    if (!object_list_cache.contains(count)) {
+        const QString parent_dn = QString("OU=synthetic-%1,%2").arg(QString::number(count), g_adconfig->domain_dn());
+
+        QList<AdObject> object_list;
+        object_list.reserve(count);
+
+        for (int i = 0; i < count; i++) {
+            object_list.append(make_synthetic_user(parent_dn, i));
+        }
+
+        object_list_cache[count] = object_list;
+    }
+
+    return object_list_cache[count];
+}
+
+// Adds a scope item for an OU that is used as parent for
+// objects. Parent is also made the current scope, so that
+// results view displays it's children.
+QModelIndex ADMCBenchmarkConsole::add_parent(const QString &dn) {
+    const QList<QStandardItem *> row = console->add_scope_item(ItemType_Object, QModelIndex());
+
+    const QHash<QString, QList<QByteArray>> attributes_data = {
+        {ATTRIBUTE_OBJECT_CLASS, {"top", CLASS_OU}},
+        {ATTRIBUTE_DN, {dn.toUtf8()}},
+        {ATTRIBUTE_NAME, {dn_get_name(dn).toUtf8()}},
+    };
+
+    AdObject object;
+    object.load(dn, attributes_data);
+    console_object_load(row, object);
+
+    // NOTE: mark parent as fetched, so that console
+    // doesn't start it's own search when parent becomes
+    // current scope
+    row[0]->setData(true, ConsoleRole_WasFetched);
+
+    const QModelIndex index = row[0]->index();
+    parent_list.append(index);
+
+    console->set_current_scope(index);
+
+    return index;
+}
+
+QModelIndex ADMCBenchmarkConsole::add_parent_with_objects(const int count) {
+    const QList<AdObject> &object_list = get_object_list(count);
+    const QModelIndex parent = add_parent(object_list[0].get_dn_view().parent().toString());
+
+    object_impl_add_objects_to_console(console, object_list, parent);
+
+    return parent;
+}
+
+void add_object_count_data(const QList<int> &count_list) {
+    QTest::addColumn<int>("count");
+
+    for (const int count : count_list) {
+        const QByteArray tag = QString("%1 objects").arg(count).toUtf8();
+
+        QTest::newRow(tag.constData()) << count;
+    }
+}
+
+QString bench_ou_dn(const QString &domain_dn, const int count) {
+    return QString("OU=bench-%1,%2").arg(QString::number(count), domain_dn);
+}
+
+AdObject make_synthetic_user(const QString &parent_dn, const int i) {
+    const QString name = QString("User-%1").arg(i);
+    const QString dn = QString("CN=%1,%2").arg(name, parent_dn);
+
+    // NOTE: vary values so that sorting does real work
+    const QDateTime start = QDateTime(QDate(2024, 1, 1), QTime(0, 0), Qt::UTC);
+    const QString when_changed = start.addSecs((i * 7919) % 1000003).toString("yyyyMMddhhmmss") + ".0Z";
+    const QString control = (i % 3 == 0 ? "514" : "512");
+    const QByteArray sid = sid_string_to_bytes(QString("%1-%2").arg(g_adconfig->domain_sid(), QString::number(100000 + i)));
+    const QString category = QString("CN=Person,%1").arg(g_adconfig->schema_dn());
+
+    const QHash<QString, QList<QByteArray>> attributes_data = {
+        {ATTRIBUTE_OBJECT_CLASS, {"top", "person", "organizationalPerson", CLASS_USER}},
+        {ATTRIBUTE_OBJECT_CATEGORY, {category.toUtf8()}},
+        {ATTRIBUTE_DN, {dn.toUtf8()}},
+        {ATTRIBUTE_NAME, {name.toUtf8()}},
+        {ATTRIBUTE_DESCRIPTION, {QString("Synthetic user %1").arg(i).toUtf8()}},
+        {ATTRIBUTE_SAM_ACCOUNT_NAME, {name.toLower().toUtf8()}},
+        {ATTRIBUTE_USER_ACCOUNT_CONTROL, {control.toUtf8()}},
+        {ATTRIBUTE_WHEN_CHANGED, {when_changed.toUtf8()}},
+        {ATTRIBUTE_OBJECT_SID, {sid}},
+    };
+
+    AdObject out;
+    out.load(dn, attributes_data);
+
+    return out;
+}
+
+// NOTE: run without a display unless another platform is
+// requested explicitly
+int main(int argc, char **argv) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+
+    ADMCBenchmarkConsole benchmark;
+
+    return QTest::qExec(&benchmark, argc, argv);
+}
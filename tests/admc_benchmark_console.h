@@ -0,0 +1,76 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADMC_BENCHMARK_CONSOLE_H
+#define ADMC_BENCHMARK_CONSOLE_H
+
+#include "ad_object.h"
+
+#include <QHash>
+#include <QModelIndex>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+class ConsoleWidget;
+class FakeAdServer;
+class ResultsView;
+
+class ADMCBenchmarkConsole : public QObject {
+    Q_OBJECT
+
+public slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+
+private slots:
+    void add_objects_data();
+    void add_objects();
+    void sort_data();
+    void sort();
+    void filter_data();
+    void filter();
+    void search_items_data();
+    void search_items();
+    void select_data();
+    void select();
+    void delete_children_data();
+    void delete_children();
+    void console_object_search_data();
+    void console_object_search();
+    void membership_reload_data();
+    void membership_reload();
+
+private:
+    FakeAdServer *server;
+    QTemporaryDir settings_dir;
+    QWidget *parent_widget;
+    ConsoleWidget *console;
+    ResultsView *results_view;
+    QHash<int, QList<AdObject>> object_list_cache;
+    QList<QPersistentModelIndex> parent_list;
+
+    const QList<AdObject> &get_object_list(const int count);
+    QModelIndex add_parent(const QString &dn);
+    QModelIndex add_parent_with_objects(const int count);
+};
+
+#endif /* ADMC_BENCHMARK_CONSOLE_H */
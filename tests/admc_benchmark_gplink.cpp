@@ -0,0 +1,132 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "admc_benchmark_gplink.h"
+
+#include "gplink.h"
+
+// NOTE: gplink strings of different sizes, from a
+// typical OU with a couple of links to a pathological
+// one with hundreds
+const QList<int> link_count_list = {1, 10, 100, 500};
+
+QString make_gplink_string(const int link_count);
+QString make_gpo_dn(const int index);
+void add_link_count_data();
+
+void ADMCBenchmarkGplink::parse_data() {
+    add_link_count_data();
+}
+
+void ADMCBenchmarkGplink::parse() {
+    QFETCH(int, link_count);
+
+    const QString gplink_string = make_gplink_string(link_count);
+
+    QBENCHMARK {
+        const Gplink gplink = Gplink(gplink_string);
+        Q_UNUSED(gplink);
+    }
+}
+
+void ADMCBenchmarkGplink::to_string_data() {
+    add_link_count_data();
+}
+
+void ADMCBenchmarkGplink::to_string() {
+    QFETCH(int, link_count);
+
+    const QString gplink_string = make_gplink_string(link_count);
+
+    // NOTE: construct a new gplink on every iteration so
+    // that cached output is not reused
+    QBENCHMARK {
+        const Gplink gplink = Gplink(gplink_string);
+        const QString out = gplink.to_string();
+        Q_UNUSED(out);
+    }
+}
+
+void ADMCBenchmarkGplink::get_gpo_list_data() {
+    add_link_count_data();
+}
+
+void ADMCBenchmarkGplink::get_gpo_list() {
+    QFETCH(int, link_count);
+
+    const Gplink gplink = Gplink(make_gplink_string(link_count));
+
+    QBENCHMARK {
+        const QList<QString> gpo_list = gplink.get_gpo_list();
+        Q_UNUSED(gpo_list);
+    }
+}
+
+void ADMCBenchmarkGplink::contains_data() {
+    add_link_count_data();
+}
+
+void ADMCBenchmarkGplink::contains() {
+    QFETCH(int, link_count);
+
+    const Gplink gplink = Gplink(make_gplink_string(link_count));
+
+    // NOTE: search for last gpo, which is the worst case
+    const QString gpo = make_gpo_dn(link_count - 1);
+    QVERIFY(gplink.contains(gpo));
+
+    QBENCHMARK {
+        const bool contains = gplink.contains(gpo);
+        Q_UNUSED(contains);
+    }
+}
+
+QString make_gpo_dn(const int index) {
+    const QString guid = QString("{%1-AAAA-AAAA-AAAA-AAAAAAAAAAAA}").arg(index, 8, 10, QChar('0'));
+    const QString out = QString("CN=%1,CN=Policies,CN=System,DC=foodomain,DC=com").arg(guid);
+
+    return out;
+}
+
+QString make_gplink_string(const int link_count) {
+    QString out;
+
+    for (int i = 0; i < link_count; i++) {
+        const QString dn = make_gpo_dn(i).toLower();
+        const int option = i % 4;
+        const QString part = QString("[LDAP://%1;%2]").arg(dn, QString::number(option));
+
+        out.append(part);
+    }
+
+    return out;
+}
+
+void add_link_count_data() {
+    QTest::addColumn<int>("link_count");
+
+    for (const int link_count : link_count_list) {
+        const QByteArray tag = QString("%1 links").arg(link_count).toUtf8();
+
+        QTest::newRow(tag.constData()) << link_count;
+    }
+}
+
+QTEST_MAIN(ADMCBenchmarkGplink)
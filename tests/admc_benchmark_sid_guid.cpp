@@ -0,0 +1,148 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "admc_benchmark_sid_guid.h"
+
+#include "ad_display.h"
+#include "ad_utils.h"
+#include "sid_guid_legacy.h"
+
+// NOTE: sid's of different lengths, from well known sid's
+// to domain sid's with max sub auth values and a sid with
+// identifier authority that is displayed as hex
+const QList<QString> sid_string_list = {
+    "S-1-1-0",
+    "S-1-5-32-544",
+    "S-1-5-21-3623811015-3361044348-30300820-1013",
+    "S-1-5-21-4294967295-4294967295-4294967295-4294967295",
+    "S-1-0x123456789abc-1-2",
+};
+
+const QList<QString> guid_string_list = {
+    "00000000-0000-0000-0000-000000000000",
+    "bf967aba-0de6-11d0-a285-00aa003049e2",
+    "ffffffff-ffff-ffff-ffff-ffffffffffff",
+    "4828cc14-1437-45bc-9b07-ad6f015e5f28",
+};
+
+void add_impl_data();
+
+void ADMCBenchmarkSidGuid::sid_to_string_data() {
+    add_impl_data();
+}
+
+void ADMCBenchmarkSidGuid::sid_to_string() {
+    QFETCH(bool, legacy);
+
+    QList<QByteArray> bytes_list;
+    for (const QString &sid_string : sid_string_list) {
+        bytes_list.append(sid_bytes_as_from_server(sid_string_to_bytes(sid_string)));
+    }
+
+    QBENCHMARK {
+        for (const QByteArray &bytes : bytes_list) {
+            const QString out = [&]() {
+                if (legacy) {
+                    return legacy_sid_to_string(bytes);
+                } else {
+                    return object_sid_display_value(bytes);
+                }
+            }();
+            Q_UNUSED(out);
+        }
+    }
+}
+
+void ADMCBenchmarkSidGuid::sid_from_string_data() {
+    add_impl_data();
+}
+
+void ADMCBenchmarkSidGuid::sid_from_string() {
+    QFETCH(bool, legacy);
+
+    QBENCHMARK {
+        for (const QString &sid_string : sid_string_list) {
+            const QByteArray out = [&]() {
+                if (legacy) {
+                    return legacy_sid_from_string(sid_string);
+                } else {
+                    return sid_string_to_bytes(sid_string);
+                }
+            }();
+            Q_UNUSED(out);
+        }
+    }
+}
+
+void ADMCBenchmarkSidGuid::guid_to_string_data() {
+    add_impl_data();
+}
+
+void ADMCBenchmarkSidGuid::guid_to_string() {
+    QFETCH(bool, legacy);
+
+    QList<QByteArray> bytes_list;
+    for (const QString &guid_string : guid_string_list) {
+        bytes_list.append(guid_string_to_bytes(guid_string));
+    }
+
+    QBENCHMARK {
+        for (const QByteArray &bytes : bytes_list) {
+            const QString out = [&]() {
+                if (legacy) {
+                    return legacy_guid_to_string(bytes);
+                } else {
+                    return guid_to_display_value(bytes);
+                }
+            }();
+            Q_UNUSED(out);
+        }
+    }
+}
+
+void ADMCBenchmarkSidGuid::guid_from_string_data() {
+    add_impl_data();
+}
+
+void ADMCBenchmarkSidGuid::guid_from_string() {
+    QFETCH(bool, legacy);
+
+    QBENCHMARK {
+        for (const QString &guid_string : guid_string_list) {
+            const QByteArray out = [&]() {
+                if (legacy) {
+                    return legacy_guid_from_string(guid_string);
+                } else {
+                    return guid_string_to_bytes(guid_string);
+                }
+            }();
+            Q_UNUSED(out);
+        }
+    }
+}
+
+void add_impl_data() {
+    QTest::addColumn<bool>("legacy");
+
+    QTest::newRow("samba") << true;
+    QTest::newRow("fixed buffer") << false;
+}
+
+QTEST_MAIN(ADMCBenchmarkSidGuid)
@@ -0,0 +1,248 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "admc_test_ad_dn.h"
+
+#include "ad_dn.h"
+#include "ad_utils.h"
+
+#include <ldap.h>
+
+// NOTE: DN's of the kind that console and policy code
+// pass to dn_canonical(), for which libldap and DnView
+// should give the same canonical name
+const QList<QString> canonical_dn_list = {
+    "CN=foo,CN=bar,DC=domain,DC=com",
+    "OU=a,OU=b,OU=c,DC=domain,DC=com",
+    "DC=domain,DC=com",
+    "CN=Users,DC=domain,DC=com",
+    "CN=foo, CN=bar, DC=domain, DC=com",
+    "cn=foo,dc=domain,dc=com",
+};
+
+void ADMCTestAdDn::parse_data() {
+    QTest::addColumn<QString>("dn");
+    QTest::addColumn<int>("rdn_count");
+    QTest::addColumn<QString>("rdn");
+    QTest::addColumn<QString>("rdn_type");
+    QTest::addColumn<QString>("name");
+    QTest::addColumn<QString>("parent");
+
+    QTest::newRow("simple") << "CN=foo,CN=bar,DC=domain,DC=com" << 4 << "CN=foo" << "CN" << "foo" << "CN=bar,DC=domain,DC=com";
+    QTest::newRow("escaped comma") << "CN=foo\\,baz,CN=bar,DC=domain,DC=com" << 4 << "CN=foo\\,baz" << "CN" << "foo,baz" << "CN=bar,DC=domain,DC=com";
+    QTest::newRow("hex escaped comma") << "CN=foo\\2Cbaz,DC=domain,DC=com" << 3 << "CN=foo\\2Cbaz" << "CN" << "foo,baz" << "DC=domain,DC=com";
+    QTest::newRow("escaped backslash") << "CN=foo\\\\,DC=domain,DC=com" << 3 << "CN=foo\\\\" << "CN" << "foo\\" << "DC=domain,DC=com";
+    QTest::newRow("quoted value") << "CN=\"foo,baz\",DC=domain,DC=com" << 3 << "CN=\"foo,baz\"" << "CN" << "foo,baz" << "DC=domain,DC=com";
+    QTest::newRow("semicolon") << "CN=foo;DC=domain;DC=com" << 3 << "CN=foo" << "CN" << "foo" << "DC=domain;DC=com";
+    QTest::newRow("spaces after separator") << "CN=foo, DC=domain, DC=com" << 3 << "CN=foo" << "CN" << "foo" << "DC=domain, DC=com";
+    QTest::newRow("single rdn") << "DC=com" << 1 << "DC=com" << "DC" << "com" << "";
+    QTest::newRow("root dse") << "" << 0 << "" << "" << "" << "";
+}
+
+void ADMCTestAdDn::parse() {
+    QFETCH(QString, dn);
+    QFETCH(int, rdn_count);
+    QFETCH(QString, rdn);
+    QFETCH(QString, rdn_type);
+    QFETCH(QString, name);
+    QFETCH(QString, parent);
+
+    const DnView dn_view(dn);
+
+    QVERIFY(dn_view.is_valid());
+    QCOMPARE(dn_view.rdn_count(), rdn_count);
+    QCOMPARE(dn_view.rdn().toString(), rdn);
+    QCOMPARE(dn_view.rdn_type().toString(), rdn_type);
+    QCOMPARE(dn_view.name(), name);
+    QCOMPARE(dn_view.parent().toString(), parent);
+
+    QCOMPARE(dn_get_rdn(dn), rdn);
+    QCOMPARE(dn_get_name(dn), name);
+    QCOMPARE(dn_get_parent(dn), parent);
+}
+
+// NOTE: values of a multi-valued RDN are separated by
+// '+', which is not a separator between RDN's, so the
+// whole thing is one RDN
+void ADMCTestAdDn::multi_valued_rdn() {
+    const QString dn = "CN=foo+OU=bar,DC=domain,DC=com";
+    const DnView dn_view(dn);
+
+    QVERIFY(dn_view.is_valid());
+    QCOMPARE(dn_view.rdn_count(), 3);
+    QCOMPARE(dn_view.rdn().toString(), QString("CN=foo+OU=bar"));
+    QCOMPARE(dn_view.rdn_type().toString(), QString("CN"));
+    QCOMPARE(dn_view.parent().toString(), QString("DC=domain,DC=com"));
+
+    const QString escaped_plus_dn = "CN=foo\\+bar,DC=domain,DC=com";
+    const DnView escaped_plus_view(escaped_plus_dn);
+
+    QVERIFY(escaped_plus_view.is_valid());
+    QCOMPARE(escaped_plus_view.rdn_count(), 3);
+    QCOMPARE(escaped_plus_view.name(), QString("foo+bar"));
+}
+
+void ADMCTestAdDn::invalid_data() {
+    QTest::addColumn<QString>("dn");
+
+    QTest::newRow("no equals") << "foo";
+    QTest::newRow("no equals in last rdn") << "CN=foo,bar";
+    QTest::newRow("no equals in middle rdn") << "CN=foo,bar,DC=domain,DC=com";
+    QTest::newRow("incomplete escape") << "CN=foo,DC=com\\";
+    QTest::newRow("unterminated quote") << "CN=\"foo,DC=domain,DC=com";
+    QTest::newRow("trailing separator") << "CN=foo,DC=com,";
+}
+
+void ADMCTestAdDn::invalid() {
+    QFETCH(QString, dn);
+
+    const DnView dn_view(dn);
+
+    QVERIFY(!dn_view.is_valid());
+    QCOMPARE(dn_view.rdn_count(), 0);
+    QVERIFY(dn_view.rdn().isEmpty());
+    QVERIFY(dn_view.rdn_type().isEmpty());
+    QVERIFY(dn_view.name().isEmpty());
+    QVERIFY(dn_view.parent().isEmpty());
+    QVERIFY(dn_view.canonical().isEmpty());
+    QVERIFY(dn_view.parent_canonical().isEmpty());
+}
+
+void ADMCTestAdDn::escape() {
+    QCOMPARE(dn_value_escape("foo"), QString("foo"));
+    QCOMPARE(dn_value_escape("foo,bar"), QString("foo\\,bar"));
+    QCOMPARE(dn_value_escape("a+b=c"), QString("a\\+b\\=c"));
+    QCOMPARE(dn_value_escape("\"<>;\\"), QString("\\\"\\<\\>\\;\\\\"));
+    QCOMPARE(dn_value_escape("#foo"), QString("\\#foo"));
+    QCOMPARE(dn_value_escape("foo#"), QString("foo#"));
+    QCOMPARE(dn_value_escape(" foo "), QString("\\ foo\\ "));
+    QCOMPARE(dn_value_escape("a b"), QString("a b"));
+
+    // NOTE: escaping and then unescaping should give back
+    // the original value
+    const QList<QString> value_list = {
+        "foo",
+        "foo,bar",
+        " foo ",
+        "#foo",
+        "a+b=c\\d",
+        QString::fromUtf8("caf\xc3\xa9"),
+    };
+
+    for (const QString &value : value_list) {
+        const QString escaped = dn_value_escape(value);
+        const QString unescaped = dn_value_unescape(QStringRef(&escaped));
+
+        QCOMPARE(unescaped, value);
+    }
+}
+
+void ADMCTestAdDn::unescape_data() {
+    QTest::addColumn<QString>("value");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("plain") << "foo" << "foo";
+    QTest::newRow("escaped comma") << "foo\\,bar" << "foo,bar";
+    QTest::newRow("hex comma") << "foo\\2cbar" << "foo,bar";
+    QTest::newRow("hex utf8") << "caf\\C3\\A9" << QString::fromUtf8("caf\xc3\xa9");
+    QTest::newRow("escaped backslash") << "foo\\\\" << "foo\\";
+    QTest::newRow("quoted") << "\"foo,bar\"" << "foo,bar";
+}
+
+void ADMCTestAdDn::unescape() {
+    QFETCH(QString, value);
+    QFETCH(QString, expected);
+
+    const QString unescaped = dn_value_unescape(QStringRef(&value));
+
+    QCOMPARE(unescaped, expected);
+}
+
+void ADMCTestAdDn::rename() {
+    QCOMPARE(dn_rename("CN=old,CN=bar,DC=domain,DC=com", "new"), QString("CN=new,CN=bar,DC=domain,DC=com"));
+    QCOMPARE(dn_rename("CN=old,CN=bar,DC=domain,DC=com", "a,b"), QString("CN=a\\,b,CN=bar,DC=domain,DC=com"));
+    QCOMPARE(dn_rename("CN=old\\,name,CN=bar,DC=domain,DC=com", "new"), QString("CN=new,CN=bar,DC=domain,DC=com"));
+    QCOMPARE(dn_rename("OU=old,DC=domain,DC=com", "new"), QString("OU=new,DC=domain,DC=com"));
+
+    const QString renamed = dn_rename("CN=old,CN=bar,DC=domain,DC=com", "a,b");
+    QCOMPARE(dn_get_rdn(renamed), QString("CN=a\\,b"));
+    QCOMPARE(dn_get_name(renamed), QString("a,b"));
+    QCOMPARE(dn_get_parent(renamed), QString("CN=bar,DC=domain,DC=com"));
+
+    const QString moved = dn_move("CN=a\\,b,CN=bar,DC=domain,DC=com", "OU=new,DC=domain,DC=com");
+    QCOMPARE(moved, QString("CN=a\\,b,OU=new,DC=domain,DC=com"));
+}
+
+void ADMCTestAdDn::canonical_data() {
+    QTest::addColumn<QString>("dn");
+    QTest::addColumn<QString>("canonical");
+    QTest::addColumn<QString>("parent_canonical");
+
+    QTest::newRow("simple") << "CN=foo,CN=bar,DC=domain,DC=com" << "domain.com/bar/foo" << "domain.com/bar";
+    QTest::newRow("domain") << "DC=domain,DC=com" << "domain.com/" << "com";
+    QTest::newRow("child of domain") << "CN=Users,DC=domain,DC=com" << "domain.com/Users" << "domain.com/";
+    QTest::newRow("escaped comma") << "CN=foo\\,baz,DC=domain,DC=com" << "domain.com/foo,baz" << "domain.com/";
+    QTest::newRow("slash") << "CN=a/b,DC=domain,DC=com" << "domain.com/a\\/b" << "domain.com/";
+    QTest::newRow("no domain") << "CN=foo,CN=bar" << "bar/foo" << "bar";
+}
+
+void ADMCTestAdDn::canonical() {
+    QFETCH(QString, dn);
+    QFETCH(QString, canonical);
+    QFETCH(QString, parent_canonical);
+
+    QCOMPARE(dn_canonical(dn), canonical);
+    QCOMPARE(dn_get_parent_canonical(dn), parent_canonical);
+}
+
+// NOTE: dn_canonical() used to be a wrapper over
+// ldap_dn2ad_canonical(), check that DnView gives the
+// same results
+void ADMCTestAdDn::canonical_equals_libldap_data() {
+    QTest::addColumn<QString>("dn");
+
+    for (const QString &dn : canonical_dn_list) {
+        QTest::newRow(qPrintable(dn)) << dn;
+    }
+}
+
+void ADMCTestAdDn::canonical_equals_libldap() {
+    QFETCH(QString, dn);
+
+    const QString libldap_canonical = [&]() {
+        const QByteArray dn_bytes = dn.toUtf8();
+        char *canonical_cstr = NULL;
+        const int result = ldap_dn2ad_canonical(dn_bytes.constData(), &canonical_cstr);
+
+        if (result != LDAP_SUCCESS) {
+            return QString();
+        }
+
+        const QString out = QString::fromUtf8(canonical_cstr);
+        ldap_memfree(canonical_cstr);
+
+        return out;
+    }();
+
+    QVERIFY(!libldap_canonical.isEmpty());
+    QCOMPARE(dn_canonical(dn), libldap_canonical);
+}
+
+QTEST_MAIN(ADMCTestAdDn)
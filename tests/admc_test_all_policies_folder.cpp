@@ -0,0 +1,292 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "admc_test_all_policies_folder.h"
+
+#include "adldap.h"
+#include "console_impls/all_policies_folder_impl.h"
+#include "console_impls/item_type.h"
+#include "console_impls/policy_impl.h"
+#include "console_widget/console_widget.h"
+#include "console_widget/console_widget_p.h"
+#include "fake_ad_server.h"
+#include "globals.h"
+
+#include <ldap.h>
+
+#include <QSettings>
+#include <QStandardItem>
+
+#include <algorithm>
+
+#define GPO_COUNT 3
+
+FakeAdAttribute make_attribute(const QString &name, const QString &value);
+QList<AdSearchRecord> get_search_records(const QString &filter_part);
+
+void ADMCTestAllPoliciesFolder::initTestCase() {
+    QVERIFY(settings_dir.isValid());
+    QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope, settings_dir.path());
+
+    FakeAdDomainSize size;
+    size.users = 10;
+    size.groups = 2;
+    size.ous = 2;
+    size.gpos = GPO_COUNT;
+
+    server = new FakeAdServer(size);
+    QVERIFY(server->start());
+    server->setup_ad_interface();
+
+    AdInterface ad;
+    QVERIFY2(ad.is_connected(), "Failed to connect to fake AD server");
+
+    g_adconfig->load(ad, QLocale(QLocale::English));
+    AdInterface::set_config(g_adconfig);
+
+    parent_widget = new QWidget();
+    console = new ConsoleWidget(parent_widget);
+
+    folder_impl = new AllPoliciesFolderImpl(console);
+    console->register_impl(ItemType_AllPoliciesFolder, folder_impl);
+}
+
+void ADMCTestAllPoliciesFolder::cleanupTestCase() {
+    delete parent_widget;
+
+    AdInterface::set_config(nullptr);
+    AdInterface::set_test_server(QString());
+
+    delete server;
+}
+
+// NOTE: every test starts with a freshly fetched folder,
+// so that all policies are loaded and highest USN is
+// remembered
+void ADMCTestAllPoliciesFolder::init() {
+    const QList<QStandardItem *> row = console->add_scope_item(ItemType_AllPoliciesFolder, QModelIndex());
+    folder_index = row[0]->index();
+
+    console->get_item(folder_index)->setData(true, ConsoleRole_WasFetched);
+    folder_impl->fetch(folder_index);
+
+    QCOMPARE(get_row_dn_list(), get_policy_dn_list(server));
+
+    ad_metrics_reset();
+}
+
+void ADMCTestAllPoliciesFolder::cleanup() {
+    console->delete_item(folder_index);
+
+    server->set_deleted_objects_readable(true);
+    server->setup_ad_interface();
+}
+
+// NOTE: only policies that changed since last load should
+// be loaded, changed rows should be patched in place and
+// rows of deleted policies removed. Deleted policies are
+// found through their tombstones.
+void ADMCTestAllPoliciesFolder::load_changes() {
+    FakeAdDirectory *directory = server->directory();
+
+    const QString modified_dn = get_policy_dn(0);
+    const QString deleted_dn = get_policy_dn(1);
+    const QString unchanged_dn = get_policy_dn(2);
+    const QString created_dn = QString("CN={6AC1786C-016F-11D2-945F-00C04FB984F9},%1").arg(g_adconfig->policies_dn());
+
+    FakeAdModification modification;
+    modification.operation = LDAP_MOD_REPLACE;
+    modification.attribute = ATTRIBUTE_DISPLAY_NAME;
+    modification.values = {"Modified"};
+    QCOMPARE(directory->modify(modified_dn, {modification}), 0);
+
+    QCOMPARE(directory->remove(deleted_dn, true), 0);
+
+    QCOMPARE(directory->add(created_dn, {make_attribute(ATTRIBUTE_OBJECT_CLASS, CLASS_GP_CONTAINER), make_attribute(ATTRIBUTE_DISPLAY_NAME, "Created")}), 0);
+
+    // NOTE: unchanged policy is not reloaded, so it's
+    // text should stay as is
+    const QPersistentModelIndex modified_index = get_row(modified_dn);
+    const QPersistentModelIndex unchanged_index = get_row(unchanged_dn);
+    QVERIFY(modified_index.isValid());
+    QVERIFY(unchanged_index.isValid());
+    console->get_item(unchanged_index)->setText("Not reloaded");
+
+    console->refresh_scope(folder_index);
+
+    QCOMPARE(get_row_dn_list(), get_policy_dn_list(server));
+    QVERIFY(!get_row(deleted_dn).isValid());
+    QCOMPARE(get_row(created_dn).data().toString(), QString("Created"));
+
+    QVERIFY(modified_index.isValid());
+    QCOMPARE(modified_index.data().toString(), QString("Modified"));
+
+    QVERIFY(unchanged_index.isValid());
+    QCOMPARE(unchanged_index.data().toString(), QString("Not reloaded"));
+
+    // NOTE: USN condition limits results to objects that
+    // changed. Deleted policy has children, but only the
+    // policy itself matches.
+    const QList<AdSearchRecord> changed_records = get_search_records(QString("(%1>=").arg(ATTRIBUTE_USN_CHANGED));
+    QCOMPARE(changed_records.size(), 2);
+
+    for (const AdSearchRecord &record : changed_records) {
+        const bool is_deleted_search = record.filter.contains(ATTRIBUTE_IS_DELETED);
+        QVERIFY(record.success);
+        QCOMPARE(record.entries, (is_deleted_search ? 1 : 2));
+    }
+
+    // Second refresh finds nothing new
+    ad_metrics_reset();
+    console->refresh_scope(folder_index);
+
+    QCOMPARE(get_row_dn_list(), get_policy_dn_list(server));
+    for (const AdSearchRecord &record : get_search_records(QString("(%1>=").arg(ATTRIBUTE_USN_CHANGED))) {
+        QCOMPARE(record.entries, 0);
+    }
+}
+
+// NOTE: if user can't read "Deleted Objects", search for
+// tombstones fails and deleted policies are found by
+// comparing loaded rows to current policies
+void ADMCTestAllPoliciesFolder::load_changes_deleted_not_readable() {
+    server->set_deleted_objects_readable(false);
+
+    const QString deleted_dn = get_policy_dn(1);
+    QCOMPARE(server->directory()->remove(deleted_dn, true), 0);
+
+    console->refresh_scope(folder_index);
+
+    QVERIFY(!get_row(deleted_dn).isValid());
+    QCOMPARE(get_row_dn_list(), get_policy_dn_list(server));
+
+    const QList<AdSearchRecord> deleted_records = get_search_records(ATTRIBUTE_IS_DELETED);
+    QCOMPARE(deleted_records.size(), 1);
+    QVERIFY(!deleted_records[0].success);
+}
+
+// NOTE: USN's are local to a DC, so after switching to
+// another DC all policies are reloaded. Second server
+// has a different set of policies, so a full reload is
+// visible in rows. It is reached through "localhost"
+// instead of "127.0.0.1", so that it looks like a
+// different DC.
+void ADMCTestAllPoliciesFolder::dc_change_reloads_all() {
+    FakeAdDomainSize other_size;
+    other_size.users = 10;
+    other_size.groups = 2;
+    other_size.ous = 2;
+    other_size.gpos = 1;
+
+    FakeAdServer other_server(other_size);
+    QVERIFY(other_server.start());
+    other_server.setup_ad_interface();
+    AdInterface::set_test_server("localhost");
+
+    console->refresh_scope(folder_index);
+
+    QCOMPARE(get_row_dn_list(), get_policy_dn_list(&other_server));
+    QVERIFY(get_row_dn_list() != get_policy_dn_list(server));
+
+    // NOTE: full reload doesn't use USN condition
+    QVERIFY(get_search_records(QString("(%1>=").arg(ATTRIBUTE_USN_CHANGED)).isEmpty());
+
+    // NOTE: switch back before other server is destroyed
+    server->setup_ad_interface();
+}
+
+QList<QString> ADMCTestAllPoliciesFolder::get_row_dn_list() const {
+    QList<QString> out;
+
+    for (int row = 0; row < console->get_child_count(folder_index); row++) {
+        const QModelIndex child = folder_index.model()->index(row, 0, folder_index);
+        const QString dn = child.data(PolicyRole_DN).toString();
+
+        out.append(dn.toLower());
+    }
+
+    std::sort(out.begin(), out.end());
+
+    return out;
+}
+
+QList<QString> ADMCTestAllPoliciesFolder::get_policy_dn_list(FakeAdServer *target_server) const {
+    FakeAdFilter filter;
+    filter.type = LDAP_FILTER_EQUALITY;
+    filter.attribute = ATTRIBUTE_OBJECT_CLASS;
+    filter.value = CLASS_GP_CONTAINER;
+
+    QList<const FakeAdEntry *> result_list;
+    target_server->directory()->search(g_adconfig->policies_dn(), LDAP_SCOPE_SUBTREE, filter, &result_list);
+
+    QList<QString> out;
+    for (const FakeAdEntry *entry : result_list) {
+        out.append(entry->dn.toLower());
+    }
+
+    std::sort(out.begin(), out.end());
+
+    return out;
+}
+
+QModelIndex ADMCTestAllPoliciesFolder::get_row(const QString &dn) const {
+    for (int row = 0; row < console->get_child_count(folder_index); row++) {
+        const QModelIndex child = folder_index.model()->index(row, 0, folder_index);
+        const QString child_dn = child.data(PolicyRole_DN).toString();
+
+        if (child_dn.compare(dn, Qt::CaseInsensitive) == 0) {
+            return child;
+        }
+    }
+
+    return QModelIndex();
+}
+
+// NOTE: excludes Default Domain Policy
+QString ADMCTestAllPoliciesFolder::get_policy_dn(const int i) const {
+    const QString default_policy_dn = QString("CN={31B2F340-016D-11D2-945F-00C04FB984F9},%1").arg(g_adconfig->policies_dn()).toLower();
+
+    QList<QString> dn_list = get_policy_dn_list(server);
+    dn_list.removeAll(default_policy_dn);
+
+    return dn_list.value(i);
+}
+
+FakeAdAttribute make_attribute(const QString &name, const QString &value) {
+    FakeAdAttribute out;
+    out.name = name;
+    out.values = {value.toUtf8()};
+
+    return out;
+}
+
+QList<AdSearchRecord> get_search_records(const QString &filter_part) {
+    QList<AdSearchRecord> out;
+
+    for (const AdSearchRecord &record : ad_metrics_get_slowest_searches()) {
+        if (record.filter.contains(filter_part)) {
+            out.append(record);
+        }
+    }
+
+    return out;
+}
+
+QTEST_MAIN(ADMCTestAllPoliciesFolder)
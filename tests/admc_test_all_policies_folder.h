@@ -0,0 +1,61 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADMC_TEST_ALL_POLICIES_FOLDER_H
+#define ADMC_TEST_ALL_POLICIES_FOLDER_H
+
+#include <QModelIndex>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+class AllPoliciesFolderImpl;
+class ConsoleWidget;
+class FakeAdServer;
+
+class ADMCTestAllPoliciesFolder : public QObject {
+    Q_OBJECT
+
+public slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void cleanup();
+
+private slots:
+    void load_changes();
+    void load_changes_deleted_not_readable();
+    void dc_change_reloads_all();
+
+private:
+    FakeAdServer *server;
+    QTemporaryDir settings_dir;
+    QWidget *parent_widget;
+    ConsoleWidget *console;
+    AllPoliciesFolderImpl *folder_impl;
+    QPersistentModelIndex folder_index;
+
+    QList<QString> get_row_dn_list() const;
+    QList<QString> get_policy_dn_list(FakeAdServer *target_server) const;
+    QModelIndex get_row(const QString &dn) const;
+    QString get_policy_dn(const int i) const;
+};
+
+#endif /* ADMC_TEST_ALL_POLICIES_FOLDER_H */
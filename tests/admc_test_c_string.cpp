@@ -0,0 +1,113 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "admc_test_c_string.h"
+
+#include "ad_utils.h"
+
+#include <cstring>
+
+// NOTE: CString's stack buffer is 256 bytes and a
+// utf16 code unit takes at most 3 bytes in utf8, so
+// strings of up to 85 units are converted on the stack
+#define STACK_MAX_LENGTH 85
+
+const QChar cyrillic_char = QChar(0x0416);
+const QChar cjk_char = QChar(0x4E2D);
+const QString emoji_string = QString::fromUcs4(U"\U0001F600");
+
+bool c_string_is_on_stack(const CString &c_string);
+
+void ADMCTestCString::c_string_data() {
+    QTest::addColumn<QString>("string");
+    QTest::addColumn<bool>("on_stack");
+
+    QTest::newRow("empty") << QString() << true;
+    QTest::newRow("ascii") << QString("CN=User,DC=domain,DC=com") << true;
+    QTest::newRow("cyrillic") << QString("CN=%1,DC=domain,DC=com").arg(QString(3, cyrillic_char)) << true;
+    QTest::newRow("cjk") << QString("CN=%1,DC=domain,DC=com").arg(QString(3, cjk_char)) << true;
+    QTest::newRow("surrogate pair") << QString("CN=%1,DC=domain,DC=com").arg(emoji_string) << true;
+    QTest::newRow("max stack length") << QString(STACK_MAX_LENGTH, cjk_char) << true;
+    QTest::newRow("min heap length") << QString(STACK_MAX_LENGTH + 1, cjk_char) << false;
+    QTest::newRow("long ascii") << QString(300, 'a') << false;
+    QTest::newRow("long mixed") << QString("CN=%1%2%3,DC=domain,DC=com").arg(QString(100, cyrillic_char), emoji_string, QString(200, 'a')) << false;
+
+    // NOTE: surrogate pair is 2 code units, so it is the
+    // last thing that fits into stack buffer or the first
+    // thing that doesn't
+    QTest::newRow("surrogate pair at stack end") << (QString(STACK_MAX_LENGTH - 2, cjk_char) + emoji_string) << true;
+    QTest::newRow("surrogate pair past stack end") << (QString(STACK_MAX_LENGTH - 1, cjk_char) + emoji_string) << false;
+}
+
+void ADMCTestCString::c_string() {
+    QFETCH(QString, string);
+    QFETCH(bool, on_stack);
+
+    const QByteArray expected = string.toUtf8();
+    const CString c_string(string);
+
+    QCOMPARE(c_string.size(), expected.size());
+    QCOMPARE((int) strlen(c_string.get()), expected.size());
+    QCOMPARE(QByteArray(c_string.get(), c_string.size()), expected);
+    QCOMPARE(QString::fromUtf8(c_string.get()), string);
+    QCOMPARE(c_string_is_on_stack(c_string), on_stack);
+}
+
+void ADMCTestCString::c_string_list() {
+    const QList<QString> list = {
+        "name",
+        QString(STACK_MAX_LENGTH + 1, cjk_char),
+        QString(2, cyrillic_char) + emoji_string,
+        QString(),
+        QString(300, 'a'),
+    };
+
+    CStringList c_string_list(list);
+    char **array = c_string_list.get();
+
+    for (int i = 0; i < list.size(); i++) {
+        QVERIFY(array[i] != NULL);
+        QCOMPARE(QByteArray(array[i]), list[i].toUtf8());
+    }
+
+    QVERIFY(array[list.size()] == NULL);
+}
+
+void ADMCTestCString::c_string_list_empty() {
+    CStringList c_string_list(QList<QString>{});
+    char **array = c_string_list.get();
+
+    QVERIFY(array != NULL);
+    QVERIFY(array[0] == NULL);
+}
+
+// NOTE: stack buffer is a member, so strings converted
+// on the stack point inside the object
+bool c_string_is_on_stack(const CString &c_string) {
+    const char *object_begin = (const char *) &c_string;
+    const char *object_end = object_begin + sizeof(CString);
+    const char *data = c_string.get();
+
+    const bool out = (data >= object_begin && data < object_end);
+
+    return out;
+}
+
+QTEST_GUILESS_MAIN(ADMCTestCString)
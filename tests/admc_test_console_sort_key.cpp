@@ -0,0 +1,207 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "admc_test_console_sort_key.h"
+
+#include "console_widget/console_item.h"
+#include "console_widget/console_sort_key.h"
+#include "console_widget/console_widget.h"
+#include "console_widget/console_widget_p.h"
+#include "console_widget/results_proxy_model.h"
+
+#include <QStandardItemModel>
+
+QList<QString> get_proxy_text_list(const QAbstractItemModel *model);
+ConsoleSortKey get_item_key(const QStandardItem *item);
+
+void ADMCTestConsoleSortKey::key_number() {
+    const ConsoleSortKey two = ConsoleSortKey::from_number(2);
+    const ConsoleSortKey ten = ConsoleSortKey::from_number(10);
+    const ConsoleSortKey negative = ConsoleSortKey::from_number(-5);
+
+    QVERIFY(two < ten);
+    QVERIFY(!(ten < two));
+    QVERIFY(negative < two);
+    QVERIFY(!(two < two));
+}
+
+void ADMCTestConsoleSortKey::key_string() {
+    const ConsoleSortKey apple = ConsoleSortKey::from_string("apple");
+    const ConsoleSortKey banana_upper = ConsoleSortKey::from_string("Banana");
+    const ConsoleSortKey banana_lower = ConsoleSortKey::from_string("banana");
+
+    QVERIFY(apple < banana_upper);
+    QVERIFY(!(banana_upper < apple));
+
+    // NOTE: case is folded, so these are equal
+    QVERIFY(!(banana_upper < banana_lower));
+    QVERIFY(!(banana_lower < banana_upper));
+}
+
+void ADMCTestConsoleSortKey::key_kind_order() {
+    const ConsoleSortKey empty = ConsoleSortKey::from_string(QString());
+    const ConsoleSortKey number = ConsoleSortKey::from_number(1000);
+    const ConsoleSortKey string = ConsoleSortKey::from_string("a");
+
+    QVERIFY(empty < number);
+    QVERIFY(number < string);
+    QVERIFY(empty < string);
+    QVERIFY(!(empty < ConsoleSortKey()));
+}
+
+void ADMCTestConsoleSortKey::key_sort_index() {
+    ConsoleSortKey first = ConsoleSortKey::from_string("z");
+    first.set_sort_index(0);
+
+    ConsoleSortKey second = ConsoleSortKey::from_string("a");
+    second.set_sort_index(1);
+
+    QVERIFY(first < second);
+    QVERIFY(!(second < first));
+}
+
+void ADMCTestConsoleSortKey::item_key_update() {
+    ConsoleItem item;
+    item.setText("b");
+
+    const ConsoleSortKey a_key = ConsoleSortKey::from_string("a");
+    const ConsoleSortKey c_key = ConsoleSortKey::from_string("c");
+
+    QVERIFY(a_key < get_item_key(&item));
+    QVERIFY(get_item_key(&item) < c_key);
+
+    // Sort number takes precedence over text
+    item.setData(5, ConsoleRole_SortNumber);
+    QVERIFY(get_item_key(&item) < ConsoleSortKey::from_number(6));
+    QVERIFY(ConsoleSortKey::from_number(4) < get_item_key(&item));
+
+    // Clearing sort number goes back to text
+    item.setData(QVariant(), ConsoleRole_SortNumber);
+    QVERIFY(ConsoleSortKey::from_number(1000000) < get_item_key(&item));
+    QVERIFY(a_key < get_item_key(&item));
+
+    // Changing text updates the key
+    item.setText("d");
+    QVERIFY(c_key < get_item_key(&item));
+
+    // Sort index updates the key
+    item.setData(-1, ConsoleRole_SortIndex);
+    QVERIFY(get_item_key(&item) < a_key);
+}
+
+// NOTE: numbers are sorted numerically, not as text
+void ADMCTestConsoleSortKey::proxy_sort_numbers() {
+    QStandardItemModel model;
+    model.setItemPrototype(new ConsoleItem());
+
+    const QList<int> number_list = {10, 9, 100, 2};
+    for (const int number : number_list) {
+        auto item = new ConsoleItem();
+        item->setText(QString::number(number));
+        item->setData(number, ConsoleRole_SortNumber);
+        model.appendRow(item);
+    }
+
+    ResultsProxyModel proxy(nullptr);
+    proxy.setSourceModel(&model);
+
+    proxy.sort(0, Qt::AscendingOrder);
+    QCOMPARE(get_proxy_text_list(&proxy), QList<QString>({"2", "9", "10", "100"}));
+
+    proxy.sort(0, Qt::DescendingOrder);
+    QCOMPARE(get_proxy_text_list(&proxy), QList<QString>({"100", "10", "9", "2"}));
+}
+
+void ADMCTestConsoleSortKey::proxy_sort_strings() {
+    QStandardItemModel model;
+
+    const QList<QString> text_list = {"charlie", "Bravo", "alpha", "Delta", ""};
+    for (const QString &text : text_list) {
+        auto item = new ConsoleItem();
+        item->setText(text);
+        model.appendRow(item);
+    }
+
+    ResultsProxyModel proxy(nullptr);
+    proxy.setSourceModel(&model);
+
+    proxy.sort(0, Qt::AscendingOrder);
+    QCOMPARE(get_proxy_text_list(&proxy), QList<QString>({"", "alpha", "Bravo", "charlie", "Delta"}));
+
+    // NOTE: changing text of an item should move it
+    model.item(2)->setText("echo");
+    proxy.sort(0, Qt::AscendingOrder);
+    QCOMPARE(get_proxy_text_list(&proxy), QList<QString>({"", "Bravo", "charlie", "Delta", "echo"}));
+}
+
+void ADMCTestConsoleSortKey::proxy_sort_index() {
+    QStandardItemModel model;
+
+    auto add_item = [&](const QString &text, const int sort_index) {
+        auto item = new ConsoleItem();
+        item->setText(text);
+        item->setData(sort_index, ConsoleRole_SortIndex);
+        model.appendRow(item);
+    };
+
+    add_item("b", 1);
+    add_item("a", 1);
+    add_item("z", 0);
+
+    ResultsProxyModel proxy(nullptr);
+    proxy.setSourceModel(&model);
+
+    proxy.sort(0, Qt::AscendingOrder);
+    QCOMPARE(get_proxy_text_list(&proxy), QList<QString>({"z", "a", "b"}));
+}
+
+// NOTE: models without console items are sorted by text,
+// case insensitively
+void ADMCTestConsoleSortKey::proxy_fallback() {
+    QStandardItemModel model;
+
+    const QList<QString> text_list = {"b", "C", "a"};
+    for (const QString &text : text_list) {
+        model.appendRow(new QStandardItem(text));
+    }
+
+    ResultsProxyModel proxy(nullptr);
+    proxy.setSourceModel(&model);
+
+    proxy.sort(0, Qt::AscendingOrder);
+    QCOMPARE(get_proxy_text_list(&proxy), QList<QString>({"a", "b", "C"}));
+}
+
+QList<QString> get_proxy_text_list(const QAbstractItemModel *model) {
+    QList<QString> out;
+
+    for (int row = 0; row < model->rowCount(); row++) {
+        const QModelIndex index = model->index(row, 0);
+        out.append(index.data().toString());
+    }
+
+    return out;
+}
+
+ConsoleSortKey get_item_key(const QStandardItem *item) {
+    return item->data(ConsoleRole_SortKey).value<ConsoleSortKey>();
+}
+
+QTEST_GUILESS_MAIN(ADMCTestConsoleSortKey)
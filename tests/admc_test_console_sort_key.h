@@ -0,0 +1,42 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADMC_TEST_CONSOLE_SORT_KEY_H
+#define ADMC_TEST_CONSOLE_SORT_KEY_H
+
+#include <QObject>
+#include <QTest>
+
+class ADMCTestConsoleSortKey : public QObject {
+    Q_OBJECT
+
+private slots:
+    void key_number();
+    void key_string();
+    void key_kind_order();
+    void key_sort_index();
+    void item_key_update();
+    void proxy_sort_numbers();
+    void proxy_sort_strings();
+    void proxy_sort_index();
+    void proxy_fallback();
+};
+
+#endif /* ADMC_TEST_CONSOLE_SORT_KEY_H */
@@ -0,0 +1,192 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "admc_test_effective_rights.h"
+
+#include "ad_security.h"
+#include "ad_utils.h"
+#include "samba/dom_sid.h"
+#include "samba/security_descriptor.h"
+
+#include <cstring>
+
+// NOTE: internal to ad_security.cpp, declared here to
+// build ACE's directly
+dom_sid dom_sid_from_bytes(const QByteArray &bytes);
+
+const QByteArray user_sid = sid_string_to_bytes("S-1-5-21-1004336348-1177238915-682003330-1001");
+const QByteArray group_sid = sid_string_to_bytes("S-1-5-21-1004336348-1177238915-682003330-1002");
+const QByteArray other_sid = sid_string_to_bytes("S-1-5-21-1004336348-1177238915-682003330-1003");
+
+// NOTE: token of user which is a member of group
+const QList<QByteArray> token = {
+    user_sid,
+    group_sid,
+    sid_string_to_bytes(SID_WORLD),
+};
+
+const QByteArray property_a = guid_string_to_bytes("bf967a0e-0de6-11d0-a285-00aa003049e2");
+const QByteArray property_b = guid_string_to_bytes("bf967a86-0de6-11d0-a285-00aa003049e2");
+
+const SecurityRight read_property = {SEC_ADS_READ_PROP, QByteArray()};
+const SecurityRight write_property_a = {SEC_ADS_WRITE_PROP, property_a};
+const SecurityRight write_property_b = {SEC_ADS_WRITE_PROP, property_b};
+const SecurityRight read_control = {SEC_STD_READ_CONTROL, QByteArray()};
+const SecurityRight write_dac = {SEC_STD_WRITE_DAC, QByteArray()};
+
+void add_ace(security_descriptor *sd, const security_ace_type type, const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type = QByteArray(), const uint8_t flags = 0x00);
+
+void ADMCTestEffectiveRights::init() {
+    sd = talloc_zero(NULL, struct security_descriptor);
+    sd->revision = SECURITY_DESCRIPTOR_REVISION_1;
+    sd->dacl = talloc_zero(sd, struct security_acl);
+}
+
+void ADMCTestEffectiveRights::cleanup() {
+    security_descriptor_free(sd);
+    sd = nullptr;
+}
+
+// NOTE: deny ACE's come first in canonical order, so deny
+// of a group wins over allow of a member
+void ADMCTestEffectiveRights::deny_before_allow() {
+    add_ace(sd, SEC_ACE_TYPE_ACCESS_DENIED, group_sid, SEC_ADS_WRITE_PROP);
+    add_ace(sd, SEC_ACE_TYPE_ACCESS_ALLOWED, user_sid, SEC_ADS_WRITE_PROP | SEC_ADS_READ_PROP);
+
+    const QList<bool> result = security_descriptor_get_effective_rights(sd, token, {read_property, write_property_a});
+    QCOMPARE(result, QList<bool>({true, false}));
+}
+
+// NOTE: first ACE that decides a bit wins, even if DACL is
+// not in canonical order
+void ADMCTestEffectiveRights::ace_order() {
+    add_ace(sd, SEC_ACE_TYPE_ACCESS_ALLOWED, user_sid, SEC_ADS_WRITE_PROP);
+    add_ace(sd, SEC_ACE_TYPE_ACCESS_DENIED, group_sid, SEC_ADS_WRITE_PROP);
+
+    const QList<bool> result = security_descriptor_get_effective_rights(sd, token, {write_property_a});
+    QCOMPARE(result, QList<bool>({true}));
+}
+
+// NOTE: object ACE only affects rights with same object
+// type. Generic deny after it doesn't undo the allow.
+void ADMCTestEffectiveRights::object_ace() {
+    add_ace(sd, SEC_ACE_TYPE_ACCESS_ALLOWED_OBJECT, user_sid, SEC_ADS_WRITE_PROP, property_a);
+    add_ace(sd, SEC_ACE_TYPE_ACCESS_DENIED, user_sid, SEC_ADS_WRITE_PROP);
+
+    const QList<bool> result = security_descriptor_get_effective_rights(sd, token, {write_property_a, write_property_b});
+    QCOMPARE(result, QList<bool>({true, false}));
+}
+
+void ADMCTestEffectiveRights::generic_ace_covers_object_rights() {
+    add_ace(sd, SEC_ACE_TYPE_ACCESS_DENIED_OBJECT, group_sid, SEC_ADS_WRITE_PROP, property_b);
+    add_ace(sd, SEC_ACE_TYPE_ACCESS_ALLOWED, group_sid, SEC_ADS_WRITE_PROP);
+
+    const QList<bool> result = security_descriptor_get_effective_rights(sd, token, {write_property_a, write_property_b, read_property});
+    QCOMPARE(result, QList<bool>({true, false, false}));
+}
+
+// NOTE: inherit-only ACE's apply only to children, while
+// inherited ACE's apply to the object itself
+void ADMCTestEffectiveRights::inherit_only_ace_skipped() {
+    add_ace(sd, SEC_ACE_TYPE_ACCESS_DENIED, user_sid, SEC_ADS_WRITE_PROP, QByteArray(), SEC_ACE_FLAG_CONTAINER_INHERIT | SEC_ACE_FLAG_INHERIT_ONLY);
+    add_ace(sd, SEC_ACE_TYPE_ACCESS_ALLOWED, user_sid, SEC_ADS_WRITE_PROP);
+    add_ace(sd, SEC_ACE_TYPE_ACCESS_ALLOWED, user_sid, SEC_ADS_READ_PROP, QByteArray(), SEC_ACE_FLAG_INHERITED_ACE);
+
+    const QList<bool> result = security_descriptor_get_effective_rights(sd, token, {write_property_a, read_property});
+    QCOMPARE(result, QList<bool>({true, true}));
+}
+
+void ADMCTestEffectiveRights::trustee_not_in_token() {
+    add_ace(sd, SEC_ACE_TYPE_ACCESS_ALLOWED, other_sid, SEC_ADS_WRITE_PROP | SEC_ADS_READ_PROP);
+    add_ace(sd, SEC_ACE_TYPE_ACCESS_ALLOWED, sid_string_to_bytes(SID_WORLD), SEC_ADS_READ_PROP);
+
+    const QList<bool> result = security_descriptor_get_effective_rights(sd, token, {write_property_a, read_property});
+    QCOMPARE(result, QList<bool>({false, true}));
+}
+
+// NOTE: right is allowed only if all of it's bits are
+// allowed
+void ADMCTestEffectiveRights::partial_mask() {
+    add_ace(sd, SEC_ACE_TYPE_ACCESS_ALLOWED, user_sid, SEC_ADS_READ_PROP);
+
+    const SecurityRight read_write_property = {SEC_ADS_READ_PROP | SEC_ADS_WRITE_PROP, QByteArray()};
+
+    const QList<bool> result = security_descriptor_get_effective_rights(sd, token, {read_write_property, read_property});
+    QCOMPARE(result, QList<bool>({false, true}));
+}
+
+// NOTE: owner can always read and change DACL, even if
+// DACL denies it
+void ADMCTestEffectiveRights::owner_implicit_rights() {
+    const QList<SecurityRight> right_list = {read_control, write_dac, read_property};
+
+    sd->owner_sid = talloc(sd, struct dom_sid);
+    *sd->owner_sid = dom_sid_from_bytes(other_sid);
+
+    const QList<bool> not_owner_result = security_descriptor_get_effective_rights(sd, token, right_list);
+    QCOMPARE(not_owner_result, QList<bool>({false, false, false}));
+
+    *sd->owner_sid = dom_sid_from_bytes(group_sid);
+
+    const QList<bool> owner_result = security_descriptor_get_effective_rights(sd, token, right_list);
+    QCOMPARE(owner_result, QList<bool>({true, true, false}));
+
+    add_ace(sd, SEC_ACE_TYPE_ACCESS_DENIED, user_sid, SEC_STD_WRITE_DAC);
+
+    const QList<bool> owner_deny_result = security_descriptor_get_effective_rights(sd, token, right_list);
+    QCOMPARE(owner_deny_result, QList<bool>({true, true, false}));
+}
+
+void ADMCTestEffectiveRights::empty_dacl() {
+    const QList<bool> result = security_descriptor_get_effective_rights(sd, token, {read_property, write_property_a, read_control});
+    QCOMPARE(result, QList<bool>({false, false, false}));
+}
+
+void ADMCTestEffectiveRights::null_dacl() {
+    talloc_free(sd->dacl);
+    sd->dacl = nullptr;
+
+    const QList<bool> result = security_descriptor_get_effective_rights(sd, token, {read_property, write_property_a, read_control});
+    QCOMPARE(result, QList<bool>({true, true, true}));
+}
+
+void ADMCTestEffectiveRights::null_sd() {
+    const QList<bool> result = security_descriptor_get_effective_rights(nullptr, token, {read_property, write_dac});
+    QCOMPARE(result, QList<bool>({false, false}));
+}
+
+void add_ace(security_descriptor *sd, const security_ace_type type, const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type, const uint8_t flags) {
+    security_ace ace;
+    memset(&ace, 0, sizeof(security_ace));
+
+    ace.type = type;
+    ace.flags = flags;
+    ace.access_mask = access_mask;
+    ace.trustee = dom_sid_from_bytes(trustee);
+
+    if (!object_type.isEmpty()) {
+        ace.object.object.flags = SEC_ACE_OBJECT_TYPE_PRESENT;
+        memcpy(&ace.object.object.type.type, object_type.constData(), sizeof(GUID));
+    }
+
+    security_descriptor_dacl_add(sd, &ace);
+}
+
+QTEST_GUILESS_MAIN(ADMCTestEffectiveRights)
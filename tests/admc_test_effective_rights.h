@@ -0,0 +1,52 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADMC_TEST_EFFECTIVE_RIGHTS_H
+#define ADMC_TEST_EFFECTIVE_RIGHTS_H
+
+#include <QObject>
+#include <QTest>
+
+struct security_descriptor;
+
+class ADMCTestEffectiveRights : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void deny_before_allow();
+    void ace_order();
+    void object_ace();
+    void generic_ace_covers_object_rights();
+    void inherit_only_ace_skipped();
+    void trustee_not_in_token();
+    void partial_mask();
+    void owner_implicit_rights();
+    void empty_dacl();
+    void null_dacl();
+    void null_sd();
+
+private:
+    security_descriptor *sd;
+};
+
+#endif /* ADMC_TEST_EFFECTIVE_RIGHTS_H */
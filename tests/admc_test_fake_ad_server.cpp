@@ -0,0 +1,392 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "admc_test_fake_ad_server.h"
+
+#include "adldap.h"
+#include "fake_ad_server.h"
+
+#include <ldap.h>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#define USER_COUNT 250
+#define GROUP_COUNT 20
+#define OU_COUNT 5
+
+#define MATCHING_RULE_BIT_AND_OID "1.2.840.113556.1.4.803"
+
+void ADMCTestFakeAdServer::initTestCase() {
+    FakeAdDomainSize size;
+    size.users = USER_COUNT;
+    size.groups = GROUP_COUNT;
+    size.ous = OU_COUNT;
+
+    server = new FakeAdServer(size);
+    QVERIFY(server->start());
+    server->setup_ad_interface();
+
+    ad = new AdInterface();
+    QVERIFY2(ad->is_connected(), "Failed to connect to fake AD server");
+
+    adconfig_instance = new AdConfig();
+    adconfig_instance->load(*ad, QLocale(QLocale::English));
+    AdInterface::set_config(adconfig_instance);
+}
+
+void ADMCTestFakeAdServer::cleanupTestCase() {
+    AdInterface::set_config(nullptr);
+    AdInterface::set_test_server(QString());
+
+    delete ad;
+    delete adconfig_instance;
+    delete server;
+}
+
+void ADMCTestFakeAdServer::init() {
+    ad->clear_messages();
+}
+
+void ADMCTestFakeAdServer::cleanup() {
+    QVERIFY(!ad->any_error_messages());
+}
+
+void ADMCTestFakeAdServer::root_dse() {
+    const AdObject root_dse = ad->search_object("", {"defaultNamingContext", "supportedControl"});
+
+    QCOMPARE(root_dse.get_string("defaultNamingContext"), server->directory()->domain_dn());
+    QVERIFY(root_dse.get_strings("supportedControl").contains(LDAP_CONTROL_PAGEDRESULTS));
+}
+
+void ADMCTestFakeAdServer::adconfig() {
+    QCOMPARE(adconfig_instance->domain_dn(), server->directory()->domain_dn());
+    QVERIFY(adconfig_instance->control_is_supported(LDAP_CONTROL_X_TREE_DELETE));
+    QCOMPARE(adconfig_instance->get_attribute_type(ATTRIBUTE_OBJECT_SID), AttributeType_Sid);
+    QVERIFY(adconfig_instance->get_attribute_is_backlink(ATTRIBUTE_MEMBER_OF));
+    QCOMPARE(adconfig_instance->get_class_display_name(CLASS_USER), QString("User"));
+    QVERIFY(adconfig_instance->get_inherit_chain(CLASS_USER).contains(CLASS_PERSON));
+}
+
+// NOTE: there are more users than fit on one page, so
+// search has to go through multiple pages
+void ADMCTestFakeAdServer::paged_search() {
+    const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_USER);
+
+    QHash<QString, AdObject> results;
+    AdCookie cookie;
+    int page_count = 0;
+
+    while (true) {
+        QVERIFY(ad->search_paged(server->directory()->domain_dn(), SearchScope_All, filter, {ATTRIBUTE_DN}, &results, &cookie));
+        page_count++;
+
+        if (!cookie.more_pages()) {
+            break;
+        }
+    }
+
+    // NOTE: +1 for Administrator
+    QCOMPARE(results.size(), USER_COUNT + 1);
+    QVERIFY(page_count > 1);
+
+    const QHash<QString, AdObject> simple_results = ad->search(server->directory()->domain_dn(), SearchScope_All, filter, {ATTRIBUTE_DN});
+    QCOMPARE(simple_results.size(), results.size());
+}
+
+void ADMCTestFakeAdServer::sd_flags() {
+    const QString dn = QString("CN=User-0,OU=OU-0,%1").arg(server->directory()->domain_dn());
+    const AdObject object = ad->search_object(dn, {ATTRIBUTE_SECURITY_DESCRIPTOR});
+
+    QVERIFY(!object.get_value(ATTRIBUTE_SECURITY_DESCRIPTOR).isEmpty());
+}
+
+void ADMCTestFakeAdServer::add_modify_delete() {
+    const QString dn = QString("CN=test-user,%1").arg(server->directory()->domain_dn());
+
+    QVERIFY(ad->object_add(dn, CLASS_USER));
+
+    const AdObject created = ad->search_object(dn);
+    QVERIFY(created.get_strings(ATTRIBUTE_OBJECT_CLASS).contains(CLASS_USER));
+    QVERIFY(!created.get_value(ATTRIBUTE_OBJECT_SID).isEmpty());
+    QVERIFY(!created.get_value(ATTRIBUTE_OBJECT_GUID).isEmpty());
+
+    QVERIFY(ad->attribute_replace_string(dn, ATTRIBUTE_DESCRIPTION, "hello"));
+    QCOMPARE(ad->search_object(dn, {ATTRIBUTE_DESCRIPTION}).get_string(ATTRIBUTE_DESCRIPTION), QString("hello"));
+
+    QVERIFY(ad->object_delete(dn));
+    QVERIFY(ad->search_object(dn).is_empty());
+}
+
+void ADMCTestFakeAdServer::membership() {
+    const QString domain_dn = server->directory()->domain_dn();
+    const QString group_dn = QString("CN=test-group,%1").arg(domain_dn);
+    const QString user_dn = QString("CN=User-1,OU=OU-1,%1").arg(domain_dn);
+
+    QVERIFY(ad->object_add(group_dn, CLASS_GROUP));
+    QVERIFY(ad->group_add_member(group_dn, user_dn));
+
+    const AdObject user = ad->search_object(user_dn, {ATTRIBUTE_MEMBER_OF});
+    QVERIFY(user.get_strings(ATTRIBUTE_MEMBER_OF).contains(group_dn));
+
+    QVERIFY(ad->object_delete(group_dn));
+
+    const AdObject user_after = ad->search_object(user_dn, {ATTRIBUTE_MEMBER_OF});
+    QVERIFY(!user_after.get_strings(ATTRIBUTE_MEMBER_OF).contains(group_dn));
+}
+
+void ADMCTestFakeAdServer::rename_and_move() {
+    const QString domain_dn = server->directory()->domain_dn();
+    const QString ou_dn = QString("OU=test-ou,%1").arg(domain_dn);
+    const QString user_dn = QString("CN=test-rename,%1").arg(domain_dn);
+
+    QVERIFY(ad->object_add(ou_dn, CLASS_OU));
+    QVERIFY(ad->object_add(user_dn, CLASS_USER));
+
+    QVERIFY(ad->object_rename(user_dn, "test-renamed"));
+    const QString renamed_dn = QString("CN=test-renamed,%1").arg(domain_dn);
+    QVERIFY(!ad->search_object(renamed_dn).is_empty());
+
+    QVERIFY(ad->object_move(renamed_dn, ou_dn));
+    const QString moved_dn = QString("CN=test-renamed,%1").arg(ou_dn);
+    QVERIFY(!ad->search_object(moved_dn).is_empty());
+    QVERIFY(ad->search_object(renamed_dn).is_empty());
+
+    QVERIFY(ad->object_delete(ou_dn));
+}
+
+void ADMCTestFakeAdServer::tree_delete() {
+    const QString domain_dn = server->directory()->domain_dn();
+    const QString ou_dn = QString("OU=test-tree,%1").arg(domain_dn);
+    const QString child_dn = QString("OU=child,%1").arg(ou_dn);
+    const QString user_dn = QString("CN=leaf,%1").arg(child_dn);
+
+    QVERIFY(ad->object_add(ou_dn, CLASS_OU));
+    QVERIFY(ad->object_add(child_dn, CLASS_OU));
+    QVERIFY(ad->object_add(user_dn, CLASS_USER));
+
+    QVERIFY(ad->object_delete(ou_dn));
+
+    QVERIFY(ad->search_object(ou_dn).is_empty());
+    QVERIFY(ad->search_object(user_dn).is_empty());
+}
+
+void ADMCTestFakeAdServer::bitwise_filter() {
+    const QString filter = QString("(&(objectClass=user)(userAccountControl:%1:=2))").arg(MATCHING_RULE_BIT_AND_OID);
+
+    // NOTE: generated users are disabled by default,
+    // Administrator is not
+    const QHash<QString, AdObject> results = ad->search(server->directory()->domain_dn(), SearchScope_All, filter, {ATTRIBUTE_DN});
+    QCOMPARE(results.size(), USER_COUNT);
+}
+
+void ADMCTestFakeAdServer::in_chain_filter() {
+    const QString domain_dn = server->directory()->domain_dn();
+    const QString outer_dn = QString("CN=test-outer,%1").arg(domain_dn);
+    const QString inner_dn = QString("CN=Group-0,OU=OU-0,%1").arg(domain_dn);
+
+    QVERIFY(ad->object_add(outer_dn, CLASS_GROUP));
+    QVERIFY(ad->group_add_member(outer_dn, inner_dn));
+
+    const QString filter = QString("(memberOf:%1:=%2)").arg(MATCHING_RULE_IN_CHAIN_OID, outer_dn);
+    const QHash<QString, AdObject> results = ad->search(domain_dn, SearchScope_All, filter, {ATTRIBUTE_DN});
+
+    // NOTE: inner group itself and it's members
+    const int inner_member_count = ad->search_object(inner_dn, {ATTRIBUTE_MEMBER}).get_strings(ATTRIBUTE_MEMBER).size();
+    QCOMPARE(results.size(), inner_member_count + 1);
+
+    QVERIFY(ad->object_delete(outer_dn));
+}
+
+void ADMCTestFakeAdServer::metrics() {
+    ad_metrics_reset();
+
+    const QString domain_dn = server->directory()->domain_dn();
+    const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_USER);
+    const QHash<QString, AdObject> results = ad->search(domain_dn, SearchScope_All, filter, {ATTRIBUTE_DN});
+
+    // NOTE: replacing attribute also searches for old
+    // value, so this adds a second search
+    const QString dn = QString("CN=metrics-user,%1").arg(domain_dn);
+    QVERIFY(ad->object_add(dn, CLASS_USER));
+    QVERIFY(ad->attribute_replace_string(dn, ATTRIBUTE_DESCRIPTION, "test"));
+    QVERIFY(ad->object_delete(dn));
+
+    const QList<AdOperationMetrics> operation_list = ad_metrics_get_operations();
+
+    auto get_metrics = [&](const AdOperation operation) {
+        for (const AdOperationMetrics &metrics : operation_list) {
+            if (metrics.operation == operation) {
+                return metrics;
+            }
+        }
+
+        return AdOperationMetrics();
+    };
+
+    const AdOperationMetrics search_metrics = get_metrics(AdOperation_Search);
+    QCOMPARE(search_metrics.count, 2);
+    QCOMPARE(search_metrics.error_count, 0);
+    QCOMPARE(search_metrics.dc, server->host());
+    QCOMPARE(search_metrics.entries, (qint64) results.size() + 1);
+    QVERIFY(search_metrics.pages > 2);
+    QVERIFY(search_metrics.bytes > 0);
+
+    int histogram_total = 0;
+    for (const int count : search_metrics.histogram) {
+        histogram_total += count;
+    }
+    QCOMPARE(histogram_total, search_metrics.count);
+    QVERIFY(search_metrics.percentile_usec(0.5) <= search_metrics.max_usec);
+
+    QCOMPARE(get_metrics(AdOperation_Add).count, 1);
+    QCOMPARE(get_metrics(AdOperation_Modify).count, 1);
+    QCOMPARE(get_metrics(AdOperation_Delete).count, 1);
+    QCOMPARE(get_metrics(AdOperation_Modify).error_count, 0);
+
+    const QList<AdSearchRecord> search_list = ad_metrics_get_slowest_searches();
+    QCOMPARE(search_list.size(), 2);
+    QVERIFY(search_list[0].usec >= search_list[1].usec);
+
+    for (const AdSearchRecord &record : search_list) {
+        QVERIFY(record.server_usec <= record.usec);
+        QVERIFY(record.complete);
+
+        if (record.filter == filter) {
+            QCOMPARE(record.entries, results.size());
+            QCOMPARE(record.base, domain_dn);
+        }
+    }
+
+    // NOTE: header + one row for each operation type
+    const QString csv = ad_metrics_operations_csv();
+    QCOMPARE(csv.count('\n'), operation_list.size() + 1);
+
+    // NOTE: search that is stopped after first page is
+    // recorded as incomplete when cookie is destroyed
+    ad_metrics_reset();
+
+    QHash<QString, AdObject> first_page;
+    {
+        AdCookie cookie;
+        QVERIFY(ad->search_paged(domain_dn, SearchScope_All, filter, {ATTRIBUTE_DN}, &first_page, &cookie));
+        QVERIFY(cookie.more_pages());
+        QVERIFY(ad_metrics_get_slowest_searches().isEmpty());
+    }
+
+    const QList<AdSearchRecord> partial_search_list = ad_metrics_get_slowest_searches();
+    QCOMPARE(partial_search_list.size(), 1);
+    QVERIFY(partial_search_list[0].success);
+    QVERIFY(!partial_search_list[0].complete);
+    QCOMPARE(partial_search_list[0].pages, 1);
+    QCOMPARE(partial_search_list[0].entries, first_page.size());
+    QCOMPARE(partial_search_list[0].filter, filter);
+    QCOMPARE(partial_search_list[0].base, domain_dn);
+}
+
+void ADMCTestFakeAdServer::trace() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("trace.json");
+
+    QVERIFY(trace_start(path));
+    QVERIFY(trace_is_enabled());
+
+    const QString domain_dn = server->directory()->domain_dn();
+    const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_USER);
+    ad->search(domain_dn, SearchScope_All, filter, {ATTRIBUTE_DN});
+
+    trace_stop();
+    QVERIFY(!trace_is_enabled());
+
+    // NOTE: spans after stop are not recorded
+    {
+        TRACE_SCOPE("test", "after_stop");
+    }
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    QJsonParseError parse_error;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parse_error);
+    QCOMPARE(parse_error.error, QJsonParseError::NoError);
+
+    int search_count = 0;
+    int decode_count = 0;
+    bool found_after_stop = false;
+
+    const QJsonArray event_list = document.object()["traceEvents"].toArray();
+    for (const QJsonValue &value : event_list) {
+        const QJsonObject event = value.toObject();
+        const QString name = event["name"].toString();
+
+        if (name == "AdInterface::search_paged") {
+            search_count++;
+
+            QCOMPARE(event["ph"].toString(), QString("X"));
+            QCOMPARE(event["args"].toObject()["base"].toString(), domain_dn);
+        } else if (name == "decode_entries") {
+            decode_count++;
+        } else if (name == "after_stop") {
+            found_after_stop = true;
+        }
+    }
+
+    // NOTE: there are more users than fit in one page
+    QVERIFY(search_count > 1);
+    QCOMPARE(decode_count, search_count);
+    QVERIFY(!found_after_stop);
+}
+
+void ADMCTestFakeAdServer::edit_rights() {
+    const QString domain_dn = server->directory()->domain_dn();
+    const QString dn = QString("CN=edit-rights-user,%1").arg(domain_dn);
+    const QString missing_dn = QString("CN=missing-user,%1").arg(domain_dn);
+
+    QVERIFY(ad->object_add(dn, CLASS_USER));
+    QVERIFY(!ad_security_get_protected_against_deletion(ad->search_object(dn)));
+
+    const QList<SecurityRightEdit> edit_list = ad_security_get_protect_against_deletion_edit_list(true);
+
+    QHash<QString, QString> error_map;
+    QVERIFY(!ad_security_edit_rights(*ad, {dn, missing_dn}, edit_list, &error_map));
+    QCOMPARE(error_map.keys(), QList<QString>({missing_dn}));
+    QVERIFY(ad_security_get_protected_against_deletion(ad->search_object(dn)));
+
+    // NOTE: object already has the rights, so it
+    // shouldn't be written again
+    ad_metrics_reset();
+    QVERIFY(ad_security_edit_rights(*ad, {dn}, edit_list));
+
+    for (const AdOperationMetrics &metrics : ad_metrics_get_operations()) {
+        if (metrics.operation == AdOperation_Modify) {
+            QCOMPARE(metrics.count, 0);
+        }
+    }
+
+    QVERIFY(ad_security_edit_rights(*ad, {dn}, ad_security_get_protect_against_deletion_edit_list(false)));
+    QVERIFY(!ad_security_get_protected_against_deletion(ad->search_object(dn)));
+    QVERIFY(ad->object_delete(dn));
+}
+
+QTEST_MAIN(ADMCTestFakeAdServer)
@@ -0,0 +1,61 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADMC_TEST_FAKE_AD_SERVER_H
+#define ADMC_TEST_FAKE_AD_SERVER_H
+
+#include <QObject>
+#include <QTest>
+
+class AdConfig;
+class AdInterface;
+class FakeAdServer;
+
+class ADMCTestFakeAdServer : public QObject {
+    Q_OBJECT
+
+public slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void cleanup();
+
+private slots:
+    void root_dse();
+    void adconfig();
+    void paged_search();
+    void sd_flags();
+    void add_modify_delete();
+    void membership();
+    void rename_and_move();
+    void tree_delete();
+    void bitwise_filter();
+    void in_chain_filter();
+    void metrics();
+    void trace();
+    void edit_rights();
+
+private:
+    FakeAdServer *server;
+    AdConfig *adconfig_instance;
+    AdInterface *ad;
+};
+
+#endif /* ADMC_TEST_FAKE_AD_SERVER_H */
@@ -294,4 +294,36 @@ void ADMCTestGplink::get_gpo_order() {
     QCOMPARE(actual_order, expected_order);
 }
 
+// NOTE: option is parsed like QString::toInt(), so
+// invalid and out of range options become 0
+void ADMCTestGplink::parse_option_data() {
+    QTest::addColumn<QString>("option_string");
+    QTest::addColumn<QString>("expected_option");
+
+    QTest::newRow("zero") << "0" << "0";
+    QTest::newRow("enforced") << "2" << "2";
+    QTest::newRow("spaces") << " 1 " << "1";
+    QTest::newRow("plus sign") << "+3" << "3";
+    QTest::newRow("empty") << "" << "0";
+    QTest::newRow("letters") << "1a" << "0";
+    QTest::newRow("int max") << "2147483647" << "2147483647";
+    QTest::newRow("int min") << "-2147483648" << "-2147483648";
+    QTest::newRow("above int max") << "2147483648" << "0";
+    QTest::newRow("below int min") << "-2147483649" << "0";
+    QTest::newRow("long digit run") << "99999999999999999999" << "0";
+    QTest::newRow("arabic-indic digit") << QString(QChar(0x0661)) << "0";
+    QTest::newRow("fullwidth digit") << QString(QChar(0xFF12)) << "0";
+}
+
+void ADMCTestGplink::parse_option() {
+    QFETCH(QString, option_string);
+    QFETCH(QString, expected_option);
+
+    const QString link_prefix = "[LDAP://cn={AAAAAAAA-AAAA-AAAA-AAAA-AAAAAAAAAAAA},cn=policies,cn=system,DC=foodomain,DC=com;";
+    const Gplink gplink(link_prefix + option_string + "]");
+
+    QCOMPARE(gplink.to_string(), link_prefix + expected_option + "]");
+    QCOMPARE(expected_option.toInt(), option_string.toInt());
+}
+
 QTEST_MAIN(ADMCTestGplink)
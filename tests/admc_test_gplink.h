@@ -54,6 +54,8 @@ private slots:
     void get_gpo_list();
     void get_gpo_order_data();
     void get_gpo_order();
+    void parse_option_data();
+    void parse_option();
 };
 
 #endif /* ADMC_TEST_GPLINK_H */
@@ -0,0 +1,258 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "admc_test_gplink_edit.h"
+
+#include "adldap.h"
+#include "fake_ad_server.h"
+
+#include <ldap.h>
+
+#include <algorithm>
+
+#define OU_COUNT 4
+#define GPO_COUNT 3
+
+int get_operation_count(const AdOperation operation);
+
+void ADMCTestGplinkEdit::initTestCase() {
+    FakeAdDomainSize size;
+    size.users = 10;
+    size.groups = 2;
+    size.ous = OU_COUNT;
+    size.gpos = GPO_COUNT;
+
+    server = new FakeAdServer(size);
+    QVERIFY(server->start());
+    server->setup_ad_interface();
+
+    ad = new AdInterface();
+    QVERIFY2(ad->is_connected(), "Failed to connect to fake AD server");
+
+    adconfig_instance = new AdConfig();
+    adconfig_instance->load(*ad, QLocale(QLocale::English));
+    AdInterface::set_config(adconfig_instance);
+
+    const QString domain_dn = server->directory()->domain_dn();
+
+    for (int i = 0; i < OU_COUNT; i++) {
+        ou_list.append(QString("OU=OU-%1,%2").arg(i).arg(domain_dn));
+    }
+
+    const QString gpo_filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_GP_CONTAINER);
+    const QHash<QString, AdObject> gpo_results = ad->search(domain_dn, SearchScope_All, gpo_filter, {ATTRIBUTE_DN});
+    gpo_list = gpo_results.keys();
+    std::sort(gpo_list.begin(), gpo_list.end());
+
+    // NOTE: +1 for Default Domain Policy
+    QCOMPARE(gpo_list.size(), GPO_COUNT + 1);
+
+    Gplink gplink;
+    for (const QString &gpo : gpo_list) {
+        gplink.add(gpo);
+    }
+    base_gplink = gplink.to_string();
+}
+
+void ADMCTestGplinkEdit::cleanupTestCase() {
+    AdInterface::set_config(nullptr);
+    AdInterface::set_test_server(QString());
+
+    delete ad;
+    delete adconfig_instance;
+    delete server;
+}
+
+// NOTE: every test starts with all policies linked to all
+// OU's
+void ADMCTestGplinkEdit::init() {
+    for (const QString &ou : ou_list) {
+        FakeAdModification modification;
+        modification.operation = LDAP_MOD_REPLACE;
+        modification.attribute = ATTRIBUTE_GPLINK;
+        modification.values = {base_gplink.toUtf8()};
+
+        QCOMPARE(server->directory()->modify(ou, {modification}), 0);
+    }
+
+    ad->clear_messages();
+    ad_metrics_reset();
+}
+
+void ADMCTestGplinkEdit::cleanup() {
+    server->set_concurrent_modify(QString(), {});
+}
+
+// NOTE: edits for one OU are not adjacent in the list, but
+// should still be applied in order and written with one
+// request. OU's for which edits changed nothing are not
+// written at all.
+void ADMCTestGplinkEdit::grouped_per_ou() {
+    const QString &gpo_A = gpo_list[0];
+    const QString &gpo_B = gpo_list[1];
+    const QString &gpo_C = gpo_list[2];
+
+    const QList<GplinkEdit> edit_list = {
+        GplinkEdit(ou_list[0], gpo_A, GplinkEditType_Remove),
+        GplinkEdit(ou_list[1], gpo_B, GplinkEditType_SetOption, GplinkOption_Enforced, true),
+        GplinkEdit(ou_list[0], gpo_C, GplinkEditType_SetOption, GplinkOption_Disabled, true),
+        GplinkEdit(ou_list[2], gpo_A, GplinkEditType_Add),
+    };
+
+    Gplink expected_0 = Gplink(base_gplink);
+    expected_0.remove(gpo_A);
+    expected_0.set_option(gpo_C, GplinkOption_Disabled, true);
+
+    Gplink expected_1 = Gplink(base_gplink);
+    expected_1.set_option(gpo_B, GplinkOption_Enforced, true);
+
+    QHash<QString, QString> gplink_map;
+    QVERIFY(ad->gplink_edit(edit_list, &gplink_map));
+    QVERIFY(!ad->any_error_messages());
+
+    QCOMPARE(gplink_map.size(), 2);
+    QCOMPARE(gplink_map.value(ou_list[0]), expected_0.to_string());
+    QCOMPARE(gplink_map.value(ou_list[1]), expected_1.to_string());
+    QVERIFY(!gplink_map.contains(ou_list[2]));
+
+    QCOMPARE(get_gplink(ou_list[0]), expected_0.to_string());
+    QCOMPARE(get_gplink(ou_list[1]), expected_1.to_string());
+    QCOMPARE(get_gplink(ou_list[2]), base_gplink);
+    QCOMPARE(get_gplink(ou_list[3]), base_gplink);
+
+    // NOTE: one search to load all gplinks and one write
+    // per changed OU
+    QCOMPARE(get_operation_count(AdOperation_Search), 1);
+    QCOMPARE(get_operation_count(AdOperation_Modify), 2);
+}
+
+void ADMCTestGplinkEdit::move_up_down() {
+    const QString &gpo_first = gpo_list.first();
+    const QString &gpo_last = gpo_list.last();
+
+    const QList<GplinkEdit> edit_list = {
+        GplinkEdit(ou_list[0], gpo_last, GplinkEditType_MoveUp),
+        GplinkEdit(ou_list[1], gpo_first, GplinkEditType_MoveDown),
+        GplinkEdit(ou_list[1], gpo_first, GplinkEditType_MoveDown),
+
+        // NOTE: these cancel each other out
+        GplinkEdit(ou_list[2], gpo_last, GplinkEditType_MoveUp),
+        GplinkEdit(ou_list[2], gpo_last, GplinkEditType_MoveDown),
+    };
+
+    Gplink expected_0 = Gplink(base_gplink);
+    expected_0.move_up(gpo_last);
+
+    Gplink expected_1 = Gplink(base_gplink);
+    expected_1.move_down(gpo_first);
+    expected_1.move_down(gpo_first);
+
+    QVERIFY(!expected_0.equals(Gplink(base_gplink)));
+    QVERIFY(!expected_1.equals(Gplink(base_gplink)));
+
+    QHash<QString, QString> gplink_map;
+    QVERIFY(ad->gplink_edit(edit_list, &gplink_map));
+
+    QCOMPARE(gplink_map.size(), 2);
+    QCOMPARE(get_gplink(ou_list[0]), expected_0.to_string());
+    QCOMPARE(get_gplink(ou_list[1]), expected_1.to_string());
+    QCOMPARE(get_gplink(ou_list[2]), base_gplink);
+
+    QCOMPARE(get_operation_count(AdOperation_Modify), 2);
+}
+
+// NOTE: gplink of second OU is changed by someone else
+// after it was loaded. Write to that OU should fail
+// without overwriting the other change, while write to
+// first OU still succeeds.
+void ADMCTestGplinkEdit::concurrent_edit() {
+    const QString &gpo_A = gpo_list[0];
+    const QString &gpo_B = gpo_list[1];
+
+    const QString concurrent_gplink = [&]() {
+        Gplink out = Gplink(base_gplink);
+        out.set_option(gpo_B, GplinkOption_Disabled, true);
+
+        return out.to_string();
+    }();
+
+    FakeAdModification concurrent_modification;
+    concurrent_modification.operation = LDAP_MOD_REPLACE;
+    concurrent_modification.attribute = ATTRIBUTE_GPLINK;
+    concurrent_modification.values = {concurrent_gplink.toUtf8()};
+    server->set_concurrent_modify(ou_list[1], {concurrent_modification});
+
+    const QList<GplinkEdit> edit_list = {
+        GplinkEdit(ou_list[0], gpo_A, GplinkEditType_Remove),
+        GplinkEdit(ou_list[1], gpo_A, GplinkEditType_Remove),
+    };
+
+    Gplink expected_0 = Gplink(base_gplink);
+    expected_0.remove(gpo_A);
+
+    QHash<QString, QString> gplink_map;
+    QVERIFY(!ad->gplink_edit(edit_list, &gplink_map));
+    QVERIFY(ad->any_error_messages());
+
+    QCOMPARE(gplink_map.keys(), QList<QString>({ou_list[0]}));
+    QCOMPARE(get_gplink(ou_list[0]), expected_0.to_string());
+    QCOMPARE(get_gplink(ou_list[1]), concurrent_gplink);
+}
+
+void ADMCTestGplinkEdit::missing_ou() {
+    const QString missing_ou = QString("OU=missing,%1").arg(server->directory()->domain_dn());
+
+    const QList<GplinkEdit> edit_list = {
+        GplinkEdit(missing_ou, gpo_list[0], GplinkEditType_Remove),
+        GplinkEdit(ou_list[0], gpo_list[0], GplinkEditType_Remove),
+    };
+
+    QHash<QString, QString> gplink_map;
+    QVERIFY(!ad->gplink_edit(edit_list, &gplink_map));
+    QVERIFY(ad->any_error_messages());
+
+    QCOMPARE(gplink_map.keys(), QList<QString>({ou_list[0]}));
+    QVERIFY(!Gplink(get_gplink(ou_list[0])).contains(gpo_list[0]));
+}
+
+QString ADMCTestGplinkEdit::get_gplink(const QString &ou_dn) const {
+    const FakeAdEntry *entry = server->directory()->get_entry(ou_dn);
+    if (entry == nullptr) {
+        return QString();
+    }
+
+    const QString out = QString::fromUtf8(entry->get_value(ATTRIBUTE_GPLINK));
+
+    return out;
+}
+
+int get_operation_count(const AdOperation operation) {
+    int out = 0;
+
+    for (const AdOperationMetrics &metrics : ad_metrics_get_operations()) {
+        if (metrics.operation == operation) {
+            out += metrics.count;
+        }
+    }
+
+    return out;
+}
+
+QTEST_MAIN(ADMCTestGplinkEdit)
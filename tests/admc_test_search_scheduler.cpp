@@ -0,0 +1,312 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "admc_test_search_scheduler.h"
+
+#include "adldap.h"
+#include "fake_ad_server.h"
+#include "search_scheduler.h"
+#include "settings.h"
+
+#include <QSettings>
+#include <QSignalSpy>
+
+#define USER_COUNT 250
+#define GROUP_COUNT 20
+#define OU_COUNT 5
+
+// NOTE: same as max_concurrent_searches in
+// search_scheduler.cpp
+#define MAX_CONCURRENT_SEARCHES 4
+
+#define SEARCH_TIMEOUT 10000
+
+QString users_filter();
+void collect_results(SearchHandle *handle, QHash<QString, AdObject> *out);
+
+void ADMCTestSearchScheduler::initTestCase() {
+    qRegisterMetaType<QHash<QString, AdObject>>("QHash<QString, AdObject>");
+
+    // NOTE: keep settings in a temporary dir, so that
+    // test doesn't use or change user's settings
+    QVERIFY(settings_dir.isValid());
+    QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope, settings_dir.path());
+
+    FakeAdDomainSize size;
+    size.users = USER_COUNT;
+    size.groups = GROUP_COUNT;
+    size.ous = OU_COUNT;
+
+    server = new FakeAdServer(size);
+    QVERIFY(server->start());
+    server->setup_ad_interface();
+
+    AdInterface ad;
+    QVERIFY2(ad.is_connected(), "Failed to connect to fake AD server");
+
+    adconfig_instance = new AdConfig();
+    adconfig_instance->load(ad, QLocale(QLocale::English));
+    AdInterface::set_config(adconfig_instance);
+}
+
+void ADMCTestSearchScheduler::cleanupTestCase() {
+    AdInterface::set_config(nullptr);
+    AdInterface::set_test_server(QString());
+
+    delete adconfig_instance;
+    delete server;
+}
+
+void ADMCTestSearchScheduler::init() {
+    server->set_search_delay(0);
+    server->reset_search_counts();
+}
+
+// NOTE: there are more users than fit on one page, so
+// results arrive in multiple parts
+void ADMCTestSearchScheduler::results() {
+    SearchScheduler scheduler;
+
+    const QString base = server->directory()->domain_dn();
+    SearchHandle *handle = scheduler.start(base, SearchScope_All, users_filter(), {ATTRIBUTE_DN});
+
+    QHash<QString, AdObject> results;
+    collect_results(handle, &results);
+
+    QSignalSpy results_spy(handle, &SearchHandle::results_ready);
+    QSignalSpy finished_spy(handle, &SearchHandle::finished);
+
+    QTRY_COMPARE_WITH_TIMEOUT(finished_spy.count(), 1, SEARCH_TIMEOUT);
+
+    QVERIFY(results_spy.count() > 1);
+    QVERIFY(!handle->failed_to_connect());
+    QVERIFY(!handle->hit_object_display_limit());
+
+    // NOTE: +1 for Administrator
+    QCOMPARE(results.size(), USER_COUNT + 1);
+
+    // NOTE: finished() should be emitted only once
+    QTest::qWait(100);
+    QCOMPARE(finished_spy.count(), 1);
+
+    delete handle;
+}
+
+void ADMCTestSearchScheduler::shared_search() {
+    SearchScheduler scheduler;
+
+    const QString base = server->directory()->domain_dn();
+    SearchHandle *handle_1 = scheduler.start(base, SearchScope_All, users_filter(), {ATTRIBUTE_DN});
+    SearchHandle *handle_2 = scheduler.start(base, SearchScope_All, users_filter(), {ATTRIBUTE_DN});
+
+    QVERIFY(handle_1->get_id() != handle_2->get_id());
+
+    QHash<QString, AdObject> results_1;
+    QHash<QString, AdObject> results_2;
+    collect_results(handle_1, &results_1);
+    collect_results(handle_2, &results_2);
+
+    QSignalSpy results_spy_1(handle_1, &SearchHandle::results_ready);
+    QSignalSpy results_spy_2(handle_2, &SearchHandle::results_ready);
+    QSignalSpy finished_spy_1(handle_1, &SearchHandle::finished);
+    QSignalSpy finished_spy_2(handle_2, &SearchHandle::finished);
+
+    QTRY_COMPARE_WITH_TIMEOUT(finished_spy_1.count(), 1, SEARCH_TIMEOUT);
+    QTRY_COMPARE_WITH_TIMEOUT(finished_spy_2.count(), 1, SEARCH_TIMEOUT);
+
+    QCOMPARE(results_spy_1.count(), results_spy_2.count());
+    QCOMPARE(results_1.size(), USER_COUNT + 1);
+    QCOMPARE(results_2.size(), results_1.size());
+
+    for (const QString &dn : results_1.keys()) {
+        QVERIFY(results_2.contains(dn));
+    }
+
+    delete handle_1;
+    delete handle_2;
+}
+
+// NOTE: searches are delayed on the server, so that all
+// searches which are allowed to run at the same time
+// are in flight together
+void ADMCTestSearchScheduler::concurrency_cap() {
+    server->set_search_delay(200);
+
+    SearchScheduler scheduler;
+
+    const int search_count = MAX_CONCURRENT_SEARCHES * 2;
+    const QString base = server->directory()->domain_dn();
+
+    QList<SearchHandle *> handle_list;
+    QList<QSignalSpy *> finished_spy_list;
+
+    // NOTE: searches differ by attributes, so that they
+    // are not shared
+    for (int i = 0; i < search_count; i++) {
+        const QString attribute = QString("attribute-%1").arg(i);
+        SearchHandle *handle = scheduler.start(base, SearchScope_All, users_filter(), {ATTRIBUTE_DN, attribute});
+
+        handle_list.append(handle);
+        finished_spy_list.append(new QSignalSpy(handle, &SearchHandle::finished));
+    }
+
+    for (QSignalSpy *finished_spy : finished_spy_list) {
+        QTRY_COMPARE_WITH_TIMEOUT(finished_spy->count(), 1, SEARCH_TIMEOUT);
+    }
+
+    QVERIFY(server->max_delayed_search_count() > 1);
+    QVERIFY(server->max_delayed_search_count() <= MAX_CONCURRENT_SEARCHES);
+
+    qDeleteAll(finished_spy_list);
+    qDeleteAll(handle_list);
+}
+
+// NOTE: cancelled search should be abandoned on the
+// server instead of waiting for remaining results
+void ADMCTestSearchScheduler::cancel_running() {
+    server->set_search_delay(2000);
+
+    SearchScheduler scheduler;
+
+    const QString base = server->directory()->domain_dn();
+    SearchHandle *handle = scheduler.start(base, SearchScope_All, users_filter(), {ATTRIBUTE_DN});
+
+    QSignalSpy results_spy(handle, &SearchHandle::results_ready);
+    QSignalSpy finished_spy(handle, &SearchHandle::finished);
+
+    QTRY_VERIFY_WITH_TIMEOUT(server->max_delayed_search_count() > 0, SEARCH_TIMEOUT);
+
+    scheduler.cancel(handle->get_id());
+
+    QTRY_COMPARE(finished_spy.count(), 1);
+    QCOMPARE(results_spy.count(), 0);
+
+    QTRY_COMPARE_WITH_TIMEOUT(server->abandoned_search_count(), 1, SEARCH_TIMEOUT);
+
+    delete handle;
+}
+
+// NOTE: queued search should be removed from queue
+// without ever reaching the server
+void ADMCTestSearchScheduler::cancel_queued() {
+    server->set_search_delay(500);
+
+    SearchScheduler scheduler;
+
+    const QString base = server->directory()->domain_dn();
+
+    QList<SearchHandle *> running_handle_list;
+    QList<QSignalSpy *> running_spy_list;
+
+    for (int i = 0; i < MAX_CONCURRENT_SEARCHES; i++) {
+        const QString attribute = QString("attribute-%1").arg(i);
+        SearchHandle *handle = scheduler.start(base, SearchScope_All, users_filter(), {ATTRIBUTE_DN, attribute});
+
+        running_handle_list.append(handle);
+        running_spy_list.append(new QSignalSpy(handle, &SearchHandle::finished));
+    }
+
+    SearchHandle *queued_handle = scheduler.start(base, SearchScope_All, users_filter(), {ATTRIBUTE_DN});
+
+    QSignalSpy queued_results_spy(queued_handle, &SearchHandle::results_ready);
+    QSignalSpy queued_finished_spy(queued_handle, &SearchHandle::finished);
+
+    scheduler.cancel(queued_handle->get_id());
+
+    QTRY_COMPARE(queued_finished_spy.count(), 1);
+
+    for (QSignalSpy *finished_spy : running_spy_list) {
+        QTRY_COMPARE_WITH_TIMEOUT(finished_spy->count(), 1, SEARCH_TIMEOUT);
+    }
+
+    QCOMPARE(queued_results_spy.count(), 0);
+    QCOMPARE(server->abandoned_search_count(), 0);
+    QVERIFY(server->max_delayed_search_count() <= MAX_CONCURRENT_SEARCHES);
+
+    qDeleteAll(running_spy_list);
+    qDeleteAll(running_handle_list);
+    delete queued_handle;
+}
+
+void ADMCTestSearchScheduler::cancel_all() {
+    server->set_search_delay(2000);
+
+    SearchScheduler scheduler;
+
+    const QString base = server->directory()->domain_dn();
+
+    QList<SearchHandle *> handle_list;
+    QList<QSignalSpy *> results_spy_list;
+    QList<QSignalSpy *> finished_spy_list;
+
+    for (int i = 0; i < MAX_CONCURRENT_SEARCHES + 1; i++) {
+        const QString attribute = QString("attribute-%1").arg(i);
+        SearchHandle *handle = scheduler.start(base, SearchScope_All, users_filter(), {ATTRIBUTE_DN, attribute});
+
+        handle_list.append(handle);
+        results_spy_list.append(new QSignalSpy(handle, &SearchHandle::results_ready));
+        finished_spy_list.append(new QSignalSpy(handle, &SearchHandle::finished));
+    }
+
+    scheduler.cancel_all();
+
+    for (QSignalSpy *finished_spy : finished_spy_list) {
+        QTRY_COMPARE(finished_spy->count(), 1);
+    }
+
+    for (QSignalSpy *results_spy : results_spy_list) {
+        QCOMPARE(results_spy->count(), 0);
+    }
+
+    // NOTE: handles of cancelled searches are forgotten,
+    // so cancelling them again does nothing
+    for (SearchHandle *handle : handle_list) {
+        scheduler.cancel(handle->get_id());
+    }
+
+    QTest::qWait(100);
+
+    for (QSignalSpy *finished_spy : finished_spy_list) {
+        QCOMPARE(finished_spy->count(), 1);
+    }
+
+    qDeleteAll(results_spy_list);
+    qDeleteAll(finished_spy_list);
+    qDeleteAll(handle_list);
+}
+
+QString users_filter() {
+    const QString out = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_USER);
+
+    return out;
+}
+
+void collect_results(SearchHandle *handle, QHash<QString, AdObject> *out) {
+    QObject::connect(
+        handle, &SearchHandle::results_ready,
+        handle,
+        [out](const QHash<QString, AdObject> &results) {
+            for (const QString &dn : results.keys()) {
+                out->insert(dn, results[dn]);
+            }
+        });
+}
+
+QTEST_GUILESS_MAIN(ADMCTestSearchScheduler)
@@ -0,0 +1,53 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADMC_TEST_SEARCH_SCHEDULER_H
+#define ADMC_TEST_SEARCH_SCHEDULER_H
+
+#include <QObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+class AdConfig;
+class FakeAdServer;
+
+class ADMCTestSearchScheduler : public QObject {
+    Q_OBJECT
+
+public slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+
+private slots:
+    void results();
+    void shared_search();
+    void concurrency_cap();
+    void cancel_running();
+    void cancel_queued();
+    void cancel_all();
+
+private:
+    QTemporaryDir settings_dir;
+    FakeAdServer *server;
+    AdConfig *adconfig_instance;
+};
+
+#endif /* ADMC_TEST_SEARCH_SCHEDULER_H */
@@ -0,0 +1,181 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "admc_test_sid_guid.h"
+
+#include "ad_display.h"
+#include "ad_utils.h"
+#include "samba/dom_sid.h"
+#include "sid_guid_legacy.h"
+
+// NOTE: sid's of different lengths, from well known sid's
+// to domain sid's with max sub auth values and a sid with
+// identifier authority that is displayed as hex
+const QList<QString> sid_string_list = {
+    "S-1-1-0",
+    "S-1-5-32-544",
+    "S-1-5-21-3623811015-3361044348-30300820-1013",
+    "S-1-5-21-4294967295-4294967295-4294967295-4294967295",
+    "S-1-0x123456789abc-1-2",
+};
+
+const QList<QString> guid_string_list = {
+    "00000000-0000-0000-0000-000000000000",
+    "bf967aba-0de6-11d0-a285-00aa003049e2",
+    "ffffffff-ffff-ffff-ffff-ffffffffffff",
+    "4828cc14-1437-45bc-9b07-ad6f015e5f28",
+};
+
+// NOTE: internal to ad_security.cpp, declared here to test
+// it directly
+dom_sid dom_sid_from_bytes(const QByteArray &bytes);
+
+void ADMCTestSidGuid::equivalence_sid() {
+    for (const QString &sid_string : sid_string_list) {
+        const QByteArray legacy_bytes = legacy_sid_from_string(sid_string);
+        const QByteArray bytes = sid_string_to_bytes(sid_string);
+        QCOMPARE(bytes, legacy_bytes);
+
+        const QByteArray server_bytes = sid_bytes_as_from_server(bytes);
+        QCOMPARE(object_sid_display_value(server_bytes), legacy_sid_to_string(server_bytes));
+        QCOMPARE(object_sid_display_value(bytes), legacy_sid_to_string(bytes));
+
+        // NOTE: strings are already in canonical form, so
+        // they should survive a round trip unchanged
+        QCOMPARE(object_sid_display_value(bytes), sid_string);
+    }
+
+    // NOTE: lower case prefix, leading zeroes and hex
+    // sub auths are accepted by samba parser
+    const QList<QString> unusual_sid_string_list = {
+        "s-1-5-32-544",
+        "S-1-5-021-0544",
+        "S-1-5-0x20-0x220",
+    };
+
+    for (const QString &sid_string : unusual_sid_string_list) {
+        QCOMPARE(sid_string_to_bytes(sid_string), legacy_sid_from_string(sid_string));
+    }
+
+    const QList<QString> invalid_sid_string_list = {
+        "",
+        "S-",
+        "X-1-5",
+        "S-1-5-",
+        "S-1-0x1000000000000",
+        "S-1-5-1-2-3-4-5-6-7-8-9-10-11-12-13-14-15-16",
+    };
+
+    for (const QString &sid_string : invalid_sid_string_list) {
+        QCOMPARE(sid_string_to_bytes(sid_string), QByteArray());
+    }
+
+    QCOMPARE(object_sid_display_value(QByteArray()), QString());
+    QCOMPARE(object_sid_display_value(QByteArray(10, '\0')), QString());
+}
+
+void ADMCTestSidGuid::equivalence_guid() {
+    for (const QString &guid_string : guid_string_list) {
+        const QByteArray legacy_bytes = legacy_guid_from_string(guid_string);
+        const QByteArray bytes = guid_string_to_bytes(guid_string);
+        QCOMPARE(bytes, legacy_bytes);
+
+        QCOMPARE(guid_to_display_value(bytes), legacy_guid_to_string(bytes));
+        QCOMPARE(guid_to_display_value(bytes), guid_string);
+
+        const QString upper_string = guid_string.toUpper();
+        QCOMPARE(guid_string_to_bytes(upper_string), bytes);
+
+        const QString braces_string = QString("{%1}").arg(guid_string);
+        QCOMPARE(guid_string_to_bytes(braces_string), bytes);
+    }
+
+    const QList<QString> invalid_guid_string_list = {
+        "",
+        "bf967aba-0de6-11d0-a285",
+        "bf967aba0de611d0a28500aa003049e2",
+        "bf967aba-0de6-11d0-a285-00aa003049eg",
+        "{bf967aba-0de6-11d0-a285-00aa003049e2",
+    };
+
+    for (const QString &guid_string : invalid_guid_string_list) {
+        QCOMPARE(guid_string_to_bytes(guid_string), QByteArray());
+    }
+
+    QCOMPARE(guid_to_display_value(QByteArray(8, '\0')), QString());
+}
+
+void ADMCTestSidGuid::truncated_sid() {
+    const QByteArray full_bytes = sid_string_to_bytes("S-1-5-21-3623811015-3361044348-30300820-1013");
+    const QByteArray server_bytes = sid_bytes_as_from_server(full_bytes);
+
+    // NOTE: sub auth count says there are 5 sub auths, but
+    // some of them are cut off
+    const QList<int> truncated_size_list = {
+        0,
+        1,
+        7,
+        8,
+        12,
+        server_bytes.size() - 1,
+    };
+
+    for (const int size : truncated_size_list) {
+        const QByteArray truncated_bytes = server_bytes.left(size);
+
+        QCOMPARE(object_sid_display_value(truncated_bytes), QString());
+
+        char buffer[SID_STRING_BUFFER_SIZE];
+        QCOMPARE(sid_to_string_buffer(truncated_bytes.constData(), truncated_bytes.size(), buffer), -1);
+
+        // NOTE: only the bytes that are present should be
+        // copied, the rest of the struct is zeroed
+        const dom_sid sid = dom_sid_from_bytes(truncated_bytes);
+        const QByteArray sid_bytes = QByteArray((const char *) &sid, sizeof(dom_sid));
+        QCOMPARE(sid_bytes.left(size), truncated_bytes);
+        QCOMPARE(sid_bytes.mid(size), QByteArray((int) sizeof(dom_sid) - size, '\0'));
+    }
+
+    // NOTE: sid from server is shorter than dom_sid, sid
+    // read from it should be the same as full sid
+    const dom_sid server_sid = dom_sid_from_bytes(server_bytes);
+    QCOMPARE(QByteArray((const char *) &server_sid, sizeof(dom_sid)), full_bytes);
+
+    // NOTE: extra bytes past the end of dom_sid are ignored
+    const QByteArray oversized_bytes = full_bytes + QByteArray(16, '\xff');
+    const dom_sid oversized_sid = dom_sid_from_bytes(oversized_bytes);
+    QCOMPARE(QByteArray((const char *) &oversized_sid, sizeof(dom_sid)), full_bytes);
+
+    // NOTE: sub auth count above max is invalid even if
+    // there are enough bytes
+    QByteArray too_many_auths_bytes = full_bytes + QByteArray(4, '\0');
+    too_many_auths_bytes[1] = 16;
+    QCOMPARE(object_sid_display_value(too_many_auths_bytes), QString());
+}
+
+void ADMCTestSidGuid::truncated_guid() {
+    const QByteArray bytes = guid_string_to_bytes("bf967aba-0de6-11d0-a285-00aa003049e2");
+
+    for (int size = 0; size < GUID_BYTES_SIZE; size++) {
+        QCOMPARE(guid_to_display_value(bytes.left(size)), QString());
+    }
+}
+
+QTEST_GUILESS_MAIN(ADMCTestSidGuid)
@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+#
+# ADMC - AD Management Center
+#
+# Copyright (C) 2020-2022 BaseALT Ltd.
+# Copyright (C) 2020-2022 Dmitry Degtyarev
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Compares two directories of benchmark results saved by
+# the "benchmark" target. Prints change of every result
+# and exits with 1 if any result got slower by more than
+# the threshold.
+#
+# Usage: compare_benchmarks.py OLD_DIR NEW_DIR [--threshold PERCENT]
+
+import argparse
+import glob
+import os
+import sys
+import xml.etree.ElementTree as ElementTree
+
+
+# Returns {(benchmark, function, tag, metric): value}
+def load_results(results_dir):
+    out = {}
+
+    for path in sorted(glob.glob(os.path.join(results_dir, "*.xml"))):
+        benchmark = os.path.splitext(os.path.basename(path))[0]
+        root = ElementTree.parse(path).getroot()
+
+        for function in root.iter("TestFunction"):
+            for result in function.iter("BenchmarkResult"):
+                key = (benchmark, function.get("name"), result.get("tag"), result.get("metric"))
+                out[key] = float(result.get("value"))
+
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare benchmark results of two builds.")
+    parser.add_argument("old_dir")
+    parser.add_argument("new_dir")
+    parser.add_argument("--threshold", type=float, default=10.0, help="max allowed slowdown in percent (default: 10)")
+    args = parser.parse_args()
+
+    old_results = load_results(args.old_dir)
+    new_results = load_results(args.new_dir)
+
+    regression_count = 0
+
+    for key in sorted(new_results.keys()):
+        benchmark, function, tag, metric = key
+        name = "%s::%s(%s)" % (benchmark, function, tag)
+        new_value = new_results[key]
+
+        if key not in old_results:
+            print("%-80s %12.6g %s (new)" % (name, new_value, metric))
+            continue
+
+        old_value = old_results[key]
+        if old_value > 0:
+            change = (new_value - old_value) / old_value * 100.0
+        else:
+            change = 0.0
+
+        # NOTE: all metrics measure cost, so bigger values
+        # are worse
+        is_regression = (change > args.threshold)
+        if is_regression:
+            regression_count += 1
+
+        marker = "REGRESSION" if is_regression else ""
+        print("%-80s %12.6g -> %12.6g %s %+7.1f%% %s" % (name, old_value, new_value, metric, change, marker))
+
+    if regression_count > 0:
+        print("\n%d result(s) slower by more than %.1f%%" % (regression_count, args.threshold))
+
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
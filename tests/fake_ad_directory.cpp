@@ -0,0 +1,1522 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fake_ad_directory.h"
+
+#include "ad_display.h"
+#include "ad_dn.h"
+
+#include <ldap.h>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QSet>
+
+class FakeAdAttributeSchema {
+public:
+    QString name;
+    QString syntax;
+    int om_syntax;
+    bool is_single_valued;
+    bool is_system_only;
+    int link_id;
+};
+
+class FakeAdClassSchema {
+public:
+    QString name;
+    QString cn;
+    QString sub_class_of;
+    QString category_cn;
+    QList<QString> poss_superiors;
+    QList<QString> may_contain;
+};
+
+const QList<FakeAdAttributeSchema> &fake_ad_attribute_schema_list();
+const QList<FakeAdClassSchema> &fake_ad_class_schema_list();
+const FakeAdClassSchema *fake_ad_class_schema(const QString &object_class);
+QList<QString> fake_ad_class_chain(const QString &object_class);
+int fake_ad_value_index(const QList<QByteArray> &value_list, const QByteArray &value);
+QByteArray fake_ad_guid(const QString &seed);
+QString fake_ad_guid_string(const QString &seed);
+QString fake_ad_time_string(const qint64 usn);
+QByteArray fake_ad_security_descriptor(const QByteArray &admins_sid);
+void fake_ad_append_u16(QByteArray *out, const quint16 value);
+void fake_ad_append_u32(QByteArray *out, const quint32 value);
+QList<QByteArray> fake_ad_values(const QList<QString> &string_list);
+FakeAdAttribute fake_ad_attribute(const QString &name, const QList<QString> &value_list);
+
+#define FAKE_AD_ADMINS_RID 512
+#define FAKE_AD_USERS_RID 513
+#define FAKE_AD_COMPUTERS_RID 515
+
+bool FakeAdEntry::contains(const QString &attribute) const {
+    return attributes.contains(attribute.toLower());
+}
+
+QList<QByteArray> FakeAdEntry::get_values(const QString &attribute) const {
+    return attributes.value(attribute.toLower()).values;
+}
+
+QByteArray FakeAdEntry::get_value(const QString &attribute) const {
+    const QList<QByteArray> values = get_values(attribute);
+
+    if (values.isEmpty()) {
+        return QByteArray();
+    } else {
+        return values[0];
+    }
+}
+
+void FakeAdEntry::set_values(const QString &attribute, const QList<QByteArray> &values) {
+    const QString key = attribute.toLower();
+
+    if (values.isEmpty()) {
+        attributes.remove(key);
+
+        return;
+    }
+
+    // NOTE: keep original capitalization of the name
+    FakeAdAttribute &stored = attributes[key];
+    if (stored.name.isEmpty()) {
+        stored.name = attribute;
+    }
+    stored.values = values;
+}
+
+FakeAdDirectory::FakeAdDirectory(const QString &domain) {
+    m_domain = domain.toUpper();
+
+    m_domain_dn = [&]() {
+        const QList<QString> part_list = domain.toLower().split('.');
+
+        QList<QString> rdn_list;
+        for (const QString &part : part_list) {
+            rdn_list.append(QString("DC=%1").arg(part));
+        }
+
+        return rdn_list.join(',');
+    }();
+
+    next_rid = 1000;
+    next_usn = 1;
+
+    // S-1-5-21-1111111111-2222222222-3333333333
+    domain_sid = [&]() {
+        QByteArray out;
+        out.append((char) 1);
+        out.append((char) 4);
+        out.append(QByteArray("\x00\x00\x00\x00\x00\x05", 6));
+        fake_ad_append_u32(&out, 21);
+        fake_ad_append_u32(&out, 1111111111u);
+        fake_ad_append_u32(&out, 2222222222u);
+        fake_ad_append_u32(&out, 3333333333u);
+
+        return out;
+    }();
+
+    root_dse.dn = QString();
+    root_dse.set_values("defaultNamingContext", {m_domain_dn.toUtf8()});
+    root_dse.set_values("rootDomainNamingContext", {m_domain_dn.toUtf8()});
+    root_dse.set_values("configurationNamingContext", {configuration_dn().toUtf8()});
+    root_dse.set_values("schemaNamingContext", {schema_dn().toUtf8()});
+    root_dse.set_values("namingContexts", fake_ad_values({m_domain_dn, configuration_dn(), schema_dn()}));
+    root_dse.set_values("dnsHostName", {QString("dc1.%1").arg(domain.toLower()).toUtf8()});
+    root_dse.set_values("supportedLDAPVersion", {"3"});
+    root_dse.set_values("supportedSASLMechanisms", {"GSSAPI"});
+    root_dse.set_values("domainFunctionality", {"7"});
+    root_dse.set_values("forestFunctionality", {"7"});
+    root_dse.set_values("domainControllerFunctionality", {"7"});
+    root_dse.set_values("isGlobalCatalogReady", {"TRUE"});
+    root_dse.set_values("supportedControl", {
+        LDAP_CONTROL_PAGEDRESULTS,
+        "1.2.840.113556.1.4.801",
+        LDAP_CONTROL_X_TREE_DELETE,
+    });
+}
+
+void FakeAdDirectory::populate(const FakeAdDomainSize &size) {
+    auto add_object = [&](const QString &dn, const QString &object_class, QList<FakeAdAttribute> attribute_list) {
+        attribute_list.append(fake_ad_attribute("objectClass", {object_class}));
+
+        add(dn, attribute_list);
+    };
+
+    auto policy_dn = [&](const QString &guid) {
+        return QString("CN=%1,CN=Policies,CN=System,%2").arg(guid, m_domain_dn);
+    };
+
+    auto gplink = [&](const QString &guid) {
+        return QString("[LDAP://cn=%1,cn=policies,cn=system,%2;0]").arg(guid.toLower(), m_domain_dn);
+    };
+
+    const QString default_policy_guid = "{31B2F340-016D-11D2-945F-00C04FB984F9}";
+
+    const QList<QString> gpo_guid_list = [&]() {
+        QList<QString> out;
+
+        for (int i = 0; i < size.gpos; i++) {
+            out.append(fake_ad_guid_string(QString("gpo-%1").arg(i)));
+        }
+
+        return out;
+    }();
+
+    //
+    // Domain
+    //
+    {
+        FakeAdAttribute sid_attribute;
+        sid_attribute.name = "objectSid";
+        sid_attribute.values = {domain_sid};
+
+        add_object(m_domain_dn, "domainDNS", {
+            sid_attribute,
+            fake_ad_attribute("gPLink", {gplink(default_policy_guid)}),
+            fake_ad_attribute("maxPwdAge", {"-37108517437440"}),
+            fake_ad_attribute("minPwdAge", {"-864000000000"}),
+            fake_ad_attribute("lockoutDuration", {"-18000000000"}),
+            fake_ad_attribute("lockOutObservationWindow", {"-18000000000"}),
+        });
+    }
+
+    const QString users_dn = QString("CN=Users,%1").arg(m_domain_dn);
+    const QString system_dn = QString("CN=System,%1").arg(m_domain_dn);
+
+    add_object(users_dn, "container", {});
+    add_object(QString("CN=Computers,%1").arg(m_domain_dn), "container", {});
+    add_object(QString("CN=Builtin,%1").arg(m_domain_dn), "builtinDomain", {});
+    add_object(QString("OU=Domain Controllers,%1").arg(m_domain_dn), "organizationalUnit", {});
+    add_object(system_dn, "container", {});
+    add_object(QString("CN=Policies,%1").arg(system_dn), "container", {});
+    add_object(QString("CN=Password Settings Container,%1").arg(system_dn), "msDS-PasswordSettingsContainer", {});
+
+    // NOTE: like in AD, the container itself is marked as
+    // deleted, so it's only visible with show deleted
+    // control
+    add_object(deleted_objects_dn(), "container", {
+        fake_ad_attribute("isDeleted", {"TRUE"}),
+    });
+
+    //
+    // Configuration and schema
+    //
+    add_object(configuration_dn(), "configuration", {});
+    add_object(schema_dn(), "dMD", {});
+    add_schema();
+
+    const QString extended_rights_dn = QString("CN=Extended-Rights,%1").arg(configuration_dn());
+    add_object(extended_rights_dn, "container", {});
+
+    const QList<QList<QString>> right_list = {
+        {"User-Force-Change-Password", "Reset Password", "00299570-246d-11d0-a768-00aa006e0529", "user"},
+        {"Send-As", "Send As", "ab721a54-1e2f-11d0-9819-00aa0040529b", "user"},
+        {"Allowed-To-Authenticate", "Allowed to Authenticate", "68b1d179-0d15-4d4f-ab71-46152e79a7bc", "computer"},
+    };
+
+    for (const QList<QString> &right : right_list) {
+        const QString applies_to = guid_to_display_value(fake_ad_guid("class:" + right[3]));
+
+        add_object(QString("CN=%1,%2").arg(right[0], extended_rights_dn), "controlAccessRight", {
+            fake_ad_attribute("displayName", {right[1]}),
+            fake_ad_attribute("rightsGuid", {right[2]}),
+            fake_ad_attribute("appliesTo", {applies_to}),
+            fake_ad_attribute("validAccesses", {"256"}),
+        });
+    }
+
+    add_display_specifiers();
+
+    //
+    // Well-known principals
+    //
+    const QString admin_dn = QString("CN=Administrator,%1").arg(users_dn);
+    {
+        FakeAdAttribute sid_attribute;
+        sid_attribute.name = "objectSid";
+        sid_attribute.values = {make_sid(500)};
+
+        add_object(admin_dn, "user", {
+            sid_attribute,
+            fake_ad_attribute("sAMAccountName", {"Administrator"}),
+            fake_ad_attribute("userAccountControl", {"512"}),
+        });
+    }
+
+    const QList<QList<QString>> well_known_group_list = {
+        {"Domain Admins", QString::number(FAKE_AD_ADMINS_RID)},
+        {"Domain Users", QString::number(FAKE_AD_USERS_RID)},
+        {"Domain Computers", QString::number(FAKE_AD_COMPUTERS_RID)},
+    };
+
+    for (const QList<QString> &group : well_known_group_list) {
+        const int rid = group[1].toInt();
+
+        FakeAdAttribute sid_attribute;
+        sid_attribute.name = "objectSid";
+        sid_attribute.values = {make_sid(rid)};
+
+        QList<FakeAdAttribute> attribute_list = {
+            sid_attribute,
+            fake_ad_attribute("sAMAccountName", {group[0]}),
+        };
+
+        if (rid == FAKE_AD_ADMINS_RID) {
+            attribute_list.append(fake_ad_attribute("member", {admin_dn}));
+        }
+
+        add_object(QString("CN=%1,%2").arg(group[0], users_dn), "group", attribute_list);
+    }
+
+    //
+    // Policies
+    //
+    auto add_policy = [&](const QString &guid, const QString &display_name) {
+        const QString dn = policy_dn(guid);
+        const QString file_sys_path = QString("\\\\%1\\SysVol\\%1\\Policies\\%2").arg(m_domain.toLower(), guid);
+
+        add_object(dn, "groupPolicyContainer", {
+            fake_ad_attribute("displayName", {display_name}),
+            fake_ad_attribute("gPCFileSysPath", {file_sys_path}),
+            fake_ad_attribute("gPCFunctionalityVersion", {"2"}),
+            fake_ad_attribute("versionNumber", {"0"}),
+            fake_ad_attribute("flags", {"0"}),
+        });
+
+        add_object(QString("CN=User,%1").arg(dn), "container", {});
+        add_object(QString("CN=Machine,%1").arg(dn), "container", {});
+    };
+
+    add_policy(default_policy_guid, "Default Domain Policy");
+
+    for (int i = 0; i < gpo_guid_list.size(); i++) {
+        add_policy(gpo_guid_list[i], QString("Policy-%1").arg(i));
+    }
+
+    //
+    // OU's, users and groups
+    //
+    const QList<QString> ou_dn_list = [&]() {
+        QList<QString> out;
+
+        for (int i = 0; i < size.ous; i++) {
+            const QString dn = QString("OU=OU-%1,%2").arg(i).arg(m_domain_dn);
+
+            QList<FakeAdAttribute> attribute_list = {
+                fake_ad_attribute("description", {QString("Generated OU %1").arg(i)}),
+            };
+
+            if (!gpo_guid_list.isEmpty()) {
+                const QString guid = gpo_guid_list[i % gpo_guid_list.size()];
+                attribute_list.append(fake_ad_attribute("gPLink", {gplink(guid)}));
+            }
+
+            add_object(dn, "organizationalUnit", attribute_list);
+
+            out.append(dn);
+        }
+
+        return out;
+    }();
+
+    auto parent_for_index = [&](const int i) {
+        if (ou_dn_list.isEmpty()) {
+            return users_dn;
+        } else {
+            return ou_dn_list[i % ou_dn_list.size()];
+        }
+    };
+
+    QList<QString> user_dn_list;
+
+    for (int i = 0; i < size.users; i++) {
+        const QString name = QString("User-%1").arg(i);
+        const QString dn = QString("CN=%1,%2").arg(name, parent_for_index(i));
+        const QString logon_name = name.toLower();
+
+        add_object(dn, "user", {
+            fake_ad_attribute("sAMAccountName", {logon_name}),
+            fake_ad_attribute("userPrincipalName", {QString("%1@%2").arg(logon_name, m_domain.toLower())}),
+            fake_ad_attribute("givenName", {"User"}),
+            fake_ad_attribute("sn", {QString::number(i)}),
+            fake_ad_attribute("displayName", {name}),
+            fake_ad_attribute("description", {QString("Generated user %1").arg(i)}),
+            fake_ad_attribute("mail", {QString("%1@%2").arg(logon_name, m_domain.toLower())}),
+        });
+
+        user_dn_list.append(dn);
+    }
+
+    for (int i = 0; i < size.groups; i++) {
+        const QString name = QString("Group-%1").arg(i);
+        const QString dn = QString("CN=%1,%2").arg(name, parent_for_index(i));
+
+        const QList<QString> member_list = [&]() {
+            QList<QString> out;
+
+            if (user_dn_list.isEmpty()) {
+                return out;
+            }
+
+            for (int j = 0; j < size.members_per_group; j++) {
+                const int user_i = (i * size.members_per_group + j) % user_dn_list.size();
+                const QString member = user_dn_list[user_i];
+
+                if (!out.contains(member)) {
+                    out.append(member);
+                }
+            }
+
+            return out;
+        }();
+
+        QList<FakeAdAttribute> attribute_list = {
+            fake_ad_attribute("sAMAccountName", {name.toLower()}),
+            fake_ad_attribute("description", {QString("Generated group %1").arg(i)}),
+        };
+
+        if (!member_list.isEmpty()) {
+            attribute_list.append(fake_ad_attribute("member", member_list));
+        }
+
+        add_object(dn, "group", attribute_list);
+    }
+}
+
+QString FakeAdDirectory::domain() const {
+    return m_domain;
+}
+
+QString FakeAdDirectory::domain_dn() const {
+    return m_domain_dn;
+}
+
+QString FakeAdDirectory::configuration_dn() const {
+    return QString("CN=Configuration,%1").arg(m_domain_dn);
+}
+
+QString FakeAdDirectory::schema_dn() const {
+    return QString("CN=Schema,%1").arg(configuration_dn());
+}
+
+QString FakeAdDirectory::deleted_objects_dn() const {
+    return QString("CN=Deleted Objects,%1").arg(m_domain_dn);
+}
+
+int FakeAdDirectory::entry_count() const {
+    return entry_map.size();
+}
+
+int FakeAdDirectory::search(const QString &base, const int scope, const FakeAdFilter &filter, QList<const FakeAdEntry *> *results, const bool show_deleted) const {
+    results->clear();
+
+    if (base.isEmpty()) {
+        if (scope != LDAP_SCOPE_BASE) {
+            return LDAP_NO_SUCH_OBJECT;
+        }
+
+        if (filter_match(filter, root_dse)) {
+            results->append(&root_dse);
+        }
+
+        return LDAP_SUCCESS;
+    }
+
+    const QString base_key = base.toLower();
+
+    const auto base_it = entry_map.constFind(base_key);
+    if (base_it == entry_map.constEnd()) {
+        return LDAP_NO_SUCH_OBJECT;
+    }
+
+    if (!show_deleted && is_deleted(base_it.value())) {
+        return LDAP_NO_SUCH_OBJECT;
+    }
+
+    QList<QString> candidate_list;
+
+    switch (scope) {
+        case LDAP_SCOPE_BASE: {
+            candidate_list.append(base_key);
+
+            break;
+        }
+        case LDAP_SCOPE_ONELEVEL: {
+            candidate_list = children_map.value(base_key);
+
+            break;
+        }
+        case LDAP_SCOPE_SUBTREE: {
+            candidate_list.append(base_key);
+            collect_subtree(base_key, &candidate_list);
+
+            break;
+        }
+        case LDAP_SCOPE_CHILDREN: {
+            collect_subtree(base_key, &candidate_list);
+
+            break;
+        }
+        default: return LDAP_PROTOCOL_ERROR;
+    }
+
+    for (const QString &key : candidate_list) {
+        const auto it = entry_map.constFind(key);
+        if (it == entry_map.constEnd()) {
+            continue;
+        }
+
+        const FakeAdEntry &entry = it.value();
+
+        if (!show_deleted && is_deleted(entry)) {
+            continue;
+        }
+
+        if (filter_match(filter, entry)) {
+            results->append(&entry);
+        }
+    }
+
+    return LDAP_SUCCESS;
+}
+
+const FakeAdEntry *FakeAdDirectory::get_entry(const QString &dn) const {
+    const auto it = entry_map.constFind(dn.toLower());
+
+    if (it == entry_map.constEnd()) {
+        return nullptr;
+    } else {
+        return &it.value();
+    }
+}
+
+int FakeAdDirectory::add(const QString &dn, const QList<FakeAdAttribute> &attribute_list) {
+    const QString key = dn.toLower();
+
+    if (entry_map.contains(key)) {
+        return LDAP_ALREADY_EXISTS;
+    }
+
+    const DnView dn_view(dn);
+    if (!dn_view.is_valid() || dn_view.rdn_count() == 0) {
+        return LDAP_INVALID_DN_SYNTAX;
+    }
+
+    // NOTE: naming contexts are separate partitions, so
+    // they are not children of their parent objects and
+    // don't need them to exist
+    const bool is_naming_context = (key == m_domain_dn.toLower() || key == configuration_dn().toLower() || key == schema_dn().toLower());
+
+    const QString parent_key = dn_view.parent().toString().toLower();
+    if (!is_naming_context && !entry_map.contains(parent_key)) {
+        return LDAP_NO_SUCH_OBJECT;
+    }
+
+    FakeAdEntry entry;
+    entry.dn = dn;
+
+    for (const FakeAdAttribute &attribute : attribute_list) {
+        const QList<QByteArray> values = entry.get_values(attribute.name) + attribute.values;
+        entry.set_values(attribute.name, values);
+    }
+
+    if (!entry.contains("objectClass")) {
+        return LDAP_OBJECT_CLASS_VIOLATION;
+    }
+
+    // NOTE: AD fills in superclasses, with the most
+    // derived class last
+    const QList<QString> class_chain = [&]() {
+        QList<QString> out;
+
+        for (const QByteArray &object_class : entry.get_values("objectClass")) {
+            const QList<QString> chain = fake_ad_class_chain(QString(object_class));
+
+            if (chain.size() > out.size()) {
+                out = chain;
+            }
+        }
+
+        return out;
+    }();
+    entry.set_values("objectClass", fake_ad_values(class_chain));
+
+    add_generated_attributes(&entry);
+
+    const QList<QByteArray> member_list = entry.get_values("member");
+
+    entry_map.insert(key, entry);
+
+    if (!is_naming_context) {
+        children_map[parent_key].append(key);
+    }
+
+    if (!member_list.isEmpty()) {
+        update_member_links(dn, QList<QByteArray>(), member_list);
+    }
+
+    return LDAP_SUCCESS;
+}
+
+int FakeAdDirectory::modify(const QString &dn, const QList<FakeAdModification> &modification_list) {
+    const auto it = entry_map.find(dn.toLower());
+    if (it == entry_map.end()) {
+        return LDAP_NO_SUCH_OBJECT;
+    }
+
+    FakeAdEntry entry = it.value();
+    const QList<QByteArray> old_member_list = entry.get_values("member");
+
+    for (const FakeAdModification &modification : modification_list) {
+        const QString attribute_key = modification.attribute.toLower();
+
+        // NOTE: AD never returns passwords, so accept
+        // password changes without storing them
+        if (attribute_key == "unicodepwd" || attribute_key == "userpassword") {
+            continue;
+        }
+
+        QList<QByteArray> values = entry.get_values(modification.attribute);
+
+        switch (modification.operation) {
+            case LDAP_MOD_ADD: {
+                for (const QByteArray &value : modification.values) {
+                    if (fake_ad_value_index(values, value) != -1) {
+                        return LDAP_TYPE_OR_VALUE_EXISTS;
+                    }
+
+                    values.append(value);
+                }
+
+                break;
+            }
+            case LDAP_MOD_DELETE: {
+                if (!entry.contains(modification.attribute)) {
+                    return LDAP_NO_SUCH_ATTRIBUTE;
+                }
+
+                if (modification.values.isEmpty()) {
+                    values.clear();
+                }
+
+                for (const QByteArray &value : modification.values) {
+                    const int index = fake_ad_value_index(values, value);
+                    if (index == -1) {
+                        return LDAP_NO_SUCH_ATTRIBUTE;
+                    }
+
+                    values.removeAt(index);
+                }
+
+                break;
+            }
+            case LDAP_MOD_REPLACE: {
+                values = modification.values;
+
+                break;
+            }
+            default: return LDAP_UNWILLING_TO_PERFORM;
+        }
+
+        entry.set_values(modification.attribute, values);
+    }
+
+    touch(&entry);
+
+    const QList<QByteArray> new_member_list = entry.get_values("member");
+
+    it.value() = entry;
+
+    update_member_links(entry.dn, old_member_list, new_member_list);
+
+    return LDAP_SUCCESS;
+}
+
+int FakeAdDirectory::remove(const QString &dn, const bool tree_delete) {
+    const QString key = dn.toLower();
+
+    if (!entry_map.contains(key)) {
+        return LDAP_NO_SUCH_OBJECT;
+    }
+
+    QList<QString> subtree_list;
+    collect_subtree(key, &subtree_list);
+
+    if (!subtree_list.isEmpty() && !tree_delete) {
+        return LDAP_NOT_ALLOWED_ON_NONLEAF;
+    }
+
+    // NOTE: delete children before parents
+    const QList<QString> delete_list = QList<QString>({key}) + subtree_list;
+    QList<FakeAdEntry> deleted_list;
+
+    for (int i = delete_list.size() - 1; i >= 0; i--) {
+        const QString &delete_key = delete_list[i];
+        const FakeAdEntry entry = entry_map.take(delete_key);
+        deleted_list.append(entry);
+
+        update_member_links(entry.dn, entry.get_values("member"), QList<QByteArray>());
+
+        for (const QByteArray &group_dn : entry.get_values("memberOf")) {
+            const auto group_it = entry_map.find(QString(group_dn).toLower());
+            if (group_it == entry_map.end()) {
+                continue;
+            }
+
+            FakeAdEntry &group = group_it.value();
+            QList<QByteArray> member_list = group.get_values("member");
+            const int index = fake_ad_value_index(member_list, entry.dn.toUtf8());
+            if (index != -1) {
+                member_list.removeAt(index);
+                group.set_values("member", member_list);
+            }
+        }
+
+        children_map.remove(delete_key);
+    }
+
+    const QString parent_key = DnView(dn).parent().toString().toLower();
+    children_map[parent_key].removeAll(key);
+
+    // NOTE: deleting a tombstone removes it for good
+    for (const FakeAdEntry &entry : deleted_list) {
+        if (!is_deleted(entry)) {
+            add_tombstone(entry);
+        }
+    }
+
+    return LDAP_SUCCESS;
+}
+
+int FakeAdDirectory::rename(const QString &dn, const QString &new_rdn, const QString &new_superior) {
+    const QString key = dn.toLower();
+
+    if (!entry_map.contains(key)) {
+        return LDAP_NO_SUCH_OBJECT;
+    }
+
+    const QString old_parent = DnView(dn).parent().toString();
+    const QString new_parent = [&]() {
+        if (new_superior.isEmpty()) {
+            return old_parent;
+        } else {
+            return new_superior;
+        }
+    }();
+    const QString new_parent_key = new_parent.toLower();
+
+    if (!entry_map.contains(new_parent_key)) {
+        return LDAP_NO_SUCH_OBJECT;
+    }
+
+    const QString new_dn = QString("%1,%2").arg(new_rdn, new_parent);
+    const QString new_key = new_dn.toLower();
+
+    if (new_key != key && entry_map.contains(new_key)) {
+        return LDAP_ALREADY_EXISTS;
+    }
+
+    // NOTE: can't move object into itself
+    if (new_parent_key == key || new_parent_key.endsWith("," + key)) {
+        return LDAP_UNWILLING_TO_PERFORM;
+    }
+
+    QList<QString> move_list = {key};
+    collect_subtree(key, &move_list);
+
+    // Move entries to new keys
+    QHash<QString, QString> old_to_new_dn_map;
+    QList<QString> new_key_list;
+
+    for (const QString &old_key : move_list) {
+        FakeAdEntry entry = entry_map.take(old_key);
+        children_map.remove(old_key);
+
+        const QString old_entry_dn = entry.dn;
+        const QString new_entry_dn = old_entry_dn.left(old_entry_dn.size() - dn.size()) + new_dn;
+
+        entry.dn = new_entry_dn;
+        entry.set_values("distinguishedName", {new_entry_dn.toUtf8()});
+
+        if (old_key == key) {
+            const DnView new_dn_view(new_dn);
+            const QByteArray name = new_dn_view.name().toUtf8();
+
+            entry.set_values(new_dn_view.rdn_type().toString().toLower(), {name});
+            entry.set_values("name", {name});
+            touch(&entry);
+        }
+
+        const QString new_entry_key = new_entry_dn.toLower();
+        entry_map.insert(new_entry_key, entry);
+        new_key_list.append(new_entry_key);
+        old_to_new_dn_map[old_key] = new_entry_dn;
+    }
+
+    // Rebuild children lists, parents come before
+    // children in move list
+    children_map[old_parent.toLower()].removeAll(key);
+    children_map[new_parent_key].append(new_key);
+
+    for (int i = 1; i < new_key_list.size(); i++) {
+        const QString &child_key = new_key_list[i];
+        const QString parent_key = DnView(child_key).parent().toString();
+        children_map[parent_key].append(child_key);
+    }
+
+    // Update membership references to moved objects
+    auto map_dn = [&](const QByteArray &value) {
+        const QString value_key = QString(value).toLower();
+
+        if (old_to_new_dn_map.contains(value_key)) {
+            return old_to_new_dn_map[value_key].toUtf8();
+        } else {
+            return value;
+        }
+    };
+
+    const QList<QList<QString>> link_list = {
+        {"member", "memberOf"},
+        {"memberOf", "member"},
+    };
+
+    for (int i = 0; i < move_list.size(); i++) {
+        FakeAdEntry &entry = entry_map[new_key_list[i]];
+
+        for (const QList<QString> &link : link_list) {
+            QList<QByteArray> values = entry.get_values(link[0]);
+            for (QByteArray &value : values) {
+                value = map_dn(value);
+            }
+            entry.set_values(link[0], values);
+
+            for (const QByteArray &value : values) {
+                const QString target_key = QString(value).toLower();
+                if (new_key_list.contains(target_key)) {
+                    continue;
+                }
+
+                const auto target_it = entry_map.find(target_key);
+                if (target_it == entry_map.end()) {
+                    continue;
+                }
+
+                FakeAdEntry &target = target_it.value();
+                QList<QByteArray> target_values = target.get_values(link[1]);
+                const int index = fake_ad_value_index(target_values, move_list[i].toUtf8());
+                if (index != -1) {
+                    target_values[index] = entry.dn.toUtf8();
+                    target.set_values(link[1], target_values);
+                }
+            }
+        }
+    }
+
+    return LDAP_SUCCESS;
+}
+
+bool FakeAdDirectory::filter_match(const FakeAdFilter &filter, const FakeAdEntry &entry) const {
+    switch (filter.type) {
+        case LDAP_FILTER_AND: {
+            for (const FakeAdFilter &child : filter.children) {
+                if (!filter_match(child, entry)) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+        case LDAP_FILTER_OR: {
+            for (const FakeAdFilter &child : filter.children) {
+                if (filter_match(child, entry)) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+        case LDAP_FILTER_NOT: {
+            if (filter.children.isEmpty()) {
+                return false;
+            }
+
+            return !filter_match(filter.children[0], entry);
+        }
+        case LDAP_FILTER_PRESENT: {
+            // NOTE: every object has an objectClass,
+            // including rootDSE
+            if (filter.attribute.compare("objectClass", Qt::CaseInsensitive) == 0) {
+                return true;
+            }
+
+            return entry.contains(filter.attribute);
+        }
+        case LDAP_FILTER_EQUALITY:
+        case LDAP_FILTER_APPROX: {
+            const QList<QByteArray> values = entry.get_values(filter.attribute);
+
+            // NOTE: AD allows filtering category by class
+            // name, like "(objectCategory=person)"
+            const bool is_category_name = (filter.attribute.compare("objectCategory", Qt::CaseInsensitive) == 0 && !filter.value.contains('='));
+            const QByteArray target = [&]() {
+                if (is_category_name) {
+                    const FakeAdClassSchema *schema = fake_ad_class_schema(QString(filter.value));
+                    const QString category_cn = (schema != nullptr ? schema->category_cn : QString(filter.value));
+
+                    return QString("CN=%1,%2").arg(category_cn, schema_dn()).toUtf8();
+                } else {
+                    return filter.value;
+                }
+            }();
+
+            return (fake_ad_value_index(values, target) != -1);
+        }
+        case LDAP_FILTER_SUBSTRINGS: {
+            const QByteArray initial = filter.substring_initial.toLower();
+            const QByteArray final = filter.substring_final.toLower();
+
+            for (const QByteArray &value_original : entry.get_values(filter.attribute)) {
+                const QByteArray value = value_original.toLower();
+
+                if (!value.startsWith(initial) || !value.endsWith(final)) {
+                    continue;
+                }
+
+                int position = initial.size();
+                bool any_match = true;
+
+                for (const QByteArray &any : filter.substring_any) {
+                    const int index = value.indexOf(any.toLower(), position);
+                    if (index == -1) {
+                        any_match = false;
+                        break;
+                    }
+
+                    position = index + any.size();
+                }
+
+                if (any_match && position <= value.size() - final.size()) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+        case LDAP_FILTER_GE:
+        case LDAP_FILTER_LE: {
+            bool target_is_number;
+            const qint64 target_number = filter.value.toLongLong(&target_is_number);
+
+            for (const QByteArray &value : entry.get_values(filter.attribute)) {
+                bool value_is_number;
+                const qint64 value_number = value.toLongLong(&value_is_number);
+
+                const int compare_result = [&]() {
+                    if (target_is_number && value_is_number) {
+                        return (value_number < target_number ? -1 : (value_number > target_number ? 1 : 0));
+                    } else {
+                        return qstrcmp(value.toLower(), filter.value.toLower());
+                    }
+                }();
+
+                const bool match = (filter.type == LDAP_FILTER_GE ? compare_result >= 0 : compare_result <= 0);
+                if (match) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+        case LDAP_FILTER_EXT: {
+            const quint32 filter_bits = (quint32) filter.value.toLongLong();
+
+            for (const QByteArray &value : entry.get_values(filter.attribute)) {
+                const quint32 value_bits = (quint32) value.toLongLong();
+
+                if (filter.matching_rule == "1.2.840.113556.1.4.803") {
+                    if ((value_bits & filter_bits) == filter_bits) {
+                        return true;
+                    }
+                } else if (filter.matching_rule == "1.2.840.113556.1.4.804") {
+                    if ((value_bits & filter_bits) != 0) {
+                        return true;
+                    }
+                } else if (filter.matching_rule.isEmpty()) {
+                    if (value.toLower() == filter.value.toLower()) {
+                        return true;
+                    }
+                }
+            }
+
+            if (filter.matching_rule == "1.2.840.113556.1.4.1941") {
+                return filter_match_in_chain(filter.attribute, filter.value, entry);
+            }
+
+            return false;
+        }
+    }
+
+    return false;
+}
+
+// NOTE: follows values of the attribute through
+// referenced objects, so "memberOf" matches groups that
+// contain the object indirectly
+bool FakeAdDirectory::filter_match_in_chain(const QString &attribute, const QByteArray &target_dn, const FakeAdEntry &entry) const {
+    const QString target_key = QString(target_dn).toLower();
+
+    QSet<QString> visited;
+    QList<const FakeAdEntry *> stack = {&entry};
+
+    while (!stack.isEmpty()) {
+        const FakeAdEntry *current = stack.takeLast();
+
+        for (const QByteArray &value : current->get_values(attribute)) {
+            const QString value_key = QString(value).toLower();
+
+            if (value_key == target_key) {
+                return true;
+            }
+
+            if (visited.contains(value_key)) {
+                continue;
+            }
+            visited.insert(value_key);
+
+            const FakeAdEntry *next = get_entry(value_key);
+            if (next != nullptr) {
+                stack.append(next);
+            }
+        }
+    }
+
+    return false;
+}
+
+void FakeAdDirectory::collect_subtree(const QString &key, QList<QString> *out) const {
+    const QList<QString> child_list = children_map.value(key);
+
+    for (const QString &child : child_list) {
+        out->append(child);
+        collect_subtree(child, out);
+    }
+}
+
+void FakeAdDirectory::add_generated_attributes(FakeAdEntry *entry) {
+    const DnView dn_view(entry->dn);
+    const QByteArray name = dn_view.name().toUtf8();
+    const QString object_class = QString(entry->get_values("objectClass").last());
+    const FakeAdClassSchema *schema = fake_ad_class_schema(object_class);
+
+    auto set_default = [&](const QString &attribute, const QByteArray &value) {
+        if (!entry->contains(attribute)) {
+            entry->set_values(attribute, {value});
+        }
+    };
+
+    entry->set_values(dn_view.rdn_type().toString().toLower(), {name});
+    entry->set_values("name", {name});
+    entry->set_values("distinguishedName", {entry->dn.toUtf8()});
+    set_default("objectGUID", fake_ad_guid(entry->dn.toLower()));
+    set_default("instanceType", "4");
+
+    const QString category_cn = (schema != nullptr ? schema->category_cn : object_class);
+    set_default("objectCategory", QString("CN=%1,%2").arg(category_cn, schema_dn()).toUtf8());
+    set_default("nTSecurityDescriptor", fake_ad_security_descriptor(make_sid(FAKE_AD_ADMINS_RID)));
+
+    const qint64 usn = next_usn;
+    entry->set_values("uSNCreated", {QByteArray::number(usn)});
+    entry->set_values("whenCreated", {fake_ad_time_string(usn).toUtf8()});
+    touch(entry);
+
+    const bool is_user = (object_class == "user" || object_class == "inetOrgPerson");
+    const bool is_computer = (object_class == "computer");
+    const bool is_group = (object_class == "group");
+
+    if (is_user || is_computer || is_group) {
+        if (!entry->contains("objectSid")) {
+            entry->set_values("objectSid", {make_sid(next_rid)});
+            next_rid++;
+        }
+
+        // NOTE: AD generates sam account name if it's
+        // not given
+        set_default("sAMAccountName", name.left(20));
+    }
+
+    if (is_user || is_computer) {
+        set_default("userAccountControl", (is_computer ? "4128" : "546"));
+        set_default("primaryGroupID", QByteArray::number(is_computer ? FAKE_AD_COMPUTERS_RID : FAKE_AD_USERS_RID));
+        set_default("sAMAccountType", (is_computer ? "805306369" : "805306368"));
+        set_default("accountExpires", "9223372036854775807");
+        set_default("pwdLastSet", "0");
+        set_default("lastLogon", "0");
+        set_default("logonCount", "0");
+        set_default("badPwdCount", "0");
+    }
+
+    if (is_group) {
+        set_default("groupType", "-2147483646");
+
+        const quint32 group_type = (quint32) entry->get_value("groupType").toLongLong();
+        const bool is_security = ((group_type & 0x80000000) != 0);
+        const bool is_domain_local = ((group_type & 0x00000004) != 0);
+
+        const QByteArray account_type = [&]() {
+            if (is_domain_local) {
+                return (is_security ? "536870912" : "536870913");
+            } else {
+                return (is_security ? "268435456" : "268435457");
+            }
+        }();
+        set_default("sAMAccountType", account_type);
+    }
+}
+
+void FakeAdDirectory::update_member_links(const QString &group_dn, const QList<QByteArray> &old_members, const QList<QByteArray> &new_members) {
+    const QByteArray group_dn_bytes = group_dn.toUtf8();
+
+    for (const QByteArray &member : old_members) {
+        if (fake_ad_value_index(new_members, member) != -1) {
+            continue;
+        }
+
+        const auto it = entry_map.find(QString(member).toLower());
+        if (it == entry_map.end()) {
+            continue;
+        }
+
+        QList<QByteArray> member_of_list = it.value().get_values("memberOf");
+        const int index = fake_ad_value_index(member_of_list, group_dn_bytes);
+        if (index != -1) {
+            member_of_list.removeAt(index);
+            it.value().set_values("memberOf", member_of_list);
+        }
+    }
+
+    for (const QByteArray &member : new_members) {
+        if (fake_ad_value_index(old_members, member) != -1) {
+            continue;
+        }
+
+        const auto it = entry_map.find(QString(member).toLower());
+        if (it == entry_map.end()) {
+            continue;
+        }
+
+        QList<QByteArray> member_of_list = it.value().get_values("memberOf");
+        if (fake_ad_value_index(member_of_list, group_dn_bytes) == -1) {
+            member_of_list.append(group_dn_bytes);
+            it.value().set_values("memberOf", member_of_list);
+        }
+    }
+}
+
+bool FakeAdDirectory::is_deleted(const FakeAdEntry &entry) const {
+    return (entry.get_value("isDeleted") == "TRUE");
+}
+
+void FakeAdDirectory::touch(FakeAdEntry *entry) {
+    const qint64 usn = next_usn;
+    next_usn++;
+
+    entry->set_values("uSNChanged", {QByteArray::number(usn)});
+    entry->set_values("whenChanged", {fake_ad_time_string(usn).toUtf8()});
+}
+
+// NOTE: tombstone is added directly, because add() would
+// generate name from the DN
+void FakeAdDirectory::add_tombstone(const FakeAdEntry &entry) {
+    const QString guid_string = guid_to_display_value(entry.get_value("objectGUID"));
+    const QString original_name = DnView(entry.dn).name();
+    const QString original_parent = DnView(entry.dn).parent().toString();
+    const QString deleted_name = QString("%1\nDEL:%2").arg(original_name, guid_string);
+
+    FakeAdEntry tombstone;
+    tombstone.dn = QString("CN=%1\\0ADEL:%2,%3").arg(original_name, guid_string, deleted_objects_dn());
+
+    const QList<QString> kept_attribute_list = {"objectClass", "objectGUID", "objectSid", "objectCategory", "instanceType", "uSNCreated", "whenCreated"};
+    for (const QString &attribute : kept_attribute_list) {
+        if (entry.contains(attribute)) {
+            tombstone.set_values(attribute, entry.get_values(attribute));
+        }
+    }
+
+    tombstone.set_values("cn", {deleted_name.toUtf8()});
+    tombstone.set_values("name", {deleted_name.toUtf8()});
+    tombstone.set_values("distinguishedName", {tombstone.dn.toUtf8()});
+    tombstone.set_values("isDeleted", {"TRUE"});
+    tombstone.set_values("lastKnownParent", {original_parent.toUtf8()});
+    touch(&tombstone);
+
+    const QString key = tombstone.dn.toLower();
+    entry_map[key] = tombstone;
+    children_map[deleted_objects_dn().toLower()].append(key);
+}
+
+QByteArray FakeAdDirectory::make_sid(const int rid) const {
+    QByteArray out = domain_sid;
+    out[1] = (char) (out[1] + 1);
+    fake_ad_append_u32(&out, (quint32) rid);
+
+    return out;
+}
+
+void FakeAdDirectory::add_schema() {
+    for (const FakeAdAttributeSchema &schema : fake_ad_attribute_schema_list()) {
+        QList<FakeAdAttribute> attribute_list = {
+            fake_ad_attribute("objectClass", {"attributeSchema"}),
+            fake_ad_attribute("lDAPDisplayName", {schema.name}),
+            fake_ad_attribute("attributeSyntax", {schema.syntax}),
+            fake_ad_attribute("oMSyntax", {QString::number(schema.om_syntax)}),
+            fake_ad_attribute("isSingleValued", {(schema.is_single_valued ? "TRUE" : "FALSE")}),
+            fake_ad_attribute("systemOnly", {(schema.is_system_only ? "TRUE" : "FALSE")}),
+            fake_ad_attribute("systemFlags", {"16"}),
+        };
+
+        if (schema.link_id != 0) {
+            attribute_list.append(fake_ad_attribute("linkID", {QString::number(schema.link_id)}));
+        }
+
+        FakeAdAttribute guid_attribute;
+        guid_attribute.name = "schemaIDGUID";
+        guid_attribute.values = {fake_ad_guid("attribute:" + schema.name)};
+        attribute_list.append(guid_attribute);
+
+        add(QString("CN=%1,%2").arg(schema.name, schema_dn()), attribute_list);
+    }
+
+    for (const FakeAdClassSchema &schema : fake_ad_class_schema_list()) {
+        QList<FakeAdAttribute> attribute_list = {
+            fake_ad_attribute("objectClass", {"classSchema"}),
+            fake_ad_attribute("lDAPDisplayName", {schema.name}),
+            fake_ad_attribute("subClassOf", {schema.sub_class_of}),
+            fake_ad_attribute("defaultObjectCategory", {QString("CN=%1,%2").arg(schema.category_cn, schema_dn())}),
+        };
+
+        if (!schema.poss_superiors.isEmpty()) {
+            attribute_list.append(fake_ad_attribute("systemPossSuperiors", schema.poss_superiors));
+        }
+
+        if (!schema.may_contain.isEmpty()) {
+            attribute_list.append(fake_ad_attribute("systemMayContain", schema.may_contain));
+        }
+
+        FakeAdAttribute guid_attribute;
+        guid_attribute.name = "schemaIDGUID";
+        guid_attribute.values = {fake_ad_guid("class:" + schema.name)};
+        attribute_list.append(guid_attribute);
+
+        add(QString("CN=%1,%2").arg(schema.cn, schema_dn()), attribute_list);
+    }
+}
+
+void FakeAdDirectory::add_display_specifiers() {
+    const QString display_specifiers_dn = QString("CN=DisplaySpecifiers,%1").arg(configuration_dn());
+    add(display_specifiers_dn, {fake_ad_attribute("objectClass", {"container"})});
+
+    const QList<QList<QString>> class_display_list = {
+        {"user", "User"},
+        {"group", "Group"},
+        {"computer", "Computer"},
+        {"contact", "Contact"},
+        {"organizationalUnit", "Organizational Unit"},
+        {"container", "Container"},
+        {"domainDNS", "Domain"},
+        {"groupPolicyContainer", "Group Policy Container"},
+    };
+
+    const QList<QString> attribute_display_names = {
+        "cn,Name",
+        "description,Description",
+        "sAMAccountName,Logon Name (pre-Windows 2000)",
+        "mail,E-Mail Address",
+    };
+
+    // NOTE: AdConfig loads specifiers for english and
+    // russian locales
+    for (const QString &locale_code : {"409", "419"}) {
+        const QString locale_dn = QString("CN=%1,%2").arg(locale_code, display_specifiers_dn);
+        add(locale_dn, {fake_ad_attribute("objectClass", {"container"})});
+
+        for (const QList<QString> &class_display : class_display_list) {
+            add(QString("CN=%1-Display,%2").arg(class_display[0], locale_dn), {
+                fake_ad_attribute("objectClass", {"displaySpecifier"}),
+                fake_ad_attribute("classDisplayName", {class_display[1]}),
+                fake_ad_attribute("attributeDisplayNames", attribute_display_names),
+            });
+        }
+
+        // NOTE: stored in reverse order, see AdConfig
+        add(QString("CN=default-Display,%1").arg(locale_dn), {
+            fake_ad_attribute("objectClass", {"displaySpecifier"}),
+            fake_ad_attribute("extraColumns", {
+                "whenChanged,Modified,0,150,0",
+                "mail,E-Mail Address,0,150,0",
+                "sAMAccountName,Pre-Windows 2000 Logon Name,0,150,0",
+            }),
+        });
+
+        add(QString("CN=DS-UI-Default-Settings,%1").arg(locale_dn), {
+            fake_ad_attribute("objectClass", {"container"}),
+            fake_ad_attribute("msDS-FilterContainers", {"Organizational-Unit", "Container", "Builtin-Domain"}),
+        });
+    }
+}
+
+const QList<FakeAdAttributeSchema> &fake_ad_attribute_schema_list() {
+    static const QList<FakeAdAttributeSchema> out = []() {
+        QList<FakeAdAttributeSchema> list;
+
+        auto add_list = [&](const QString &syntax, const int om_syntax, const bool is_single_valued, const QList<QString> &name_list) {
+            for (const QString &name : name_list) {
+                list.append({name, syntax, om_syntax, is_single_valued, false, 0});
+            }
+        };
+
+        add_list("2.5.5.12", 64, true, {"cn", "name", "displayName", "sAMAccountName", "userPrincipalName", "givenName", "sn", "initials", "mail", "dc", "lDAPDisplayName", "classDisplayName", "physicalDeliveryOfficeName", "telephoneNumber", "wWWHomePage", "streetAddress", "l", "st", "postalCode", "c", "co", "company", "department", "title", "homeDirectory", "homeDrive", "profilePath", "scriptPath", "gPCFileSysPath", "gPLink", "location", "info", "rightsGuid", "userWorkstations", "gPCMachineExtensionNames", "gPCUserExtensionNames", "dNSHostName", "operatingSystem"});
+        add_list("2.5.5.12", 64, false, {"description", "ou", "attributeDisplayNames", "extraColumns", "msDS-FilterContainers", "otherTelephone", "appliesTo"});
+        add_list("2.5.5.2", 6, true, {"subClassOf", "attributeSyntax", "governsID", "attributeID"});
+        add_list("2.5.5.2", 6, false, {"objectClass", "possSuperiors", "systemPossSuperiors", "mayContain", "systemMayContain", "mustContain", "systemMustContain", "auxiliaryClass", "systemAuxiliaryClass"});
+        add_list("2.5.5.1", 127, true, {"distinguishedName", "objectCategory", "defaultObjectCategory", "lastKnownParent"});
+        add_list("2.5.5.9", 2, true, {"userAccountControl", "groupType", "systemFlags", "instanceType", "sAMAccountType", "primaryGroupID", "oMSyntax", "linkID", "rangeUpper", "gPOptions", "gPCFunctionalityVersion", "flags", "versionNumber", "validAccesses", "msDS-SupportedEncryptionTypes", "adminCount", "logonCount", "badPwdCount"});
+        add_list("2.5.5.9", 10, true, {"countryCode"});
+        add_list("2.5.5.8", 1, true, {"isSingleValued", "systemOnly", "isCriticalSystemObject", "showInAdvancedViewOnly", "isDeleted"});
+        add_list("2.5.5.16", 65, true, {"accountExpires", "pwdLastSet", "lastLogon", "lastLogonTimestamp", "badPasswordTime", "lockoutTime", "uSNCreated", "uSNChanged", "maxPwdAge", "minPwdAge", "lockoutDuration", "lockOutObservationWindow"});
+        add_list("2.5.5.11", 24, true, {"whenCreated", "whenChanged"});
+        add_list("2.5.5.10", 4, true, {"objectGUID", "schemaIDGUID", "logonHours"});
+        add_list("2.5.5.17", 4, true, {"objectSid"});
+        add_list("2.5.5.15", 66, true, {"nTSecurityDescriptor"});
+
+        // Linked attributes, odd link id's are backlinks
+        list.append({"member", "2.5.5.1", 127, false, false, 2});
+        list.append({"memberOf", "2.5.5.1", 127, false, true, 3});
+        list.append({"manager", "2.5.5.1", 127, true, false, 42});
+        list.append({"directReports", "2.5.5.1", 127, false, true, 43});
+        list.append({"managedBy", "2.5.5.1", 127, true, false, 72});
+        list.append({"managedObjects", "2.5.5.1", 127, false, true, 73});
+
+        return list;
+    }();
+
+    return out;
+}
+
+const QList<FakeAdClassSchema> &fake_ad_class_schema_list() {
+    static const QList<FakeAdClassSchema> out = []() {
+        const QList<QString> container_superiors = {"domainDNS", "organizationalUnit", "container"};
+        const QList<QString> person_may_contain = {"givenName", "initials", "displayName", "title", "department", "company", "physicalDeliveryOfficeName", "telephoneNumber", "otherTelephone", "streetAddress", "l", "st", "postalCode", "c", "co", "countryCode", "mail", "wWWHomePage", "manager", "directReports"};
+        const QList<QString> user_may_contain = {"sAMAccountName", "userPrincipalName", "userAccountControl", "accountExpires", "pwdLastSet", "lastLogon", "lastLogonTimestamp", "badPasswordTime", "lockoutTime", "homeDirectory", "homeDrive", "profilePath", "scriptPath", "memberOf", "primaryGroupID", "logonHours", "userWorkstations", "objectSid", "logonCount", "badPwdCount", "adminCount", "sAMAccountType"};
+
+        const QList<FakeAdClassSchema> list = {
+            {"top", "Top", "top", "Top", {}, {"cn", "name", "description", "distinguishedName", "objectCategory", "objectGUID", "nTSecurityDescriptor", "whenCreated", "whenChanged", "uSNCreated", "uSNChanged", "instanceType", "systemFlags", "isCriticalSystemObject", "showInAdvancedViewOnly", "managedObjects", "info"}},
+            {"domain", "Domain", "top", "Domain", {}, {"dc"}},
+            {"domainDNS", "Domain-DNS", "domain", "Domain-DNS", {"domainDNS"}, {"gPLink", "gPOptions", "maxPwdAge", "minPwdAge", "lockoutDuration", "lockOutObservationWindow", "objectSid"}},
+            {"organizationalUnit", "Organizational-Unit", "top", "Organizational-Unit", {"domainDNS", "organizationalUnit"}, {"ou", "gPLink", "gPOptions", "managedBy", "streetAddress", "l", "st", "postalCode", "c", "co", "countryCode"}},
+            {"container", "Container", "top", "Container", {"domainDNS", "organizationalUnit", "container", "configuration"}, {}},
+            {"person", "Person", "top", "Person", container_superiors, {"sn", "telephoneNumber"}},
+            {"organizationalPerson", "Organizational-Person", "person", "Person", container_superiors, person_may_contain},
+            {"user", "User", "organizationalPerson", "Person", container_superiors, user_may_contain},
+            {"inetOrgPerson", "inetOrgPerson", "user", "Person", container_superiors, {}},
+            {"computer", "Computer", "user", "Computer", container_superiors, {"dNSHostName", "operatingSystem", "location", "managedBy", "msDS-SupportedEncryptionTypes"}},
+            {"contact", "Contact", "organizationalPerson", "Person", container_superiors, {"memberOf"}},
+            {"group", "Group", "top", "Group", container_superiors, {"sAMAccountName", "groupType", "sAMAccountType", "member", "memberOf", "managedBy", "mail", "objectSid", "adminCount"}},
+            {"groupPolicyContainer", "Group-Policy-Container", "container", "Group-Policy-Container", {"container"}, {"displayName", "gPCFileSysPath", "versionNumber", "flags", "gPCFunctionalityVersion", "gPCMachineExtensionNames", "gPCUserExtensionNames"}},
+            {"builtinDomain", "Builtin-Domain", "top", "Builtin-Domain", {"domainDNS"}, {}},
+            {"configuration", "Configuration", "top", "Configuration", {"domainDNS"}, {}},
+            {"dMD", "DMD", "top", "DMD", {"configuration"}, {}},
+            {"attributeSchema", "Attribute-Schema", "top", "Attribute-Schema", {"dMD"}, {"lDAPDisplayName", "attributeSyntax", "oMSyntax", "isSingleValued", "systemOnly", "rangeUpper", "linkID", "schemaIDGUID", "attributeID"}},
+            {"classSchema", "Class-Schema", "top", "Class-Schema", {"dMD"}, {"lDAPDisplayName", "possSuperiors", "systemPossSuperiors", "mayContain", "systemMayContain", "mustContain", "systemMustContain", "auxiliaryClass", "systemAuxiliaryClass", "subClassOf", "schemaIDGUID", "governsID", "defaultObjectCategory"}},
+            {"controlAccessRight", "Control-Access-Right", "top", "Control-Access-Right", {"container"}, {"displayName", "rightsGuid", "appliesTo", "validAccesses"}},
+            {"displaySpecifier", "Display-Specifier", "top", "Display-Specifier", {"container"}, {"classDisplayName", "attributeDisplayNames", "extraColumns"}},
+            {"msDS-PasswordSettingsContainer", "ms-DS-Password-Settings-Container", "top", "ms-DS-Password-Settings-Container", {"container"}, {}},
+            {"msDS-PasswordSettings", "ms-DS-Password-Settings", "top", "ms-DS-Password-Settings", {"msDS-PasswordSettingsContainer"}, {}},
+            {"volume", "Volume", "top", "Volume", container_superiors, {}},
+        };
+
+        return list;
+    }();
+
+    return out;
+}
+
+const FakeAdClassSchema *fake_ad_class_schema(const QString &object_class) {
+    static const QHash<QString, int> index_map = []() {
+        QHash<QString, int> out;
+
+        const QList<FakeAdClassSchema> &list = fake_ad_class_schema_list();
+        for (int i = 0; i < list.size(); i++) {
+            out[list[i].name.toLower()] = i;
+        }
+
+        return out;
+    }();
+
+    const int index = index_map.value(object_class.toLower(), -1);
+
+    if (index == -1) {
+        return nullptr;
+    } else {
+        return &fake_ad_class_schema_list()[index];
+    }
+}
+
+// "user" => {"top", "person", "organizationalPerson", "user"}
+QList<QString> fake_ad_class_chain(const QString &object_class) {
+    QList<QString> out;
+
+    const FakeAdClassSchema *schema = fake_ad_class_schema(object_class);
+
+    if (schema == nullptr) {
+        return {"top", object_class};
+    }
+
+    while (schema != nullptr) {
+        out.prepend(schema->name);
+
+        if (schema->name == "top") {
+            break;
+        }
+
+        schema = fake_ad_class_schema(schema->sub_class_of);
+    }
+
+    return out;
+}
+
+// NOTE: AD compares most values case insensitively
+int fake_ad_value_index(const QList<QByteArray> &value_list, const QByteArray &value) {
+    const QByteArray value_lower = value.toLower();
+
+    for (int i = 0; i < value_list.size(); i++) {
+        if (value_list[i].size() == value.size() && value_list[i].toLower() == value_lower) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// NOTE: GUID's are derived from seeds so that generated
+// domains are the same between runs
+QByteArray fake_ad_guid(const QString &seed) {
+    return QCryptographicHash::hash(seed.toUtf8(), QCryptographicHash::Md5);
+}
+
+QString fake_ad_guid_string(const QString &seed) {
+    const QString guid = guid_to_display_value(fake_ad_guid(seed)).toUpper();
+
+    return QString("{%1}").arg(guid);
+}
+
+// NOTE: timestamps advance with USN from a fixed start,
+// so that generated domains are the same between runs
+QString fake_ad_time_string(const qint64 usn) {
+    const QDateTime start = QDateTime(QDate(2024, 1, 1), QTime(0, 0), Qt::UTC);
+    const QDateTime time = start.addSecs(usn);
+
+    return time.toString("yyyyMMddhhmmss") + ".0Z";
+}
+
+// Self-relative security descriptor with owner and group
+// set to domain admins and a DACL that gives read access
+// to everyone and full access to admins and system
+QByteArray fake_ad_security_descriptor(const QByteArray &admins_sid) {
+    const QByteArray everyone_sid("\x01\x01\x00\x00\x00\x00\x00\x01\x00\x00\x00\x00", 12);
+    const QByteArray system_sid("\x01\x01\x00\x00\x00\x00\x00\x05\x12\x00\x00\x00", 12);
+    const quint32 read_mask = 0x00020094;
+    const quint32 full_mask = 0x000F01FF;
+
+    const QList<QPair<QByteArray, quint32>> ace_list = {
+        {everyone_sid, read_mask},
+        {admins_sid, full_mask},
+        {system_sid, full_mask},
+    };
+
+    QByteArray ace_data;
+    for (const QPair<QByteArray, quint32> &ace : ace_list) {
+        // Type, flags, size, mask, sid
+        ace_data.append((char) 0);
+        ace_data.append((char) 0);
+        fake_ad_append_u16(&ace_data, (quint16) (8 + ace.first.size()));
+        fake_ad_append_u32(&ace_data, ace.second);
+        ace_data.append(ace.first);
+    }
+
+    QByteArray acl;
+    acl.append((char) 2);
+    acl.append((char) 0);
+    fake_ad_append_u16(&acl, (quint16) (8 + ace_data.size()));
+    fake_ad_append_u16(&acl, (quint16) ace_list.size());
+    fake_ad_append_u16(&acl, 0);
+    acl.append(ace_data);
+
+    const quint32 header_size = 20;
+    const quint32 owner_offset = header_size;
+    const quint32 group_offset = owner_offset + admins_sid.size();
+    const quint32 dacl_offset = group_offset + admins_sid.size();
+
+    // SE_SELF_RELATIVE | SE_DACL_PRESENT
+    const quint16 control = 0x8004;
+
+    QByteArray out;
+    out.append((char) 1);
+    out.append((char) 0);
+    fake_ad_append_u16(&out, control);
+    fake_ad_append_u32(&out, owner_offset);
+    fake_ad_append_u32(&out, group_offset);
+    fake_ad_append_u32(&out, 0);
+    fake_ad_append_u32(&out, dacl_offset);
+    out.append(admins_sid);
+    out.append(admins_sid);
+    out.append(acl);
+
+    return out;
+}
+
+void fake_ad_append_u16(QByteArray *out, const quint16 value) {
+    out->append((char) (value & 0xFF));
+    out->append((char) ((value >> 8) & 0xFF));
+}
+
+void fake_ad_append_u32(QByteArray *out, const quint32 value) {
+    for (int i = 0; i < 4; i++) {
+        out->append((char) ((value >> (8 * i)) & 0xFF));
+    }
+}
+
+QList<QByteArray> fake_ad_values(const QList<QString> &string_list) {
+    QList<QByteArray> out;
+
+    for (const QString &string : string_list) {
+        out.append(string.toUtf8());
+    }
+
+    return out;
+}
+
+FakeAdAttribute fake_ad_attribute(const QString &name, const QList<QString> &value_list) {
+    FakeAdAttribute out;
+    out.name = name;
+    out.values = fake_ad_values(value_list);
+
+    return out;
+}
@@ -0,0 +1,153 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FAKE_AD_DIRECTORY_H
+#define FAKE_AD_DIRECTORY_H
+
+/**
+ * In-memory stand-in for an AD domain. Implements the
+ * subset of AD behavior that ADMC depends on: rootDSE,
+ * schema and display specifier objects that AdConfig
+ * loads, objectClass expansion, generated attributes
+ * (GUID, SID, timestamps, USN's, default security
+ * descriptor), member/memberOf backlinks, tree delete and
+ * tombstones of deleted objects.
+ * Operations return LDAP result codes. Used by
+ * FakeAdServer, which makes the directory reachable over
+ * LDAP, so that tests and benchmarks can run without a
+ * real domain.
+ */
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+// Amounts of objects in generated domain. Users and
+// groups are distributed between OU's. Each OU is linked
+// to one of the GPO's.
+class FakeAdDomainSize {
+public:
+    int users = 100;
+    int groups = 10;
+    int ous = 10;
+    int gpos = 5;
+    int members_per_group = 10;
+};
+
+class FakeAdAttribute {
+public:
+    QString name;
+    QList<QByteArray> values;
+};
+
+class FakeAdEntry {
+public:
+    QString dn;
+
+    // NOTE: keys are lowercased attribute names
+    QHash<QString, FakeAdAttribute> attributes;
+
+    bool contains(const QString &attribute) const;
+    QList<QByteArray> get_values(const QString &attribute) const;
+    QByteArray get_value(const QString &attribute) const;
+    void set_values(const QString &attribute, const QList<QByteArray> &values);
+};
+
+// Decoded search filter. Type is one of LDAP_FILTER_*
+// values.
+class FakeAdFilter {
+public:
+    int type = 0;
+    QString attribute;
+    QByteArray value;
+    QString matching_rule;
+    QByteArray substring_initial;
+    QList<QByteArray> substring_any;
+    QByteArray substring_final;
+    QList<FakeAdFilter> children;
+};
+
+// Operation is one of LDAP_MOD_* values
+class FakeAdModification {
+public:
+    int operation;
+    QString attribute;
+    QList<QByteArray> values;
+};
+
+class FakeAdDirectory {
+
+public:
+    FakeAdDirectory(const QString &domain);
+
+    // Generates a domain with given amounts of objects.
+    // Call once, on an empty directory.
+    void populate(const FakeAdDomainSize &size);
+
+    QString domain() const;
+    QString domain_dn() const;
+    QString configuration_dn() const;
+    QString schema_dn() const;
+    QString deleted_objects_dn() const;
+    int entry_count() const;
+
+    // NOTE: returned pointers are valid until next
+    // operation that modifies the directory. Deleted
+    // objects are only returned if show_deleted is true,
+    // like with the show deleted control.
+    int search(const QString &base, const int scope, const FakeAdFilter &filter, QList<const FakeAdEntry *> *results, const bool show_deleted = false) const;
+    const FakeAdEntry *get_entry(const QString &dn) const;
+
+    int add(const QString &dn, const QList<FakeAdAttribute> &attribute_list);
+    int modify(const QString &dn, const QList<FakeAdModification> &modification_list);
+
+    // NOTE: like AD, deleted objects are moved to
+    // "Deleted Objects" container as tombstones. Tombstone
+    // keeps objectClass and GUID, name becomes original
+    // name followed by "\nDEL:" and GUID and original
+    // parent is saved in lastKnownParent.
+    int remove(const QString &dn, const bool tree_delete);
+    int rename(const QString &dn, const QString &new_rdn, const QString &new_superior);
+
+private:
+    QString m_domain;
+    QString m_domain_dn;
+    FakeAdEntry root_dse;
+    QByteArray domain_sid;
+    QHash<QString, FakeAdEntry> entry_map;
+    QHash<QString, QList<QString>> children_map;
+    int next_rid;
+    qint64 next_usn;
+
+    bool filter_match(const FakeAdFilter &filter, const FakeAdEntry &entry) const;
+    bool is_deleted(const FakeAdEntry &entry) const;
+    bool filter_match_in_chain(const QString &attribute, const QByteArray &target_dn, const FakeAdEntry &entry) const;
+    void collect_subtree(const QString &key, QList<QString> *out) const;
+    void add_generated_attributes(FakeAdEntry *entry);
+    void update_member_links(const QString &group_dn, const QList<QByteArray> &old_members, const QList<QByteArray> &new_members);
+    void touch(FakeAdEntry *entry);
+    void add_tombstone(const FakeAdEntry &entry);
+    QByteArray make_sid(const int rid) const;
+    void add_schema();
+    void add_display_specifiers();
+};
+
+#endif /* FAKE_AD_DIRECTORY_H */
@@ -0,0 +1,1095 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fake_ad_server.h"
+
+#include "ad_interface.h"
+
+#include <lber.h>
+#include <ldap.h>
+
+#include <QHostAddress>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QSemaphore>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <QTimer>
+
+#include <climits>
+
+class FakeAdControl {
+public:
+    QString oid;
+    bool is_critical = false;
+    QByteArray value;
+};
+
+class FakeAdConnection {
+
+public:
+    FakeAdConnection(QTcpSocket *socket, FakeAdDirectory *directory, FakeAdServerThread *server);
+    ~FakeAdConnection();
+
+    void on_ready_read();
+
+private:
+    QTcpSocket *socket;
+    FakeAdDirectory *directory;
+    FakeAdServerThread *server;
+    QByteArray buffer;
+
+    // NOTE: searches which are waiting for search delay
+    // to pass, by message id. Abandoned searches are
+    // removed from here and never answered.
+    QHash<ber_int_t, QByteArray> delayed_search_map;
+
+    // NOTE: remaining results of paged searches, by
+    // cookie. Results are collected once on first page.
+    QHash<QByteArray, QList<QString>> paged_search_map;
+    int next_cookie;
+
+    void process_message(const QByteArray &message, const bool search_delay_allowed = true);
+    void delay_search(const QByteArray &message, const ber_int_t message_id, const int search_delay);
+    void process_abandon(BerElement *ber);
+    void process_search(BerElement *ber, const ber_int_t message_id);
+    void process_modify(BerElement *ber, const ber_int_t message_id);
+    void process_add(BerElement *ber, const ber_int_t message_id);
+    void process_delete(BerElement *ber, const ber_int_t message_id);
+    void process_rename(BerElement *ber, const ber_int_t message_id);
+    void send_entry(const ber_int_t message_id, const FakeAdEntry &entry, const QList<QString> &attribute_list, const bool attrs_only);
+    void send_result(const ber_int_t message_id, const ber_tag_t tag, const int result, const QByteArray &page_cookie = QByteArray(), const bool is_paged = false);
+    void send(BerElement *ber);
+};
+
+class FakeAdServerThread final : public QThread {
+
+public:
+    FakeAdServerThread(FakeAdDirectory *directory);
+
+    int port;
+    QSemaphore ready_semaphore;
+
+    // NOTE: these are accessed from both server and test
+    // threads
+    QAtomicInt search_delay;
+    QAtomicInt delayed_search_count;
+    QAtomicInt max_delayed_search_count;
+    QAtomicInt abandoned_search_count;
+    QAtomicInt deleted_objects_readable;
+
+    // NOTE: set from test thread, applied in server
+    // thread, so guarded by mutex
+    QMutex concurrent_modify_mutex;
+    QString concurrent_modify_dn;
+    QList<FakeAdModification> concurrent_modify_list;
+
+protected:
+    void run() override;
+
+private:
+    FakeAdDirectory *directory;
+};
+
+int fake_ad_message_size(const QByteArray &buffer);
+QList<FakeAdControl> fake_ad_decode_controls(BerElement *ber);
+bool fake_ad_decode_filter(BerElement *ber, FakeAdFilter *out);
+QByteArray fake_ad_bv_to_bytes(const struct berval &bv);
+QString fake_ad_bv_to_string(const struct berval &bv);
+
+FakeAdServer::FakeAdServer(const FakeAdDomainSize &size, const QString &domain)
+: m_directory(domain) {
+    m_directory.populate(size);
+
+    thread = nullptr;
+    delay_msecs = 0;
+    deleted_objects_readable = true;
+}
+
+FakeAdServer::~FakeAdServer() {
+    stop();
+}
+
+bool FakeAdServer::start() {
+    if (thread != nullptr) {
+        return true;
+    }
+
+    thread = new FakeAdServerThread(&m_directory);
+    thread->search_delay.storeRelease(delay_msecs);
+    thread->deleted_objects_readable.storeRelease(deleted_objects_readable);
+    thread->start();
+    thread->ready_semaphore.acquire();
+
+    if (thread->port == 0) {
+        stop();
+
+        return false;
+    }
+
+    return true;
+}
+
+void FakeAdServer::stop() {
+    if (thread == nullptr) {
+        return;
+    }
+
+    thread->quit();
+    thread->wait();
+
+    delete thread;
+    thread = nullptr;
+}
+
+QString FakeAdServer::host() const {
+    return "127.0.0.1";
+}
+
+int FakeAdServer::port() const {
+    if (thread == nullptr) {
+        return 0;
+    }
+
+    return thread->port;
+}
+
+QString FakeAdServer::domain() const {
+    return m_directory.domain();
+}
+
+FakeAdDirectory *FakeAdServer::directory() {
+    return &m_directory;
+}
+
+void FakeAdServer::set_search_delay(const int msecs) {
+    delay_msecs = msecs;
+
+    if (thread != nullptr) {
+        thread->search_delay.storeRelease(msecs);
+    }
+}
+
+int FakeAdServer::max_delayed_search_count() const {
+    if (thread == nullptr) {
+        return 0;
+    }
+
+    return thread->max_delayed_search_count.loadAcquire();
+}
+
+int FakeAdServer::abandoned_search_count() const {
+    if (thread == nullptr) {
+        return 0;
+    }
+
+    return thread->abandoned_search_count.loadAcquire();
+}
+
+void FakeAdServer::reset_search_counts() {
+    if (thread == nullptr) {
+        return;
+    }
+
+    thread->max_delayed_search_count.storeRelease(0);
+    thread->abandoned_search_count.storeRelease(0);
+}
+
+void FakeAdServer::set_concurrent_modify(const QString &dn, const QList<FakeAdModification> &modification_list) {
+    if (thread == nullptr) {
+        return;
+    }
+
+    QMutexLocker locker(&thread->concurrent_modify_mutex);
+    thread->concurrent_modify_dn = dn;
+    thread->concurrent_modify_list = modification_list;
+}
+
+void FakeAdServer::set_deleted_objects_readable(const bool readable) {
+    deleted_objects_readable = readable;
+
+    if (thread != nullptr) {
+        thread->deleted_objects_readable.storeRelease(readable);
+    }
+}
+
+void FakeAdServer::setup_ad_interface() const {
+    AdInterface::set_domain_is_default(false);
+    AdInterface::set_custom_domain(domain());
+    AdInterface::set_test_server(host());
+    AdInterface::set_port(port());
+}
+
+FakeAdServerThread::FakeAdServerThread(FakeAdDirectory *directory_arg)
+: QThread() {
+    directory = directory_arg;
+    port = 0;
+}
+
+void FakeAdServerThread::run() {
+    // NOTE: server and sockets must live in this thread,
+    // so they are created here and destroyed when event
+    // loop exits
+    QTcpServer server;
+
+    if (!server.listen(QHostAddress::LocalHost, 0)) {
+        ready_semaphore.release();
+
+        return;
+    }
+
+    port = server.serverPort();
+
+    QObject::connect(
+        &server, &QTcpServer::newConnection,
+        &server,
+        [&]() {
+            while (server.hasPendingConnections()) {
+                QTcpSocket *socket = server.nextPendingConnection();
+                FakeAdConnection *connection = new FakeAdConnection(socket, directory, this);
+
+                QObject::connect(
+                    socket, &QTcpSocket::readyRead,
+                    socket,
+                    [connection]() {
+                        connection->on_ready_read();
+                    });
+                QObject::connect(
+                    socket, &QTcpSocket::disconnected,
+                    socket, &QObject::deleteLater);
+                QObject::connect(
+                    socket, &QObject::destroyed,
+                    [connection]() {
+                        delete connection;
+                    });
+            }
+        });
+
+    ready_semaphore.release();
+
+    exec();
+}
+
+FakeAdConnection::FakeAdConnection(QTcpSocket *socket_arg, FakeAdDirectory *directory_arg, FakeAdServerThread *server_arg) {
+    socket = socket_arg;
+    directory = directory_arg;
+    server = server_arg;
+    next_cookie = 1;
+}
+
+FakeAdConnection::~FakeAdConnection() {
+    server->delayed_search_count.fetchAndSubOrdered(delayed_search_map.size());
+}
+
+void FakeAdConnection::on_ready_read() {
+    buffer.append(socket->readAll());
+
+    while (true) {
+        const int message_size = fake_ad_message_size(buffer);
+
+        if (message_size == -1) {
+            socket->abort();
+
+            return;
+        } else if (message_size == 0 || message_size > buffer.size()) {
+            return;
+        }
+
+        const QByteArray message = buffer.left(message_size);
+        buffer.remove(0, message_size);
+
+        process_message(message);
+
+        if (socket->state() != QAbstractSocket::ConnectedState) {
+            return;
+        }
+    }
+}
+
+void FakeAdConnection::process_message(const QByteArray &message, const bool search_delay_allowed) {
+    struct berval message_bv;
+    message_bv.bv_val = (char *) message.constData();
+    message_bv.bv_len = message.size();
+
+    BerElement *ber = ber_init(&message_bv);
+    if (ber == NULL) {
+        socket->abort();
+
+        return;
+    }
+
+    ber_int_t message_id;
+    ber_len_t len;
+    const ber_tag_t scan_tag = ber_scanf(ber, "{i", &message_id);
+    const ber_tag_t tag = ber_peek_tag(ber, &len);
+
+    if (scan_tag == LBER_ERROR || tag == LBER_ERROR) {
+        ber_free(ber, 1);
+        socket->abort();
+
+        return;
+    }
+
+    switch (tag) {
+        case LDAP_REQ_BIND: {
+            // NOTE: any bind succeeds
+            send_result(message_id, LDAP_RES_BIND, LDAP_SUCCESS);
+
+            break;
+        }
+        case LDAP_REQ_UNBIND: {
+            socket->disconnectFromHost();
+
+            break;
+        }
+        case LDAP_REQ_SEARCH: {
+            const int search_delay = server->search_delay.loadAcquire();
+
+            if (search_delay_allowed && search_delay > 0) {
+                delay_search(message, message_id, search_delay);
+            } else {
+                process_search(ber, message_id);
+            }
+
+            break;
+        }
+        case LDAP_REQ_MODIFY: {
+            process_modify(ber, message_id);
+
+            break;
+        }
+        case LDAP_REQ_ADD: {
+            process_add(ber, message_id);
+
+            break;
+        }
+        case LDAP_REQ_DELETE: {
+            process_delete(ber, message_id);
+
+            break;
+        }
+        case LDAP_REQ_MODDN: {
+            process_rename(ber, message_id);
+
+            break;
+        }
+        case LDAP_REQ_ABANDON: {
+            process_abandon(ber);
+
+            break;
+        }
+        case LDAP_REQ_EXTENDED: {
+            send_result(message_id, LDAP_RES_EXTENDED, LDAP_UNWILLING_TO_PERFORM);
+
+            break;
+        }
+        default: {
+            socket->abort();
+
+            break;
+        }
+    }
+
+    ber_free(ber, 1);
+}
+
+// NOTE: whole message is kept and processed again once
+// delay passes, so that delayed searches are answered by
+// the same code as other searches
+void FakeAdConnection::delay_search(const QByteArray &message, const ber_int_t message_id, const int search_delay) {
+    delayed_search_map[message_id] = message;
+
+    const int delayed_count = server->delayed_search_count.fetchAndAddOrdered(1) + 1;
+
+    int max_count = server->max_delayed_search_count.loadAcquire();
+    while (delayed_count > max_count && !server->max_delayed_search_count.testAndSetOrdered(max_count, delayed_count)) {
+        max_count = server->max_delayed_search_count.loadAcquire();
+    }
+
+    // NOTE: socket is used as context, so that timer
+    // doesn't fire after connection is deleted
+    QTimer::singleShot(search_delay, socket,
+        [this, message_id]() {
+            if (!delayed_search_map.contains(message_id)) {
+                return;
+            }
+
+            const QByteArray delayed_message = delayed_search_map.take(message_id);
+            server->delayed_search_count.fetchAndSubOrdered(1);
+
+            process_message(delayed_message, false);
+        });
+}
+
+// NOTE: abandon is only meaningful for delayed searches,
+// other requests are answered before the next message
+// is read
+void FakeAdConnection::process_abandon(BerElement *ber) {
+    ber_int_t abandoned_id;
+    if (ber_scanf(ber, "i", &abandoned_id) == LBER_ERROR) {
+        return;
+    }
+
+    if (delayed_search_map.remove(abandoned_id) > 0) {
+        server->delayed_search_count.fetchAndSubOrdered(1);
+        server->abandoned_search_count.fetchAndAddOrdered(1);
+    }
+}
+
+void FakeAdConnection::process_search(BerElement *ber, const ber_int_t message_id) {
+    struct berval base_bv;
+    ber_int_t scope;
+    ber_int_t deref;
+    ber_int_t size_limit;
+    ber_int_t time_limit;
+    ber_int_t attrs_only;
+    if (ber_scanf(ber, "{meeiib", &base_bv, &scope, &deref, &size_limit, &time_limit, &attrs_only) == LBER_ERROR) {
+        send_result(message_id, LDAP_RES_SEARCH_RESULT, LDAP_PROTOCOL_ERROR);
+
+        return;
+    }
+
+    FakeAdFilter filter;
+    if (!fake_ad_decode_filter(ber, &filter)) {
+        send_result(message_id, LDAP_RES_SEARCH_RESULT, LDAP_PROTOCOL_ERROR);
+
+        return;
+    }
+
+    QList<QString> attribute_list;
+    {
+        ber_len_t len;
+        char *last;
+        for (ber_tag_t tag = ber_first_element(ber, &len, &last); tag != LBER_DEFAULT; tag = ber_next_element(ber, &len, last)) {
+            struct berval attribute_bv;
+            if (ber_scanf(ber, "m", &attribute_bv) == LBER_ERROR) {
+                send_result(message_id, LDAP_RES_SEARCH_RESULT, LDAP_PROTOCOL_ERROR);
+
+                return;
+            }
+
+            attribute_list.append(fake_ad_bv_to_string(attribute_bv));
+        }
+    }
+
+    ber_scanf(ber, "}");
+
+    bool is_paged = false;
+    ber_int_t page_size = 0;
+    QByteArray cookie;
+    bool show_deleted = false;
+
+    for (const FakeAdControl &control : fake_ad_decode_controls(ber)) {
+        if (control.oid == LDAP_CONTROL_PAGEDRESULTS) {
+            struct berval value_bv;
+            value_bv.bv_val = (char *) control.value.constData();
+            value_bv.bv_len = control.value.size();
+
+            BerElement *value_ber = ber_init(&value_bv);
+            struct berval cookie_bv;
+            const ber_tag_t scan_tag = (value_ber != NULL ? ber_scanf(value_ber, "{im}", &page_size, &cookie_bv) : LBER_ERROR);
+
+            if (scan_tag == LBER_ERROR) {
+                if (value_ber != NULL) {
+                    ber_free(value_ber, 1);
+                }
+                send_result(message_id, LDAP_RES_SEARCH_RESULT, LDAP_PROTOCOL_ERROR);
+
+                return;
+            }
+
+            cookie = fake_ad_bv_to_bytes(cookie_bv);
+            is_paged = true;
+            ber_free(value_ber, 1);
+        } else if (control.oid == "1.2.840.113556.1.4.801") {
+            // NOTE: SD flags control only limits which
+            // parts of security descriptor are returned,
+            // directory always returns whole descriptor
+        } else if (control.oid == LDAP_SERVER_SHOW_DELETED_OID) {
+            show_deleted = (server->deleted_objects_readable.loadAcquire() != 0);
+        } else if (control.is_critical) {
+            send_result(message_id, LDAP_RES_SEARCH_RESULT, LDAP_UNAVAILABLE_CRITICAL_EXTENSION);
+
+            return;
+        }
+    }
+
+    const QString base = fake_ad_bv_to_string(base_bv);
+
+    auto send_entry_list = [&](const QList<const FakeAdEntry *> &entry_list) {
+        for (const FakeAdEntry *entry : entry_list) {
+            send_entry(message_id, *entry, attribute_list, attrs_only);
+        }
+    };
+
+    if (!is_paged) {
+        QList<const FakeAdEntry *> result_list;
+        const int result = directory->search(base, scope, filter, &result_list, show_deleted);
+
+        if (size_limit > 0 && result_list.size() > size_limit) {
+            send_entry_list(result_list.mid(0, size_limit));
+            send_result(message_id, LDAP_RES_SEARCH_RESULT, LDAP_SIZELIMIT_EXCEEDED);
+        } else {
+            send_entry_list(result_list);
+            send_result(message_id, LDAP_RES_SEARCH_RESULT, result);
+        }
+
+        return;
+    }
+
+    // Paged search
+    if (cookie.isEmpty()) {
+        QList<const FakeAdEntry *> result_list;
+        const int result = directory->search(base, scope, filter, &result_list, show_deleted);
+
+        if (result != LDAP_SUCCESS) {
+            send_result(message_id, LDAP_RES_SEARCH_RESULT, result);
+
+            return;
+        }
+
+        cookie = QByteArray::number(next_cookie);
+        next_cookie++;
+
+        QList<QString> &remaining = paged_search_map[cookie];
+        for (const FakeAdEntry *entry : result_list) {
+            remaining.append(entry->dn);
+        }
+    } else if (!paged_search_map.contains(cookie)) {
+        send_result(message_id, LDAP_RES_SEARCH_RESULT, LDAP_UNWILLING_TO_PERFORM);
+
+        return;
+    }
+
+    // NOTE: page size of 0 means that client is done
+    // with the search
+    QList<QString> &remaining = paged_search_map[cookie];
+    const int send_count = (page_size > 0 ? qMin((int) page_size, remaining.size()) : 0);
+
+    QList<const FakeAdEntry *> page;
+    for (int i = 0; i < send_count; i++) {
+        const FakeAdEntry *entry = directory->get_entry(remaining[i]);
+
+        // NOTE: object may have been deleted between
+        // pages
+        if (entry != nullptr) {
+            page.append(entry);
+        }
+    }
+    remaining.erase(remaining.begin(), remaining.begin() + send_count);
+
+    send_entry_list(page);
+
+    if (page_size == 0 || remaining.isEmpty()) {
+        paged_search_map.remove(cookie);
+        cookie.clear();
+    }
+
+    send_result(message_id, LDAP_RES_SEARCH_RESULT, LDAP_SUCCESS, cookie, true);
+}
+
+void FakeAdConnection::process_modify(BerElement *ber, const ber_int_t message_id) {
+    struct berval dn_bv;
+    if (ber_scanf(ber, "{m", &dn_bv) == LBER_ERROR) {
+        send_result(message_id, LDAP_RES_MODIFY, LDAP_PROTOCOL_ERROR);
+
+        return;
+    }
+
+    QList<FakeAdModification> modification_list;
+
+    ber_len_t len;
+    char *last;
+    for (ber_tag_t tag = ber_first_element(ber, &len, &last); tag != LBER_DEFAULT; tag = ber_next_element(ber, &len, last)) {
+        FakeAdModification modification;
+        ber_int_t operation;
+        struct berval attribute_bv;
+
+        if (ber_scanf(ber, "{e{m", &operation, &attribute_bv) == LBER_ERROR) {
+            send_result(message_id, LDAP_RES_MODIFY, LDAP_PROTOCOL_ERROR);
+
+            return;
+        }
+
+        modification.operation = operation;
+        modification.attribute = fake_ad_bv_to_string(attribute_bv);
+
+        ber_len_t value_len;
+        char *value_last;
+        for (ber_tag_t value_tag = ber_first_element(ber, &value_len, &value_last); value_tag != LBER_DEFAULT; value_tag = ber_next_element(ber, &value_len, value_last)) {
+            struct berval value_bv;
+            if (ber_scanf(ber, "m", &value_bv) == LBER_ERROR) {
+                send_result(message_id, LDAP_RES_MODIFY, LDAP_PROTOCOL_ERROR);
+
+                return;
+            }
+
+            modification.values.append(fake_ad_bv_to_bytes(value_bv));
+        }
+
+        ber_scanf(ber, "}}");
+
+        modification_list.append(modification);
+    }
+
+    ber_scanf(ber, "}");
+
+    const QList<FakeAdControl> control_list = fake_ad_decode_controls(ber);
+    for (const FakeAdControl &control : control_list) {
+        if (control.is_critical && control.oid != "1.2.840.113556.1.4.801") {
+            send_result(message_id, LDAP_RES_MODIFY, LDAP_UNAVAILABLE_CRITICAL_EXTENSION);
+
+            return;
+        }
+    }
+
+    const QString dn = fake_ad_bv_to_string(dn_bv);
+
+    // NOTE: apply concurrent modification first, as if
+    // another client got to the object before this
+    // request
+    {
+        QMutexLocker locker(&server->concurrent_modify_mutex);
+
+        const bool is_concurrent_target = (!server->concurrent_modify_dn.isEmpty() && QString::compare(dn, server->concurrent_modify_dn, Qt::CaseInsensitive) == 0);
+        if (is_concurrent_target) {
+            directory->modify(dn, server->concurrent_modify_list);
+
+            server->concurrent_modify_dn.clear();
+            server->concurrent_modify_list.clear();
+        }
+    }
+
+    const int result = directory->modify(dn, modification_list);
+    send_result(message_id, LDAP_RES_MODIFY, result);
+}
+
+void FakeAdConnection::process_add(BerElement *ber, const ber_int_t message_id) {
+    struct berval dn_bv;
+    if (ber_scanf(ber, "{m", &dn_bv) == LBER_ERROR) {
+        send_result(message_id, LDAP_RES_ADD, LDAP_PROTOCOL_ERROR);
+
+        return;
+    }
+
+    QList<FakeAdAttribute> attribute_list;
+
+    ber_len_t len;
+    char *last;
+    for (ber_tag_t tag = ber_first_element(ber, &len, &last); tag != LBER_DEFAULT; tag = ber_next_element(ber, &len, last)) {
+        FakeAdAttribute attribute;
+        struct berval attribute_bv;
+
+        if (ber_scanf(ber, "{m", &attribute_bv) == LBER_ERROR) {
+            send_result(message_id, LDAP_RES_ADD, LDAP_PROTOCOL_ERROR);
+
+            return;
+        }
+
+        attribute.name = fake_ad_bv_to_string(attribute_bv);
+
+        ber_len_t value_len;
+        char *value_last;
+        for (ber_tag_t value_tag = ber_first_element(ber, &value_len, &value_last); value_tag != LBER_DEFAULT; value_tag = ber_next_element(ber, &value_len, value_last)) {
+            struct berval value_bv;
+            if (ber_scanf(ber, "m", &value_bv) == LBER_ERROR) {
+                send_result(message_id, LDAP_RES_ADD, LDAP_PROTOCOL_ERROR);
+
+                return;
+            }
+
+            attribute.values.append(fake_ad_bv_to_bytes(value_bv));
+        }
+
+        ber_scanf(ber, "}");
+
+        attribute_list.append(attribute);
+    }
+
+    ber_scanf(ber, "}");
+
+    const int result = directory->add(fake_ad_bv_to_string(dn_bv), attribute_list);
+    send_result(message_id, LDAP_RES_ADD, result);
+}
+
+void FakeAdConnection::process_delete(BerElement *ber, const ber_int_t message_id) {
+    struct berval dn_bv;
+    if (ber_scanf(ber, "m", &dn_bv) == LBER_ERROR) {
+        send_result(message_id, LDAP_RES_DELETE, LDAP_PROTOCOL_ERROR);
+
+        return;
+    }
+
+    bool tree_delete = false;
+
+    for (const FakeAdControl &control : fake_ad_decode_controls(ber)) {
+        if (control.oid == LDAP_CONTROL_X_TREE_DELETE) {
+            tree_delete = true;
+        } else if (control.is_critical) {
+            send_result(message_id, LDAP_RES_DELETE, LDAP_UNAVAILABLE_CRITICAL_EXTENSION);
+
+            return;
+        }
+    }
+
+    const int result = directory->remove(fake_ad_bv_to_string(dn_bv), tree_delete);
+    send_result(message_id, LDAP_RES_DELETE, result);
+}
+
+void FakeAdConnection::process_rename(BerElement *ber, const ber_int_t message_id) {
+    struct berval dn_bv;
+    struct berval new_rdn_bv;
+    ber_int_t delete_old_rdn;
+    if (ber_scanf(ber, "{mmb", &dn_bv, &new_rdn_bv, &delete_old_rdn) == LBER_ERROR) {
+        send_result(message_id, LDAP_RES_MODDN, LDAP_PROTOCOL_ERROR);
+
+        return;
+    }
+
+    QString new_superior;
+
+    ber_len_t len;
+    if (ber_peek_tag(ber, &len) == LDAP_TAG_NEWSUPERIOR) {
+        struct berval new_superior_bv;
+        if (ber_scanf(ber, "m", &new_superior_bv) == LBER_ERROR) {
+            send_result(message_id, LDAP_RES_MODDN, LDAP_PROTOCOL_ERROR);
+
+            return;
+        }
+
+        new_superior = fake_ad_bv_to_string(new_superior_bv);
+    }
+
+    ber_scanf(ber, "}");
+
+    const int result = directory->rename(fake_ad_bv_to_string(dn_bv), fake_ad_bv_to_string(new_rdn_bv), new_superior);
+    send_result(message_id, LDAP_RES_MODDN, result);
+}
+
+void FakeAdConnection::send_entry(const ber_int_t message_id, const FakeAdEntry &entry, const QList<QString> &attribute_list, const bool attrs_only) {
+    const bool all_attributes = (attribute_list.isEmpty() || attribute_list.contains("*"));
+
+    QByteArray dn = entry.dn.toUtf8();
+
+    BerElement *ber = ber_alloc_t(LBER_USE_DER);
+    ber_printf(ber, "{it{s{", message_id, (ber_tag_t) LDAP_RES_SEARCH_ENTRY, dn.data());
+
+    auto add_attribute = [&](const FakeAdAttribute &attribute) {
+        QByteArray name = attribute.name.toUtf8();
+        ber_printf(ber, "{s[", name.data());
+
+        if (!attrs_only) {
+            for (const QByteArray &value_const : attribute.values) {
+                QByteArray value = value_const;
+                ber_printf(ber, "o", value.data(), (ber_len_t) value.size());
+            }
+        }
+
+        ber_printf(ber, "]}");
+    };
+
+    if (all_attributes) {
+        for (const FakeAdAttribute &attribute : entry.attributes) {
+            add_attribute(attribute);
+        }
+    } else {
+        for (const QString &attribute_name : attribute_list) {
+            const QString key = attribute_name.toLower();
+
+            if (entry.attributes.contains(key)) {
+                add_attribute(entry.attributes[key]);
+            }
+        }
+    }
+
+    ber_printf(ber, "}}}");
+
+    send(ber);
+}
+
+void FakeAdConnection::send_result(const ber_int_t message_id, const ber_tag_t tag, const int result, const QByteArray &page_cookie, const bool is_paged) {
+    QByteArray message = [&]() -> QByteArray {
+        if (result == LDAP_SUCCESS) {
+            return QByteArray();
+        } else {
+            return ldap_err2string(result);
+        }
+    }();
+    QByteArray matched_dn;
+
+    BerElement *ber = ber_alloc_t(LBER_USE_DER);
+    ber_printf(ber, "{it{ess}", message_id, tag, (ber_int_t) result, matched_dn.data(), message.data());
+
+    if (is_paged) {
+        QByteArray cookie = page_cookie;
+
+        BerElement *value_ber = ber_alloc_t(LBER_USE_DER);
+        ber_printf(value_ber, "{io}", (ber_int_t) 0, cookie.data(), (ber_len_t) cookie.size());
+
+        struct berval *value_bv = NULL;
+        ber_flatten(value_ber, &value_bv);
+        ber_free(value_ber, 1);
+
+        ber_printf(ber, "t{{sO}}", (ber_tag_t) LDAP_TAG_CONTROLS, LDAP_CONTROL_PAGEDRESULTS, value_bv);
+
+        ber_bvfree(value_bv);
+    }
+
+    ber_printf(ber, "}");
+
+    send(ber);
+}
+
+void FakeAdConnection::send(BerElement *ber) {
+    struct berval *bv = NULL;
+
+    if (ber_flatten(ber, &bv) == 0) {
+        socket->write(bv->bv_val, bv->bv_len);
+        ber_bvfree(bv);
+    }
+
+    ber_free(ber, 1);
+}
+
+// Returns total size of first message in buffer, 0 if
+// buffer doesn't contain enough to tell or -1 if message
+// is malformed
+int fake_ad_message_size(const QByteArray &buffer) {
+    if (buffer.size() < 2) {
+        return 0;
+    }
+
+    if ((unsigned char) buffer[0] != LBER_SEQUENCE) {
+        return -1;
+    }
+
+    const unsigned char first_length_byte = (unsigned char) buffer[1];
+
+    if ((first_length_byte & 0x80) == 0) {
+        return 2 + first_length_byte;
+    }
+
+    const int length_byte_count = (first_length_byte & 0x7F);
+    if (length_byte_count == 0 || length_byte_count > 4) {
+        return -1;
+    }
+
+    if (buffer.size() < 2 + length_byte_count) {
+        return 0;
+    }
+
+    qint64 length = 0;
+    for (int i = 0; i < length_byte_count; i++) {
+        length = (length << 8) | (unsigned char) buffer[2 + i];
+    }
+
+    if (length > INT_MAX - 6) {
+        return -1;
+    }
+
+    return 2 + length_byte_count + (int) length;
+}
+
+QList<FakeAdControl> fake_ad_decode_controls(BerElement *ber) {
+    QList<FakeAdControl> out;
+
+    ber_len_t len;
+    if (ber_peek_tag(ber, &len) != LDAP_TAG_CONTROLS) {
+        return out;
+    }
+
+    char *last;
+    for (ber_tag_t tag = ber_first_element(ber, &len, &last); tag != LBER_DEFAULT; tag = ber_next_element(ber, &len, last)) {
+        FakeAdControl control;
+
+        char *control_last;
+        for (ber_tag_t element_tag = ber_first_element(ber, &len, &control_last); element_tag != LBER_DEFAULT; element_tag = ber_next_element(ber, &len, control_last)) {
+            struct berval value_bv;
+            ber_int_t is_critical;
+
+            if (element_tag == LBER_BOOLEAN) {
+                ber_scanf(ber, "b", &is_critical);
+                control.is_critical = is_critical;
+            } else if (control.oid.isEmpty()) {
+                ber_scanf(ber, "m", &value_bv);
+                control.oid = fake_ad_bv_to_string(value_bv);
+            } else {
+                ber_scanf(ber, "m", &value_bv);
+                control.value = fake_ad_bv_to_bytes(value_bv);
+            }
+        }
+
+        out.append(control);
+    }
+
+    return out;
+}
+
+bool fake_ad_decode_filter(BerElement *ber, FakeAdFilter *out) {
+    ber_len_t len;
+    const ber_tag_t tag = ber_peek_tag(ber, &len);
+    out->type = (int) tag;
+
+    switch (tag) {
+        case LDAP_FILTER_AND:
+        case LDAP_FILTER_OR: {
+            char *last;
+            for (ber_tag_t child_tag = ber_first_element(ber, &len, &last); child_tag != LBER_DEFAULT; child_tag = ber_next_element(ber, &len, last)) {
+                FakeAdFilter child;
+                if (!fake_ad_decode_filter(ber, &child)) {
+                    return false;
+                }
+
+                out->children.append(child);
+            }
+
+            return true;
+        }
+        case LDAP_FILTER_NOT: {
+            if (ber_skip_tag(ber, &len) == LBER_DEFAULT) {
+                return false;
+            }
+
+            FakeAdFilter child;
+            if (!fake_ad_decode_filter(ber, &child)) {
+                return false;
+            }
+
+            out->children.append(child);
+
+            return true;
+        }
+        case LDAP_FILTER_EQUALITY:
+        case LDAP_FILTER_GE:
+        case LDAP_FILTER_LE:
+        case LDAP_FILTER_APPROX: {
+            struct berval attribute_bv;
+            struct berval value_bv;
+            if (ber_scanf(ber, "{mm}", &attribute_bv, &value_bv) == LBER_ERROR) {
+                return false;
+            }
+
+            out->attribute = fake_ad_bv_to_string(attribute_bv);
+            out->value = fake_ad_bv_to_bytes(value_bv);
+
+            return true;
+        }
+        case LDAP_FILTER_PRESENT: {
+            struct berval attribute_bv;
+            if (ber_scanf(ber, "m", &attribute_bv) == LBER_ERROR) {
+                return false;
+            }
+
+            out->attribute = fake_ad_bv_to_string(attribute_bv);
+
+            return true;
+        }
+        case LDAP_FILTER_SUBSTRINGS: {
+            struct berval attribute_bv;
+            if (ber_scanf(ber, "{m", &attribute_bv) == LBER_ERROR) {
+                return false;
+            }
+
+            out->attribute = fake_ad_bv_to_string(attribute_bv);
+
+            char *last;
+            for (ber_tag_t child_tag = ber_first_element(ber, &len, &last); child_tag != LBER_DEFAULT; child_tag = ber_next_element(ber, &len, last)) {
+                struct berval value_bv;
+                if (ber_scanf(ber, "m", &value_bv) == LBER_ERROR) {
+                    return false;
+                }
+
+                const QByteArray value = fake_ad_bv_to_bytes(value_bv);
+
+                switch (child_tag) {
+                    case LDAP_SUBSTRING_INITIAL: {
+                        out->substring_initial = value;
+
+                        break;
+                    }
+                    case LDAP_SUBSTRING_ANY: {
+                        out->substring_any.append(value);
+
+                        break;
+                    }
+                    case LDAP_SUBSTRING_FINAL: {
+                        out->substring_final = value;
+
+                        break;
+                    }
+                    default: return false;
+                }
+            }
+
+            ber_scanf(ber, "}");
+
+            return true;
+        }
+        case LDAP_FILTER_EXT: {
+            char *last;
+            for (ber_tag_t child_tag = ber_first_element(ber, &len, &last); child_tag != LBER_DEFAULT; child_tag = ber_next_element(ber, &len, last)) {
+                struct berval value_bv;
+
+                if (child_tag == LDAP_FILTER_EXT_DNATTRS) {
+                    ber_int_t dn_attributes;
+                    ber_scanf(ber, "b", &dn_attributes);
+
+                    continue;
+                }
+
+                if (ber_scanf(ber, "m", &value_bv) == LBER_ERROR) {
+                    return false;
+                }
+
+                switch (child_tag) {
+                    case LDAP_FILTER_EXT_OID: {
+                        out->matching_rule = fake_ad_bv_to_string(value_bv);
+
+                        break;
+                    }
+                    case LDAP_FILTER_EXT_TYPE: {
+                        out->attribute = fake_ad_bv_to_string(value_bv);
+
+                        break;
+                    }
+                    case LDAP_FILTER_EXT_VALUE: {
+                        out->value = fake_ad_bv_to_bytes(value_bv);
+
+                        break;
+                    }
+                    default: return false;
+                }
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+QByteArray fake_ad_bv_to_bytes(const struct berval &bv) {
+    return QByteArray(bv.bv_val, bv.bv_len);
+}
+
+QString fake_ad_bv_to_string(const struct berval &bv) {
+    return QString::fromUtf8(bv.bv_val, bv.bv_len);
+}
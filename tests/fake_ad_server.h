@@ -0,0 +1,95 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FAKE_AD_SERVER_H
+#define FAKE_AD_SERVER_H
+
+/**
+ * Serves a FakeAdDirectory over LDAP on localhost, so
+ * that AdInterface can connect to it like to a real
+ * domain controller. Supports the parts of the protocol
+ * that ADMC uses: simple bind, search with paged results,
+ * SD flags and show deleted controls, modify, add, delete with tree
+ * delete control, modify DN and abandon of delayed
+ * searches. Server runs in it's own thread, so that
+ * blocking AdInterface calls made from the test thread
+ * get answered.
+ */
+
+#include "fake_ad_directory.h"
+
+class FakeAdServerThread;
+
+class FakeAdServer {
+
+public:
+    FakeAdServer(const FakeAdDomainSize &size, const QString &domain = "FAKE.TEST");
+    ~FakeAdServer();
+
+    bool start();
+    void stop();
+
+    QString host() const;
+    int port() const;
+    QString domain() const;
+
+    // NOTE: only access directory while no requests
+    // are in progress, it's not locked
+    FakeAdDirectory *directory();
+
+    // Delays answers to searches, so that searches stay in
+    // flight long enough to be abandoned or to overlap
+    // with other searches. 0 by default.
+    void set_search_delay(const int msecs);
+
+    // Max number of delayed searches which were waiting
+    // for an answer at the same time, on all connections
+    int max_delayed_search_count() const;
+
+    // Number of delayed searches abandoned by client
+    // before they were answered
+    int abandoned_search_count() const;
+
+    void reset_search_counts();
+
+    // Applies modification to object right before the next
+    // modify request for that object is processed, as if
+    // another client changed the object after it was read.
+    // Used to test handling of concurrent edits.
+    void set_concurrent_modify(const QString &dn, const QList<FakeAdModification> &modification_list);
+
+    // If false, show deleted control is accepted but
+    // deleted objects stay hidden, like for a user that
+    // can't read "Deleted Objects" container. True by
+    // default.
+    void set_deleted_objects_readable(const bool readable);
+
+    // Points AdInterface at this server. Call before
+    // creating AdInterface's.
+    void setup_ad_interface() const;
+
+private:
+    FakeAdDirectory m_directory;
+    FakeAdServerThread *thread;
+    int delay_msecs;
+    bool deleted_objects_readable;
+};
+
+#endif /* FAKE_AD_SERVER_H */
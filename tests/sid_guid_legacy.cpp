@@ -0,0 +1,107 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sid_guid_legacy.h"
+
+#include "ad_utils.h"
+#include "samba/dom_sid.h"
+
+#include <algorithm>
+
+QString legacy_sid_to_string(const QByteArray &sid_bytes) {
+    // NOTE: copy into a full struct first so that short
+    // sid's from server are not over-read
+    dom_sid sid;
+    memset(&sid, '\0', sizeof(dom_sid));
+    memcpy(&sid, sid_bytes.constData(), qMin(sid_bytes.size(), (int) sizeof(dom_sid)));
+
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+
+    const char *sid_cstr = dom_sid_string(tmp_ctx, &sid);
+    const QString out = QString(sid_cstr);
+
+    talloc_free(tmp_ctx);
+
+    return out;
+}
+
+QByteArray legacy_sid_from_string(const QString &sid_string) {
+    dom_sid sid;
+    string_to_sid(&sid, CString(sid_string).get());
+
+    const QByteArray sid_bytes = QByteArray((char *) &sid, sizeof(dom_sid));
+
+    return sid_bytes;
+}
+
+QString legacy_guid_to_string(const QByteArray &bytes) {
+    const int segments_count = 5;
+    QByteArray segments[segments_count];
+    segments[0] = bytes.mid(0, 4);
+    segments[1] = bytes.mid(4, 2);
+    segments[2] = bytes.mid(6, 2);
+    segments[3] = bytes.mid(8, 2);
+    segments[4] = bytes.mid(10, 6);
+    std::reverse(segments[0].begin(), segments[0].end());
+    std::reverse(segments[1].begin(), segments[1].end());
+    std::reverse(segments[2].begin(), segments[2].end());
+
+    QString out;
+
+    for (int i = 0; i < segments_count; i++) {
+        if (i > 0) {
+            out += '-';
+        }
+
+        out += segments[i].toHex();
+    }
+
+    return out;
+}
+
+QByteArray legacy_guid_from_string(const QString &guid_string) {
+    QList<QByteArray> segment_list;
+
+    const QList<QString> string_segment_list = guid_string.split('-');
+
+    for (const QString &string_segment : string_segment_list) {
+        const QByteArray segment = QByteArray::fromHex(string_segment.toLatin1());
+        segment_list.append(segment);
+    }
+
+    std::reverse(segment_list[0].begin(), segment_list[0].end());
+    std::reverse(segment_list[1].begin(), segment_list[1].end());
+    std::reverse(segment_list[2].begin(), segment_list[2].end());
+
+    QByteArray out;
+
+    for (const QByteArray &segment : segment_list) {
+        out.append(segment);
+    }
+
+    return out;
+}
+
+QByteArray sid_bytes_as_from_server(const QByteArray &sid_bytes) {
+    const int num_auths = (uchar) sid_bytes[1];
+    const QByteArray out = sid_bytes.left(8 + 4 * num_auths);
+
+    return out;
+}
@@ -0,0 +1,43 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SID_GUID_LEGACY_H
+#define SID_GUID_LEGACY_H
+
+/**
+ * Previous sid and guid codecs which went through samba,
+ * talloc and QString formatting. Kept for tests and
+ * benchmarks to validate and compare against fixed buffer
+ * codecs in ad_utils.
+ */
+
+#include <QByteArray>
+#include <QString>
+
+QString legacy_sid_to_string(const QByteArray &sid_bytes);
+QByteArray legacy_sid_from_string(const QString &sid_string);
+QString legacy_guid_to_string(const QByteArray &bytes);
+QByteArray legacy_guid_from_string(const QString &guid_string);
+
+// NOTE: server returns only the meaningful part of sid,
+// without unused sub auths
+QByteArray sid_bytes_as_from_server(const QByteArray &sid_bytes);
+
+#endif /* SID_GUID_LEGACY_H */